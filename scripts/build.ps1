@@ -66,6 +66,10 @@ This script provides helpers for building msquic.
 .PARAMETER UseIoUring
     Enables io_uring support (Linux-only).
 
+.PARAMETER UseShmDatapath
+    Replaces the UDP datapath with a shared memory loopback datapath, for
+    in-host benchmarking (Linux-only).
+
 .PARAMETER Generator
     Specifies a specific cmake generator (Only supported on unix)
 
@@ -186,6 +190,9 @@ param (
     [Parameter(Mandatory = $false)]
     [switch]$UseIoUring = $false,
 
+    [Parameter(Mandatory = $false)]
+    [switch]$UseShmDatapath = $false,
+
     [Parameter(Mandatory = $false)]
     [string]$Generator = "",
 
@@ -496,6 +503,9 @@ function CMake-Generate {
     if ($UseIoUring) {
         $Arguments += " -DQUIC_LINUX_IOURING_ENABLED=on"
     }
+    if ($UseShmDatapath) {
+        $Arguments += " -DQUIC_LINUX_SHM_DATAPATH=on"
+    }
     if ($Platform -eq "uwp") {
         $Arguments += " -DCMAKE_SYSTEM_NAME=WindowsStore -DCMAKE_SYSTEM_VERSION=10.0 -DQUIC_UWP_BUILD=on"
     }
@@ -3,6 +3,10 @@
 # Set the number of NIC pairs
 NumNicPairs=1
 
+# Set the number of RX/TX queues per NIC (optional second argument). With more
+# than one, XDP opens an AF_XDP socket per queue, spread across partitions.
+NumQueues=${2:-1}
+
 if [ "$1" == "install" ]; then
     # Configure each pair separately with its own hard-coded subnet, ie 192.168.x.0/24 and fc00::x/112
     for ((i=1; i<=NumNicPairs; i++)); do
@@ -13,7 +17,8 @@ if [ "$1" == "install" ]; then
         nic2="duo$((i * 2))"
 
         # Create veth pair
-        sudo ip link add ${nic1} type veth peer name ${nic2}
+        sudo ip link add ${nic1} numtxqueues ${NumQueues} numrxqueues ${NumQueues} type veth \
+            peer name ${nic2} numtxqueues ${NumQueues} numrxqueues ${NumQueues}
 
         # Set the veth interfaces up
         sudo ip link set ${nic1} up
@@ -97,6 +102,6 @@ elif [ "$1" == "uninstall" ]; then
         sudo ip link delete ${nic1}
     done
 else
-    echo "Usage: $0 {install|uninsatll}"
+    echo "Usage: $0 {install [NumQueues]|uninstall}"
     exit 1
 fi
@@ -1018,94 +1018,34 @@ Error:
     return Status;
 }
 
+//
+// Queues a send request from the app on the stream. The request is allocated
+// from the partition's pool and filled in by the caller; it's freed here if it
+// can't be queued.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
-QUIC_API
-MsQuicStreamSend(
-    _In_ _Pre_defensive_ HQUIC Handle,
-    _In_reads_(BufferCount) _Pre_defensive_
-        const QUIC_BUFFER * const Buffers,
-    _In_ uint32_t BufferCount,
-    _In_ QUIC_SEND_FLAGS Flags,
-    _In_opt_ void* ClientSendContext
+QuicStreamQueueApiSend(
+    _In_ QUIC_STREAM* Stream,
+    _In_ __drv_aliasesMem QUIC_SEND_REQUEST* SendRequest
     )
 {
     QUIC_STATUS Status;
-    QUIC_STREAM* Stream;
-    QUIC_CONNECTION* Connection;
-    uint64_t TotalLength;
-    QUIC_SEND_REQUEST* SendRequest;
+    QUIC_CONNECTION* Connection = Stream->Connection;
     BOOLEAN QueueOper = TRUE;
-    const BOOLEAN IsPriority = !!(Flags & QUIC_SEND_FLAG_PRIORITY_WORK);
+    const BOOLEAN IsPriority = !!(SendRequest->Flags & QUIC_SEND_FLAG_PRIORITY_WORK);
     BOOLEAN SendInline;
     QUIC_OPERATION* Oper;
 
-    QuicTraceEvent(
-        ApiEnter,
-        "[ api] Enter %u (%p).",
-        QUIC_TRACE_API_STREAM_SEND,
-        Handle);
-
-    if (!IS_STREAM_HANDLE(Handle) ||
-        (Buffers == NULL && BufferCount != 0)) {
-        Status = QUIC_STATUS_INVALID_PARAMETER;
-        goto Exit;
-    }
-
-#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
-    Stream = (QUIC_STREAM*)Handle;
-
-    CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
-    CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
-
-    Connection = Stream->Connection;
-
-    if (Connection->State.ClosedRemotely) {
-        Status = QUIC_STATUS_ABORTED;
-        goto Exit;
-    }
-
-    TotalLength = 0;
-    for (uint32_t i = 0; i < BufferCount; ++i) {
-        TotalLength += Buffers[i].Length;
-    }
-
-    if (TotalLength > UINT32_MAX) {
-        QuicTraceEvent(
-            StreamError,
-            "[strm][%p] ERROR, %s.",
-            Stream,
-            "Send request total length exceeds max");
-        Status = QUIC_STATUS_INVALID_PARAMETER;
-        goto Exit;
-    }
-
-#pragma prefast(suppress: __WARNING_6014, "Memory is correctly freed (QuicStreamCompleteSendRequest).")
-    SendRequest = CxPlatPoolAlloc(&Connection->Partition->SendRequestPool);
-    if (SendRequest == NULL) {
-        Status = QUIC_STATUS_OUT_OF_MEMORY;
-        QuicTraceEvent(
-            AllocFailure,
-            "Allocation of '%s' failed. (%llu bytes)",
-            "Stream Send request",
-            0);
-        goto Exit;
-    }
-
     QuicTraceEvent(
         StreamAppSend,
         "[strm][%p] App queuing send [%llu bytes, %u buffers, 0x%x flags]",
         Stream,
-        TotalLength,
-        BufferCount,
-        Flags);
+        SendRequest->TotalLength,
+        SendRequest->BufferCount,
+        SendRequest->Flags);
 
     SendRequest->Next = NULL;
-    SendRequest->Buffers = Buffers;
-    SendRequest->BufferCount = BufferCount;
-    SendRequest->Flags = Flags & ~QUIC_SEND_FLAGS_INTERNAL;
-    SendRequest->TotalLength = TotalLength;
-    SendRequest->ClientContext = ClientSendContext;
 
 #pragma warning(push)
 #pragma warning(disable:6240) // CXPLAT_AT_DISPATCH only really does anything for kernel mode
@@ -1216,6 +1156,185 @@ MsQuicStreamSend(
         }
     }
 
+Exit:
+
+    return Status;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSend(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _In_reads_(BufferCount) _Pre_defensive_
+        const QUIC_BUFFER * const Buffers,
+    _In_ uint32_t BufferCount,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_STREAM* Stream;
+    QUIC_CONNECTION* Connection;
+    uint64_t TotalLength;
+    QUIC_SEND_REQUEST* SendRequest;
+
+    QuicTraceEvent(
+        ApiEnter,
+        "[ api] Enter %u (%p).",
+        QUIC_TRACE_API_STREAM_SEND,
+        Handle);
+
+    if (!IS_STREAM_HANDLE(Handle) ||
+        (Buffers == NULL && BufferCount != 0)) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+    Stream = (QUIC_STREAM*)Handle;
+
+    CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
+    CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
+
+    Connection = Stream->Connection;
+
+    if (Connection->State.ClosedRemotely) {
+        Status = QUIC_STATUS_ABORTED;
+        goto Exit;
+    }
+
+    TotalLength = 0;
+    for (uint32_t i = 0; i < BufferCount; ++i) {
+        TotalLength += Buffers[i].Length;
+    }
+
+    if (TotalLength > UINT32_MAX) {
+        QuicTraceEvent(
+            StreamError,
+            "[strm][%p] ERROR, %s.",
+            Stream,
+            "Send request total length exceeds max");
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_6014, "Memory is correctly freed (QuicStreamCompleteSendRequest).")
+    SendRequest = CxPlatPoolAlloc(&Connection->Partition->SendRequestPool);
+    if (SendRequest == NULL) {
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Stream Send request",
+            0);
+        goto Exit;
+    }
+
+    SendRequest->Buffers = Buffers;
+    SendRequest->BufferCount = BufferCount;
+    SendRequest->Flags = Flags & ~QUIC_SEND_FLAGS_INTERNAL;
+    SendRequest->TotalLength = TotalLength;
+    SendRequest->ClientContext = ClientSendContext;
+
+    Status = QuicStreamQueueApiSend(Stream, SendRequest);
+
+Exit:
+
+    QuicTraceEvent(
+        ApiExitStatus,
+        "[ api] Exit %u",
+        Status);
+
+    return Status;
+}
+
+#ifndef _KERNEL_MODE
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSendFile(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_STREAM* Stream;
+    QUIC_CONNECTION* Connection;
+    QUIC_FILE RegionFile;
+    QUIC_SEND_REQUEST* SendRequest;
+
+    QuicTraceEvent(
+        ApiEnter,
+        "[ api] Enter %u (%p).",
+        QUIC_TRACE_API_STREAM_SEND_FILE,
+        Handle);
+
+    if (!IS_STREAM_HANDLE(Handle) || Length == 0) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+    Stream = (QUIC_STREAM*)Handle;
+
+    CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
+    CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
+
+    Connection = Stream->Connection;
+
+    if (Connection->State.ClosedRemotely) {
+        Status = QUIC_STATUS_ABORTED;
+        goto Exit;
+    }
+
+    //
+    // The stream keeps its own handle to the file and the worker reads each
+    // frame's data from it as the frame is written. The handle is closed once
+    // the request completes.
+    //
+    Status = CxPlatFileOpenRegion(File, Offset, Length, &RegionFile);
+    if (QUIC_FAILED(Status)) {
+        QuicTraceEvent(
+            StreamError,
+            "[strm][%p] ERROR, %s.",
+            Stream,
+            "Opening the file failed");
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_6014, "Memory is correctly freed (QuicStreamCompleteSendRequest).")
+    SendRequest = CxPlatPoolAlloc(&Connection->Partition->SendRequestPool);
+    if (SendRequest == NULL) {
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Stream Send request",
+            0);
+        CxPlatFileClose(RegionFile);
+        goto Exit;
+    }
+
+    SendRequest->InternalBuffer.Length = Length;
+    SendRequest->InternalBuffer.Buffer = NULL;
+    SendRequest->Buffers = &SendRequest->InternalBuffer;
+    SendRequest->BufferCount = 1;
+    SendRequest->Flags = (Flags & ~QUIC_SEND_FLAGS_INTERNAL) | QUIC_SEND_FLAG_FILE;
+    SendRequest->TotalLength = Length;
+    SendRequest->ClientContext = ClientSendContext;
+    SendRequest->File = RegionFile;
+    SendRequest->FileOffset = Offset;
+
+    Status = QuicStreamQueueApiSend(Stream, SendRequest);
+    if (QUIC_FAILED(Status)) {
+        CxPlatFileClose(RegionFile);
+    }
+
 Exit:
 
     QuicTraceEvent(
@@ -1225,6 +1344,7 @@ Exit:
 
     return Status;
 }
+#endif
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
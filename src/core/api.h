@@ -253,6 +253,20 @@ MsQuicStreamSend(
     _In_opt_ void* ClientSendContext
     );
 
+#ifndef _KERNEL_MODE
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSendFile(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    );
+#endif
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QUIC_API
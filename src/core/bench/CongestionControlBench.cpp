@@ -0,0 +1,177 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Micro-benchmarks for the per-ACK cost of the congestion control
+    algorithms. Any printf or heavy floating point on the OnDataAcknowledged
+    path shows up directly in these numbers.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "CongestionControlBench.cpp.clog.h"
+#endif
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define CC_BENCH_NULL_DEVICE "NUL"
+#define dup _dup
+#define dup2 _dup2
+#define open _open
+#define close _close
+#define fileno _fileno
+#else
+#include <unistd.h>
+#define CC_BENCH_NULL_DEVICE "/dev/null"
+#endif
+
+#define CC_BENCH_MTU                1280
+#define CC_BENCH_RATE_MBPS          100             // Bits per microsecond
+#define CC_BENCH_RTT                MS_TO_US(50)
+#define CC_BENCH_WARMUP_ACK_COUNT   20000
+
+//
+// The algorithms printf on window updates and losses. Point stdout at the null
+// device while they run so the output doesn't end up in the JSON report.
+//
+struct CcBenchMuteStdout {
+    int Saved;
+    CcBenchMuteStdout() {
+        fflush(stdout);
+        Saved = dup(fileno(stdout));
+        int Null = open(CC_BENCH_NULL_DEVICE, O_WRONLY);
+        if (Null >= 0) {
+            dup2(Null, fileno(stdout));
+            close(Null);
+        }
+    }
+    ~CcBenchMuteStdout() {
+        fflush(stdout);
+        if (Saved >= 0) {
+            dup2(Saved, fileno(stdout));
+            close(Saved);
+        }
+    }
+};
+
+//
+// Feeds a steady stream of single-packet ACKs, one per bottleneck transmit
+// time, straight into the algorithm. The warm-up (with a single loss, to get
+// the loss based algorithms out of slow start) is excluded from the timing.
+//
+static void
+CcBenchAckCost(
+    QuicBenchState& State,
+    QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm
+    )
+{
+    State.PauseTiming();
+    CcBenchMuteStdout Mute;
+
+    QUIC_CONNECTION* Connection =
+        (QUIC_CONNECTION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+    CXPLAT_FRE_ASSERT(Connection != NULL);
+    CxPlatZeroMemory(Connection, sizeof(QUIC_CONNECTION));
+    QuicSettingsSetDefault(&Connection->Settings);
+    Connection->Settings.CongestionControlAlgorithm = (uint16_t)Algorithm;
+    Connection->Settings.IsSet.CongestionControlAlgorithm = TRUE;
+
+    QUIC_PATH* Path = &Connection->Paths[0];
+    Path->IsActive = TRUE;
+    Path->Mtu = CC_BENCH_MTU;
+    QuicAddrSetFamily(&Path->Route.RemoteAddress, QUIC_ADDRESS_FAMILY_INET);
+    Path->SmoothedRtt = CC_BENCH_RTT;
+    Path->MinRtt = CC_BENCH_RTT;
+    Path->RttVariance = CC_BENCH_RTT / 2;
+    Connection->PathsCount = 1;
+
+    QUIC_CONGESTION_CONTROL* Cc = &Connection->CongestionControl;
+    QuicCongestionControlInitialize(Cc, &Connection->Settings);
+
+    const uint16_t Length = QuicPathGetDatagramPayloadSize(Path);
+    const uint64_t AckInterval = (uint64_t)Length * 8 / CC_BENCH_RATE_MBPS;
+
+    QUIC_MAX_SENT_PACKET_METADATA Packet;
+    CxPlatZeroMemory(&Packet, sizeof(Packet));
+    Packet.Metadata.PacketLength = Length;
+    Packet.Metadata.Flags.HasLastAckedPacketInfo = TRUE;
+
+    QUIC_ACK_EVENT AckEvent;
+    CxPlatZeroMemory(&AckEvent, sizeof(AckEvent));
+    AckEvent.NumRetransmittableBytes = Length;
+    AckEvent.SmoothedRtt = CC_BENCH_RTT;
+    AckEvent.MinRtt = CC_BENCH_RTT;
+    AckEvent.MinRttValid = TRUE;
+    AckEvent.OneWayDelay = CC_BENCH_RTT / 2;
+    AckEvent.AckedPackets = &Packet.Metadata;
+
+    uint64_t TimeNow = S_TO_US(1);
+    uint64_t PacketNumber = 0;
+    uint64_t TotalBytes = 0;
+
+    for (uint64_t i = 0; i < CC_BENCH_WARMUP_ACK_COUNT + State.Iterations; ++i) {
+        if (i == CC_BENCH_WARMUP_ACK_COUNT / 2) {
+            QuicCongestionControlOnDataSent(Cc, Length);
+            QUIC_LOSS_EVENT LossEvent;
+            CxPlatZeroMemory(&LossEvent, sizeof(LossEvent));
+            LossEvent.LargestPacketNumberLost = PacketNumber;
+            LossEvent.LargestSentPacketNumber = PacketNumber;
+            LossEvent.NumRetransmittableBytes = Length;
+            QuicCongestionControlOnDataLost(Cc, &LossEvent);
+            ++PacketNumber;
+        } else if (i == CC_BENCH_WARMUP_ACK_COUNT) {
+            State.ResumeTiming();
+        }
+
+        QuicCongestionControlOnDataSent(Cc, Length);
+
+        TimeNow += AckInterval;
+        TotalBytes += Length;
+        Packet.Metadata.PacketNumber = PacketNumber;
+        Packet.Metadata.SentTime = TimeNow - CC_BENCH_RTT;
+        Packet.Metadata.TotalBytesSent = TotalBytes;
+        Packet.Metadata.LastAckedPacketInfo.SentTime = Packet.Metadata.SentTime - AckInterval;
+        Packet.Metadata.LastAckedPacketInfo.AckTime = TimeNow - AckInterval;
+        Packet.Metadata.LastAckedPacketInfo.AdjustedAckTime = TimeNow - AckInterval;
+        Packet.Metadata.LastAckedPacketInfo.TotalBytesSent = TotalBytes - Length;
+        Packet.Metadata.LastAckedPacketInfo.TotalBytesAcked = TotalBytes - Length;
+
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.AdjustedAckTime = TimeNow;
+        AckEvent.LargestAck = PacketNumber;
+        AckEvent.LargestSentPacketNumber = PacketNumber;
+        AckEvent.NumTotalAckedRetransmittableBytes = TotalBytes;
+        QuicBenchDoNotOptimize(QuicCongestionControlOnDataAcknowledged(Cc, &AckEvent));
+        ++PacketNumber;
+    }
+
+    State.PauseTiming();
+    State.ItemsProcessed = State.Iterations;
+    CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+    State.ResumeTiming();
+}
+
+QUIC_BENCH(CubicAckCost)
+{
+    CcBenchAckCost(State, QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC);
+}
+
+QUIC_BENCH(CubicProbeAckCost)
+{
+    CcBenchAckCost(State, QUIC_CONGESTION_CONTROL_ALGORITHM_CUBICPROBE);
+}
+
+QUIC_BENCH(BbrAckCost)
+{
+    CcBenchAckCost(State, QUIC_CONGESTION_CONTROL_ALGORITHM_BBR);
+}
+
+QUIC_BENCH(BbrResyncAckCost)
+{
+    CcBenchAckCost(State, QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC);
+}
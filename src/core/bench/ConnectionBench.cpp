@@ -0,0 +1,286 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Micro-benchmarks for the per-connection worker/binding structures: the
+    operation queue, the timer wheel, the local CID lookup and the stream send
+    queue.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "ConnectionBench.cpp.clog.h"
+#endif
+
+extern "C"
+void
+MsQuicCalculatePartitionMask(
+    void
+    );
+
+extern "C"
+QUIC_STREAM*
+QuicSendGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    );
+
+#define CONN_BENCH_CONNECTION_COUNT         1024
+#define CONN_BENCH_CONNECTION_COUNT_LARGE   (128 * 1024)
+#define CONN_BENCH_CID_COUNT                4096
+#define CONN_BENCH_CID_COUNT_LARGE          (1024 * 1024)
+#define CONN_BENCH_OPER_BATCH_COUNT         16
+#define CONN_BENCH_STREAM_COUNT             4096
+#define CONN_BENCH_STREAM_PRIORITY_COUNT    4
+
+//
+// Only the fields touched by the timer wheel and lookup are meaningful; the
+// base reference keeps the connection from ever being freed by a release.
+//
+static QUIC_CONNECTION*
+ConnectionBenchAlloc(
+    void
+    )
+{
+    QUIC_CONNECTION* Connection =
+        (QUIC_CONNECTION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+    CXPLAT_FRE_ASSERT(Connection != NULL);
+    CxPlatZeroMemory(Connection, sizeof(QUIC_CONNECTION));
+    Connection->RefCount = 1;
+    Connection->EarliestExpirationTime = UINT64_MAX;
+    return Connection;
+}
+
+//
+// Queues a batch of operations, a few of them priority, and drains them until
+// the queue is found empty, as the worker does for a busy connection.
+//
+QUIC_BENCH(OperationQueueEnqueueDequeue)
+{
+    State.PauseTiming();
+    QUIC_PARTITION* Partition =
+        (QUIC_PARTITION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_PARTITION), QUIC_POOL_TEST);
+    CXPLAT_FRE_ASSERT(Partition != NULL);
+    CxPlatZeroMemory(Partition, sizeof(QUIC_PARTITION));
+    QUIC_OPERATION Opers[CONN_BENCH_OPER_BATCH_COUNT];
+    CxPlatZeroMemory(Opers, sizeof(Opers));
+    QUIC_OPERATION_QUEUE OperQ;
+    QuicOperationQueueInitialize(&OperQ);
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        for (uint32_t j = 0; j < CONN_BENCH_OPER_BATCH_COUNT; ++j) {
+            if (j % 4 == 3) {
+                QuicBenchDoNotOptimize(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[j]));
+            } else {
+                QuicBenchDoNotOptimize(QuicOperationEnqueue(&OperQ, Partition, &Opers[j]));
+            }
+        }
+        QUIC_OPERATION* Oper;
+        while ((Oper = QuicOperationDequeue(&OperQ, Partition)) != NULL) {
+            QuicBenchDoNotOptimize(Oper);
+        }
+    }
+    State.ItemsProcessed = State.Iterations * CONN_BENCH_OPER_BATCH_COUNT;
+
+    State.PauseTiming();
+    QuicOperationQueueUninitialize(&OperQ);
+    CXPLAT_FREE(Partition, QUIC_POOL_TEST);
+}
+
+//
+// Reschedules random connections in a populated wheel, the pattern produced
+// by loss detection and idle timers being reset on every packet. Expired
+// timers are processed and rearmed as the worker would.
+//
+static void
+ConnectionBenchTimerWheel(
+    QuicBenchState& State,
+    uint32_t ConnectionCount
+    )
+{
+    State.PauseTiming();
+    QUIC_TIMER_WHEEL TimerWheel;
+    CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(QuicTimerWheelInitialize(&TimerWheel)));
+
+    std::vector<QUIC_CONNECTION*> Connections(ConnectionCount);
+    uint32_t Seed = 1;
+    uint64_t TimeNow = CxPlatTimeUs64();
+    for (auto& Connection : Connections) {
+        Connection = ConnectionBenchAlloc();
+        Connection->EarliestExpirationTime = TimeNow + QuicBenchRandom(&Seed) % S_TO_US(1);
+        QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+    }
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        QUIC_CONNECTION* Connection =
+            Connections[QuicBenchRandom(&Seed) % ConnectionCount];
+        TimeNow += 10;
+        Connection->EarliestExpirationTime = TimeNow + QuicBenchRandom(&Seed) % S_TO_US(1);
+        QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+
+        if (TimerWheel.NextExpirationTime <= TimeNow) {
+            CXPLAT_LIST_ENTRY ExpiredTimers;
+            CxPlatListInitializeHead(&ExpiredTimers);
+            QuicTimerWheelGetExpired(&TimerWheel, TimeNow, &ExpiredTimers);
+            while (!CxPlatListIsEmpty(&ExpiredTimers)) {
+                CXPLAT_LIST_ENTRY* Entry = CxPlatListRemoveHead(&ExpiredTimers);
+                Entry->Flink = NULL;
+                Connection = CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
+                Connection->EarliestExpirationTime = TimeNow + QuicBenchRandom(&Seed) % S_TO_US(1);
+                QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+                QuicConnRelease(Connection, QUIC_CONN_REF_WORKER);
+            }
+        }
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    for (auto Connection : Connections) {
+        Connection->EarliestExpirationTime = UINT64_MAX;
+        QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+        CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+    }
+    QuicTimerWheelUninitialize(&TimerWheel);
+}
+
+QUIC_BENCH(TimerWheelUpdateConnection)
+{
+    ConnectionBenchTimerWheel(State, CONN_BENCH_CONNECTION_COUNT);
+}
+
+QUIC_BENCH(TimerWheelUpdateConnectionLarge)
+{
+    ConnectionBenchTimerWheel(State, CONN_BENCH_CONNECTION_COUNT_LARGE);
+}
+
+//
+// Looks up random known CIDs in a server-style (maximally partitioned)
+// lookup table, as done for every received short header packet.
+//
+static void
+ConnectionBenchLookup(
+    QuicBenchState& State,
+    uint32_t CidCount
+    )
+{
+    State.PauseTiming();
+
+    //
+    // Partitions are normally set up by the library's lazy initialization,
+    // which also brings up the datapath. Fake just the partition count.
+    //
+    const uint16_t OldPartitionCount = MsQuicLib.PartitionCount;
+    const uint16_t OldPartitionMask = MsQuicLib.PartitionMask;
+    if (MsQuicLib.PartitionCount == 0) {
+        MsQuicLib.PartitionCount =
+            (uint16_t)CXPLAT_MIN(CxPlatProcCount(), QUIC_MAX_PARTITION_COUNT);
+        MsQuicCalculatePartitionMask();
+    }
+
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    CXPLAT_FRE_ASSERT(QuicLookupMaximizePartitioning(&Lookup));
+
+    QUIC_CONNECTION* Connection = ConnectionBenchAlloc();
+    std::vector<QUIC_CID_HASH_ENTRY*> Cids(CidCount);
+    for (uint32_t i = 0; i < CidCount; ++i) {
+        Cids[i] =
+            QuicCidNewRandomSource(
+                Connection,
+                NULL,
+                QuicPartitionIdCreate((uint16_t)(i % MsQuicLib.PartitionCount)),
+                0,
+                NULL);
+        CXPLAT_FRE_ASSERT(Cids[i] != NULL);
+        CxPlatListPushEntry(&Connection->SourceCids, &Cids[i]->Link);
+        QUIC_CONNECTION* Collision;
+        CXPLAT_FRE_ASSERT(QuicLookupAddLocalCid(&Lookup, Cids[i], &Collision));
+    }
+    uint32_t Seed = 1;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        const QUIC_CID_HASH_ENTRY* Cid = Cids[QuicBenchRandom(&Seed) % CidCount];
+        QUIC_CONNECTION* Found =
+            QuicLookupFindConnectionByLocalCid(&Lookup, Cid->CID.Data, Cid->CID.Length);
+        QuicBenchDoNotOptimize(Found);
+        QuicConnRelease(Found, QUIC_CONN_REF_LOOKUP_RESULT);
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicLookupRemoveLocalCids(&Lookup, Connection);
+    QuicLookupUninitialize(&Lookup);
+    CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+
+    MsQuicLib.PartitionCount = OldPartitionCount;
+    MsQuicLib.PartitionMask = OldPartitionMask;
+}
+
+QUIC_BENCH(LookupFindConnectionByLocalCid)
+{
+    ConnectionBenchLookup(State, CONN_BENCH_CID_COUNT);
+}
+
+//
+// The same, but with far more CIDs than fit in the CPU caches.
+//
+QUIC_BENCH(LookupFindConnectionByLocalCidLarge)
+{
+    ConnectionBenchLookup(State, CONN_BENCH_CID_COUNT_LARGE);
+}
+
+//
+// Round robin scheduling over many streams queued at a few priorities, with a
+// random stream finishing and getting new data to send on every iteration.
+//
+QUIC_BENCH(SendQueueRoundRobin)
+{
+    State.PauseTiming();
+    QUIC_CONNECTION* Connection = ConnectionBenchAlloc();
+    Connection->Crypto.TlsState.WriteKey = QUIC_PACKET_KEY_1_RTT;
+    Connection->Streams.Types[STREAM_ID_FLAG_IS_CLIENT | STREAM_ID_FLAG_IS_BI_DIR].MaxTotalStreamCount = UINT64_MAX;
+    QUIC_SETTINGS_INTERNAL Settings;
+    CxPlatZeroMemory(&Settings, sizeof(Settings));
+    QuicSendInitialize(&Connection->Send, &Settings);
+    QuicSendSetStreamSchedulingScheme(&Connection->Send, QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN);
+
+    std::vector<QUIC_STREAM*> Streams(CONN_BENCH_STREAM_COUNT);
+    for (uint32_t i = 0; i < CONN_BENCH_STREAM_COUNT; ++i) {
+        QUIC_STREAM* Stream =
+            (QUIC_STREAM*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_STREAM), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Stream != NULL);
+        CxPlatZeroMemory(Stream, sizeof(QUIC_STREAM));
+        Stream->Connection = Connection;
+        Stream->RefCount = 1;
+        Stream->ID = (uint64_t)i << 2;
+        Stream->Flags.Started = TRUE;
+        Stream->SendPriority = (uint16_t)(i % CONN_BENCH_STREAM_PRIORITY_COUNT);
+        QuicSendSetStreamSendFlag(&Connection->Send, Stream, QUIC_STREAM_SEND_FLAG_MAX_DATA, FALSE);
+        Streams[i] = Stream;
+    }
+    uint32_t Seed = 1;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        QUIC_STREAM* Stream = Streams[QuicBenchRandom(&Seed) % CONN_BENCH_STREAM_COUNT];
+        QuicSendClearStreamSendFlag(&Connection->Send, Stream, QUIC_STREAM_SEND_FLAGS_ALL);
+        QuicSendSetStreamSendFlag(&Connection->Send, Stream, QUIC_STREAM_SEND_FLAG_MAX_DATA, FALSE);
+        uint32_t PacketCount;
+        QuicBenchDoNotOptimize(QuicSendGetNextStream(&Connection->Send, &PacketCount));
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicSendUninitialize(&Connection->Send);
+    for (auto Stream : Streams) {
+        CXPLAT_FREE(Stream, QUIC_POOL_TEST);
+    }
+    CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+}
@@ -0,0 +1,257 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Micro-benchmarks for the platform primitives on the per-packet path: the
+    hash table, the Toeplitz hash and packet/header protection crypto.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "PlatformBench.cpp.clog.h"
+#endif
+
+#define HASHTABLE_BENCH_ENTRY_COUNT 4096
+#define CRYPT_BENCH_PAYLOAD_LENGTH  1200
+#define CRYPT_BENCH_HEADER_LENGTH   20
+#define TOEPLITZ_BENCH_INPUT_COUNT  32
+
+QUIC_BENCH(HashtableLookup)
+{
+    State.PauseTiming();
+    CXPLAT_HASHTABLE Table;
+    CXPLAT_FRE_ASSERT(CxPlatHashtableInitializeEx(&Table, CXPLAT_HASH_MIN_SIZE));
+    std::vector<CXPLAT_HASHTABLE_ENTRY> Entries(HASHTABLE_BENCH_ENTRY_COUNT);
+    std::vector<uint64_t> Signatures(HASHTABLE_BENCH_ENTRY_COUNT);
+    for (uint32_t i = 0; i < HASHTABLE_BENCH_ENTRY_COUNT; ++i) {
+        uint64_t Key = i;
+        Signatures[i] = CxPlatHashSimple(sizeof(Key), (const uint8_t*)&Key);
+        CxPlatHashtableInsert(&Table, &Entries[i], Signatures[i], NULL);
+    }
+    uint32_t Seed = 1;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
+        QuicBenchDoNotOptimize(
+            CxPlatHashtableLookup(
+                &Table,
+                Signatures[QuicBenchRandom(&Seed) % HASHTABLE_BENCH_ENTRY_COUNT],
+                &Context));
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    for (auto& Entry : Entries) {
+        CxPlatHashtableRemove(&Table, &Entry, NULL);
+    }
+    CxPlatHashtableUninitialize(&Table);
+}
+
+//
+// Toeplitz hash of an IPv6 4-tuple, as computed for software RSS, with the
+// lookup tables, with carry-less multiply (if supported) and in batches.
+//
+static void
+ToeplitzBenchCompute(
+    QuicBenchState& State,
+    BOOLEAN UseClmul,
+    uint32_t BatchSize
+    )
+{
+    State.PauseTiming();
+    CXPLAT_TOEPLITZ_HASH Toeplitz;
+    CxPlatZeroMemory(&Toeplitz, sizeof(Toeplitz));
+    CxPlatRandom(sizeof(Toeplitz.HashKey), Toeplitz.HashKey);
+    Toeplitz.InputSize = CXPLAT_TOEPLITZ_INPUT_SIZE_IP;
+    CxPlatToeplitzHashInitialize(&Toeplitz);
+    if (UseClmul && !Toeplitz.UseClmul) {
+        State.SkipWithError("Carry-less multiply not supported");
+        return;
+    }
+    Toeplitz.UseClmul = UseClmul;
+
+    std::vector<uint8_t> Inputs(TOEPLITZ_BENCH_INPUT_COUNT * CXPLAT_TOEPLITZ_INPUT_SIZE_IP);
+    CxPlatRandom((uint32_t)Inputs.size(), Inputs.data());
+    std::vector<const uint8_t*> InputPtrs(TOEPLITZ_BENCH_INPUT_COUNT);
+    for (uint32_t i = 0; i < TOEPLITZ_BENCH_INPUT_COUNT; ++i) {
+        InputPtrs[i] = Inputs.data() + i * CXPLAT_TOEPLITZ_INPUT_SIZE_IP;
+    }
+    uint32_t Hashes[TOEPLITZ_BENCH_INPUT_COUNT];
+    uint32_t Next = 0;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        if (BatchSize == 1) {
+            Hashes[0] =
+                CxPlatToeplitzHashCompute(
+                    &Toeplitz, InputPtrs[Next], CXPLAT_TOEPLITZ_INPUT_SIZE_IP, 0);
+        } else {
+            CxPlatToeplitzHashComputeBatch(
+                &Toeplitz,
+                BatchSize,
+                InputPtrs.data() + Next,
+                CXPLAT_TOEPLITZ_INPUT_SIZE_IP,
+                0,
+                Hashes);
+        }
+        QuicBenchDoNotOptimize(Hashes[0]);
+        Next = (Next + BatchSize) % TOEPLITZ_BENCH_INPUT_COUNT;
+    }
+    State.ItemsProcessed = State.Iterations * BatchSize;
+}
+
+QUIC_BENCH(ToeplitzHashLookupTables)
+{
+    ToeplitzBenchCompute(State, FALSE, 1);
+}
+
+QUIC_BENCH(ToeplitzHashClmul)
+{
+    ToeplitzBenchCompute(State, TRUE, 1);
+}
+
+QUIC_BENCH(ToeplitzHashClmulBatch)
+{
+    ToeplitzBenchCompute(State, TRUE, TOEPLITZ_BENCH_INPUT_COUNT);
+}
+
+//
+// AEAD seal of a full-sized 1-RTT packet payload.
+//
+static void
+CryptBenchEncrypt(
+    QuicBenchState& State,
+    CXPLAT_AEAD_TYPE AeadType
+    )
+{
+    State.PauseTiming();
+    const uint8_t RawKey[32] = {0};
+    CXPLAT_KEY* Key = NULL;
+    if (QUIC_FAILED(CxPlatKeyCreate(AeadType, RawKey, &Key))) {
+        State.SkipWithError("CxPlatKeyCreate failed");
+        return;
+    }
+    uint8_t Iv[CXPLAT_IV_LENGTH] = {0};
+    uint8_t Header[CRYPT_BENCH_HEADER_LENGTH] = {0};
+    uint8_t Buffer[CRYPT_BENCH_PAYLOAD_LENGTH + CXPLAT_ENCRYPTION_OVERHEAD] = {0};
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        CxPlatCopyMemory(Iv + CXPLAT_IV_LENGTH - sizeof(i), &i, sizeof(i));
+        if (QUIC_FAILED(
+                CxPlatEncrypt(Key, Iv, sizeof(Header), Header, sizeof(Buffer), Buffer))) {
+            State.SkipWithError("CxPlatEncrypt failed");
+            break;
+        }
+    }
+    State.ItemsProcessed = State.Iterations;
+    State.BytesProcessed = State.Iterations * CRYPT_BENCH_PAYLOAD_LENGTH;
+
+    State.PauseTiming();
+    CxPlatKeyFree(Key);
+}
+
+QUIC_BENCH(CryptEncryptAes128Gcm)
+{
+    CryptBenchEncrypt(State, CXPLAT_AEAD_AES_128_GCM);
+}
+
+QUIC_BENCH(CryptEncryptAes256Gcm)
+{
+    CryptBenchEncrypt(State, CXPLAT_AEAD_AES_256_GCM);
+}
+
+QUIC_BENCH(CryptEncryptChaCha20Poly1305)
+{
+    CryptBenchEncrypt(State, CXPLAT_AEAD_CHACHA20_POLY1305);
+}
+
+//
+// AEAD seal of a full send batch of 1-RTT packet payloads under one key.
+//
+QUIC_BENCH(CryptEncryptBatchAes128Gcm)
+{
+    State.PauseTiming();
+    const uint8_t RawKey[32] = {0};
+    CXPLAT_KEY* Key = NULL;
+    if (QUIC_FAILED(CxPlatKeyCreate(CXPLAT_AEAD_AES_128_GCM, RawKey, &Key))) {
+        State.SkipWithError("CxPlatKeyCreate failed");
+        return;
+    }
+    const uint16_t BufferLength = CRYPT_BENCH_PAYLOAD_LENGTH + CXPLAT_ENCRYPTION_OVERHEAD;
+    std::vector<uint8_t> Buffers(BufferLength * QUIC_MAX_CRYPTO_BATCH_COUNT);
+    uint8_t Ivs[CXPLAT_IV_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT] = {0};
+    uint8_t Header[CRYPT_BENCH_HEADER_LENGTH] = {0};
+    CXPLAT_CRYPT_BATCH_ENTRY Entries[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    for (uint8_t i = 0; i < QUIC_MAX_CRYPTO_BATCH_COUNT; ++i) {
+        Entries[i].Iv = Ivs + i * CXPLAT_IV_LENGTH;
+        Entries[i].AuthData = Header;
+        Entries[i].AuthDataLength = sizeof(Header);
+        Entries[i].Buffer = Buffers.data() + i * BufferLength;
+        Entries[i].BufferLength = BufferLength;
+    }
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        for (uint8_t j = 0; j < QUIC_MAX_CRYPTO_BATCH_COUNT; ++j) {
+            Ivs[j * CXPLAT_IV_LENGTH + CXPLAT_IV_LENGTH - 1] = (uint8_t)(i + j);
+        }
+        if (QUIC_FAILED(CxPlatEncryptBatch(Key, QUIC_MAX_CRYPTO_BATCH_COUNT, Entries))) {
+            State.SkipWithError("CxPlatEncryptBatch failed");
+            break;
+        }
+    }
+    State.ItemsProcessed = State.Iterations * QUIC_MAX_CRYPTO_BATCH_COUNT;
+    State.BytesProcessed = State.ItemsProcessed * CRYPT_BENCH_PAYLOAD_LENGTH;
+
+    State.PauseTiming();
+    CxPlatKeyFree(Key);
+}
+
+//
+// Header protection masks for a single packet and for a full send batch.
+//
+static void
+CryptBenchHpComputeMask(
+    QuicBenchState& State,
+    uint8_t BatchSize
+    )
+{
+    State.PauseTiming();
+    const uint8_t RawKey[32] = {0};
+    CXPLAT_HP_KEY* HpKey = NULL;
+    if (QUIC_FAILED(CxPlatHpKeyCreate(CXPLAT_AEAD_AES_128_GCM, RawKey, &HpKey))) {
+        State.SkipWithError("CxPlatHpKeyCreate failed");
+        return;
+    }
+    uint8_t Cipher[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT] = {0};
+    uint8_t Mask[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        if (QUIC_FAILED(CxPlatHpComputeMask(HpKey, BatchSize, Cipher, Mask))) {
+            State.SkipWithError("CxPlatHpComputeMask failed");
+            break;
+        }
+        QuicBenchDoNotOptimize(Mask[0]);
+    }
+    State.ItemsProcessed = State.Iterations * BatchSize;
+
+    State.PauseTiming();
+    CxPlatHpKeyFree(HpKey);
+}
+
+QUIC_BENCH(CryptHpComputeMask)
+{
+    CryptBenchHpComputeMask(State, 1);
+}
+
+QUIC_BENCH(CryptHpComputeMaskBatch)
+{
+    CryptBenchHpComputeMask(State, QUIC_MAX_CRYPTO_BATCH_COUNT);
+}
@@ -0,0 +1,142 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Micro-benchmarks for the QUIC_RANGE multirange tracker.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "RangeBench.cpp.clog.h"
+#endif
+
+//
+// Number of disjoint subranges kept in the range while benchmarking, roughly
+// what an ACK tracker holds under moderate reordering/loss.
+//
+#define RANGE_BENCH_SUBRANGES 256
+
+//
+// How late, in packet numbers, a reordered packet may arrive.
+//
+#define RANGE_BENCH_REORDER_WINDOW 32
+
+//
+// Appends new, non-adjacent ranges in increasing order (the common ACK
+// tracking pattern), resetting once the tracker holds RANGE_BENCH_SUBRANGES.
+//
+QUIC_BENCH(RangeAddRangeAscending)
+{
+    State.PauseTiming();
+    QUIC_RANGE Range;
+    QuicRangeInitialize(QUIC_MAX_RANGE_ALLOC_SIZE, &Range);
+
+    uint64_t Low = 0;
+    State.ResumeTiming();
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        if ((i % RANGE_BENCH_SUBRANGES) == 0) {
+            QuicRangeReset(&Range);
+            Low = 0;
+        }
+        BOOLEAN RangeUpdated;
+        QuicBenchDoNotOptimize(QuicRangeAddRange(&Range, Low, 2, &RangeUpdated));
+        Low += 3;
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicRangeUninitialize(&Range);
+}
+
+//
+// Fills gaps at random positions inside a populated range, which forces the
+// binary search plus subrange merges.
+//
+QUIC_BENCH(RangeAddRangeRandomFill)
+{
+    State.PauseTiming();
+    QUIC_RANGE Range;
+    QuicRangeInitialize(QUIC_MAX_RANGE_ALLOC_SIZE, &Range);
+    uint32_t Seed = 1;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        if ((i % RANGE_BENCH_SUBRANGES) == 0) {
+            State.PauseTiming();
+            QuicRangeReset(&Range);
+            for (uint64_t j = 0; j < RANGE_BENCH_SUBRANGES; ++j) {
+                BOOLEAN RangeUpdated;
+                (void)QuicRangeAddRange(&Range, j * 3, 2, &RangeUpdated);
+            }
+            State.ResumeTiming();
+        }
+        BOOLEAN RangeUpdated;
+        const uint64_t Gap = (QuicBenchRandom(&Seed) % RANGE_BENCH_SUBRANGES) * 3 + 2;
+        QuicBenchDoNotOptimize(QuicRangeAddRange(&Range, Gap, 1, &RangeUpdated));
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicRangeUninitialize(&Range);
+}
+
+//
+// Adds packet numbers as an ACK tracker sees them on a lossy, reordering path:
+// a quarter are dropped and the rest arrive up to RANGE_BENCH_REORDER_WINDOW
+// late, so the new values land among the last few subranges. The older half
+// is periodically dropped, as when an ACK frame is acknowledged.
+//
+QUIC_BENCH(RangeAddValueLossyReordered)
+{
+    State.PauseTiming();
+    QUIC_RANGE Range;
+    QuicRangeInitialize(QUIC_MAX_RANGE_ALLOC_SIZE, &Range);
+    uint32_t Seed = 1;
+    uint64_t PacketNumber = 0;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        uint64_t Value;
+        do {
+            Value = PacketNumber++;
+        } while (QuicBenchRandom(&Seed) % 4 == 0);
+        if (Value >= RANGE_BENCH_REORDER_WINDOW) {
+            Value -= QuicBenchRandom(&Seed) % RANGE_BENCH_REORDER_WINDOW;
+        }
+        QuicBenchDoNotOptimize(QuicRangeAddValue(&Range, Value));
+        if (QuicRangeSize(&Range) > RANGE_BENCH_SUBRANGES) {
+            QuicRangeSetMin(&Range, QuicRangeGet(&Range, RANGE_BENCH_SUBRANGES / 2)->Low);
+        }
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicRangeUninitialize(&Range);
+}
+
+QUIC_BENCH(RangeSearch)
+{
+    State.PauseTiming();
+    QUIC_RANGE Range;
+    QuicRangeInitialize(QUIC_MAX_RANGE_ALLOC_SIZE, &Range);
+    for (uint64_t j = 0; j < RANGE_BENCH_SUBRANGES; ++j) {
+        BOOLEAN RangeUpdated;
+        (void)QuicRangeAddRange(&Range, j * 3, 2, &RangeUpdated);
+    }
+    uint32_t Seed = 1;
+
+    State.ResumeTiming();
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        const uint64_t Value = QuicBenchRandom(&Seed) % (RANGE_BENCH_SUBRANGES * 3);
+        QUIC_RANGE_SEARCH_KEY Key = { Value, Value };
+        QuicBenchDoNotOptimize(QuicRangeSearch(&Range, &Key));
+    }
+    State.ItemsProcessed = State.Iterations;
+
+    State.PauseTiming();
+    QuicRangeUninitialize(&Range);
+}
@@ -0,0 +1,124 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Micro-benchmarks for QUIC_RECV_BUFFER write/read/drain in each receive
+    mode.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "RecvBufferBench.cpp.clog.h"
+#endif
+
+#define RECVBUF_BENCH_FRAME_LENGTH  1200
+#define RECVBUF_BENCH_BURST         4   // Frames written per read/drain
+
+//
+// Each iteration writes one in-order STREAM frame payload; every
+// RECVBUF_BENCH_BURST frames the data is read and fully drained, as a
+// receive indication followed by an app completion would.
+//
+static void
+RecvBufferBenchWriteRead(
+    QuicBenchState& State,
+    QUIC_RECV_BUF_MODE RecvMode
+    )
+{
+    State.PauseTiming();
+
+    const uint32_t AllocLength =
+        RecvMode == QUIC_RECV_BUF_MODE_APP_OWNED ? 0 : QUIC_DEFAULT_STREAM_RECV_BUFFER_SIZE;
+    const uint32_t VirtualLength =
+        RecvMode == QUIC_RECV_BUF_MODE_APP_OWNED ? 0 : QUIC_DEFAULT_STREAM_FC_WINDOW_SIZE;
+    const uint32_t AppBufferLength = RECVBUF_BENCH_FRAME_LENGTH * RECVBUF_BENCH_BURST;
+
+    QUIC_RECV_BUFFER RecvBuffer;
+    CxPlatZeroMemory(&RecvBuffer, sizeof(RecvBuffer));
+    CXPLAT_FRE_ASSERT(
+        QUIC_SUCCEEDED(
+        QuicRecvBufferInitialize(&RecvBuffer, AllocLength, VirtualLength, RecvMode, NULL)));
+
+    CXPLAT_POOL ChunkPool;
+    CxPlatPoolInitialize(FALSE, sizeof(QUIC_RECV_CHUNK), QUIC_POOL_TEST, &ChunkPool);
+    uint8_t* AppBuffer = (uint8_t*)CXPLAT_ALLOC_NONPAGED(AppBufferLength, QUIC_POOL_TEST);
+    CXPLAT_FRE_ASSERT(AppBuffer != NULL);
+
+    uint8_t Frame[RECVBUF_BENCH_FRAME_LENGTH];
+    CxPlatZeroMemory(Frame, sizeof(Frame));
+    QUIC_BUFFER Buffers[3];
+    uint64_t WriteOffset = 0;
+    State.ResumeTiming();
+
+    for (uint64_t i = 0; i < State.Iterations; ++i) {
+        if (RecvMode == QUIC_RECV_BUF_MODE_APP_OWNED && (i % RECVBUF_BENCH_BURST) == 0) {
+            //
+            // The app hands over a fresh buffer for each burst.
+            //
+            CXPLAT_LIST_ENTRY ChunkList;
+            CxPlatListInitializeHead(&ChunkList);
+            QUIC_RECV_CHUNK* Chunk = (QUIC_RECV_CHUNK*)CxPlatPoolAlloc(&ChunkPool);
+            QuicRecvChunkInitialize(Chunk, AppBufferLength, AppBuffer, TRUE);
+            CxPlatListInsertTail(&ChunkList, &Chunk->Link);
+            CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(QuicRecvBufferProvideChunks(&RecvBuffer, &ChunkList)));
+        }
+
+        uint64_t QuotaConsumed;
+        BOOLEAN NewDataReady;
+        uint64_t BufferSizeNeeded;
+        CXPLAT_FRE_ASSERT(
+            QUIC_SUCCEEDED(
+            QuicRecvBufferWrite(
+                &RecvBuffer,
+                WriteOffset,
+                sizeof(Frame),
+                Frame,
+                UINT64_MAX,
+                &QuotaConsumed,
+                &NewDataReady,
+                &BufferSizeNeeded)));
+        WriteOffset += sizeof(Frame);
+
+        if ((i % RECVBUF_BENCH_BURST) == RECVBUF_BENCH_BURST - 1 || i == State.Iterations - 1) {
+            uint64_t ReadOffset;
+            uint32_t BufferCount = ARRAYSIZE(Buffers);
+            QuicRecvBufferRead(&RecvBuffer, &ReadOffset, &BufferCount, Buffers);
+            uint64_t ReadLength = 0;
+            for (uint32_t j = 0; j < BufferCount; ++j) {
+                ReadLength += Buffers[j].Length;
+            }
+            QuicBenchDoNotOptimize(QuicRecvBufferDrain(&RecvBuffer, ReadLength));
+        }
+    }
+    State.ItemsProcessed = State.Iterations;
+    State.BytesProcessed = State.Iterations * sizeof(Frame);
+
+    State.PauseTiming();
+    QuicRecvBufferUninitialize(&RecvBuffer);
+    CXPLAT_FREE(AppBuffer, QUIC_POOL_TEST);
+    CxPlatPoolUninitialize(&ChunkPool);
+}
+
+QUIC_BENCH(RecvBufferWriteReadSingle)
+{
+    RecvBufferBenchWriteRead(State, QUIC_RECV_BUF_MODE_SINGLE);
+}
+
+QUIC_BENCH(RecvBufferWriteReadCircular)
+{
+    RecvBufferBenchWriteRead(State, QUIC_RECV_BUF_MODE_CIRCULAR);
+}
+
+QUIC_BENCH(RecvBufferWriteReadMultiple)
+{
+    RecvBufferBenchWriteRead(State, QUIC_RECV_BUF_MODE_MULTIPLE);
+}
+
+QUIC_BENCH(RecvBufferWriteReadAppOwned)
+{
+    RecvBufferBenchWriteRead(State, QUIC_RECV_BUF_MODE_APP_OWNED);
+}
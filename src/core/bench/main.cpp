@@ -0,0 +1,313 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Entry point and runner for msquiccorebench. Results are written as JSON
+    using the same layout as Google Benchmark's --benchmark_format=json so
+    existing comparison tooling can consume them.
+
+    Usage:
+
+        msquiccorebench [--benchmark_filter=<regex>]
+                        [--benchmark_min_time=<seconds>[s]]
+                        [--benchmark_out=<file>]
+
+    As with Google Benchmark, the filter is matched anywhere in the name and
+    the minimum time is in (possibly fractional) seconds.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "main.cpp.clog.h"
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <regex>
+#include <string>
+
+extern "C" {
+void
+MsQuicLibraryLoad(
+    void
+    );
+
+QUIC_STATUS
+MsQuicAddRef(
+    void
+    );
+
+void
+MsQuicRelease(
+    void
+    );
+
+void
+MsQuicLibraryUnload(
+    void
+    );
+}
+
+#define QUIC_BENCH_DEFAULT_MIN_TIME_NS  MS_TO_US(US_TO_NS(200))
+#define QUIC_BENCH_MAX_ITERATIONS       1000000000ull
+
+static uint64_t
+QuicBenchNowNs(
+    void
+    )
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void
+QuicBenchState::StartTiming()
+{
+    if (!Running) {
+        Running = true;
+        StartNs = QuicBenchNowNs();
+    }
+}
+
+void
+QuicBenchState::StopTiming()
+{
+    if (Running) {
+        ElapsedNs += QuicBenchNowNs() - StartNs;
+        Running = false;
+    }
+}
+
+QuicBenchRegistration::QuicBenchRegistration(
+    const char* Name,
+    QUIC_BENCH_FN* Fn
+    ) : Name(Name), Fn(Fn)
+{
+    All().push_back(this);
+}
+
+std::vector<QuicBenchRegistration*>&
+QuicBenchRegistration::All()
+{
+    static std::vector<QuicBenchRegistration*> Registrations;
+    return Registrations;
+}
+
+struct QuicBenchResult {
+    const char* Name;
+    uint64_t Iterations;
+    double NsPerOp;
+    double BytesPerSecond;
+    double ItemsPerSecond;
+    const char* ErrorMessage;
+};
+
+//
+// Runs a single benchmark, growing the iteration count until the timed
+// portion takes at least MinTimeNs.
+//
+static QuicBenchResult
+QuicBenchRun(
+    const QuicBenchRegistration* Bench,
+    uint64_t MinTimeNs
+    )
+{
+    uint64_t Iterations = 1;
+    while (true) {
+        QuicBenchState State;
+        State.Iterations = Iterations;
+        State.StartTiming();
+        Bench->Fn(State);
+        State.StopTiming();
+
+        if (State.ErrorMessage != nullptr) {
+            return { Bench->Name, 0, 0, 0, 0, State.ErrorMessage };
+        }
+
+        if (State.ElapsedNs >= MinTimeNs || Iterations >= QUIC_BENCH_MAX_ITERATIONS) {
+            const double Seconds = (double)State.ElapsedNs / 1e9;
+            return {
+                Bench->Name,
+                Iterations,
+                (double)State.ElapsedNs / (double)Iterations,
+                Seconds > 0 ? (double)State.BytesProcessed / Seconds : 0,
+                Seconds > 0 ? (double)State.ItemsProcessed / Seconds : 0,
+                nullptr };
+        }
+
+        //
+        // Same growth policy as Google Benchmark: aim 40% past the target,
+        // but never grow more than 10x per step.
+        //
+        double Multiplier =
+            State.ElapsedNs == 0 ?
+                10.0 : ((double)MinTimeNs * 1.4) / (double)State.ElapsedNs;
+        if (Multiplier > 10.0) {
+            Multiplier = 10.0;
+        }
+        uint64_t Next = (uint64_t)((double)Iterations * Multiplier);
+        Iterations = Next > Iterations ? Next : Iterations + 1;
+        if (Iterations > QUIC_BENCH_MAX_ITERATIONS) {
+            Iterations = QUIC_BENCH_MAX_ITERATIONS;
+        }
+    }
+}
+
+static void
+QuicBenchWriteJson(
+    FILE* Out,
+    const char* Executable,
+    const std::vector<QuicBenchResult>& Results
+    )
+{
+    fprintf(Out, "{\n");
+    fprintf(Out, "  \"context\": {\n");
+    fprintf(Out, "    \"executable\": \"%s\",\n", Executable);
+    fprintf(Out, "    \"num_cpus\": %u,\n", (uint32_t)CxPlatProcCount());
+#if DEBUG
+    fprintf(Out, "    \"library_build_type\": \"debug\"\n");
+#else
+    fprintf(Out, "    \"library_build_type\": \"release\"\n");
+#endif
+    fprintf(Out, "  },\n");
+    fprintf(Out, "  \"benchmarks\": [");
+    for (size_t i = 0; i < Results.size(); ++i) {
+        const QuicBenchResult& Result = Results[i];
+        fprintf(Out, "%s\n    {\n", i == 0 ? "" : ",");
+        fprintf(Out, "      \"name\": \"%s\",\n", Result.Name);
+        fprintf(Out, "      \"run_name\": \"%s\",\n", Result.Name);
+        fprintf(Out, "      \"run_type\": \"iteration\",\n");
+        if (Result.ErrorMessage != nullptr) {
+            fprintf(Out, "      \"error_occurred\": true,\n");
+            fprintf(Out, "      \"error_message\": \"%s\"\n", Result.ErrorMessage);
+        } else {
+            fprintf(Out, "      \"iterations\": %llu,\n", (unsigned long long)Result.Iterations);
+            fprintf(Out, "      \"real_time\": %.3f,\n", Result.NsPerOp);
+            fprintf(Out, "      \"cpu_time\": %.3f,\n", Result.NsPerOp);
+            if (Result.BytesPerSecond > 0) {
+                fprintf(Out, "      \"bytes_per_second\": %.0f,\n", Result.BytesPerSecond);
+            }
+            if (Result.ItemsPerSecond > 0) {
+                fprintf(Out, "      \"items_per_second\": %.0f,\n", Result.ItemsPerSecond);
+            }
+            fprintf(Out, "      \"time_unit\": \"ns\"\n");
+        }
+        fprintf(Out, "    }");
+    }
+    fprintf(Out, "\n  ]\n}\n");
+}
+
+static const char*
+QuicBenchGetArg(
+    const char* Arg,
+    const char* Name
+    )
+{
+    const size_t Length = strlen(Name);
+    if (strncmp(Arg, Name, Length) == 0 && Arg[Length] == '=') {
+        return Arg + Length + 1;
+    }
+    return nullptr;
+}
+
+//
+// Parses a Google Benchmark style minimum time: seconds, optionally
+// fractional, with an optional trailing 's'.
+//
+static bool
+QuicBenchParseMinTime(
+    const char* Value,
+    uint64_t* MinTimeNs
+    )
+{
+    char* End;
+    const double Seconds = strtod(Value, &End);
+    if (End == Value || Seconds < 0 || (*End != '\0' && strcmp(End, "s") != 0)) {
+        return false;
+    }
+    *MinTimeNs = (uint64_t)(Seconds * S_TO_US(US_TO_NS(1)));
+    return true;
+}
+
+int
+QUIC_MAIN_EXPORT
+main(
+    _In_ int argc,
+    _In_reads_(argc) _Null_terminated_ char* argv[]
+    )
+{
+    std::regex Filter;
+    bool FilterSet = false;
+    const char* OutFile = nullptr;
+    uint64_t MinTimeNs = QUIC_BENCH_DEFAULT_MIN_TIME_NS;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* Value;
+        bool Valid = true;
+        if ((Value = QuicBenchGetArg(argv[i], "--benchmark_filter")) != nullptr) {
+            try {
+                Filter.assign(Value, std::regex::extended);
+                FilterSet = true;
+            } catch (const std::regex_error&) {
+                fprintf(stderr, "Invalid --benchmark_filter regex: %s\n", Value);
+                Valid = false;
+            }
+        } else if ((Value = QuicBenchGetArg(argv[i], "--benchmark_min_time")) != nullptr) {
+            Valid = QuicBenchParseMinTime(Value, &MinTimeNs);
+        } else if ((Value = QuicBenchGetArg(argv[i], "--benchmark_out")) != nullptr) {
+            OutFile = Value;
+        } else {
+            Valid = false;
+        }
+        if (!Valid) {
+            fprintf(stderr,
+                "Usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>[s]] [--benchmark_out=<file>]\n",
+                argv[0]);
+            return 1;
+        }
+    }
+
+    MsQuicLibraryLoad();
+    if (QUIC_FAILED(MsQuicAddRef())) {
+        fprintf(stderr, "MsQuicAddRef failed\n");
+        MsQuicLibraryUnload();
+        return 1;
+    }
+
+    std::vector<QuicBenchResult> Results;
+    for (auto Bench : QuicBenchRegistration::All()) {
+        if (FilterSet && !std::regex_search(Bench->Name, Filter)) {
+            continue;
+        }
+        Results.push_back(QuicBenchRun(Bench, MinTimeNs));
+        const QuicBenchResult& Result = Results.back();
+        if (Result.ErrorMessage != nullptr) {
+            fprintf(stderr, "%-40s ERROR: %s\n", Result.Name, Result.ErrorMessage);
+        } else {
+            fprintf(stderr, "%-40s %12.1f ns %14llu\n",
+                Result.Name, Result.NsPerOp, (unsigned long long)Result.Iterations);
+        }
+    }
+
+    MsQuicRelease();
+    MsQuicLibraryUnload();
+
+    FILE* Out = stdout;
+    if (OutFile != nullptr) {
+        Out = fopen(OutFile, "w");
+        if (Out == nullptr) {
+            fprintf(stderr, "Failed to open %s\n", OutFile);
+            return 1;
+        }
+    }
+    QuicBenchWriteJson(Out, argv[0], Results);
+    if (Out != stdout) {
+        fclose(Out);
+    }
+
+    return 0;
+}
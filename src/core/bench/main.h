@@ -0,0 +1,100 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Minimal micro-benchmark harness for the core hot-path primitives. Modeled
+    after Google Benchmark: each benchmark is handed an iteration count, runs
+    that many operations, and the harness scales the count until the run is
+    long enough to measure.
+
+--*/
+
+#pragma once
+
+#include "precomp.h"
+
+#undef min
+#undef max
+#include <vector>
+
+struct QuicBenchState {
+    //
+    // Number of operations the benchmark must run.
+    //
+    uint64_t Iterations {0};
+
+    //
+    // Optional throughput counters, reported per second of timed run time.
+    //
+    uint64_t BytesProcessed {0};
+    uint64_t ItemsProcessed {0};
+
+    //
+    // Set when the benchmark could not run (e.g. missing crypto support).
+    //
+    const char* ErrorMessage {nullptr};
+
+    uint64_t ElapsedNs {0};
+    uint64_t StartNs {0};
+    bool Running {false};
+
+    void StartTiming();
+    void StopTiming();
+
+    //
+    // Timing is already running when the benchmark function is entered.
+    // These exclude setup/cleanup inside a benchmark from the measured time.
+    //
+    void PauseTiming() { StopTiming(); }
+    void ResumeTiming() { StartTiming(); }
+
+    void SkipWithError(const char* Message) { ErrorMessage = Message; }
+};
+
+typedef void QUIC_BENCH_FN(QuicBenchState& State);
+
+struct QuicBenchRegistration {
+    const char* Name;
+    QUIC_BENCH_FN* Fn;
+    QuicBenchRegistration(const char* Name, QUIC_BENCH_FN* Fn);
+    static std::vector<QuicBenchRegistration*>& All();
+};
+
+#define QUIC_BENCH(Name) \
+    static void Name(QuicBenchState& State); \
+    static QuicBenchRegistration Name##Registration(#Name, Name); \
+    static void Name(QuicBenchState& State)
+
+//
+// Prevents the compiler from discarding a computed value.
+//
+template<typename T>
+QUIC_INLINE
+void
+QuicBenchDoNotOptimize(
+    const T& Value
+    )
+{
+#if defined(_MSC_VER)
+    (void)*(volatile const char*)&Value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(Value) : "memory");
+#endif
+}
+
+//
+// Cheap deterministic pseudo-random sequence so runs are comparable.
+//
+QUIC_INLINE
+uint32_t
+QuicBenchRandom(
+    _Inout_ uint32_t* Seed
+    )
+{
+    *Seed = *Seed * 1664525 + 1013904223;
+    return *Seed >> 8;
+}
@@ -96,6 +96,13 @@ typedef struct QUIC_RX_PACKET {
     uint8_t DestCidLen;
     uint8_t SourceCidLen;
 
+    //
+    // References held on the datagram by streams that indicated data straight
+    // from its payload. Zero if never held; otherwise it includes a reference
+    // for the connection, released when it's done with the receive batch.
+    //
+    short HoldCount;
+
     //
     // The type of key used to decrypt the packet.
     //
@@ -171,6 +178,37 @@ typedef struct QUIC_RX_PACKET {
 
 } QUIC_RX_PACKET;
 
+//
+// Keeps the datagram from being returned to the datapath until released. Only
+// called while the connection is still processing the datagram.
+//
+QUIC_INLINE
+void
+QuicRxPacketHold(
+    _Inout_ QUIC_RX_PACKET* Packet
+    )
+{
+    if (Packet->HoldCount == 0) {
+        Packet->HoldCount = 2;
+    } else {
+        InterlockedIncrement16(&Packet->HoldCount);
+    }
+}
+
+//
+// Releases a hold on the datagram. Returns TRUE if it was the last one, and
+// the caller must return the datagram to the datapath.
+//
+QUIC_INLINE
+BOOLEAN
+QuicRxPacketRelease(
+    _Inout_ QUIC_RX_PACKET* Packet
+    )
+{
+    CXPLAT_DBG_ASSERT(Packet->HoldCount > 0);
+    return InterlockedDecrement16(&Packet->HoldCount) == 0;
+}
+
 typedef enum QUIC_BINDING_LOOKUP_TYPE {
 
     QUIC_BINDING_LOOKUP_SINGLE,         // Single connection
@@ -165,7 +165,6 @@ typedef struct QUIC_CID_LIST_ENTRY {
 
 typedef struct QUIC_CID_HASH_ENTRY {
 
-    CXPLAT_HASHTABLE_ENTRY Entry;
     CXPLAT_SLIST_ENTRY Link;
     QUIC_CONNECTION* Connection;
     QUIC_CID CID;
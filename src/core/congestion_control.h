@@ -6,6 +6,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 #include "bbr.h"
 #include "cubic.h"
 #include "cubicprobe.h" // <--- [수정 1] cubicprobe.h 헤더 추가
@@ -433,4 +437,8 @@ QuicCongestionControlSetAppLimited(
     )
 {
     Cc->QuicCongestionControlSetAppLimited(Cc);
-}
\ No newline at end of file
+}
+
+#if defined(__cplusplus)
+}
+#endif
@@ -1005,6 +1005,22 @@ QuicConnGenerateNewSourceCids(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnMoveToPartition(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint16_t PartitionIndex
+    )
+{
+    CXPLAT_DBG_ASSERT(Connection->Registration);
+    CXPLAT_DBG_ASSERT(!Connection->Registration->NoPartitioning);
+    CXPLAT_DBG_ASSERT(!Connection->State.UpdateWorker);
+    CXPLAT_DBG_ASSERT(PartitionIndex != QuicPartitionIdGetIndex(Connection->PartitionID));
+    Connection->PartitionID = QuicPartitionIdCreate(PartitionIndex);
+    QuicConnGenerateNewSourceCids(Connection, TRUE);
+    Connection->State.UpdateWorker = TRUE;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_CID_LIST_ENTRY*
 QuicConnGetUnusedDestCid(
@@ -3065,6 +3081,7 @@ QuicConnProcessPeerTransportParameters(
         Connection->PeerTransportParams.InitialMaxBidiStreams,
         Connection->PeerTransportParams.InitialMaxUniStreams,
         !FromResumptionTicket);
+    QuicSendStreamsUnblocked(&Connection->Send);
 
     QuicDatagramOnSendStateChanged(&Connection->Datagram);
 
@@ -4140,125 +4157,116 @@ QuicConnRecvPrepareDecrypt(
 }
 
 //
-// Decrypts the packet's payload and authenticates the whole packet. On
-// successful authentication of the packet, does some final processing of the
-// packet header (key and CID updates). Returns TRUE if the packet should
-// continue to be processed further.
+// Copies the packet's potential stateless reset token. This must be done
+// before trying decryption, as a failed decryption trashes it. Returns TRUE if
+// the packet could be a stateless reset.
 //
 _IRQL_requires_max_(PASSIVE_LEVEL)
 BOOLEAN
-QuicConnRecvDecryptAndAuthenticate(
+QuicConnRecvCopyStatelessResetToken(
     _In_ QUIC_CONNECTION* Connection,
-    _In_ QUIC_PATH* Path,
-    _In_ QUIC_RX_PACKET* Packet
+    _In_ const QUIC_RX_PACKET* Packet,
+    _Out_writes_(QUIC_STATELESS_RESET_TOKEN_LENGTH)
+        uint8_t* PacketResetToken
     )
 {
-    CXPLAT_DBG_ASSERT(Packet->AvailBufferLength >= Packet->HeaderLength + Packet->PayloadLength);
-
-    const uint8_t* Payload = Packet->AvailBuffer + Packet->HeaderLength;
-
-    //
-    // We need to copy the end of the packet before trying decryption, as a
-    // failed decryption trashes the stateless reset token.
-    //
-    BOOLEAN CanCheckForStatelessReset = FALSE;
-    uint8_t PacketResetToken[QUIC_STATELESS_RESET_TOKEN_LENGTH];
     if (QuicConnIsClient(Connection) &&
         Packet->IsShortHeader &&
         Packet->HeaderLength + Packet->PayloadLength >= QUIC_MIN_STATELESS_RESET_PACKET_LENGTH) {
-        CanCheckForStatelessReset = TRUE;
         CxPlatCopyMemory(
             PacketResetToken,
-            Payload + Packet->PayloadLength - QUIC_STATELESS_RESET_TOKEN_LENGTH,
+            Packet->AvailBuffer + Packet->HeaderLength + Packet->PayloadLength -
+                QUIC_STATELESS_RESET_TOKEN_LENGTH,
             QUIC_STATELESS_RESET_TOKEN_LENGTH);
+        return TRUE;
     }
+    return FALSE;
+}
 
-    CXPLAT_DBG_ASSERT(Packet->PacketId != 0);
-
-    uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
-    QuicCryptoCombineIvAndPacketNumber(
-        Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->Iv,
-        (uint8_t*)&Packet->PacketNumber,
-        Iv);
-
+//
+// Handles a packet that failed decryption: either it's a stateless reset for
+// the connection, or it's dropped.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnRecvDecryptFailed(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_RX_PACKET* Packet,
+    _In_reads_opt_(QUIC_STATELESS_RESET_TOKEN_LENGTH)
+        const uint8_t* PacketResetToken
+    )
+{
     //
-    // Decrypt the payload with the appropriate key.
+    // Check for a stateless reset packet.
     //
-    if (Packet->Encrypted) {
-        QuicTraceEvent(
-            PacketDecrypt,
-            "[pack][%llu] Decrypting",
-            Packet->PacketId);
-        if (QUIC_FAILED(
-            CxPlatDecrypt(
-                Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->PacketKey,
-                Iv,
-                Packet->HeaderLength,   // HeaderLength
-                Packet->AvailBuffer,    // Header
-                Packet->PayloadLength,  // BufferLength
-                (uint8_t*)Payload))) {  // Buffer
-
+    if (PacketResetToken != NULL) {
+        for (CXPLAT_LIST_ENTRY* Entry = Connection->DestCids.Flink;
+                Entry != &Connection->DestCids;
+                Entry = Entry->Flink) {
             //
-            // Check for a stateless reset packet.
+            // Loop through all our stored stateless reset tokens to see if
+            // we have a match.
             //
-            if (CanCheckForStatelessReset) {
-                for (CXPLAT_LIST_ENTRY* Entry = Connection->DestCids.Flink;
-                        Entry != &Connection->DestCids;
-                        Entry = Entry->Flink) {
-                    //
-                    // Loop through all our stored stateless reset tokens to see if
-                    // we have a match.
-                    //
-                    QUIC_CID_LIST_ENTRY* DestCid =
-                        CXPLAT_CONTAINING_RECORD(
-                            Entry,
-                            QUIC_CID_LIST_ENTRY,
-                            Link);
-                    if (DestCid->CID.HasResetToken &&
-                        !DestCid->CID.Retired &&
-                        memcmp(
-                            DestCid->ResetToken,
-                            PacketResetToken,
-                            QUIC_STATELESS_RESET_TOKEN_LENGTH) == 0) {
-                        QuicTraceLogVerbose(
-                            PacketRxStatelessReset,
-                            "[S][RX][-] SR %s",
-                            QuicCidBufToStr(PacketResetToken, QUIC_STATELESS_RESET_TOKEN_LENGTH).Buffer);
-                        QuicTraceLogConnInfo(
-                            RecvStatelessReset,
-                            Connection,
-                            "Received stateless reset");
-                        QuicConnCloseLocally(
-                            Connection,
-                            QUIC_CLOSE_INTERNAL_SILENT | QUIC_CLOSE_QUIC_STATUS,
-                            (uint64_t)QUIC_STATUS_ABORTED,
-                            NULL);
-                        return FALSE;
-                    }
-                }
-            }
-
-            if (QuicTraceLogVerboseEnabled()) {
-                QuicPacketLogHeader(
+            QUIC_CID_LIST_ENTRY* DestCid =
+                CXPLAT_CONTAINING_RECORD(
+                    Entry,
+                    QUIC_CID_LIST_ENTRY,
+                    Link);
+            if (DestCid->CID.HasResetToken &&
+                !DestCid->CID.Retired &&
+                memcmp(
+                    DestCid->ResetToken,
+                    PacketResetToken,
+                    QUIC_STATELESS_RESET_TOKEN_LENGTH) == 0) {
+                QuicTraceLogVerbose(
+                    PacketRxStatelessReset,
+                    "[S][RX][-] SR %s",
+                    QuicCidBufToStr(PacketResetToken, QUIC_STATELESS_RESET_TOKEN_LENGTH).Buffer);
+                QuicTraceLogConnInfo(
+                    RecvStatelessReset,
                     Connection,
-                    TRUE,
-                    Connection->State.ShareBinding ? MsQuicLib.CidTotalLength : 0,
-                    Packet->PacketNumber,
-                    Packet->HeaderLength,
-                    Packet->AvailBuffer,
-                    Connection->Stats.QuicVersion);
-            }
-            Connection->Stats.Recv.DecryptionFailures++;
-            QuicPacketLogDrop(Connection, Packet, "Decryption failure");
-            QuicPerfCounterIncrement(Connection->Partition, QUIC_PERF_COUNTER_PKTS_DECRYPTION_FAIL);
-            if (Connection->Stats.Recv.DecryptionFailures >= CXPLAT_AEAD_INTEGRITY_LIMIT) {
-                QuicConnTransportError(Connection, QUIC_ERROR_AEAD_LIMIT_REACHED);
+                    "Received stateless reset");
+                QuicConnCloseLocally(
+                    Connection,
+                    QUIC_CLOSE_INTERNAL_SILENT | QUIC_CLOSE_QUIC_STATUS,
+                    (uint64_t)QUIC_STATUS_ABORTED,
+                    NULL);
+                return;
             }
-
-            return FALSE;
         }
     }
 
+    if (QuicTraceLogVerboseEnabled()) {
+        QuicPacketLogHeader(
+            Connection,
+            TRUE,
+            Connection->State.ShareBinding ? MsQuicLib.CidTotalLength : 0,
+            Packet->PacketNumber,
+            Packet->HeaderLength,
+            Packet->AvailBuffer,
+            Connection->Stats.QuicVersion);
+    }
+    Connection->Stats.Recv.DecryptionFailures++;
+    QuicPacketLogDrop(Connection, Packet, "Decryption failure");
+    QuicPerfCounterIncrement(Connection->Partition, QUIC_PERF_COUNTER_PKTS_DECRYPTION_FAIL);
+    if (Connection->Stats.Recv.DecryptionFailures >= CXPLAT_AEAD_INTEGRITY_LIMIT) {
+        QuicConnTransportError(Connection, QUIC_ERROR_AEAD_LIMIT_REACHED);
+    }
+}
+
+//
+// On successful authentication (decryption) of the packet, does some final
+// processing of the packet header (key and CID updates). Returns TRUE if the
+// packet should continue to be processed further.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicConnRecvAuthenticated(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ QUIC_RX_PACKET* Packet
+    )
+{
     Connection->Stats.Recv.ValidPackets++;
 
     //
@@ -4417,6 +4425,60 @@ QuicConnRecvDecryptAndAuthenticate(
     return TRUE;
 }
 
+//
+// Decrypts the packet's payload and authenticates the whole packet. On
+// successful authentication of the packet, does some final processing of the
+// packet header (key and CID updates). Returns TRUE if the packet should
+// continue to be processed further.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicConnRecvDecryptAndAuthenticate(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_PATH* Path,
+    _In_ QUIC_RX_PACKET* Packet
+    )
+{
+    CXPLAT_DBG_ASSERT(Packet->AvailBufferLength >= Packet->HeaderLength + Packet->PayloadLength);
+    CXPLAT_DBG_ASSERT(Packet->PacketId != 0);
+
+    //
+    // Decrypt the payload with the appropriate key.
+    //
+    if (Packet->Encrypted) {
+        uint8_t PacketResetToken[QUIC_STATELESS_RESET_TOKEN_LENGTH];
+        const BOOLEAN CanCheckForStatelessReset =
+            QuicConnRecvCopyStatelessResetToken(Connection, Packet, PacketResetToken);
+
+        uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
+        QuicCryptoCombineIvAndPacketNumber(
+            Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->Iv,
+            (uint8_t*)&Packet->PacketNumber,
+            Iv);
+
+        QuicTraceEvent(
+            PacketDecrypt,
+            "[pack][%llu] Decrypting",
+            Packet->PacketId);
+        if (QUIC_FAILED(
+            CxPlatDecrypt(
+                Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->PacketKey,
+                Iv,
+                Packet->HeaderLength,   // HeaderLength
+                Packet->AvailBuffer,    // Header
+                Packet->PayloadLength,  // BufferLength
+                (uint8_t*)Packet->AvailBuffer + Packet->HeaderLength))) { // Buffer
+            QuicConnRecvDecryptFailed(
+                Connection,
+                Packet,
+                CanCheckForStatelessReset ? PacketResetToken : NULL);
+            return FALSE;
+        }
+    }
+
+    return QuicConnRecvAuthenticated(Connection, Path, Packet);
+}
+
 //
 // Reads the frames in a packet, and if everything is successful marks the
 // packet for acknowledgement and returns TRUE.
@@ -4828,6 +4890,7 @@ QuicConnRecvFrames(
                 UpdatedFlowControl = TRUE;
                 QuicConnRemoveOutFlowBlockedReason(
                     Connection, QUIC_FLOW_BLOCKED_CONN_FLOW_CONTROL);
+                QuicSendStreamsUnblocked(&Connection->Send);
                 QuicSendQueueFlush(
                     &Connection->Send, REASON_CONNECTION_FLOW_CONTROL);
             }
@@ -5571,14 +5634,96 @@ QuicConnRecvDatagramBatch(
         CxPlatZeroMemory(HpMask, BatchCount * CXPLAT_HP_SAMPLE_LENGTH);
     }
 
+    //
+    // Remove header protection from the leading packets in the current key
+    // phase and decrypt all their payloads at once, before any frames are
+    // processed. The first packet in a different key phase ends this, since
+    // the key it needs depends on the packets before it having been fully
+    // processed; it and the rest are handled one at a time below.
+    //
+    uint8_t PreparedCount = 0;
+    BOOLEAN Prepared[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    QUIC_STATUS DecryptStatus[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    BOOLEAN CanCheckForStatelessReset[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t PacketResetTokens[QUIC_MAX_CRYPTO_BATCH_COUNT][QUIC_STATELESS_RESET_TOKEN_LENGTH];
+    if (BatchCount > 1 && Packet->IsShortHeader && Packet->Encrypted) {
+        const QUIC_PACKET_KEY* ReadKey =
+            Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT];
+        const BOOLEAN CurrentKeyPhase =
+            Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT]->CurrentKeyPhase;
+        uint8_t Iv[QUIC_MAX_CRYPTO_BATCH_COUNT][CXPLAT_MAX_IV_LENGTH];
+        CXPLAT_CRYPT_BATCH_ENTRY Entries[QUIC_MAX_CRYPTO_BATCH_COUNT];
+        uint8_t EntryCount = 0;
+
+        CXPLAT_DBG_ASSERT(Packet->KeyType == QUIC_PACKET_KEY_1_RTT);
+        for (; PreparedCount < BatchCount; ++PreparedCount) {
+            Packet = Packets[PreparedCount];
+            const uint8_t* Mask = HpMask + PreparedCount * CXPLAT_HP_SAMPLE_LENGTH;
+            uint8_t FirstByte = Packet->AvailBuffer[0] ^ (Mask[0] & 0x1f);
+            if (((QUIC_SHORT_HEADER_V1*)&FirstByte)->KeyPhase != CurrentKeyPhase) {
+                break;
+            }
+
+            Prepared[PreparedCount] = QuicConnRecvPrepareDecrypt(Connection, Packet, Mask);
+            if (!Prepared[PreparedCount]) {
+                continue;
+            }
+            CXPLAT_DBG_ASSERT(Packet->KeyType == QUIC_PACKET_KEY_1_RTT);
+
+            CanCheckForStatelessReset[PreparedCount] =
+                QuicConnRecvCopyStatelessResetToken(
+                    Connection, Packet, PacketResetTokens[PreparedCount]);
+            QuicCryptoCombineIvAndPacketNumber(
+                ReadKey->Iv, (uint8_t*)&Packet->PacketNumber, Iv[EntryCount]);
+            QuicTraceEvent(
+                PacketDecrypt,
+                "[pack][%llu] Decrypting",
+                Packet->PacketId);
+
+            Entries[EntryCount].Iv = Iv[EntryCount];
+            Entries[EntryCount].AuthData = Packet->AvailBuffer;
+            Entries[EntryCount].AuthDataLength = Packet->HeaderLength;
+            Entries[EntryCount].Buffer = (uint8_t*)Packet->AvailBuffer + Packet->HeaderLength;
+            Entries[EntryCount].BufferLength = Packet->PayloadLength;
+            EntryCount++;
+        }
+
+        if (EntryCount != 0) {
+            QUIC_STATUS EntryStatus[QUIC_MAX_CRYPTO_BATCH_COUNT];
+            (void)CxPlatDecryptBatch(ReadKey->PacketKey, EntryCount, Entries, EntryStatus);
+            for (uint8_t i = 0, j = 0; i < PreparedCount; ++i) {
+                if (Prepared[i]) {
+                    DecryptStatus[i] = EntryStatus[j++];
+                }
+            }
+        }
+    }
+
     for (uint8_t i = 0; i < BatchCount; ++i) {
         CXPLAT_DBG_ASSERT(Packets[i]->Allocated);
         CXPLAT_ECN_TYPE ECN = CXPLAT_ECN_FROM_TOS(Packets[i]->TypeOfService);
         Packet = Packets[i];
         CXPLAT_DBG_ASSERT(Packet->PacketId != 0);
-        if (!QuicConnRecvPrepareDecrypt(
-                Connection, Packet, HpMask + i * CXPLAT_HP_SAMPLE_LENGTH) ||
-            !QuicConnRecvDecryptAndAuthenticate(Connection, Path, Packet)) {
+        BOOLEAN Valid;
+        if (i < PreparedCount) {
+            if (!Prepared[i]) {
+                Valid = FALSE;
+            } else if (QUIC_FAILED(DecryptStatus[i])) {
+                QuicConnRecvDecryptFailed(
+                    Connection,
+                    Packet,
+                    CanCheckForStatelessReset[i] ? PacketResetTokens[i] : NULL);
+                Valid = FALSE;
+            } else {
+                Valid = QuicConnRecvAuthenticated(Connection, Path, Packet);
+            }
+        } else {
+            Valid =
+                QuicConnRecvPrepareDecrypt(
+                    Connection, Packet, HpMask + i * CXPLAT_HP_SAMPLE_LENGTH) &&
+                QuicConnRecvDecryptAndAuthenticate(Connection, Path, Packet);
+        }
+        if (!Valid) {
             if (Connection->State.CompatibleVerNegotiationAttempted &&
                 !Connection->State.CompatibleVerNegotiationCompleted) {
                 //
@@ -5613,6 +5758,35 @@ QuicConnRecvDatagramBatch(
     }
 }
 
+//
+// Returns processed datagrams to the datapath, except for the ones still held
+// by streams. Those are returned when the last hold is released.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnReturnRecvDatagrams(
+    _In_ QUIC_RX_PACKET* Packets
+    )
+{
+    QUIC_RX_PACKET* ReleaseChain = NULL;
+    QUIC_RX_PACKET** ReleaseChainTail = &ReleaseChain;
+
+    while (Packets != NULL) {
+        QUIC_RX_PACKET* Packet = Packets;
+        Packets = (QUIC_RX_PACKET*)Packet->Next;
+        if (Packet->HoldCount != 0 && !QuicRxPacketRelease(Packet)) {
+            continue;
+        }
+        *ReleaseChainTail = Packet;
+        ReleaseChainTail = (QUIC_RX_PACKET**)&Packet->Next;
+    }
+
+    if (ReleaseChain != NULL) {
+        *ReleaseChainTail = NULL;
+        CxPlatRecvDataReturn((CXPLAT_RECV_DATA*)ReleaseChain);
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicConnRecvDatagrams(
@@ -5822,7 +5996,7 @@ QuicConnRecvDatagrams(
                         &RecvState);
                     BatchCount = 0;
                 }
-                CxPlatRecvDataReturn((CXPLAT_RECV_DATA*)ReleaseChain);
+                QuicConnReturnRecvDatagrams(ReleaseChain);
                 ReleaseChain = NULL;
                 ReleaseChainTail = &ReleaseChain;
                 ReleaseChainCount = 0;
@@ -5860,7 +6034,7 @@ QuicConnRecvDatagrams(
     }
 
     if (ReleaseChain != NULL) {
-        CxPlatRecvDataReturn((CXPLAT_RECV_DATA*)ReleaseChain);
+        QuicConnReturnRecvDatagrams(ReleaseChain);
     }
 
     if (QuicConnIsServer(Connection) &&
@@ -5896,12 +6070,7 @@ QuicConnRecvDatagrams(
 
     if (!Connection->State.UpdateWorker && Connection->State.Connected &&
         !Connection->State.ShutdownComplete && RecvState.UpdatePartitionId) {
-        CXPLAT_DBG_ASSERT(Connection->Registration);
-        CXPLAT_DBG_ASSERT(!Connection->Registration->NoPartitioning);
-        CXPLAT_DBG_ASSERT(RecvState.PartitionIndex != QuicPartitionIdGetIndex(Connection->PartitionID));
-        Connection->PartitionID = QuicPartitionIdCreate(RecvState.PartitionIndex);
-        QuicConnGenerateNewSourceCids(Connection, TRUE);
-        Connection->State.UpdateWorker = TRUE;
+        QuicConnMoveToPartition(Connection, RecvState.PartitionIndex);
     }
 }
 
@@ -6494,8 +6663,7 @@ QuicConnParamSet(
             break;
         }
 
-        Connection->State.UseRoundRobinStreamScheduling =
-            Scheme == QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN;
+        QuicSendSetStreamSchedulingScheme(&Connection->Send, Scheme);
 
         QuicTraceLogConnInfo(
             UpdateStreamSchedulingScheme,
@@ -7256,9 +7424,7 @@ QuicConnParamGet(
         }
 
         *BufferLength = sizeof(QUIC_STREAM_SCHEDULING_SCHEME);
-        *(QUIC_STREAM_SCHEDULING_SCHEME*)Buffer =
-            Connection->State.UseRoundRobinStreamScheduling ?
-                QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN : QUIC_STREAM_SCHEDULING_SCHEME_FIFO;
+        *(QUIC_STREAM_SCHEDULING_SCHEME*)Buffer = Connection->Send.Scheduler->Scheme;
 
         Status = QUIC_STATUS_SUCCESS;
         break;
@@ -7911,6 +8077,14 @@ QuicConnDrainOperations(
 
     QuicStreamSetDrainClosedStreams(&Connection->Streams);
 
+    if (!HasMoreWorkToDo && !QuicConnIsClosed(Connection)) {
+        //
+        // All queued work is done; use the idle time to get ready for the
+        // next key update.
+        //
+        QuicCryptoPrepareNextKeys(Connection);
+    }
+
     QuicConnValidate(Connection);
 
     if (HasMoreWorkToDo) {
@@ -8,6 +8,10 @@
 #include "connection.h.clog.h"
 #endif
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_LISTENER QUIC_LISTENER;
 
 //
@@ -133,12 +137,6 @@ typedef union QUIC_CONNECTION_STATE {
         //
         BOOLEAN TestTransportParameterSet : 1;
 
-        //
-        // Indicates the connection is using the round robin stream scheduling
-        // scheme.
-        //
-        BOOLEAN UseRoundRobinStreamScheduling : 1;
-
         //
         // Indicates that this connection has resumption enabled and needs to
         // keep the TLS state and transport parameters until it is done sending
@@ -1245,6 +1243,18 @@ QuicConnGenerateNewSourceCids(
     _In_ BOOLEAN ReplaceExistingCids
     );
 
+//
+// Moves the connection to another partition, and so to the worker for that
+// partition, once the current drain completes. New source CIDs are generated
+// for the new partition.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnMoveToPartition(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint16_t PartitionIndex
+    );
+
 //
 // Retires the currently used destination connection ID.
 //
@@ -1727,3 +1737,7 @@ QuicMtuDiscoveryCheckSearchCompleteTimeout(
         }
     }
 }
+
+#if defined(__cplusplus)
+}
+#endif
@@ -1449,6 +1449,10 @@ QuicCryptoProcessTlsCompletion(
         CXPLAT_DBG_ASSERT(Crypto->TlsState.WriteKey <= QUIC_PACKET_KEY_1_RTT);
         _Analysis_assume_(Crypto->TlsState.WriteKey >= 0);
         CXPLAT_TEL_ASSERT(Crypto->TlsState.WriteKeys[Crypto->TlsState.WriteKey] != NULL);
+        //
+        // Streams may have been waiting on 0-RTT or 1-RTT keys to send.
+        //
+        QuicSendStreamsUnblocked(&Connection->Send);
         if (Crypto->TlsState.WriteKey == QUIC_PACKET_KEY_1_RTT) {
             if (QuicConnIsClient(Connection)) {
                 //
@@ -2087,6 +2091,35 @@ Error:
     return Status;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoPrepareNextKeys(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    if (!Connection->State.HandshakeConfirmed ||
+        Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT] == NULL ||
+        Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT_NEW] != NULL) {
+        return;
+    }
+
+    //
+    // Most connections never update keys, so don't spend the memory on the
+    // next keys until either the peer has already updated once (and so likely
+    // will again) or half of the local limit of bytes per key has been sent.
+    //
+    const QUIC_PACKET_SPACE* PacketSpace = Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT];
+    if (Connection->Stats.Misc.KeyUpdateCount == 0 &&
+        PacketSpace->CurrentKeyPhaseBytesSent < Connection->Settings.MaxBytesPerKey / 2) {
+        return;
+    }
+
+    //
+    // On failure, the keys are simply generated on demand later.
+    //
+    (void)QuicCryptoGenerateNewKeys(Connection);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicCryptoUpdateKeyPhase(
@@ -335,6 +335,16 @@ QuicCryptoGenerateNewKeys(
     _In_ QUIC_CONNECTION* Connection
     );
 
+//
+// Generates the next 1-RTT keys ahead of time, so that a key update doesn't
+// have to derive them on the packet path. Only done once an update is likely.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoPrepareNextKeys(
+    _In_ QUIC_CONNECTION* Connection
+    );
+
 //
 // Shift 1-RTT keys, freeing the old keys and replacing them with the current
 // keys, replacing the current keys with the new keys; update the start packet
@@ -298,6 +298,11 @@ QuicAckFrameDecode(
     uint64_t Largest = Frame.LargestAcknowledged;
     uint64_t Count = Frame.FirstAckBlock + 1;
 
+    if (Count > Largest + 1) {
+        *InvalidFrame = TRUE; // The block would go below packet number zero.
+        return FALSE;
+    }
+
     BOOLEAN DontCare;
     if (!QuicRangeAddRange(AckRanges, Largest + 1 - Count, Count, &DontCare)) {
         return FALSE;
@@ -335,14 +340,21 @@ QuicAckFrameDecode(
         Largest -= (Block.Gap + 1);
         Count = Block.AckBlock + 1;
 
+        if (Count > Largest + 1) {
+            *InvalidFrame = TRUE;
+            return FALSE;
+        }
+
         //
-        // N.B. The efficiency here isn't great because we are always inserting
-        // values less than the current minimum, which requires a complete
-        // memmove of the current array. A circular buffer that allows both
-        // forward and backward growth would fix this.
+        // The blocks are in decreasing order and never adjacent, so unless
+        // the caller passed in overlapping values, each one can be put in
+        // front of the range without searching it.
         //
-
-        if (!QuicRangeAddRange(AckRanges, Largest - Count + 1, Count, &DontCare)) {
+        if (Largest + 1 < QuicRangeGetMin(AckRanges)) {
+            if (!QuicRangeAddRangeBeforeMin(AckRanges, Largest - Count + 1, Count)) {
+                return FALSE;
+            }
+        } else if (!QuicRangeAddRange(AckRanges, Largest - Count + 1, Count, &DontCare)) {
             return FALSE;
         }
     }
@@ -438,6 +438,8 @@ MsQuicLibraryOnSettingsChanged(
     MsQuicLib.HandshakeMemoryLimit =
         (MsQuicLib.Settings.RetryMemoryLimit * CxPlatTotalMemory) / UINT16_MAX;
     QuicLibraryEvaluateSendRetryState();
+    MsQuicLib.RecvWindowMemoryLimit =
+        (QUIC_RECV_WINDOW_MEMORY_FRACTION * CxPlatTotalMemory) / UINT16_MAX;
 
     if (UpdateRegistrations) {
         CxPlatLockAcquire(&MsQuicLib.Lock);
@@ -696,6 +698,7 @@ MsQuicLibraryUninitialize(
         CXPLAT_FREE(MsQuicLib.ExecutionConfig, QUIC_POOL_EXECUTION_CONFIG);
         MsQuicLib.ExecutionConfig = NULL;
     }
+    MsQuicLib.RebalanceConnections = FALSE;
 
     MsQuicLib.LazyInitComplete = FALSE;
 
@@ -1144,6 +1147,7 @@ QuicLibrarySetGlobalParam(
                 CXPLAT_FREE(MsQuicLib.ExecutionConfig, QUIC_POOL_EXECUTION_CONFIG);
                 MsQuicLib.ExecutionConfig = NULL;
             }
+            MsQuicLib.RebalanceConnections = FALSE;
             return QUIC_STATUS_SUCCESS;
         }
 
@@ -1167,15 +1171,18 @@ QuicLibrarySetGlobalParam(
         if (MsQuicLib.LazyInitComplete) {
 
             //
-            // We only allow for updating the polling idle timeout after MsQuic library has
-            // finished up lazy initialization, which initializes both PerProc struct and
-            // the datapath; and only if the app set some custom config to begin with.
+            // We only allow for updating the polling idle timeout (and the
+            // rebalance flag) after MsQuic library has finished up lazy
+            // initialization, which initializes both PerProc struct and the
+            // datapath; and only if the app set some custom config to begin with.
             //
             CXPLAT_DBG_ASSERT(MsQuicLib.Partitions != NULL);
             CXPLAT_DBG_ASSERT(MsQuicLib.Datapath != NULL);
 
             CxPlatDataPathUpdatePollingIdleTimeout(
                 MsQuicLib.Datapath, Config->PollingIdleTimeoutUs);
+            MsQuicLib.RebalanceConnections =
+                !!(Config->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE);
             Status = QUIC_STATUS_SUCCESS;
             CxPlatLockRelease(&MsQuicLib.Lock);
             break;
@@ -1200,6 +1207,8 @@ QuicLibrarySetGlobalParam(
 
         CxPlatCopyMemory(NewConfig, Config, BufferLength);
         MsQuicLib.ExecutionConfig = NewConfig;
+        MsQuicLib.RebalanceConnections =
+            !!(Config->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE);
         CxPlatLockRelease(&MsQuicLib.Lock);
 
         QuicTraceLogInfo(
@@ -2030,6 +2039,7 @@ MsQuicOpenVersion(
     Api->ExecutionCreate = MsQuicExecutionCreate;
     Api->ExecutionDelete = MsQuicExecutionDelete;
     Api->ExecutionPoll = MsQuicExecutionPoll;
+    Api->StreamSendFile = MsQuicStreamSendFile;
 #endif
 
     Api->ConnectionPoolCreate = MsQuicConnectionPoolCreate;
@@ -2557,6 +2567,36 @@ QuicLibraryOnHandshakeConnectionRemoved(
     QuicLibraryEvaluateSendRetryState();
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLibraryTryReserveRecvWindowMemory(
+    _In_ uint64_t Length
+    )
+{
+    const uint64_t NewUsage =
+        (uint64_t)InterlockedExchangeAdd64(
+            (int64_t*)&MsQuicLib.CurrentRecvWindowMemoryUsage,
+            (int64_t)Length) + Length;
+    if (NewUsage > MsQuicLib.RecvWindowMemoryLimit) {
+        InterlockedExchangeAdd64(
+            (int64_t*)&MsQuicLib.CurrentRecvWindowMemoryUsage,
+            -1 * (int64_t)Length);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLibraryReleaseRecvWindowMemory(
+    _In_ uint64_t Length
+    )
+{
+    InterlockedExchangeAdd64(
+        (int64_t*)&MsQuicLib.CurrentRecvWindowMemoryUsage,
+        -1 * (int64_t)Length);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicLibraryEvaluateSendRetryState(
@@ -167,6 +167,17 @@ typedef struct QUIC_LIBRARY {
     //
     uint64_t CurrentHandshakeMemoryUsage;
 
+    //
+    // The maximum total memory that connection-wide flow control windows may
+    // be grown by receive window tuning.
+    //
+    uint64_t RecvWindowMemoryLimit;
+
+    //
+    // The current total growth of connection-wide flow control windows.
+    //
+    uint64_t CurrentRecvWindowMemoryUsage;
+
     //
     // Handle to global persistent storage (registry).
     //
@@ -177,6 +188,13 @@ typedef struct QUIC_LIBRARY {
     //
     QUIC_GLOBAL_EXECUTION_CONFIG* ExecutionConfig;
 
+    //
+    // Whether workers move connections off when overloaded. Tracks the
+    // QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE flag, which (unlike the rest
+    // of the execution config) can still be changed after lazy initialization.
+    //
+    BOOLEAN RebalanceConnections;
+
     //
     // Datapath instance for the library.
     //
@@ -552,6 +570,25 @@ QuicLibraryOnHandshakeConnectionRemoved(
     void
     );
 
+//
+// Reserves memory for growing a connection-wide flow control window. Fails if
+// the total would exceed the library's receive window memory limit.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLibraryTryReserveRecvWindowMemory(
+    _In_ uint64_t Length
+    );
+
+//
+// Releases memory previously reserved for flow control window growth.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLibraryReleaseRecvWindowMemory(
+    _In_ uint64_t Length
+    );
+
 //
 // Generates a stateless reset token for the given connection ID.
 //
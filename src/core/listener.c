@@ -330,6 +330,14 @@ MsQuicListenerStart(
             UdpConfig.CibirIdLength);
     }
 
+    //
+    // Lets the datapath steer short header packets to the socket owned by the
+    // partition encoded in the destination CID.
+    //
+    UdpConfig.CidPartitionIdOffset = MsQuicLib.CidServerIdLength;
+    UdpConfig.CidPartitionMask = MsQuicLib.PartitionMask;
+    UdpConfig.CidPartitionCount = MsQuicLib.PartitionCount;
+
     if (MsQuicLib.Settings.XdpEnabled) {
         UdpConfig.Flags |= CXPLAT_SOCKET_FLAG_XDP;
     }
@@ -14,13 +14,256 @@ Abstract:
 #include "lookup.c.clog.h"
 #endif
 
+#define QUIC_CID_TABLE_LANE_LOW_BIT     0x0101010101010101ull
+#define QUIC_CID_TABLE_LANE_LOW_7_BITS  0x7F7F7F7F7F7F7F7Full
+#define QUIC_CID_TABLE_LANE_HIGH_BIT    0x0080808080808080ull // Only the used lanes
+
 typedef struct QUIC_CACHEALIGN QUIC_PARTITIONED_HASHTABLE {
 
     CXPLAT_DISPATCH_RW_LOCK RwLock;
-    CXPLAT_HASHTABLE Table;
+    QUIC_CID_TABLE Table;
 
 } QUIC_PARTITIONED_HASHTABLE;
 
+#define QuicCidTableTag(Hash) ((uint8_t)((Hash) >> 25))
+#define QuicCidTableCapacity(Table) (((Table)->GroupMask + 1) * QUIC_CID_TABLE_GROUP_SLOTS)
+
+//
+// Returns a mask with the high bit of each used lane set if that lane's tag
+// equals Tag.
+//
+QUIC_INLINE
+uint64_t
+QuicCidTableMatch(
+    _In_ const QUIC_CID_TABLE_GROUP* Group,
+    _In_ uint8_t Tag
+    )
+{
+    uint64_t Tags;
+    CxPlatCopyMemory(&Tags, Group->Tags, sizeof(Tags));
+    const uint64_t Diff = Tags ^ (QUIC_CID_TABLE_LANE_LOW_BIT * Tag);
+    //
+    // Sets the high bit of exactly those lanes that are zero, without carries
+    // between lanes.
+    //
+    return
+        ~(((Diff & QUIC_CID_TABLE_LANE_LOW_7_BITS) + QUIC_CID_TABLE_LANE_LOW_7_BITS) |
+            Diff | QUIC_CID_TABLE_LANE_LOW_7_BITS) &
+        QUIC_CID_TABLE_LANE_HIGH_BIT;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicCidTableInitialize(
+    _Out_ QUIC_CID_TABLE* Table,
+    _In_ uint32_t GroupCount
+    )
+{
+    CXPLAT_DBG_ASSERT((GroupCount & (GroupCount - 1)) == 0);
+    Table->Allocation =
+        CXPLAT_ALLOC_NONPAGED(
+            GroupCount * sizeof(QUIC_CID_TABLE_GROUP) + QUIC_CID_TABLE_GROUP_ALIGNMENT - 1,
+            QUIC_POOL_LOOKUP_HASHTABLE);
+    if (Table->Allocation == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CID table",
+            GroupCount * sizeof(QUIC_CID_TABLE_GROUP) + QUIC_CID_TABLE_GROUP_ALIGNMENT - 1);
+        return FALSE;
+    }
+
+    Table->Groups =
+        (QUIC_CID_TABLE_GROUP*)
+            (((uintptr_t)Table->Allocation + QUIC_CID_TABLE_GROUP_ALIGNMENT - 1) &
+                ~(uintptr_t)(QUIC_CID_TABLE_GROUP_ALIGNMENT - 1));
+    for (uint32_t i = 0; i < GroupCount; ++i) {
+        memset(Table->Groups[i].Tags, QUIC_CID_TABLE_TAG_EMPTY, sizeof(Table->Groups[i].Tags));
+    }
+    Table->GroupMask = GroupCount - 1;
+    Table->EntryCount = 0;
+    Table->DeletedCount = 0;
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableUninitialize(
+    _In_ QUIC_CID_TABLE* Table
+    )
+{
+    CXPLAT_FREE(Table->Allocation, QUIC_POOL_LOOKUP_HASHTABLE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CID_HASH_ENTRY*
+QuicCidTableLookup(
+    _In_ const QUIC_CID_TABLE* Table,
+    _In_reads_(Length)
+        const uint8_t* const Cid,
+    _In_ uint8_t Length,
+    _In_ uint32_t Hash
+    )
+{
+    const uint8_t Tag = QuicCidTableTag(Hash);
+    uint32_t GroupIndex = Hash & Table->GroupMask;
+    for (uint32_t Probe = 1; Probe <= Table->GroupMask + 1; ++Probe) {
+        const QUIC_CID_TABLE_GROUP* Group = &Table->Groups[GroupIndex];
+        uint64_t Match = QuicCidTableMatch(Group, Tag);
+        for (uint32_t i = 0; Match != 0; ++i, Match >>= 8) {
+            if (Match & 0x80) {
+                QUIC_CID_HASH_ENTRY* Entry = Group->Entries[i];
+                if (Entry->CID.Length == Length &&
+                    memcmp(Cid, Entry->CID.Data, Length) == 0) {
+                    return Entry;
+                }
+            }
+        }
+        if (QuicCidTableMatch(Group, QUIC_CID_TABLE_TAG_EMPTY) != 0) {
+            break;
+        }
+        GroupIndex = (GroupIndex + Probe) & Table->GroupMask;
+    }
+    return NULL;
+}
+
+//
+// Inserts into the first empty or deleted slot, which must exist.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableInsertSlot(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ QUIC_CID_HASH_ENTRY* Entry,
+    _In_ uint32_t Hash
+    )
+{
+    uint32_t GroupIndex = Hash & Table->GroupMask;
+    for (uint32_t Probe = 1; Probe <= Table->GroupMask + 1; ++Probe) {
+        QUIC_CID_TABLE_GROUP* Group = &Table->Groups[GroupIndex];
+        for (uint32_t i = 0; i < QUIC_CID_TABLE_GROUP_SLOTS; ++i) {
+            if (Group->Tags[i] == QUIC_CID_TABLE_TAG_EMPTY ||
+                Group->Tags[i] == QUIC_CID_TABLE_TAG_DELETED) {
+                if (Group->Tags[i] == QUIC_CID_TABLE_TAG_DELETED) {
+                    Table->DeletedCount--;
+                }
+                Group->Tags[i] = QuicCidTableTag(Hash);
+                Group->Entries[i] = Entry;
+                Table->EntryCount++;
+                return;
+            }
+        }
+        GroupIndex = (GroupIndex + Probe) & Table->GroupMask;
+    }
+    CXPLAT_FRE_ASSERT(FALSE);
+}
+
+//
+// Moves all the entries to a new table with the given number of groups, which
+// also drops all deleted slots. Returns FALSE if out of memory, in which case
+// the table is unchanged. Entries are always hashed with CxPlatHashSimple.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicCidTableResize(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ uint32_t GroupCount
+    )
+{
+    QUIC_CID_TABLE NewTable;
+    if (!QuicCidTableInitialize(&NewTable, GroupCount)) {
+        return FALSE;
+    }
+
+    for (uint32_t i = 0; i <= Table->GroupMask; ++i) {
+        const QUIC_CID_TABLE_GROUP* Group = &Table->Groups[i];
+        for (uint32_t j = 0; j < QUIC_CID_TABLE_GROUP_SLOTS; ++j) {
+            if (!(Group->Tags[j] & QUIC_CID_TABLE_TAG_EMPTY)) { // Neither empty nor deleted
+                QUIC_CID_HASH_ENTRY* Entry = Group->Entries[j];
+                QuicCidTableInsertSlot(
+                    &NewTable,
+                    Entry,
+                    CxPlatHashSimple(Entry->CID.Length, Entry->CID.Data));
+            }
+        }
+    }
+
+    CXPLAT_DBG_ASSERT(NewTable.EntryCount == Table->EntryCount);
+    QuicCidTableUninitialize(Table);
+    *Table = NewTable;
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicCidTableInsert(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ QUIC_CID_HASH_ENTRY* Entry,
+    _In_ uint32_t Hash
+    )
+{
+    //
+    // Keep at least 1/8 of the slots empty so probe sequences stay short.
+    // Grow if more than half the slots would be in use; otherwise there are
+    // enough deleted slots that a same size rehash is enough.
+    //
+    const uint32_t Capacity = QuicCidTableCapacity(Table);
+    if (Table->EntryCount + Table->DeletedCount + 1 > Capacity - Capacity / 8) {
+        const uint32_t GroupCount = Table->GroupMask + 1;
+        if (!QuicCidTableResize(
+                Table,
+                Table->EntryCount + 1 > Capacity / 2 ? GroupCount * 2 : GroupCount) &&
+            Table->EntryCount + Table->DeletedCount == Capacity) {
+            return FALSE;
+        }
+    }
+
+    QuicCidTableInsertSlot(Table, Entry, Hash);
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableRemove(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ const QUIC_CID_HASH_ENTRY* Entry,
+    _In_ uint32_t Hash
+    )
+{
+    const uint8_t Tag = QuicCidTableTag(Hash);
+    uint32_t GroupIndex = Hash & Table->GroupMask;
+    for (uint32_t Probe = 1; Probe <= Table->GroupMask + 1; ++Probe) {
+        QUIC_CID_TABLE_GROUP* Group = &Table->Groups[GroupIndex];
+        uint64_t Match = QuicCidTableMatch(Group, Tag);
+        for (uint32_t i = 0; Match != 0; ++i, Match >>= 8) {
+            if ((Match & 0x80) && Group->Entries[i] == Entry) {
+                if (QuicCidTableMatch(Group, QUIC_CID_TABLE_TAG_EMPTY) != 0) {
+                    //
+                    // No probe sequence continues past a group with an empty
+                    // slot, so this slot can be made empty too.
+                    //
+                    Group->Tags[i] = QUIC_CID_TABLE_TAG_EMPTY;
+                } else {
+                    Group->Tags[i] = QUIC_CID_TABLE_TAG_DELETED;
+                    Table->DeletedCount++;
+                }
+                Table->EntryCount--;
+
+                //
+                // Shrink once mostly empty; failure to do so is harmless.
+                //
+                if (Table->GroupMask + 1 > QUIC_CID_TABLE_MIN_GROUPS &&
+                    Table->EntryCount < QuicCidTableCapacity(Table) / 8) {
+                    (void)QuicCidTableResize(Table, (Table->GroupMask + 1) / 2);
+                }
+                return;
+            }
+        }
+        GroupIndex = (GroupIndex + Probe) & Table->GroupMask;
+    }
+    CXPLAT_DBG_ASSERT(FALSE); // Not found
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicLookupInsertLocalCid(
@@ -30,6 +273,24 @@ QuicLookupInsertLocalCid(
     _In_ BOOLEAN UpdateRefCount
     );
 
+//
+// Frees a set of partitioned hash tables. The CID entries themselves are
+// owned by their connections and aren't touched.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupDestroyHashTable(
+    _In_reads_(PartitionCount) QUIC_PARTITIONED_HASHTABLE* Tables,
+    _In_ uint16_t PartitionCount
+    )
+{
+    for (uint16_t i = 0; i < PartitionCount; i++) {
+        QuicCidTableUninitialize(&Tables[i].Table);
+        CxPlatDispatchRwLockUninitialize(&Tables[i].RwLock);
+    }
+    CXPLAT_FREE(Tables, QUIC_POOL_LOOKUP_HASHTABLE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicLookupInitialize(
@@ -53,15 +314,9 @@ QuicLookupUninitialize(
     } else {
         CXPLAT_DBG_ASSERT(Lookup->HASH.Tables != NULL);
         for (uint16_t i = 0; i < Lookup->PartitionCount; i++) {
-            QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[i];
-            CXPLAT_DBG_ASSERT(Table->Table.NumEntries == 0);
-#pragma warning(push)
-#pragma warning(disable:6001)
-            CxPlatHashtableUninitialize(&Table->Table);
-#pragma warning(pop)
-            CxPlatDispatchRwLockUninitialize(&Table->RwLock);
+            CXPLAT_DBG_ASSERT(Lookup->HASH.Tables[i].Table.EntryCount == 0);
         }
-        CXPLAT_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
+        QuicLookupDestroyHashTable(Lookup->HASH.Tables, Lookup->PartitionCount);
     }
 
     if (Lookup->MaximizePartitioning) {
@@ -95,7 +350,7 @@ QuicLookupCreateHashTable(
         uint16_t Cleanup = 0;
         uint8_t Failed = FALSE;
         for (uint16_t i = 0; i < PartitionCount; i++) {
-            if (!CxPlatHashtableInitializeEx(&Lookup->HASH.Tables[i].Table, CXPLAT_HASH_MIN_SIZE)) {
+            if (!QuicCidTableInitialize(&Lookup->HASH.Tables[i].Table, QUIC_CID_TABLE_MIN_GROUPS)) {
                 Cleanup = i;
                 Failed = TRUE;
                 break;
@@ -104,7 +359,8 @@ QuicLookupCreateHashTable(
         }
         if (Failed) {
             for (uint16_t i = 0; i < Cleanup; i++) {
-                CxPlatHashtableUninitialize(&Lookup->HASH.Tables[i].Table);
+                QuicCidTableUninitialize(&Lookup->HASH.Tables[i].Table);
+                CxPlatDispatchRwLockUninitialize(&Lookup->HASH.Tables[i].RwLock);
             }
             CXPLAT_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
             Lookup->HASH.Tables = NULL;
@@ -119,7 +375,7 @@ QuicLookupCreateHashTable(
 //
 // Rebalances the lookup tables to make sure they are optimal for the current
 // configuration of connections and listeners. Requires the RwLock to be held
-// exclusively.
+// exclusively. Returns FALSE, with the lookup unchanged, if out of memory.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
@@ -164,9 +420,13 @@ QuicLookupRebalance(
         }
 
         //
-        // Move the CIDs to the new table.
+        // Move the CIDs to the new table. The previous tables are left
+        // untouched until every CID has been moved, so that they can be put
+        // back if an insert runs out of memory.
         //
 
+        BOOLEAN Moved = TRUE;
+
         if (PreviousPartitionCount == 0) {
 
             //
@@ -184,11 +444,14 @@ QuicLookupRebalance(
                             Entry,
                             QUIC_CID_HASH_ENTRY,
                             Link);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
+                    if (!QuicLookupInsertLocalCid(
+                            Lookup,
+                            CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
+                            CID,
+                            FALSE)) {
+                        Moved = FALSE;
+                        break;
+                    }
                     Entry = Entry->Next;
                 }
             }
@@ -196,43 +459,41 @@ QuicLookupRebalance(
         } else {
 
             //
-            // Changes the number of partitioned tables. Remove all the CIDs
-            // from the old tables and insert them into the new tables.
+            // Changes the number of partitioned tables. Insert all the CIDs
+            // from the old tables into the new tables.
             //
 
             QUIC_PARTITIONED_HASHTABLE* PreviousTable = PreviousLookup;
-            for (uint16_t i = 0; i < PreviousPartitionCount; i++) {
-                CXPLAT_HASHTABLE_ENUMERATOR Enumerator;
-#pragma warning(push)
-#pragma warning(disable:6001)
-                CxPlatHashtableEnumerateBegin(&PreviousTable[i].Table, &Enumerator);
-#pragma warning(pop)
-                while (TRUE) {
-                    CXPLAT_HASHTABLE_ENTRY* Entry =
-                        CxPlatHashtableEnumerateNext(&PreviousTable[i].Table, &Enumerator);
-                    if (Entry == NULL) {
-                        CxPlatHashtableEnumerateEnd(&PreviousTable[i].Table, &Enumerator);
-                        break;
+            for (uint16_t i = 0; Moved && i < PreviousPartitionCount; i++) {
+                QUIC_CID_TABLE* Table = &PreviousTable[i].Table;
+                for (uint32_t j = 0; Moved && j <= Table->GroupMask; j++) {
+                    const QUIC_CID_TABLE_GROUP* Group = &Table->Groups[j];
+                    for (uint32_t k = 0; k < QUIC_CID_TABLE_GROUP_SLOTS; k++) {
+                        if (!(Group->Tags[k] & QUIC_CID_TABLE_TAG_EMPTY)) {
+                            QUIC_CID_HASH_ENTRY *CID = Group->Entries[k];
+                            if (!QuicLookupInsertLocalCid(
+                                    Lookup,
+                                    CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
+                                    CID,
+                                    FALSE)) {
+                                Moved = FALSE;
+                                break;
+                            }
+                        }
                     }
-                    CxPlatHashtableRemove(&PreviousTable[i].Table, Entry, NULL);
-
-                    QUIC_CID_HASH_ENTRY *CID =
-                        CXPLAT_CONTAINING_RECORD(
-                            Entry,
-                            QUIC_CID_HASH_ENTRY,
-                            Entry);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
                 }
-#pragma warning(push)
-#pragma warning(disable:6001)
-                CxPlatHashtableUninitialize(&PreviousTable[i].Table);
-#pragma warning(pop)
             }
-            CXPLAT_FREE(PreviousTable, QUIC_POOL_LOOKUP_HASHTABLE);
+        }
+
+        if (!Moved) {
+            QuicLookupDestroyHashTable(Lookup->HASH.Tables, Lookup->PartitionCount);
+            Lookup->LookupTable = PreviousLookup;
+            Lookup->PartitionCount = PreviousPartitionCount;
+            return FALSE;
+        }
+
+        if (PreviousPartitionCount != 0) {
+            QuicLookupDestroyHashTable(PreviousLookup, PreviousPartitionCount);
         }
     }
 
@@ -298,39 +559,6 @@ QuicCidMatchConnection(
     return FALSE;
 }
 
-//
-// Uses the hash and destination connection ID to look up the connection in the
-// hash table. Returns the pointer to the connection if found; NULL otherwise.
-//
-_IRQL_requires_max_(DISPATCH_LEVEL)
-QUIC_CONNECTION*
-QuicHashLookupConnection(
-    _In_ CXPLAT_HASHTABLE* Table,
-    _In_reads_(Length)
-        const uint8_t* const DestCid,
-    _In_ uint8_t Length,
-    _In_ uint32_t Hash
-    )
-{
-    CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
-    CXPLAT_HASHTABLE_ENTRY* TableEntry =
-        CxPlatHashtableLookup(Table, Hash, &Context);
-
-    while (TableEntry != NULL) {
-        QUIC_CID_HASH_ENTRY* CIDEntry =
-            CXPLAT_CONTAINING_RECORD(TableEntry, QUIC_CID_HASH_ENTRY, Entry);
-
-        if (CIDEntry->CID.Length == Length &&
-            memcmp(DestCid, CIDEntry->CID.Data, Length) == 0) {
-            return CIDEntry->Connection;
-        }
-
-        TableEntry = CxPlatHashtableLookupNext(Table, &Context);
-    }
-
-    return NULL;
-}
-
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicLookupFindConnectionByLocalCidInternal(
@@ -370,12 +598,10 @@ QuicLookupFindConnectionByLocalCidInternal(
         QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
 
         CxPlatDispatchRwLockAcquireShared(&Table->RwLock, PrevIrql);
-        Connection =
-            QuicHashLookupConnection(
-                &Table->Table,
-                CID,
-                CIDLen,
-                Hash);
+        QUIC_CID_HASH_ENTRY* Entry = QuicCidTableLookup(&Table->Table, CID, CIDLen, Hash);
+        if (Entry != NULL) {
+            Connection = Entry->Connection;
+        }
         CxPlatDispatchRwLockReleaseShared(&Table->RwLock, PrevIrql);
     }
 
@@ -488,12 +714,11 @@ QuicLookupInsertLocalCid(
         QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
 
         CxPlatDispatchRwLockAcquireExclusive(&Table->RwLock, PrevIrql);
-        CxPlatHashtableInsert(
-            &Table->Table,
-            &SourceCid->Entry,
-            Hash,
-            NULL);
+        BOOLEAN Inserted = QuicCidTableInsert(&Table->Table, SourceCid, Hash);
         CxPlatDispatchRwLockReleaseExclusive(&Table->RwLock, PrevIrql);
+        if (!Inserted) {
+            return FALSE;
+        }
     }
 
     if (UpdateRefCount) {
@@ -618,7 +843,10 @@ QuicLookupRemoveLocalCidInt(
         PartitionIndex %= Lookup->PartitionCount;
         QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
         CxPlatDispatchRwLockAcquireExclusive(&Table->RwLock, PrevIrql);
-        CxPlatHashtableRemove(&Table->Table, &SourceCid->Entry, NULL);
+        QuicCidTableRemove(
+            &Table->Table,
+            SourceCid,
+            CxPlatHashSimple(SourceCid->CID.Length, SourceCid->CID.Data));
         CxPlatDispatchRwLockReleaseExclusive(&Table->RwLock, PrevIrql);
     }
 }
@@ -5,6 +5,109 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//
+// The local CID table is an open addressing hash table made up of groups of
+// slots that each fit in a single cache line. Each slot has a tag byte, which
+// holds 7 bits of the CID's hash when the slot is in use, and a pointer to the
+// CID entry. All the tags of a group are compared at once, as a 64-bit word,
+// so a lookup normally only touches one group and the matching CID entry.
+//
+// Groups are probed quadratically from the one picked by the hash until a
+// group with an empty slot is found. Removed slots are marked deleted instead
+// of empty if their group is full, so they don't cut a probe sequence short.
+//
+#define QUIC_CID_TABLE_GROUP_SLOTS      7
+#define QUIC_CID_TABLE_GROUP_ALIGNMENT  64
+#define QUIC_CID_TABLE_MIN_GROUPS       2   // Must be a power of 2
+
+#define QUIC_CID_TABLE_TAG_EMPTY        0x80
+#define QUIC_CID_TABLE_TAG_DELETED      0xFE
+
+typedef struct QUIC_CID_TABLE_GROUP {
+
+    //
+    // The last tag is padding and never used.
+    //
+    uint8_t Tags[QUIC_CID_TABLE_GROUP_SLOTS + 1];
+    QUIC_CID_HASH_ENTRY* Entries[QUIC_CID_TABLE_GROUP_SLOTS];
+
+} QUIC_CID_TABLE_GROUP;
+
+CXPLAT_STATIC_ASSERT(
+    sizeof(QUIC_CID_TABLE_GROUP) <= QUIC_CID_TABLE_GROUP_ALIGNMENT,
+    "A group must fit in a cache line");
+
+typedef struct QUIC_CID_TABLE {
+
+    void* Allocation;
+    _Field_size_(GroupMask + 1)
+    QUIC_CID_TABLE_GROUP* Groups;
+    uint32_t GroupMask;
+    uint32_t EntryCount;
+    uint32_t DeletedCount;
+
+} QUIC_CID_TABLE;
+
+
+//
+// Initializes an empty CID table with the given number of groups, which must
+// be a power of 2.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicCidTableInitialize(
+    _Out_ QUIC_CID_TABLE* Table,
+    _In_ uint32_t GroupCount
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableUninitialize(
+    _In_ QUIC_CID_TABLE* Table
+    );
+
+//
+// Returns the entry for the given CID, or NULL. Hash must be the
+// CxPlatHashSimple hash of the CID.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CID_HASH_ENTRY*
+QuicCidTableLookup(
+    _In_ const QUIC_CID_TABLE* Table,
+    _In_reads_(Length)
+        const uint8_t* const Cid,
+    _In_ uint8_t Length,
+    _In_ uint32_t Hash
+    );
+
+//
+// Inserts the entry, growing or rehashing the table first if needed. Returns
+// FALSE if that ran out of memory and no slot was left.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicCidTableInsert(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ QUIC_CID_HASH_ENTRY* Entry,
+    _In_ uint32_t Hash
+    );
+
+//
+// Removes the entry, which must be in the table, shrinking the table once it
+// is mostly empty.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableRemove(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ const QUIC_CID_HASH_ENTRY* Entry,
+    _In_ uint32_t Hash
+    );
+
 typedef struct QUIC_PARTITIONED_HASHTABLE QUIC_PARTITIONED_HASHTABLE;
 
 typedef struct QUIC_REMOTE_HASH_ENTRY {
@@ -200,3 +303,7 @@ QuicLookupMoveLocalConnectionIDs(
     _In_ QUIC_LOOKUP* LookupDest,
     _In_ QUIC_CONNECTION* Connection
     );
+
+#if defined(__cplusplus)
+}
+#endif
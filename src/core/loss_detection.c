@@ -87,6 +87,124 @@ QuicLossDetectionInitializeInternalState(
     LossDetection->ProbeCount = 0;
 }
 
+//
+// Returns the outstanding packet with the given number, or NULL if there isn't
+// one.
+//
+QUIC_INLINE
+QUIC_SENT_PACKET_METADATA*
+QuicLossDetectionGetSentPacket(
+    _In_ const QUIC_LOSS_DETECTION* LossDetection,
+    _In_ uint64_t PacketNumber
+    )
+{
+    const uint64_t Offset = PacketNumber - LossDetection->SentPacketsBase;
+    if (Offset >= LossDetection->SentPacketsSpan) {
+        return NULL;
+    }
+    return
+        LossDetection->SentPackets[
+            (LossDetection->SentPacketsStart + (uint32_t)Offset) &
+            (LossDetection->SentPacketsSize - 1)];
+}
+
+//
+// Removes an outstanding packet from the ring. If it was the first (or last)
+// one, the span shrinks past any following (or preceding) empty slots.
+//
+QUIC_INLINE
+void
+QuicLossDetectionRemoveSentPacket(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ uint64_t PacketNumber
+    )
+{
+    const uint32_t Mask = LossDetection->SentPacketsSize - 1;
+    const uint32_t Offset = (uint32_t)(PacketNumber - LossDetection->SentPacketsBase);
+    CXPLAT_DBG_ASSERT(PacketNumber - LossDetection->SentPacketsBase < LossDetection->SentPacketsSpan);
+    CXPLAT_DBG_ASSERT(LossDetection->SentPackets[(LossDetection->SentPacketsStart + Offset) & Mask] != NULL);
+    LossDetection->SentPackets[(LossDetection->SentPacketsStart + Offset) & Mask] = NULL;
+
+    if (Offset == 0) {
+        do {
+            LossDetection->SentPacketsStart = (LossDetection->SentPacketsStart + 1) & Mask;
+            LossDetection->SentPacketsBase++;
+            LossDetection->SentPacketsSpan--;
+        } while (LossDetection->SentPacketsSpan != 0 &&
+                 LossDetection->SentPackets[LossDetection->SentPacketsStart] == NULL);
+
+    } else if (Offset == LossDetection->SentPacketsSpan - 1) {
+        do {
+            LossDetection->SentPacketsSpan--;
+        } while (LossDetection->SentPackets[
+                    (LossDetection->SentPacketsStart + LossDetection->SentPacketsSpan - 1) & Mask] == NULL);
+    }
+}
+
+//
+// Makes sure the ring has a slot for the given packet number, which must be
+// larger than any outstanding one. Returns FALSE if the ring needed to grow
+// and the allocation failed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicLossDetectionReserveSentPacket(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ uint64_t PacketNumber
+    )
+{
+    if (LossDetection->SentPacketsSpan == 0) {
+        LossDetection->SentPacketsBase = PacketNumber;
+        if (LossDetection->SentPacketsSize != 0) {
+            return TRUE;
+        }
+    } else {
+        CXPLAT_DBG_ASSERT(
+            PacketNumber - LossDetection->SentPacketsBase >= LossDetection->SentPacketsSpan);
+        if (PacketNumber - LossDetection->SentPacketsBase < LossDetection->SentPacketsSize) {
+            return TRUE;
+        }
+    }
+
+    uint64_t NewSize =
+        LossDetection->SentPacketsSize == 0 ?
+            QUIC_SENT_PACKET_RING_INITIAL_SIZE : LossDetection->SentPacketsSize;
+    while (NewSize <= PacketNumber - LossDetection->SentPacketsBase) {
+        NewSize <<= 1;
+    }
+    if (NewSize > 0x80000000ull) {
+        return FALSE;
+    }
+
+    QUIC_SENT_PACKET_METADATA** NewSentPackets =
+        CXPLAT_ALLOC_NONPAGED(
+            (size_t)NewSize * sizeof(QUIC_SENT_PACKET_METADATA*),
+            QUIC_POOL_SENT_PACKET_RING);
+    if (NewSentPackets == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Sent packet ring",
+            NewSize * sizeof(QUIC_SENT_PACKET_METADATA*));
+        return FALSE;
+    }
+    CxPlatZeroMemory(NewSentPackets, (size_t)NewSize * sizeof(QUIC_SENT_PACKET_METADATA*));
+
+    for (uint32_t i = 0; i < LossDetection->SentPacketsSpan; ++i) {
+        NewSentPackets[i] =
+            LossDetection->SentPackets[
+                (LossDetection->SentPacketsStart + i) & (LossDetection->SentPacketsSize - 1)];
+    }
+    if (LossDetection->SentPackets != NULL) {
+        CXPLAT_FREE(LossDetection->SentPackets, QUIC_POOL_SENT_PACKET_RING);
+    }
+    LossDetection->SentPackets = NewSentPackets;
+    LossDetection->SentPacketsSize = (uint32_t)NewSize;
+    LossDetection->SentPacketsStart = 0;
+
+    return TRUE;
+}
+
 #if DEBUG
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
@@ -95,18 +213,23 @@ QuicLossValidate(
     )
 {
     uint32_t AckElicitingPackets = 0;
-    QUIC_SENT_PACKET_METADATA** Tail = &LossDetection->SentPackets;
-    while (*Tail) {
-        CXPLAT_DBG_ASSERT(!(*Tail)->Flags.Freed);
-        if ((*Tail)->Flags.IsAckEliciting) {
-            AckElicitingPackets++;
+    for (uint32_t i = 0; i < LossDetection->SentPacketsSpan; ++i) {
+        const QUIC_SENT_PACKET_METADATA* Packet =
+            LossDetection->SentPackets[
+                (LossDetection->SentPacketsStart + i) & (LossDetection->SentPacketsSize - 1)];
+        if (Packet == NULL) {
+            CXPLAT_DBG_ASSERT(i != 0 && i != LossDetection->SentPacketsSpan - 1);
+        } else {
+            CXPLAT_DBG_ASSERT(!Packet->Flags.Freed);
+            CXPLAT_DBG_ASSERT(Packet->PacketNumber == LossDetection->SentPacketsBase + i);
+            if (Packet->Flags.IsAckEliciting) {
+                AckElicitingPackets++;
+            }
         }
-        Tail = &((*Tail)->Next);
     }
-    CXPLAT_DBG_ASSERT(Tail == LossDetection->SentPacketsTail);
     CXPLAT_DBG_ASSERT(LossDetection->PacketsInFlight == AckElicitingPackets);
 
-    Tail = &LossDetection->LostPackets;
+    QUIC_SENT_PACKET_METADATA** Tail = &LossDetection->LostPackets;
     while (*Tail) {
         CXPLAT_DBG_ASSERT(!(*Tail)->Flags.Freed);
         Tail = &((*Tail)->Next);
@@ -124,7 +247,10 @@ QuicLossDetectionInitialize(
     )
 {
     LossDetection->SentPackets = NULL;
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
+    LossDetection->SentPacketsBase = 0;
+    LossDetection->SentPacketsSize = 0;
+    LossDetection->SentPacketsStart = 0;
+    LossDetection->SentPacketsSpan = 0;
     LossDetection->LostPackets = NULL;
     LossDetection->LostPacketsTail = &LossDetection->LostPackets;
     QuicLossDetectionInitializeInternalState(LossDetection);
@@ -138,9 +264,14 @@ QuicLossDetectionUninitialize(
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet == NULL) {
+            continue;
+        }
+        QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
 
         if (Packet->Flags.IsAckEliciting) {
             QuicTraceLogVerbose(
@@ -153,6 +284,12 @@ QuicLossDetectionUninitialize(
 
         QuicLossDetectionOnPacketDiscarded(LossDetection, Packet, FALSE);
     }
+    if (LossDetection->SentPackets != NULL) {
+        CXPLAT_FREE(LossDetection->SentPackets, QUIC_POOL_SENT_PACKET_RING);
+        LossDetection->SentPackets = NULL;
+        LossDetection->SentPacketsSize = 0;
+        LossDetection->SentPacketsStart = 0;
+    }
     while (LossDetection->LostPackets != NULL) {
         QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
         LossDetection->LostPackets = LossDetection->LostPackets->Next;
@@ -186,12 +323,15 @@ QuicLossDetectionReset(
     // Throw away any outstanding packets.
     //
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
-        QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet != NULL) {
+            QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
+            QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
+        }
     }
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
 
     while (LossDetection->LostPackets != NULL) {
         QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
@@ -214,11 +354,15 @@ QuicLossDetectionOldestOutstandingPacket(
     _In_ QUIC_LOSS_DETECTION* LossDetection
     )
 {
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-    while (Packet != NULL && !Packet->Flags.IsAckEliciting) {
-        Packet = Packet->Next;
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet != NULL && Packet->Flags.IsAckEliciting) {
+            return Packet;
+        }
     }
-    return Packet;
+    return NULL;
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -392,22 +536,27 @@ QuicLossDetectionOnPacketSent(
     CXPLAT_DBG_ASSERT(TempSentPacket->FrameCount != 0);
 
     //
-    // Allocate a copy of the packet metadata.
+    // Allocate a copy of the packet metadata and a slot for it in the ring.
     //
-    QUIC_SENT_PACKET_METADATA* SentPacket =
-        QuicSentPacketPoolGetPacketMetadata(
-            &Connection->Partition->SentPacketPool,
-            TempSentPacket->FrameCount);
+    QUIC_SENT_PACKET_METADATA* SentPacket = NULL;
+    if (QuicLossDetectionReserveSentPacket(LossDetection, TempSentPacket->PacketNumber)) {
+        SentPacket =
+            QuicSentPacketPoolGetPacketMetadata(
+                &Connection->Partition->SentPacketPool,
+                TempSentPacket->FrameCount);
+        if (SentPacket == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "Sent packet metadata",
+                SIZEOF_QUIC_SENT_PACKET_METADATA(TempSentPacket->FrameCount));
+        }
+    }
     if (SentPacket == NULL) {
         //
         // We can't allocate the memory to permanently track this packet so just
         // go ahead and immediately clean up and mark the data in it as lost.
         //
-        QuicTraceEvent(
-            AllocFailure,
-            "Allocation of '%s' failed. (%llu bytes)",
-            "Sent packet metadata",
-            SIZEOF_QUIC_SENT_PACKET_METADATA(TempSentPacket->FrameCount));
         QuicLossDetectionRetransmitFrames(LossDetection, TempSentPacket, FALSE);
         QuicSentPacketMetadataReleaseFrames(TempSentPacket, Connection);
         return;
@@ -422,11 +571,15 @@ QuicLossDetectionOnPacketSent(
     LossDetection->LargestSentPacketNumber = TempSentPacket->PacketNumber;
 
     //
-    // Add to the outstanding-packet queue.
+    // Add to the outstanding-packet ring.
     //
+    const uint32_t Offset =
+        (uint32_t)(SentPacket->PacketNumber - LossDetection->SentPacketsBase);
     SentPacket->Next = NULL;
-    *LossDetection->SentPacketsTail = SentPacket;
-    LossDetection->SentPacketsTail = &SentPacket->Next;
+    LossDetection->SentPackets[
+        (LossDetection->SentPacketsStart + Offset) &
+        (LossDetection->SentPacketsSize - 1)] = SentPacket;
+    LossDetection->SentPacketsSpan = Offset + 1;
 
     CXPLAT_DBG_ASSERT(
         SentPacket->Flags.KeyType != QUIC_PACKET_KEY_0_RTT ||
@@ -959,7 +1112,7 @@ QuicLossDetectionDetectAndHandleLostPackets(
         QuicLossValidate(LossDetection);
     }
 
-    if (LossDetection->SentPackets != NULL) {
+    if (LossDetection->SentPacketsSpan != 0) {
         //
         // Remove "suspect" packets inferred lost from out-of-order ACKs.
         // The spec has:
@@ -972,9 +1125,20 @@ QuicLossDetectionDetectAndHandleLostPackets(
         uint64_t Rtt = CXPLAT_MAX(Path->SmoothedRtt, Path->LatestRttSample);
         uint64_t TimeReorderThreshold = QUIC_TIME_REORDER_THRESHOLD(Rtt);
         uint64_t LargestLostPacketNumber = 0;
-        QUIC_SENT_PACKET_METADATA* PrevPacket = NULL;
-        Packet = LossDetection->SentPackets;
-        while (Packet != NULL) {
+
+        //
+        // Only packets sent before the largest acknowledged one can be lost.
+        //
+        const uint64_t End =
+            CXPLAT_MIN(
+                LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan,
+                LossDetection->LargestAck);
+        for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+
+            Packet = QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+            if (Packet == NULL) {
+                continue;
+            }
 
             BOOLEAN NonretransmittableHandshakePacket =
                 !Packet->Flags.IsAckEliciting &&
@@ -983,8 +1147,6 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType);
 
             if (EncryptLevel > LossDetection->LargestAckEncryptLevel) {
-                PrevPacket = Packet;
-                Packet = Packet->Next;
                 continue;
             }
 
@@ -1035,22 +1197,11 @@ QuicLossDetectionDetectAndHandleLostPackets(
             }
 
             LargestLostPacketNumber = Packet->PacketNumber;
-            if (PrevPacket == NULL) {
-                LossDetection->SentPackets = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            } else {
-                PrevPacket->Next = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            }
+            QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
 
+            Packet->Next = NULL;
             *LossDetection->LostPacketsTail = Packet;
             LossDetection->LostPacketsTail = &Packet->Next;
-            Packet = Packet->Next;
-            *LossDetection->LostPacketsTail = NULL;
         }
 
         QuicLossValidate(LossDetection);
@@ -1149,51 +1300,35 @@ QuicLossDetectionDiscardPackets(
 
     QuicLossValidate(LossDetection);
 
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
-
-        if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
-
-            QuicTraceLogVerbose(
-                PacketTxAckedImplicit,
-                "[%c][TX][%llu] ACKed (implicit)",
-                PtkConnPre(Connection),
-                Packet->PacketNumber);
-            QuicTraceEvent(
-                ConnPacketACKed,
-                "[conn][%p][TX][%llu] %hhu ACKed",
-                Connection,
-                Packet->PacketNumber,
-                QuicPacketTraceType(Packet));
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        Packet = QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet == NULL || Packet->Flags.KeyType != KeyType) {
+            continue;
+        }
 
-            if (Packet->Flags.IsAckEliciting) {
-                LossDetection->PacketsInFlight--;
-                AckedRetransmittableBytes += Packet->PacketLength;
-            }
+        QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
 
-            QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet, TRUE, TimeNow, 0);
+        QuicTraceLogVerbose(
+            PacketTxAckedImplicit,
+            "[%c][TX][%llu] ACKed (implicit)",
+            PtkConnPre(Connection),
+            Packet->PacketNumber);
+        QuicTraceEvent(
+            ConnPacketACKed,
+            "[conn][%p][TX][%llu] %hhu ACKed",
+            Connection,
+            Packet->PacketNumber,
+            QuicPacketTraceType(Packet));
 
-            QuicSentPacketPoolReturnPacketMetadata(Packet, Connection);
+        if (Packet->Flags.IsAckEliciting) {
+            LossDetection->PacketsInFlight--;
+            AckedRetransmittableBytes += Packet->PacketLength;
+        }
 
-            Packet = NextPacket;
+        QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet, TRUE, TimeNow, 0);
 
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
-        }
+        QuicSentPacketPoolReturnPacketMetadata(Packet, Connection);
     }
 
     QuicLossValidate(LossDetection);
@@ -1234,51 +1369,34 @@ QuicLossDetectionOnZeroRttRejected(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
-    QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t CountRetransmittableBytes = 0;
 
     //
     // Marks all the packets as lost so they can be retransmitted immediately.
     //
 
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
-
-        if (Packet->Flags.KeyType == QUIC_PACKET_KEY_0_RTT) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
-
-            QuicTraceLogVerbose(
-                PacketTx0RttRejected,
-                "[%c][TX][%llu] Rejected",
-                PtkConnPre(Connection),
-                Packet->PacketNumber);
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet == NULL || Packet->Flags.KeyType != QUIC_PACKET_KEY_0_RTT) {
+            continue;
+        }
 
-            CXPLAT_DBG_ASSERT(Packet->Flags.IsAckEliciting);
+        QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
 
-            LossDetection->PacketsInFlight--;
-            CountRetransmittableBytes += Packet->PacketLength;
+        QuicTraceLogVerbose(
+            PacketTx0RttRejected,
+            "[%c][TX][%llu] Rejected",
+            PtkConnPre(Connection),
+            Packet->PacketNumber);
 
-            QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
+        CXPLAT_DBG_ASSERT(Packet->Flags.IsAckEliciting);
 
-            Packet = NextPacket;
+        LossDetection->PacketsInFlight--;
+        CountRetransmittableBytes += Packet->PacketLength;
 
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
-        }
+        QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
     }
 
     QuicLossValidate(LossDetection);
@@ -1323,7 +1441,6 @@ QuicLossDetectionProcessAckBlocks(
     *InvalidAckBlock = FALSE;
 
     QUIC_SENT_PACKET_METADATA** LostPacketsStart = &LossDetection->LostPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsStart = &LossDetection->SentPackets;
     QUIC_SENT_PACKET_METADATA* LargestAckedPacket = NULL;
 
     uint32_t i = 0;
@@ -1409,38 +1526,34 @@ QuicLossDetectionProcessAckBlocks(
 
 CheckSentPackets:
         //
-        // Now find all the acknowledged packets in the SentPackets list.
+        // Now remove all the acknowledged packets from the outstanding packet
+        // ring, looking up just the packet numbers covered by the ACK block.
         //
-        if (*SentPacketsStart != NULL) {
-            while (*SentPacketsStart && (*SentPacketsStart)->PacketNumber < AckBlock->Low) {
-                SentPacketsStart = &((*SentPacketsStart)->Next);
-            }
-
-            QUIC_SENT_PACKET_METADATA** End = SentPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
+        if (LossDetection->SentPacketsSpan != 0) {
+            const uint64_t End =
+                CXPLAT_MIN(
+                    QuicRangeGetHigh(AckBlock) + 1,
+                    LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan);
+            uint64_t PacketNumber = CXPLAT_MAX(AckBlock->Low, LossDetection->SentPacketsBase);
+            for (; PacketNumber < End; ++PacketNumber) {
+                QUIC_SENT_PACKET_METADATA* SentPacket =
+                    QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+                if (SentPacket == NULL) {
+                    continue;
+                }
 
-                if ((*End)->Flags.IsAckEliciting) {
+                QuicLossDetectionRemoveSentPacket(LossDetection, PacketNumber);
+                if (SentPacket->Flags.IsAckEliciting) {
                     LossDetection->PacketsInFlight--;
-                    AckedRetransmittableBytes += (*End)->PacketLength;
+                    AckedRetransmittableBytes += SentPacket->PacketLength;
                 }
-                LargestAckedPacket = *End;
-                End = &((*End)->Next);
+                LargestAckedPacket = SentPacket;
+                *AckedPacketsTail = SentPacket;
+                AckedPacketsTail = &SentPacket->Next;
             }
+            *AckedPacketsTail = NULL;
 
-            if (SentPacketsStart != End) {
-                //
-                // Remove the ACKed packets from the outstanding packet list.
-                //
-                *AckedPacketsTail = *SentPacketsStart;
-                AckedPacketsTail = End;
-                *SentPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->SentPacketsTail) {
-                    LossDetection->SentPacketsTail = SentPacketsStart;
-                }
-
-                QuicLossValidate(LossDetection);
-            }
+            QuicLossValidate(LossDetection);
         }
 
         if (LargestAckedPacket != NULL &&
@@ -1784,9 +1897,11 @@ QuicLossDetectionScheduleProbe(
     // Not enough new stream data exists to fill the probing packets. Schedule
     // retransmits if possible.
     //
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
-        if (Packet->Flags.IsAckEliciting) {
+    const uint64_t End = LossDetection->SentPacketsBase + LossDetection->SentPacketsSpan;
+    for (uint64_t PacketNumber = LossDetection->SentPacketsBase; PacketNumber < End; ++PacketNumber) {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            QuicLossDetectionGetSentPacket(LossDetection, PacketNumber);
+        if (Packet != NULL && Packet->Flags.IsAckEliciting) {
             QuicTraceLogVerbose(
                 PacketTxProbeRetransmit,
                 "[%c][TX][%llu] Probe Retransmit",
@@ -1804,7 +1919,6 @@ QuicLossDetectionScheduleProbe(
                 return;
             }
         }
-        Packet = Packet->Next;
     }
 
     //
@@ -1854,7 +1968,7 @@ QuicLossDetectionProcessTimerOperation(
         CxPlatTimeDiff64(OldestPacket->SentTime, TimeNow) >=
             MS_TO_US((uint64_t)Connection->Settings.DisconnectTimeoutMs)) {
         //
-        // OldestPacket has been in the SentPackets list for at least
+        // OldestPacket has been outstanding for at least
         // DisconnectTimeoutUs without an ACK for either OldestPacket or for any
         // packets sent more than the reordering threshold after it. Assume the
         // path is dead and close the connection.
@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_LOSS_DETECTION {
 
     //
@@ -58,20 +62,28 @@ typedef struct QUIC_LOSS_DETECTION {
     uint64_t TotalBytesSentAtLastAck;
 
     //
-    // N.B.: SentPackets and LostPackets are generally kept in ascending packet
-    // number order, and packets in the LostPackets list generally have smaller
-    // numbers than those in the SentPackets list. The only case this is not
-    // true is during the handshake. Since multiple encryption levels are used
-    // in parallel, higher numbered packets in lower encryption levels can be
-    // "lost" sooner than the higher encryption levels.
+    // N.B.: LostPackets is generally kept in ascending packet number order, and
+    // its packets generally have smaller numbers than the outstanding ones.
+    // The only case this is not true is during the handshake. Since multiple
+    // encryption levels are used in parallel, higher numbered packets in lower
+    // encryption levels can be "lost" sooner than the higher encryption levels.
     //
 
     //
-    // Outstanding packets.
+    // Outstanding packets, in a ring indexed by packet number so that ACK
+    // blocks and loss detection can go straight to the packets they cover.
+    // Slot SentPacketsStart holds the oldest outstanding packet, numbered
+    // SentPacketsBase, and the following SentPacketsSpan - 1 slots hold the
+    // next packet numbers. Slots for packet numbers that are no longer (or
+    // never were) outstanding, as well as all slots outside the span, are NULL.
+    // SentPacketsSize is always a power of two.
     //
     uint64_t LargestSentPacketNumber;
-    QUIC_SENT_PACKET_METADATA* SentPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsTail;
+    uint64_t SentPacketsBase;
+    QUIC_SENT_PACKET_METADATA** SentPackets;
+    uint32_t SentPacketsSize;
+    uint32_t SentPacketsStart;
+    uint32_t SentPacketsSpan;
 
     //
     // Lost packets. The purpose of this list is to remember packets a little
@@ -187,3 +199,7 @@ void
 QuicLossDetectionProcessTimerOperation(
     _In_ QUIC_LOSS_DETECTION* LossDetection
     );
+
+#if defined(__cplusplus)
+}
+#endif
@@ -20,6 +20,11 @@ Abstract:
     is the only thread that touches the connection itself, which simplifies
     synchronization.
 
+    The queue is lock-free. Each lane is an intrusive stack that producers
+    push onto with a compare-exchange. The worker takes a whole lane stack at
+    once and reverses it to get the operations back in queuing order, except
+    for the front lane, which is meant to be drained most recent first.
+
 --*/
 
 #include "precomp.h"
@@ -33,10 +38,7 @@ QuicOperationQueueInitialize(
     _Inout_ QUIC_OPERATION_QUEUE* OperQ
     )
 {
-    OperQ->ActivelyProcessing = FALSE;
-    CxPlatDispatchLockInitialize(&OperQ->Lock);
-    CxPlatListInitializeHead(&OperQ->List);
-    OperQ->PriorityTail = &OperQ->List.Flink;
+    CxPlatZeroMemory(OperQ, sizeof(*OperQ));
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -46,9 +48,12 @@ QuicOperationQueueUninitialize(
     )
 {
     UNREFERENCED_PARAMETER(OperQ);
-    CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&OperQ->List));
-    CXPLAT_DBG_ASSERT(OperQ->PriorityTail == &OperQ->List.Flink);
-    CxPlatDispatchLockUninitialize(&OperQ->Lock);
+#if DEBUG
+    for (uint32_t i = 0; i < QUIC_OPERATION_LANE_COUNT; ++i) {
+        CXPLAT_DBG_ASSERT(OperQ->Pushed[i] == NULL);
+        CXPLAT_DBG_ASSERT(OperQ->Taken[i] == NULL);
+    }
+#endif
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -141,25 +146,112 @@ QuicOperationFree(
     CxPlatPoolFree(Oper);
 }
 
+//
+// Pushes the operation onto a lane and returns TRUE if the caller needs to
+// schedule the connection for processing.
+//
+static
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
-QuicOperationEnqueue(
+QuicOperationPush(
     _In_ QUIC_OPERATION_QUEUE* OperQ,
     _In_ QUIC_PARTITION* Partition,
-    _In_ QUIC_OPERATION* Oper
+    _In_ QUIC_OPERATION* Oper,
+    _In_ QUIC_OPERATION_LANE Lane
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
 #if DEBUG
     CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
 #endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertTail(&OperQ->List, &Oper->Link);
-    CxPlatDispatchLockRelease(&OperQ->Lock);
+    CXPLAT_SLIST_ENTRY* Head =
+        (CXPLAT_SLIST_ENTRY*)QuicReadPtrNoFence((void**)&OperQ->Pushed[Lane]);
+    for (;;) {
+        Oper->QueueLink.Next = Head;
+        CXPLAT_SLIST_ENTRY* Observed =
+            (CXPLAT_SLIST_ENTRY*)InterlockedCompareExchangePointer(
+                (void* volatile*)&OperQ->Pushed[Lane], &Oper->QueueLink, Head);
+        if (Observed == Head) {
+            break;
+        }
+        Head = Observed;
+    }
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+
+    //
+    // The push is a full barrier, so the flag is tested after the operation
+    // is visible: a dequeue concurrently giving up on the queue either sees
+    // the operation or has already cleared the flag for this call to set.
+    //
+    if (OperQ->Scheduled) {
+        return FALSE;
+    }
+    return !InterlockedFetchAndSetBoolean(&OperQ->Scheduled);
+}
+
+//
+// Removes the next operation from the lanes, in drain order. Only called by
+// the single consumer.
+//
+static
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_OPERATION*
+QuicOperationTake(
+    _In_ QUIC_OPERATION_QUEUE* OperQ
+    )
+{
+    //
+    // Front lane operations are popped straight off the stack. Producers only
+    // ever push, so with a single consumer the head can't be removed and
+    // reused underneath the compare-exchange (no ABA).
+    //
+    CXPLAT_SLIST_ENTRY* Head =
+        (CXPLAT_SLIST_ENTRY*)QuicReadPtrNoFence((void**)&OperQ->Pushed[QUIC_OPERATION_LANE_FRONT]);
+    while (Head != NULL) {
+        CXPLAT_SLIST_ENTRY* Observed =
+            (CXPLAT_SLIST_ENTRY*)InterlockedCompareExchangePointer(
+                (void* volatile*)&OperQ->Pushed[QUIC_OPERATION_LANE_FRONT], Head->Next, Head);
+        if (Observed == Head) {
+            return CXPLAT_CONTAINING_RECORD(Head, QUIC_OPERATION, QueueLink);
+        }
+        Head = Observed;
+    }
+
+    for (uint32_t Lane = QUIC_OPERATION_LANE_PRIORITY; Lane < QUIC_OPERATION_LANE_COUNT; ++Lane) {
+        if (OperQ->Taken[Lane] == NULL &&
+            QuicReadPtrNoFence((void**)&OperQ->Pushed[Lane]) != NULL) {
+            //
+            // Take everything pushed so far and reverse it into queuing order.
+            //
+            CXPLAT_SLIST_ENTRY* Entry =
+                (CXPLAT_SLIST_ENTRY*)InterlockedFetchAndClearPointer(
+                    (void* volatile*)&OperQ->Pushed[Lane]);
+            while (Entry != NULL) {
+                CXPLAT_SLIST_ENTRY* Next = Entry->Next;
+                Entry->Next = OperQ->Taken[Lane];
+                OperQ->Taken[Lane] = Entry;
+                Entry = Next;
+            }
+        }
+        CXPLAT_SLIST_ENTRY* Entry = OperQ->Taken[Lane];
+        if (Entry != NULL) {
+            OperQ->Taken[Lane] = Entry->Next;
+            return CXPLAT_CONTAINING_RECORD(Entry, QUIC_OPERATION, QueueLink);
+        }
+    }
+
+    return NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicOperationEnqueue(
+    _In_ QUIC_OPERATION_QUEUE* OperQ,
+    _In_ QUIC_PARTITION* Partition,
+    _In_ QUIC_OPERATION* Oper
+    )
+{
+    return QuicOperationPush(OperQ, Partition, Oper, QUIC_OPERATION_LANE_NORMAL);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -170,18 +262,7 @@ QuicOperationEnqueuePriority(
     _In_ QUIC_OPERATION* Oper
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-#if DEBUG
-    CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
-#endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertTail(*OperQ->PriorityTail, &Oper->Link);
-    OperQ->PriorityTail = &Oper->Link.Flink;
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+    return QuicOperationPush(OperQ, Partition, Oper, QUIC_OPERATION_LANE_PRIORITY);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -192,20 +273,7 @@ QuicOperationEnqueueFront(
     _In_ QUIC_OPERATION* Oper
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-#if DEBUG
-    CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
-#endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertHead(&OperQ->List, &Oper->Link);
-    if (OperQ->PriorityTail == &OperQ->List.Flink) {
-        OperQ->PriorityTail = &Oper->Link.Flink;
-    }
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+    return QuicOperationPush(OperQ, Partition, Oper, QUIC_OPERATION_LANE_FRONT);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -215,28 +283,33 @@ QuicOperationDequeue(
     _In_ QUIC_PARTITION* Partition
     )
 {
-    QUIC_OPERATION* Oper;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    if (CxPlatListIsEmpty(&OperQ->List)) {
-        OperQ->ActivelyProcessing = FALSE;
-        Oper = NULL;
-    } else {
-        OperQ->ActivelyProcessing = TRUE;
-        Oper =
-            CXPLAT_CONTAINING_RECORD(
-                CxPlatListRemoveHead(&OperQ->List), QUIC_OPERATION, Link);
-#if DEBUG
-        Oper->Link.Flink = NULL;
-#endif
-        if (OperQ->PriorityTail == &Oper->Link.Flink) {
-            OperQ->PriorityTail = &OperQ->List.Flink;
+    QUIC_OPERATION* Oper = QuicOperationTake(OperQ);
+    if (Oper == NULL) {
+        //
+        // The queue looks empty, so stop processing. Anything pushed before
+        // the flag was cleared has to be picked up here, since its producer
+        // didn't schedule the connection; unless a later producer has already
+        // set the flag again and will schedule it instead.
+        //
+        InterlockedFetchAndClearBoolean(&OperQ->Scheduled);
+        BOOLEAN HasPushed = FALSE;
+        for (uint32_t Lane = 0; Lane < QUIC_OPERATION_LANE_COUNT; ++Lane) {
+            if (QuicReadPtrNoFence((void**)&OperQ->Pushed[Lane]) != NULL) {
+                HasPushed = TRUE;
+                break;
+            }
         }
+        if (!HasPushed || InterlockedFetchAndSetBoolean(&OperQ->Scheduled)) {
+            return NULL;
+        }
+        Oper = QuicOperationTake(OperQ);
+        CXPLAT_DBG_ASSERT(Oper != NULL);
     }
-    CxPlatDispatchLockRelease(&OperQ->Lock);
 
-    if (Oper != NULL) {
-        QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, -1);
-    }
+#if DEBUG
+    Oper->Link.Flink = NULL;
+#endif
+    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, -1);
     return Oper;
 }
 
@@ -247,20 +320,16 @@ QuicOperationQueueClear(
     _In_ QUIC_PARTITION* Partition
     )
 {
-    CXPLAT_LIST_ENTRY OldList;
-    CxPlatListInitializeHead(&OldList);
-
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    OperQ->ActivelyProcessing = FALSE;
-    CxPlatListMoveItems(&OperQ->List, &OldList);
-    OperQ->PriorityTail = &OperQ->List.Flink;
-    CxPlatDispatchLockRelease(&OperQ->Lock);
+    //
+    // Nothing can be queued concurrently anymore, so the operations can just be
+    // taken in drain order.
+    //
+    OperQ->Scheduled = FALSE;
 
     int64_t OperationsDequeued = 0;
 
-    while (!CxPlatListIsEmpty(&OldList)) {
-        QUIC_OPERATION* Oper =
-            CXPLAT_CONTAINING_RECORD(CxPlatListRemoveHead(&OldList), QUIC_OPERATION, Link);
+    QUIC_OPERATION* Oper;
+    while ((Oper = QuicOperationTake(OperQ)) != NULL) {
         --OperationsDequeued;
 #if DEBUG
         Oper->Link.Flink = NULL;
@@ -9,6 +9,10 @@
 #include "operation.h.clog.h"
 #endif
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_SEND_REQUEST QUIC_SEND_REQUEST;
 
 //
@@ -207,7 +211,10 @@ typedef struct QUIC_STATELESS_CONTEXT {
 //
 typedef struct QUIC_OPERATION {
 
-    CXPLAT_LIST_ENTRY Link;
+    union {
+        CXPLAT_LIST_ENTRY Link;
+        CXPLAT_SLIST_ENTRY QueueLink; // Used while in a QUIC_OPERATION_QUEUE.
+    };
     QUIC_OPERATION_TYPE Type;
 
     //
@@ -287,21 +294,43 @@ QuicOperLog(
 }
 
 //
-// A queue of operations to be executed for a connection.
+// The lanes of an operation queue, in the order they are drained.
+//
+typedef enum QUIC_OPERATION_LANE {
+
+    QUIC_OPERATION_LANE_FRONT,      // Most recently queued first.
+    QUIC_OPERATION_LANE_PRIORITY,
+    QUIC_OPERATION_LANE_NORMAL,
+    QUIC_OPERATION_LANE_COUNT
+
+} QUIC_OPERATION_LANE;
+
+//
+// A queue of operations to be executed for a connection. Any thread may queue
+// operations, without taking a lock, but only the worker currently processing
+// the connection may dequeue them.
 //
 typedef struct QUIC_OPERATION_QUEUE {
 
     //
-    // TRUE if the queue is being drained.
+    // TRUE from when an operation is queued while the queue is idle, until a
+    // dequeue finds the queue empty. Only the queuing that sets it needs to
+    // schedule the connection on its worker.
+    //
+    BOOLEAN volatile Scheduled;
+
+    //
+    // Per lane, the operations queued since the worker last took them,
+    // most recent first. Updated with interlocked operations.
     //
-    BOOLEAN ActivelyProcessing;
+    CXPLAT_SLIST_ENTRY* volatile Pushed[QUIC_OPERATION_LANE_COUNT];
 
     //
-    // Queue of pending operations.
+    // Per lane, the operations taken by the worker but not yet dequeued,
+    // oldest first. Only accessed by the worker. The front lane is always
+    // dequeued straight from Pushed.
     //
-    CXPLAT_DISPATCH_LOCK Lock;
-    CXPLAT_LIST_ENTRY List;
-    CXPLAT_LIST_ENTRY** PriorityTail; // Tail of the priority queue.
+    CXPLAT_SLIST_ENTRY* Taken[QUIC_OPERATION_LANE_COUNT];
 
 } QUIC_OPERATION_QUEUE;
 
@@ -343,7 +372,8 @@ QuicOperationFree(
     );
 
 //
-// Returns TRUE if the operation queue has priority operations queued.
+// Returns TRUE if the operation queue has priority operations queued. Only
+// called by the worker processing the connection.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_INLINE
@@ -352,10 +382,10 @@ QuicOperationHasPriority(
     _In_ QUIC_OPERATION_QUEUE* OperQ
     )
 {
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    BOOLEAN HasPriorityWork = (&OperQ->List.Flink != OperQ->PriorityTail);
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    return HasPriorityWork;
+    return
+        OperQ->Taken[QUIC_OPERATION_LANE_PRIORITY] != NULL ||
+        QuicReadPtrNoFence((void**)&OperQ->Pushed[QUIC_OPERATION_LANE_FRONT]) != NULL ||
+        QuicReadPtrNoFence((void**)&OperQ->Pushed[QUIC_OPERATION_LANE_PRIORITY]) != NULL;
 }
 
 //
@@ -406,7 +436,8 @@ QuicOperationDequeue(
     );
 
 //
-// Dequeues and frees all operations.
+// Dequeues and frees all operations. Only called once the connection can no
+// longer have operations queued.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -414,3 +445,7 @@ QuicOperationQueueClear(
     _In_ QUIC_OPERATION_QUEUE* OperQ,
     _In_ QUIC_PARTITION* Partition
     );
+
+#if defined(__cplusplus)
+}
+#endif
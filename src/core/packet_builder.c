@@ -149,6 +149,7 @@ QuicPacketBuilderCleanup(
     )
 {
     CXPLAT_DBG_ASSERT(Builder->SendData == NULL);
+    CXPLAT_DBG_ASSERT(Builder->BatchCount == 0);
 
     if (Builder->PacketBatchSent && Builder->PacketBatchRetransmittable) {
         QuicLossDetectionUpdateTimer(&Builder->Connection->LossDetection, FALSE);
@@ -676,15 +677,59 @@ QuicPacketBuilderPrepareForStreamFrames(
     return QuicPacketBuilderPrepare(Builder, PacketKeyType, IsTailLossProbe, FALSE);
 }
 
+//
+// Encrypts the batched short header packets with a single call and then
+// applies header protection to all of them.
+//
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
-QuicPacketBuilderFinalizeHeaderProtection(
+QuicPacketBuilderFinalizeCryptoBatch(
     _Inout_ QUIC_PACKET_BUILDER* Builder
     )
 {
     CXPLAT_DBG_ASSERT(Builder->Key != NULL);
+    CXPLAT_DBG_ASSERT(Builder->BatchCount != 0);
+
+    uint8_t Iv[CXPLAT_MAX_IV_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    CXPLAT_CRYPT_BATCH_ENTRY Entries[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    for (uint8_t i = 0; i < Builder->BatchCount; ++i) {
+        uint8_t* Header = Builder->HeaderBatch[i];
+        QuicCryptoCombineIvAndPacketNumber(
+            Builder->Key->Iv,
+            (uint8_t*)&Builder->PacketNumberBatch[i],
+            Iv + i * CXPLAT_MAX_IV_LENGTH);
+        Entries[i].Iv = Iv + i * CXPLAT_MAX_IV_LENGTH;
+        Entries[i].AuthData = Header;
+        Entries[i].AuthDataLength = Builder->HeaderLengthBatch[i];
+        Entries[i].Buffer = Header + Builder->HeaderLengthBatch[i];
+        Entries[i].BufferLength = Builder->PayloadLengthBatch[i];
+    }
 
     QUIC_STATUS Status;
+    if (QUIC_FAILED(
+        Status =
+        CxPlatEncryptBatch(
+            Builder->Key->PacketKey,
+            Builder->BatchCount,
+            Entries))) {
+        QuicConnFatalError(Builder->Connection, Status, "Encryption failure");
+        Builder->BatchCount = 0;
+        return;
+    }
+
+    if (!Builder->Connection->State.HeaderProtectionEnabled) {
+        Builder->BatchCount = 0;
+        return;
+    }
+
+    for (uint8_t i = 0; i < Builder->BatchCount; ++i) {
+        const uint8_t* PnStart = Entries[i].Buffer - Builder->PacketNumberLength;
+        CxPlatCopyMemory(
+            Builder->CipherBatch + i * CXPLAT_HP_SAMPLE_LENGTH,
+            PnStart + 4,
+            CXPLAT_HP_SAMPLE_LENGTH);
+    }
+
     if (QUIC_FAILED(
         Status =
         CxPlatHpComputeMask(
@@ -694,6 +739,7 @@ QuicPacketBuilderFinalizeHeaderProtection(
             Builder->HpMask))) {
         CXPLAT_TEL_ASSERT(FALSE);
         QuicConnFatalError(Builder->Connection, Status, "HP failure");
+        Builder->BatchCount = 0;
         return;
     }
 
@@ -859,57 +905,63 @@ QuicPacketBuilderFinalize(
 
         uint8_t* Payload = Header + Builder->HeaderLength;
 
-        uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
-        QuicCryptoCombineIvAndPacketNumber(Builder->Key->Iv, (uint8_t*) &Builder->Metadata->PacketNumber, Iv);
-
-        QUIC_STATUS Status;
-        if (QUIC_FAILED(
-            Status =
-            CxPlatEncrypt(
-                Builder->Key->PacketKey,
-                Iv,
-                Builder->HeaderLength,
-                Header,
-                PayloadLength,
-                Payload))) {
-            QuicConnFatalError(Connection, Status, "Encryption failure");
-            goto Exit;
-        }
-
-        QuicTraceEvent(
-            PacketFinalize,
-            "[pack][%llu] Finalizing",
-            Builder->Metadata->PacketId);
+        if (Builder->PacketType == SEND_PACKET_SHORT_HEADER_TYPE) {
+            CXPLAT_DBG_ASSERT(Builder->BatchCount < QUIC_MAX_CRYPTO_BATCH_COUNT);
 
-        if (Connection->State.HeaderProtectionEnabled) {
+            //
+            // Batch the encryption and header protection for short header
+            // packets, which all use the same key.
+            //
 
-            uint8_t* PnStart = Payload - Builder->PacketNumberLength;
+            CXPLAT_DBG_ASSERT(Builder->HeaderLength <= UINT8_MAX);
+            Builder->HeaderBatch[Builder->BatchCount] = Header;
+            Builder->HeaderLengthBatch[Builder->BatchCount] = (uint8_t)Builder->HeaderLength;
+            Builder->PayloadLengthBatch[Builder->BatchCount] = PayloadLength;
+            Builder->PacketNumberBatch[Builder->BatchCount] = Builder->Metadata->PacketNumber;
 
-            if (Builder->PacketType == SEND_PACKET_SHORT_HEADER_TYPE) {
-                CXPLAT_DBG_ASSERT(Builder->BatchCount < QUIC_MAX_CRYPTO_BATCH_COUNT);
+            QuicTraceEvent(
+                PacketFinalize,
+                "[pack][%llu] Finalizing",
+                Builder->Metadata->PacketId);
 
-                //
-                // Batch the header protection for short header packets.
-                //
+            if (++Builder->BatchCount == QUIC_MAX_CRYPTO_BATCH_COUNT) {
+                QuicPacketBuilderFinalizeCryptoBatch(Builder);
+            }
 
-                CxPlatCopyMemory(
-                    Builder->CipherBatch + Builder->BatchCount * CXPLAT_HP_SAMPLE_LENGTH,
-                    PnStart + 4,
-                    CXPLAT_HP_SAMPLE_LENGTH);
-                Builder->HeaderBatch[Builder->BatchCount] = Header;
+        } else {
+            CXPLAT_DBG_ASSERT(Builder->BatchCount == 0);
+
+            uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
+            QuicCryptoCombineIvAndPacketNumber(Builder->Key->Iv, (uint8_t*) &Builder->Metadata->PacketNumber, Iv);
+
+            QUIC_STATUS Status;
+            if (QUIC_FAILED(
+                Status =
+                CxPlatEncrypt(
+                    Builder->Key->PacketKey,
+                    Iv,
+                    Builder->HeaderLength,
+                    Header,
+                    PayloadLength,
+                    Payload))) {
+                QuicConnFatalError(Connection, Status, "Encryption failure");
+                goto Exit;
+            }
 
-                if (++Builder->BatchCount == QUIC_MAX_CRYPTO_BATCH_COUNT) {
-                    QuicPacketBuilderFinalizeHeaderProtection(Builder);
-                }
+            QuicTraceEvent(
+                PacketFinalize,
+                "[pack][%llu] Finalizing",
+                Builder->Metadata->PacketId);
 
-            } else {
-                CXPLAT_DBG_ASSERT(Builder->BatchCount == 0);
+            if (Connection->State.HeaderProtectionEnabled) {
 
                 //
                 // Individually do header protection for long header packets as
                 // they generally use different keys.
                 //
 
+                uint8_t* PnStart = Payload - Builder->PacketNumberLength;
+
                 if (QUIC_FAILED(
                     Status =
                     CxPlatHpComputeMask(
@@ -945,7 +997,14 @@ QuicPacketBuilderFinalize(
             !PacketSpace->AwaitingKeyPhaseConfirmation &&
             Connection->State.HandshakeConfirmed) {
 
-            Status = QuicCryptoGenerateNewKeys(Connection);
+            //
+            // Packets already batched must be encrypted with the current key.
+            //
+            if (Builder->BatchCount != 0) {
+                QuicPacketBuilderFinalizeCryptoBatch(Builder);
+            }
+
+            QUIC_STATUS Status = QuicCryptoGenerateNewKeys(Connection);
             if (QUIC_FAILED(Status)) {
                 QuicTraceEvent(
                     ConnErrorStatus,
@@ -1032,7 +1091,7 @@ Exit:
 
         if (FlushBatchedDatagrams || CxPlatSendDataIsFull(Builder->SendData)) {
             if (Builder->BatchCount != 0) {
-                QuicPacketBuilderFinalizeHeaderProtection(Builder);
+                QuicPacketBuilderFinalizeCryptoBatch(Builder);
             }
             CXPLAT_DBG_ASSERT(Builder->TotalCountDatagrams > 0);
             QuicPacketBuilderSendBatch(Builder);
@@ -57,6 +57,14 @@ typedef struct QUIC_PACKET_BUILDER {
     //
     uint8_t* HeaderBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
 
+    //
+    // Packet numbers and lengths of the batched packets, for encrypting their
+    // payloads in one batch.
+    //
+    uint64_t PacketNumberBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint16_t PayloadLengthBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t HeaderLengthBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+
     //
     // Indicates a batch of packets has been sent.
     //
@@ -69,7 +77,7 @@ typedef struct QUIC_PACKET_BUILDER {
     uint8_t PacketBatchRetransmittable : 1;
 
     //
-    // The number of batched packets to do header protection on.
+    // The number of batched packets to encrypt and do header protection on.
     //
     uint8_t BatchCount : 4;
 
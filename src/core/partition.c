@@ -33,6 +33,7 @@ QuicPartitionInitialize(
 
     Partition->Index = Index;
     Partition->Processor = Processor;
+    Partition->NumaNode = (uint16_t)CxPlatProcNumaNode(Processor);
     CxPlatPoolInitialize(FALSE, sizeof(QUIC_CONNECTION), QUIC_POOL_CONN, &Partition->ConnectionPool);
     CxPlatPoolInitialize(FALSE, sizeof(QUIC_TRANSPORT_PARAMETERS), QUIC_POOL_TP, &Partition->TransportParamPool);
     CxPlatPoolInitialize(FALSE, sizeof(QUIC_PACKET_SPACE), QUIC_POOL_TP, &Partition->PacketSpacePool);
@@ -60,6 +60,11 @@ typedef struct QUIC_CACHEALIGN QUIC_PARTITION {
     //
     uint16_t Processor;
 
+    //
+    // The NUMA node of the processor.
+    //
+    uint16_t NumaNode;
+
     //
     // Log correlation ID for events.
     //
@@ -79,6 +79,12 @@ typedef struct QUIC_RX_PACKET QUIC_RX_PACKET;
 //
 #define QUIC_TIME_REORDER_THRESHOLD(rtt)        ((rtt) + ((rtt) / 8))
 
+//
+// The initial number of slots in the ring of outstanding packets, indexed by
+// packet number. It doubles as needed to cover all packet numbers in flight.
+//
+#define QUIC_SENT_PACKET_RING_INITIAL_SIZE      64
+
 //
 // Number of consecutive PTOs after which the network is considered to be
 // experiencing persistent congestion.
@@ -153,6 +159,19 @@ typedef struct QUIC_RX_PACKET QUIC_RX_PACKET;
 //
 #define QUIC_MAX_WORKER_QUEUE_DELAY             250
 
+//
+// With QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE, the average queue delay (in
+// us) at which a worker with more connections waiting starts moving them to
+// less loaded workers on the same NUMA node.
+//
+#define QUIC_WORKER_REBALANCE_QUEUE_DELAY_US    1000
+
+//
+// The minimum time (in us) between connections being moved off a worker, to
+// let the queue delays settle.
+//
+#define QUIC_WORKER_REBALANCE_INTERVAL_US       10000
+
 //
 // The maximum number of simultaneous stateless operations that can be queued on
 // a single worker.
@@ -190,6 +209,16 @@ typedef struct QUIC_RX_PACKET QUIC_RX_PACKET;
 //
 #define QUIC_STREAM_SEND_BATCH_COUNT            8
 
+//
+// The number of distinct stream send priorities tracked without allocating.
+//
+#define QUIC_SEND_PRIORITY_LEVEL_PREALLOC_COUNT 4
+
+//
+// The initial number of streams the weighted fair scheduler's queue holds.
+//
+#define QUIC_SEND_FAIR_QUEUE_INITIAL_COUNT      8
+
 //
 // The maximum number of received packets to batch process at a time.
 //
@@ -340,6 +369,12 @@ CXPLAT_STATIC_ASSERT(
 //
 #define QUIC_RECV_BUFFER_DRAIN_RATIO            4
 
+//
+// The fraction ((0 to UINT16_MAX) / UINT16_MAX) of memory that connection-wide
+// flow control windows may grow into, in total, beyond their configured size.
+//
+#define QUIC_RECV_WINDOW_MEMORY_FRACTION        8192 // ~12.5%
+
 //
 // The default value for send buffering being enabled or not.
 //
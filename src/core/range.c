@@ -23,6 +23,7 @@ QuicRangeInitialize(
     )
 {
     Range->UsedLength = 0;
+    Range->GapStart = 0;
     Range->AllocLength = QUIC_RANGE_INITIAL_SUB_COUNT;
     Range->MaxAllocSize = MaxAllocSize;
     CXPLAT_FRE_ASSERT(sizeof(QUIC_SUBRANGE) * QUIC_RANGE_INITIAL_SUB_COUNT < MaxAllocSize);
@@ -47,14 +48,72 @@ QuicRangeReset(
     )
 {
     Range->UsedLength = 0;
+    Range->GapStart = 0;
+}
+
+//
+// Moves the gap so that it starts at the given index, by moving the subranges
+// in between to the other side of it.
+//
+QUIC_INLINE
+void
+QuicRangeMoveGap(
+    _Inout_ QUIC_RANGE* Range,
+    _In_ uint32_t Index
+    )
+{
+    CXPLAT_DBG_ASSERT(Index <= Range->UsedLength);
+    const uint32_t GapLength = Range->AllocLength - Range->UsedLength;
+    if (GapLength != 0) {
+        if (Index < Range->GapStart) {
+            memmove(
+                Range->SubRanges + Index + GapLength,
+                Range->SubRanges + Index,
+                (Range->GapStart - Index) * sizeof(QUIC_SUBRANGE));
+        } else if (Index > Range->GapStart) {
+            memmove(
+                Range->SubRanges + Range->GapStart,
+                Range->SubRanges + Range->GapStart + GapLength,
+                (Index - Range->GapStart) * sizeof(QUIC_SUBRANGE));
+        }
+    }
+    Range->GapStart = Index;
+}
+
+//
+// Copies the subranges to a new array of a different size, keeping the gap at
+// the same index, and frees the old array.
+//
+QUIC_INLINE
+void
+QuicRangeRelocate(
+    _Inout_ QUIC_RANGE* Range,
+    _Out_writes_(NewAllocLength) QUIC_SUBRANGE* NewSubRanges,
+    _In_ uint32_t NewAllocLength
+    )
+{
+    const uint32_t TailLength = Range->UsedLength - Range->GapStart;
+    memcpy(
+        NewSubRanges,
+        Range->SubRanges,
+        Range->GapStart * sizeof(QUIC_SUBRANGE));
+    memcpy(
+        NewSubRanges + NewAllocLength - TailLength,
+        Range->SubRanges + Range->AllocLength - TailLength,
+        TailLength * sizeof(QUIC_SUBRANGE));
+
+    if (Range->AllocLength != QUIC_RANGE_INITIAL_SUB_COUNT) {
+        CXPLAT_FREE(Range->SubRanges, QUIC_POOL_RANGE);
+    }
+    Range->SubRanges = NewSubRanges;
+    Range->AllocLength = NewAllocLength;
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != FALSE)
 BOOLEAN
 QuicRangeGrow(
-    _Inout_ QUIC_RANGE* Range,
-    _In_ uint32_t NextIndex   // The next index to write to after the grow.
+    _Inout_ QUIC_RANGE* Range
     )
 {
     if (Range->AllocLength == QUIC_MAX_RANGE_ALLOC_SIZE) {
@@ -82,44 +141,14 @@ QuicRangeGrow(
         return FALSE;
     }
 
-    //
-    // Move the items to the new array and make room for the next index to write.
-    //
-
     CXPLAT_DBG_ASSERT(Range->SubRanges != 0);
-    if (NextIndex == 0) {
-        memcpy(
-            NewSubRanges + 1,
-            Range->SubRanges,
-            Range->UsedLength * sizeof(QUIC_SUBRANGE));
-    } else if (NextIndex == Range->UsedLength) {
-        memcpy(
-            NewSubRanges,
-            Range->SubRanges,
-            Range->UsedLength * sizeof(QUIC_SUBRANGE));
-    } else {
-        memcpy(
-            NewSubRanges,
-            Range->SubRanges,
-            NextIndex * sizeof(QUIC_SUBRANGE));
-        memcpy(
-            NewSubRanges + NextIndex + 1,
-            Range->SubRanges + NextIndex,
-            (Range->UsedLength - NextIndex) * sizeof(QUIC_SUBRANGE));
-    }
-
-    if (Range->AllocLength != QUIC_RANGE_INITIAL_SUB_COUNT) {
-        CXPLAT_FREE(Range->SubRanges, QUIC_POOL_RANGE);
-    }
-    Range->SubRanges = NewSubRanges;
-    Range->AllocLength = NewAllocLength;
-    Range->UsedLength++; // For the next write index.
+    QuicRangeRelocate(Range, NewSubRanges, NewAllocLength);
 
     return TRUE;
 }
 
 //
-// Reads the array for inserting a new subrange at the given index.
+// Readies the array for inserting a new subrange at the given index.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != NULL)
@@ -131,46 +160,29 @@ QuicRangeMakeSpace(
 {
     CXPLAT_DBG_ASSERT(*Index <= Range->UsedLength);
 
-    if (Range->UsedLength == Range->AllocLength) {
-        if (!QuicRangeGrow(Range, *Index)) {
-            //
-            // We either can't or aren't allowed to grow any more. If we weren't
-            // trying to append to the front, age out the smallest values to
-            // make room for a new larger one.
-            //
-            if (Range->MaxAllocSize == QUIC_MAX_RANGE_ALLOC_SIZE ||
-                *Index == 0) {
-                return NULL;
-            }
-
-            if (*Index > 1) {
-                memmove(
-                    Range->SubRanges,
-                    Range->SubRanges + 1,
-                    (*Index - 1) * sizeof(QUIC_SUBRANGE));
-            }
-            (*Index)--; // Actually going to be inserting 1 before where requested.
-        }
-    } else {
-        CXPLAT_DBG_ASSERT(Range->SubRanges != 0);
-        if (*Index == 0) {
-            memmove(
-                Range->SubRanges + 1,
-                Range->SubRanges,
-                Range->UsedLength * sizeof(QUIC_SUBRANGE));
-        } else if (*Index == Range->UsedLength) {
-            //
-            // No need to copy. Appending to the end.
-            //
-        } else {
-            memmove(
-                Range->SubRanges + *Index + 1,
-                Range->SubRanges + *Index,
-                (Range->UsedLength - *Index) * sizeof(QUIC_SUBRANGE));
+    if (Range->UsedLength == Range->AllocLength && !QuicRangeGrow(Range)) {
+        //
+        // We either can't or aren't allowed to grow any more. If we weren't
+        // trying to append to the front, age out the smallest values to
+        // make room for a new larger one.
+        //
+        if (Range->MaxAllocSize == QUIC_MAX_RANGE_ALLOC_SIZE ||
+            *Index == 0) {
+            return NULL;
         }
-        Range->UsedLength++; // For the new write.
+
+        //
+        // The array is full, so moving the (empty) gap to the front is free.
+        //
+        QuicRangeMoveGap(Range, 0);
+        Range->UsedLength--;
+        (*Index)--; // Actually going to be inserting 1 before where requested.
     }
 
+    QuicRangeMoveGap(Range, *Index);
+    Range->GapStart++;
+    Range->UsedLength++; // For the new write.
+
     return Range->SubRanges + *Index;
 }
 
@@ -185,13 +197,16 @@ QuicRangeRemoveSubranges(
     CXPLAT_DBG_ASSERT(Count > 0);
     CXPLAT_DBG_ASSERT(Index + Count <= Range->UsedLength);
 
-    if (Index + Count < Range->UsedLength) {
-        memmove(
-            Range->SubRanges + Index,
-            Range->SubRanges + Index + Count,
-            (Range->UsedLength - Index - Count) * sizeof(QUIC_SUBRANGE));
+    //
+    // With the gap moved next to them, the removed subranges just become part
+    // of it. Use whichever side needs fewer subranges moved.
+    //
+    if (Range->GapStart > Index) {
+        QuicRangeMoveGap(Range, Index + Count);
+        Range->GapStart -= Count;
+    } else {
+        QuicRangeMoveGap(Range, Index);
     }
-
     Range->UsedLength -= Count;
 
     if (Range->AllocLength >= QUIC_RANGE_INITIAL_SUB_COUNT * 2 &&
@@ -210,13 +225,7 @@ QuicRangeRemoveSubranges(
                 return FALSE;
             }
         }
-        memcpy(
-            NewSubRanges,
-            Range->SubRanges,
-            Range->UsedLength * sizeof(QUIC_SUBRANGE));
-        CXPLAT_FREE(Range->SubRanges, QUIC_POOL_RANGE);
-        Range->SubRanges = NewSubRanges;
-        Range->AllocLength = NewAllocLength;
+        QuicRangeRelocate(Range, NewSubRanges, NewAllocLength);
         return TRUE;
     }
 
@@ -273,14 +282,9 @@ QuicRangeAddRange(
         int result = QuicRangeSearch(Range, &Key);
         if (IS_FIND_INDEX(result)) {
             //
-            // We found 'an' overlapping subrange. We need to ensure this is the
-            // first overlapping range.
+            // The search returns the first overlapping subrange.
             //
             i = (uint32_t)result;
-            while ((Sub = QuicRangeGetSafe(Range, i - 1)) != NULL &&
-                    QuicRangeCompare(&Key, Sub) == 0) {
-                --i;
-            }
         } else {
             //
             // No overlapping range was found, so the index of the insert was
@@ -363,18 +367,43 @@ QuicRangeAddRange(
 
         uint32_t RemoveCount = j - (i + 1);
         if (RemoveCount != 0) {
-            if (QuicRangeRemoveSubranges(Range, i + 1, RemoveCount)) {
-                //
-                // The subranges were reallocated, so update our Sub pointer.
-                //
-                Sub = QuicRangeGet(Range, i);
-            }
+            QuicRangeRemoveSubranges(Range, i + 1, RemoveCount);
+            //
+            // The subranges were moved or reallocated, so update our Sub
+            // pointer.
+            //
+            Sub = QuicRangeGet(Range, i);
         }
     }
 
     return Sub;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+QUIC_SUBRANGE*
+QuicRangeAddRangeBeforeMin(
+    _Inout_ QUIC_RANGE* Range,
+    _In_ uint64_t Low,
+    _In_ uint64_t Count
+    )
+{
+    CXPLAT_DBG_ASSERT(Count > 0);
+    CXPLAT_DBG_ASSERT(Range->UsedLength == 0 || Low + Count < QuicRangeGetMin(Range));
+
+    //
+    // After the first call the gap is already at the front, so nothing moves
+    // but the previously added subrange.
+    //
+    uint32_t i = 0;
+    QUIC_SUBRANGE* Sub = QuicRangeMakeSpace(Range, &i);
+    if (Sub != NULL) {
+        Sub->Low = Low;
+        Sub->Count = Count;
+    }
+    return Sub;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != FALSE)
 BOOLEAN
@@ -402,21 +431,12 @@ QuicRangeRemoveRange(
     // and returns TRUE).
     //
 
-    uint32_t i;
-    QUIC_SUBRANGE* Sub = NULL;
-    QUIC_SUBRANGE* Test;
-
     //
     // Find the leftmost overlapping subrange.
     //
-    for (i = 0; (Test = QuicRangeGetSafe(Range, i)) != NULL; i++) {
-        if (Test->Low < Low + Count &&
-            Test->Low + Test->Count > Low) {
-            Sub = Test;
-            break;
-        }
-    }
-    if (Sub == NULL) {
+    uint32_t i = QuicRangeLowerBound(Range, Low);
+    QUIC_SUBRANGE* Sub = QuicRangeGetSafe(Range, i);
+    if (Sub == NULL || Sub->Low >= Low + Count) {
         return TRUE;
     }
 
@@ -428,12 +448,12 @@ QuicRangeRemoveRange(
         // and the second part will be handled by the "left edge
         // overlaps" case.
         //
-        QUIC_SUBRANGE* NewSub = QuicRangeMakeSpace(Range, &i);
-        if (NewSub == NULL) {
+        const QUIC_SUBRANGE Split = *Sub;
+        Sub = QuicRangeMakeSpace(Range, &i);
+        if (Sub == NULL) {
             return FALSE;
         }
-        *NewSub = *Sub;
-        Sub = NewSub;
+        *Sub = Split;
     }
 
     if (Sub->Low < Low) {
@@ -45,7 +45,10 @@ QuicRangeGetHigh(
 typedef struct QUIC_RANGE {
 
     //
-    // Array of subranges that represent the set of intervals.
+    // Array of subranges that represent the set of intervals. The array is a
+    // gap buffer: the unused (AllocLength - UsedLength) entries sit in a
+    // single gap starting at GapStart, so that inserts and removals only move
+    // the subranges between the gap and the last modified position.
     //
     _Field_size_(AllocLength)
     QUIC_SUBRANGE* SubRanges;
@@ -55,6 +58,12 @@ typedef struct QUIC_RANGE {
     //
     uint32_t UsedLength;
 
+    //
+    // The index of the first subrange after the gap. Subranges before it are
+    // stored at their own index, the others right after the gap.
+    //
+    uint32_t GapStart;
+
     //
     // The number of allocated subranges in the 'SubRanges' array.
     //
@@ -87,7 +96,8 @@ QuicRangeSize(
 }
 
 //
-// Accessor function for a subrange at a given index.
+// Accessor function for a subrange at a given index. The returned pointer is
+// only valid until the range is next modified.
 //
 QUIC_INLINE
 QUIC_SUBRANGE*
@@ -96,7 +106,10 @@ QuicRangeGet(
     _In_ uint32_t Index
     )
 {
-    return &Range->SubRanges[Index];
+    return
+        &Range->SubRanges[
+            Index < Range->GapStart ?
+                Index : Index + Range->AllocLength - Range->UsedLength];
 }
 
 //
@@ -110,7 +123,7 @@ QuicRangeGetSafe(
     _In_ uint32_t Index
     )
 {
-    return Index < QuicRangeSize(Range) ? &Range->SubRanges[Index] : NULL;
+    return Index < QuicRangeSize(Range) ? QuicRangeGet(Range, Index) : NULL;
 }
 
 //
@@ -146,13 +159,48 @@ QuicRangeCompare(
 #define FIND_INDEX_TO_INSERT_INDEX(i)   (-((int)(i)) - 1)
 #define INSERT_INDEX_TO_FIND_INDEX(i)   (uint32_t)(-((i) + 1))
 
+//
+// O(log(n))
+// Returns the index of the first subrange whose largest value is not less than
+// the input value, or the number of subranges if there is none. The contiguous
+// part of the array on the correct side of the gap is picked with a single
+// compare, and then searched without any data dependent branches, which would
+// otherwise mispredict about half of the time.
+//
+QUIC_INLINE
+uint32_t
+QuicRangeLowerBound(
+    _In_ const QUIC_RANGE* Range,
+    _In_ uint64_t Value
+    )
+{
+    const QUIC_SUBRANGE* Sub = Range->SubRanges;
+    uint32_t Start = 0;
+    uint32_t Length = Range->GapStart;
+    if (Length == 0 || QuicRangeGetHigh(Sub + Length - 1) < Value) {
+        Start = Length;
+        Sub += Length + Range->AllocLength - Range->UsedLength;
+        Length = Range->UsedLength - Length;
+        if (Length == 0) {
+            return Start;
+        }
+    }
+
+    const QUIC_SUBRANGE* Base = Sub;
+    while (Length > 1) {
+        const uint32_t Half = Length / 2;
+        Base = QuicRangeGetHigh(Base + Half) < Value ? Base + Half : Base;
+        Length -= Half;
+    }
+    return Start + (uint32_t)(Base - Sub) + (QuicRangeGetHigh(Base) < Value);
+}
+
 #if QUIC_RANGE_USE_BINARY_SEARCH
 
 //
 // O(log(n))
-// Does a binary search to find *a* subrange that overlaps the search key passed
-// into the function. There is no guarentee which subrange is returned if
-// multiple overlap the search.
+// Does a binary search to find the first subrange that overlaps the search key
+// passed into the function.
 //
 QUIC_INLINE
 int
@@ -161,49 +209,18 @@ QuicRangeSearch(
     _In_ const QUIC_RANGE_SEARCH_KEY* Key
     )
 {
-    uint32_t Num = Range->UsedLength;
-    uint32_t Lo = 0;
-    uint32_t Hi = Range->UsedLength - 1;
-    uint32_t Mid = 0;
-    int Result = 0;
-
-    while (Lo <= Hi) {
-        uint32_t Half;
-        if ((Half = Num / 2) != 0) {
-            Mid = Lo + ((Num & 1) ? Half : (Half - 1));
-            if ((Result = QuicRangeCompare(Key, QuicRangeGet(Range, Mid))) == 0) {
-                return (int)Mid;
-            } else if (Result < 0) {
-                Hi = Mid - 1;
-                Num = (Num & 1) ? Half : Half-1;
-            } else {
-                Lo = Mid + 1;
-                Num = Half;
-            }
-        } else if (Num) {
-            if ((Result = QuicRangeCompare(Key, QuicRangeGet(Range, Lo))) == 0) {
-                return (int)Lo;
-            } else if (Result < 0) {
-                return FIND_INDEX_TO_INSERT_INDEX(Lo);
-            } else {
-                return FIND_INDEX_TO_INSERT_INDEX(Lo + 1);
-            }
-        } else {
-            break;
-        }
+    const uint32_t i = QuicRangeLowerBound(Range, Key->Low);
+    if (i < Range->UsedLength && QuicRangeGet(Range, i)->Low <= Key->High) {
+        return (int)i;
     }
-
-    return
-        Result > 0 ?
-            FIND_INDEX_TO_INSERT_INDEX(Mid + 1) :
-            FIND_INDEX_TO_INSERT_INDEX(Mid);
+    return FIND_INDEX_TO_INSERT_INDEX(i);
 }
 
 #else
 
 //
 // O(n)
-// Does a reverse linear search to find the largest subrange that overlaps the
+// Does a reverse linear search to find the first subrange that overlaps the
 // search key passed into the function.
 //
 QUIC_INLINE
@@ -213,15 +230,15 @@ QuicRangeSearch(
     _In_ const QUIC_RANGE_SEARCH_KEY* Key
     )
 {
-    int Result;
-    uint32_t i;
-    for (i = QuicRangeSize(Range); i > 0; i--) {
-        QUIC_SUBRANGE* Sub = QuicRangeGet(Range, i - 1);
-        if ((Result = QuicRangeCompare(Key, Sub)) == 0) {
-            return (int)(i - 1);
-        } else if (Result > 0) {
-            break;
-        }
+    //
+    // Skip back over every subrange that isn't entirely below the key.
+    //
+    uint32_t i = QuicRangeSize(Range);
+    while (i > 0 && QuicRangeCompare(Key, QuicRangeGet(Range, i - 1)) <= 0) {
+        i--;
+    }
+    if (i < QuicRangeSize(Range) && QuicRangeCompare(Key, QuicRangeGet(Range, i)) == 0) {
+        return (int)i;
     }
     return FIND_INDEX_TO_INSERT_INDEX(i);
 }
@@ -298,9 +315,25 @@ QuicRangeAddRange(
     _Out_ BOOLEAN* RangeUpdated
     );
 
+//
+// O(1)
+// Adds a range of contiguous values that are all less than, and not adjacent
+// to, the current minimum value. Returns the new subrange if successful or
+// NULL on an allocation failure.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+QUIC_SUBRANGE*
+QuicRangeAddRangeBeforeMin(
+    _Inout_ QUIC_RANGE* Range,
+    _In_ uint64_t LowValue,
+    _In_ uint64_t Count
+    );
+
 //
 // Removes a number of subranges from the range. Returns TRUE if the list was
-// shrunk (reallocated) because of the removal operation.
+// shrunk (reallocated) because of the removal operation. Any subrange pointer
+// previously returned is invalidated either way.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
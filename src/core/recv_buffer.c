@@ -568,6 +568,23 @@ QuicRecvBufferResize(
     return TRUE;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferUpdateReadLength(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer
+    )
+{
+    //
+    // Update the amount of data readable in the first chunk.
+    //
+    QUIC_SUBRANGE* FirstRange = QuicRangeGet(&RecvBuffer->WrittenRanges, 0);
+    if (FirstRange->Low == 0) {
+        RecvBuffer->ReadLength = (uint32_t)CXPLAT_MIN(
+            RecvBuffer->Capacity,
+            FirstRange->Count - RecvBuffer->BaseOffset);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicRecvBufferCopyIntoChunks(
@@ -612,15 +629,7 @@ QuicRecvBufferCopyIntoChunks(
     }
     CXPLAT_DBG_ASSERT(WriteLength == 0); // Should always have enough room to copy everything
 
-    //
-    // Update the amount of data readable in the first chunk.
-    //
-    QUIC_SUBRANGE* FirstRange = QuicRangeGet(&RecvBuffer->WrittenRanges, 0);
-    if (FirstRange->Low == 0) {
-        RecvBuffer->ReadLength = (uint32_t)CXPLAT_MIN(
-            RecvBuffer->Capacity,
-            FirstRange->Count - RecvBuffer->BaseOffset);
-    }
+    QuicRecvBufferUpdateReadLength(RecvBuffer);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -630,7 +639,7 @@ QuicRecvBufferWrite(
     _In_ QUIC_RECV_BUFFER* RecvBuffer,
     _In_ uint64_t WriteOffset,
     _In_ uint16_t WriteLength,
-    _In_reads_bytes_(WriteLength) uint8_t const* WriteBuffer,
+    _In_reads_bytes_opt_(WriteLength) uint8_t const* WriteBuffer,
     _In_ uint64_t WriteQuota,
     _Out_ uint64_t* QuotaConsumed,
     _Out_ BOOLEAN* NewDataReady,
@@ -743,8 +752,13 @@ QuicRecvBufferWrite(
 
     //
     // Write the data into the chunks now that everything has been validated.
+    // Without a buffer, the caller copies the data in later.
     //
-    QuicRecvBufferCopyIntoChunks(RecvBuffer, WriteOffset, WriteLength, WriteBuffer);
+    if (WriteBuffer != NULL) {
+        QuicRecvBufferCopyIntoChunks(RecvBuffer, WriteOffset, WriteLength, WriteBuffer);
+    } else {
+        QuicRecvBufferUpdateReadLength(RecvBuffer);
+    }
 
     QuicRecvBufferValidate(RecvBuffer);
     return QUIC_STATUS_SUCCESS;
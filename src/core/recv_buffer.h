@@ -171,6 +171,10 @@ QuicRecvBufferProvideChunks(
 // NewDataReady indicates if new in-order bytes are ready to be delivered to the
 // client.
 //
+// If WriteBuffer is NULL, the space is reserved and the range is marked as
+// written, but nothing is copied. The caller must copy the data in with
+// QuicRecvBufferCopyIntoChunks before the range is read from the buffer.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return == QUIC_STATUS_SUCCESS)
 QUIC_STATUS
@@ -178,13 +182,26 @@ QuicRecvBufferWrite(
     _In_ QUIC_RECV_BUFFER* RecvBuffer,
     _In_ uint64_t WriteOffset,
     _In_ uint16_t WriteLength,
-    _In_reads_bytes_(WriteLength) uint8_t const* WriteBuffer,
+    _In_reads_bytes_opt_(WriteLength) uint8_t const* WriteBuffer,
     _In_ uint64_t WriteQuota,
     _Out_ uint64_t* QuotaConsumed,
     _Out_ BOOLEAN* NewDataReady,
     _Out_ uint64_t* BufferSizeNeeded
     );
 
+//
+// Copies data into a range that was already written (or reserved).
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferCopyIntoChunks(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer,
+    _In_ uint64_t WriteOffset,
+    _In_ uint16_t WriteLength,
+    _In_reads_bytes_(WriteLength)
+        uint8_t const* WriteBuffer
+    );
+
 //
 // Returns how many QUIC_BUFFERs should be passed to `QuicRecvBufferRead` to
 // read all the available data in the buffer.
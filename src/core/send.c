@@ -33,7 +33,12 @@ QuicSendInitialize(
     )
 {
     CxPlatListInitializeHead(&Send->SendStreams);
+    Send->PriorityLevels = Send->PriorityLevelsPrealloc;
+    Send->PriorityLevelAllocCount = QUIC_SEND_PRIORITY_LEVEL_PREALLOC_COUNT;
+    QuicSendSetStreamSchedulingScheme(Send, QUIC_STREAM_SCHEDULING_SCHEME_FIFO);
     Send->MaxData = Settings->ConnFlowControlWindow;
+    Send->ConnFlowControlWindow = Settings->ConnFlowControlWindow;
+    Send->ConnFlowControlWindowLastUpdate = CxPlatTimeUs64();
     Send->SkippedPacketNumber = UINT64_MAX;
 
     //
@@ -66,9 +71,15 @@ QuicSendUninitialize(
         Send->InitialToken = NULL;
     }
 
+    if (Send->ConnFlowControlWindowReserved != 0) {
+        QuicLibraryReleaseRecvWindowMemory(Send->ConnFlowControlWindowReserved);
+        Send->ConnFlowControlWindowReserved = 0;
+    }
+
     //
     // Release all the stream refs.
     //
+    Send->Scheduler->Uninitialize(Send);
     CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Flink;
     while (Entry != &Send->SendStreams) {
 
@@ -82,6 +93,15 @@ QuicSendUninitialize(
 
         QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
     }
+    CxPlatListInitializeHead(&Send->SendStreams);
+    Send->PriorityLevelCount = 0;
+    Send->PriorityLevelsInvalid = FALSE;
+
+    if (Send->PriorityLevels != Send->PriorityLevelsPrealloc) {
+        CXPLAT_FREE(Send->PriorityLevels, QUIC_POOL_SEND_PRIORITY_LEVELS);
+        Send->PriorityLevels = Send->PriorityLevelsPrealloc;
+        Send->PriorityLevelAllocCount = QUIC_SEND_PRIORITY_LEVEL_PREALLOC_COUNT;
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -92,6 +112,11 @@ QuicSendApplyNewSettings(
     )
 {
     Send->MaxData = Settings->ConnFlowControlWindow;
+    Send->ConnFlowControlWindow = Settings->ConnFlowControlWindow;
+    if (Send->ConnFlowControlWindowReserved != 0) {
+        QuicLibraryReleaseRecvWindowMemory(Send->ConnFlowControlWindowReserved);
+        Send->ConnFlowControlWindowReserved = 0;
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -154,31 +179,264 @@ QuicSendQueueFlush(
     }
 }
 
+//
+// The key the send queue is ordered by: the send priority plus one, or zero
+// once the stream has missed its send deadline.
+//
+QUIC_INLINE
+uint32_t
+QuicSendStreamQueuePriority(
+    _In_ const QUIC_STREAM* Stream
+    )
+{
+    return Stream->Flags.SendLate ? 0 : (uint32_t)Stream->SendPriority + 1;
+}
+
+//
+// Returns the index of the first priority level with a priority less than or
+// equal to Priority.
+//
+QUIC_INLINE
+uint32_t
+QuicSendPriorityLevelLowerBound(
+    _In_ const QUIC_SEND* Send,
+    _In_ uint32_t Priority
+    )
+{
+    uint32_t Lo = 0, Hi = Send->PriorityLevelCount;
+    while (Lo < Hi) {
+        uint32_t Mid = Lo + (Hi - Lo) / 2;
+        if (Send->PriorityLevels[Mid].Priority > Priority) {
+            Lo = Mid + 1;
+        } else {
+            Hi = Mid;
+        }
+    }
+    return Lo;
+}
+
+//
+// Searches back to front for the last stream with a priority greater than or
+// equal to Priority. Only used when the priority levels are invalid.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+CXPLAT_LIST_ENTRY*
+QuicSendFindStreamInsertPosition(
+    _In_ QUIC_SEND* Send,
+    _In_ uint32_t Priority
+    )
+{
+    CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Blink;
+    while (Entry != &Send->SendStreams) {
+        if (Priority <=
+            QuicSendStreamQueuePriority(
+                CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink))) {
+            break;
+        }
+        Entry = Entry->Blink;
+    }
+    return Entry;
+}
+
+//
+// Adds a new priority level at Index, growing the levels if necessary.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Success_(return != FALSE)
+BOOLEAN
+QuicSendPriorityLevelInsert(
+    _In_ QUIC_SEND* Send,
+    _In_ uint32_t Index
+    )
+{
+    if (Send->PriorityLevelCount == Send->PriorityLevelAllocCount) {
+        const uint32_t NewAllocCount = Send->PriorityLevelAllocCount * 2;
+        QUIC_SEND_PRIORITY_LEVEL* NewLevels =
+            CXPLAT_ALLOC_NONPAGED(
+                sizeof(QUIC_SEND_PRIORITY_LEVEL) * NewAllocCount,
+                QUIC_POOL_SEND_PRIORITY_LEVELS);
+        if (NewLevels == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "send priority levels",
+                sizeof(QUIC_SEND_PRIORITY_LEVEL) * NewAllocCount);
+            return FALSE;
+        }
+        CxPlatCopyMemory(
+            NewLevels,
+            Send->PriorityLevels,
+            sizeof(QUIC_SEND_PRIORITY_LEVEL) * Send->PriorityLevelCount);
+        if (Send->PriorityLevels != Send->PriorityLevelsPrealloc) {
+            CXPLAT_FREE(Send->PriorityLevels, QUIC_POOL_SEND_PRIORITY_LEVELS);
+        }
+        Send->PriorityLevels = NewLevels;
+        Send->PriorityLevelAllocCount = NewAllocCount;
+    }
+
+    CxPlatMoveMemory(
+        Send->PriorityLevels + Index + 1,
+        Send->PriorityLevels + Index,
+        sizeof(QUIC_SEND_PRIORITY_LEVEL) * (Send->PriorityLevelCount - Index));
+    Send->PriorityLevelCount++;
+    return TRUE;
+}
+
+//
+// Inserts the stream into the send queue after any streams of the same or
+// higher priority.
+//
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
-QuicSendQueueFlushForStream(
+QuicSendStreamQueueInsert(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    const uint32_t Priority = QuicSendStreamQueuePriority(Stream);
+
+    if (Send->PriorityLevelsInvalid) {
+        CxPlatListInsertHead( // Insert after the returned entry
+            QuicSendFindStreamInsertPosition(Send, Priority),
+            &Stream->SendLink);
+        goto Exit;
+    }
+
+    const uint32_t Index = QuicSendPriorityLevelLowerBound(Send, Priority);
+    QUIC_SEND_PRIORITY_LEVEL* Level = Send->PriorityLevels + Index;
+
+    if (Index < Send->PriorityLevelCount && Level->Priority == Priority) {
+        CxPlatListInsertHead(Level->Tail, &Stream->SendLink); // Insert after the tail
+        Level->Tail = &Stream->SendLink;
+        Level->StreamCount++;
+        goto Exit;
+    }
+
+    //
+    // First stream of this priority. It goes right after the streams of the
+    // next higher priority.
+    //
+    CXPLAT_LIST_ENTRY* Prev =
+        Index == 0 ? &Send->SendStreams : Send->PriorityLevels[Index - 1].Tail;
+    CxPlatListInsertHead(Prev, &Stream->SendLink);
+
+    if (!QuicSendPriorityLevelInsert(Send, Index)) {
+        //
+        // The queue is still correctly ordered; the levels just can't track it
+        // any more.
+        //
+        Send->PriorityLevelsInvalid = TRUE;
+        Send->PriorityLevelCount = 0;
+        goto Exit;
+    }
+
+    Level = Send->PriorityLevels + Index;
+    Level->Tail = &Stream->SendLink;
+    Level->StreamCount = 1;
+    Level->Priority = Priority;
+
+Exit:
+
+    Send->Scheduler->OnStreamQueued(Send, Stream);
+}
+
+//
+// Removes the stream, queued with the given priority, from the send queue.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamQueueRemove(
     _In_ QUIC_SEND* Send,
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN DelaySend
+    _In_ uint32_t Priority
     )
 {
-    if (Stream->SendLink.Flink == NULL) {
+    if (!Send->PriorityLevelsInvalid) {
+        const uint32_t Index = QuicSendPriorityLevelLowerBound(Send, Priority);
+        QUIC_SEND_PRIORITY_LEVEL* Level = Send->PriorityLevels + Index;
+        CXPLAT_DBG_ASSERT(Index < Send->PriorityLevelCount);
+        CXPLAT_DBG_ASSERT(Level->Priority == Priority);
+
+        if (--Level->StreamCount == 0) {
+            CXPLAT_DBG_ASSERT(Level->Tail == &Stream->SendLink);
+            CxPlatMoveMemory(
+                Level,
+                Level + 1,
+                sizeof(QUIC_SEND_PRIORITY_LEVEL) * (Send->PriorityLevelCount - Index - 1));
+            Send->PriorityLevelCount--;
+        } else if (Level->Tail == &Stream->SendLink) {
+            Level->Tail = Stream->SendLink.Blink;
+        }
+    }
+
+    CxPlatListEntryRemove(&Stream->SendLink);
+
+    if (Send->PriorityLevelsInvalid && CxPlatListIsEmpty(&Send->SendStreams)) {
+        Send->PriorityLevelsInvalid = FALSE;
+    }
+
+    Send->Scheduler->OnStreamDequeued(Send, Stream);
+}
+
+//
+// Moves the stream after all other streams of the same priority.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamQueueMoveToPriorityTail(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    const uint32_t Priority = QuicSendStreamQueuePriority(Stream);
+
+    if (Send->PriorityLevelsInvalid) {
         //
-        // Not previously queued, so add the stream to the end of the queue.
+        // Start with the "next" entry in the list and keep going until the
+        // next entry's priority is less. Then move the stream before that
+        // entry.
         //
-        CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Blink;
-        while (Entry != &Send->SendStreams) {
-            //
-            // Search back to front for the right place (based on priority) to
-            // insert the stream.
-            //
-            if (Stream->SendPriority <=
-                CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink)->SendPriority) {
+        CXPLAT_LIST_ENTRY* LastEntry = Stream->SendLink.Flink;
+        while (LastEntry != &Send->SendStreams) {
+            if (Priority >
+                QuicSendStreamQueuePriority(
+                    CXPLAT_CONTAINING_RECORD(LastEntry, QUIC_STREAM, SendLink))) {
                 break;
             }
-            Entry = Entry->Blink;
+            LastEntry = LastEntry->Flink;
+        }
+        if (LastEntry->Blink != &Stream->SendLink) {
+            CxPlatListEntryRemove(&Stream->SendLink);
+            CxPlatListInsertTail(LastEntry, &Stream->SendLink);
         }
-        CxPlatListInsertHead(Entry, &Stream->SendLink); // Insert after current Entry
+        return;
+    }
+
+    QUIC_SEND_PRIORITY_LEVEL* Level =
+        Send->PriorityLevels + QuicSendPriorityLevelLowerBound(Send, Priority);
+    CXPLAT_DBG_ASSERT(Level->Priority == Priority);
+
+    if (Level->Tail != &Stream->SendLink) {
+        CxPlatListEntryRemove(&Stream->SendLink);
+        CxPlatListInsertHead(Level->Tail, &Stream->SendLink); // Insert after the tail
+        Level->Tail = &Stream->SendLink;
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendQueueFlushForStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ BOOLEAN DelaySend
+    )
+{
+    if (Stream->SendLink.Flink == NULL) {
+        //
+        // Not previously queued, so add the stream to the end of the queue
+        // (based on priority).
+        //
+        QuicSendStreamQueueInsert(Send, Stream);
         QuicStreamAddRef(Stream, QUIC_STREAM_REF_SEND);
     }
 
@@ -200,29 +458,85 @@ QuicSendQueueFlushForStream(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendTuneConnFlowControlWindow(
+    _In_ QUIC_SEND* Send,
+    _In_ uint64_t TimeNow
+    )
+{
+    QUIC_CONNECTION* Connection = QuicSendGetConnection(Send);
+    const uint64_t DrainThreshold =
+        Send->ConnFlowControlWindow / QUIC_RECV_BUFFER_DRAIN_RATIO;
+
+    //
+    // The same tuning as for stream receive buffers: the window limits
+    // throughput to ConnFlowControlWindow / RTT, so if the app drained
+    // 1 / QUIC_RECV_BUFFER_DRAIN_RATIO of it within an RTT, double it. The
+    // growth is bounded by a memory limit shared by all connections rather
+    // than by a per-connection setting.
+    //
+    const uint64_t TimeThreshold =
+        DrainThreshold == 0 ?
+            0 :
+            (Send->OrderedStreamBytesDeliveredAccumulator * Connection->Paths[0].SmoothedRtt) /
+                DrainThreshold;
+    if (CxPlatTimeDiff64(Send->ConnFlowControlWindowLastUpdate, TimeNow) <= TimeThreshold &&
+        Send->ConnFlowControlWindow != 0 &&
+        QuicLibraryTryReserveRecvWindowMemory(Send->ConnFlowControlWindow)) {
+
+        Send->ConnFlowControlWindowReserved += Send->ConnFlowControlWindow;
+        Send->MaxData += Send->ConnFlowControlWindow;
+        Send->ConnFlowControlWindow *= 2;
+
+        QuicTraceLogConnVerbose(
+            IncreaseConnFlowControlWindow,
+            Connection,
+            "Increasing connection flow control window to %llu (SmoothedRtt=%llu)",
+            Send->ConnFlowControlWindow,
+            Connection->Paths[0].SmoothedRtt);
+    }
+
+    Send->ConnFlowControlWindowLastUpdate = TimeNow;
+    Send->OrderedStreamBytesDeliveredAccumulator = 0;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicSendUpdateStreamPriority(
     _In_ QUIC_SEND* Send,
-    _In_ QUIC_STREAM* Stream
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint16_t OldPriority
     )
 {
     CXPLAT_DBG_ASSERT(Stream->SendLink.Flink != NULL);
-    CxPlatListEntryRemove(&Stream->SendLink);
+    QuicSendStreamQueueRemove(
+        Send,
+        Stream,
+        Stream->Flags.SendLate ? 0 : (uint32_t)OldPriority + 1);
+    QuicSendStreamQueueInsert(Send, Stream);
+}
 
-    CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Blink;
-    while (Entry != &Send->SendStreams) {
-        //
-        // Search back to front for the right place (based on priority) to
-        // insert the stream.
-        //
-        if (Stream->SendPriority <=
-            CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink)->SendPriority) {
-            break;
-        }
-        Entry = Entry->Blink;
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamLate(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ BOOLEAN Late
+    )
+{
+    if (Stream->Flags.SendLate == !!Late) {
+        return;
     }
-    CxPlatListInsertHead(Entry, &Stream->SendLink); // Insert after current Entry
+
+    if (Stream->SendLink.Flink == NULL) {
+        Stream->Flags.SendLate = !!Late;
+        return;
+    }
+
+    QuicSendStreamQueueRemove(Send, Stream, QuicSendStreamQueuePriority(Stream));
+    Stream->Flags.SendLate = !!Late;
+    QuicSendStreamQueueInsert(Send, Stream);
 }
 
 #if DEBUG
@@ -276,6 +590,7 @@ QuicSendClear(
     //
     // Remove any queued up streams.
     //
+    Send->Scheduler->Uninitialize(Send);
     while (!CxPlatListIsEmpty(&Send->SendStreams)) {
 
         QUIC_STREAM* Stream =
@@ -288,6 +603,9 @@ QuicSendClear(
 
         QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
     }
+    Send->PriorityLevelCount = 0;
+    Send->PriorityLevelsInvalid = FALSE;
+    Send->Scheduler->Initialize(Send);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -441,6 +759,13 @@ QuicSendSetStreamSendFlag(
         Stream->SendFlags |= SendFlags;
     }
 
+    if (SendFlags != 0) {
+        //
+        // New frames (or data to recover) may let a blocked stream send again.
+        //
+        QuicSendStreamUnblocked(Send, Stream);
+    }
+
     return SendFlags != 0;
 }
 
@@ -452,8 +777,6 @@ QuicSendClearStreamSendFlag(
     _In_ uint32_t SendFlags
     )
 {
-    UNREFERENCED_PARAMETER(Send);
-
     if (Stream->SendFlags & SendFlags) {
 
         QuicTraceLogStreamVerbose(
@@ -471,7 +794,7 @@ QuicSendClearStreamSendFlag(
             //
             // Since there are no flags left, remove the stream from the queue.
             //
-            CxPlatListEntryRemove(&Stream->SendLink);
+            QuicSendStreamQueueRemove(Send, Stream, QuicSendStreamQueuePriority(Stream));
             Stream->SendLink.Flink = NULL;
             QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
         }
@@ -996,16 +1319,19 @@ QuicSendCanSendStreamNow(
     return FALSE;
 }
 
-_Success_(return != NULL)
+//
+// The FIFO and round robin schedulers send from the first stream in the queue
+// that can send. Round robin, and incremental streams under FIFO, then move the
+// stream behind the others of the same priority after a batch of packets.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STREAM*
-QuicSendGetNextStream(
+QuicSendPriorityGetNextStream(
     _In_ QUIC_SEND* Send,
-    _Out_ uint32_t* PacketCount
+    _Out_ uint32_t* PacketCount,
+    _In_ BOOLEAN RoundRobin
     )
 {
-    QUIC_CONNECTION* Connection = QuicSendGetConnection(Send);
-    CXPLAT_DBG_ASSERT(!QuicConnIsClosed(Connection) || CxPlatListIsEmpty(&Send->SendStreams));
-
     CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Flink;
     while (Entry != &Send->SendStreams) {
 
@@ -1022,25 +1348,11 @@ QuicSendGetNextStream(
         //
         if (QuicSendCanSendStreamNow(Stream)) {
 
-            if (Connection->State.UseRoundRobinStreamScheduling) {
+            if (RoundRobin || Stream->Flags.SendIncremental) {
                 //
-                // Move the stream after any streams of the same priority. Start
-                // with the "next" entry in the list and keep going until the
-                // next entry's priority is less. Then move the stream before
-                // that entry.
+                // Move the stream after any streams of the same priority.
                 //
-                CXPLAT_LIST_ENTRY* LastEntry = Stream->SendLink.Flink;
-                while (LastEntry != &Send->SendStreams) {
-                    if (Stream->SendPriority >
-                        CXPLAT_CONTAINING_RECORD(LastEntry, QUIC_STREAM, SendLink)->SendPriority) {
-                        break;
-                    }
-                    LastEntry = LastEntry->Flink;
-                }
-                if (LastEntry->Blink != &Stream->SendLink) {
-                    CxPlatListEntryRemove(&Stream->SendLink);
-                    CxPlatListInsertTail(LastEntry, &Stream->SendLink);
-                }
+                QuicSendStreamQueueMoveToPriorityTail(Send, Stream);
 
                 *PacketCount = QUIC_STREAM_SEND_BATCH_COUNT;
 
@@ -1057,6 +1369,574 @@ QuicSendGetNextStream(
     return NULL;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STREAM*
+QuicSendFifoGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    )
+{
+    return QuicSendPriorityGetNextStream(Send, PacketCount, FALSE);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STREAM*
+QuicSendRoundRobinGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    )
+{
+    return QuicSendPriorityGetNextStream(Send, PacketCount, TRUE);
+}
+
+//
+// The FIFO and round robin schedulers only need the send queue itself.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendPrioritySchedulerUpdate(
+    _In_ QUIC_SEND* Send
+    )
+{
+    UNREFERENCED_PARAMETER(Send);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendPrioritySchedulerStreamUpdate(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    UNREFERENCED_PARAMETER(Send);
+    UNREFERENCED_PARAMETER(Stream);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendPrioritySchedulerOnStreamSent(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint32_t BytesSent
+    )
+{
+    UNREFERENCED_PARAMETER(Send);
+    UNREFERENCED_PARAMETER(Stream);
+    UNREFERENCED_PARAMETER(BytesSent);
+}
+
+//
+// The weighted fair scheduler is start time fair queuing: every stream has a
+// virtual time, advanced by the bytes it sends divided by its weight (its send
+// priority plus one), and the stream with the earliest virtual time sends next.
+// A newly queued stream starts no earlier than the stream last picked, so idle
+// time doesn't build up credit. Streams past their send deadline go after all
+// others.
+//
+QUIC_INLINE
+BOOLEAN
+QuicSendFairQueueLess(
+    _In_ const QUIC_STREAM* A,
+    _In_ const QUIC_STREAM* B
+    )
+{
+    if (A->Flags.SendLate != B->Flags.SendLate) {
+        return B->Flags.SendLate;
+    }
+    if (A->SendVirtualTime != B->SendVirtualTime) {
+        return A->SendVirtualTime < B->SendVirtualTime;
+    }
+    return A->ID < B->ID;
+}
+
+QUIC_INLINE
+void
+QuicSendFairQueueSet(
+    _In_ QUIC_SEND* Send,
+    _In_ uint32_t Index,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    Send->FairQueue[Index] = Stream;
+    Stream->SendFairQueueIndex = Index;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairQueueSiftUp(
+    _In_ QUIC_SEND* Send,
+    _In_ uint32_t Index
+    )
+{
+    QUIC_STREAM* Stream = Send->FairQueue[Index];
+    while (Index > 0) {
+        const uint32_t Parent = (Index - 1) / 2;
+        if (!QuicSendFairQueueLess(Stream, Send->FairQueue[Parent])) {
+            break;
+        }
+        QuicSendFairQueueSet(Send, Index, Send->FairQueue[Parent]);
+        Index = Parent;
+    }
+    QuicSendFairQueueSet(Send, Index, Stream);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairQueueSiftDown(
+    _In_ QUIC_SEND* Send,
+    _In_ uint32_t Index
+    )
+{
+    QUIC_STREAM* Stream = Send->FairQueue[Index];
+    for (;;) {
+        uint32_t Child = 2 * Index + 1;
+        if (Child >= Send->FairQueueCount) {
+            break;
+        }
+        if (Child + 1 < Send->FairQueueCount &&
+            QuicSendFairQueueLess(Send->FairQueue[Child + 1], Send->FairQueue[Child])) {
+            Child++;
+        }
+        if (!QuicSendFairQueueLess(Send->FairQueue[Child], Stream)) {
+            break;
+        }
+        QuicSendFairQueueSet(Send, Index, Send->FairQueue[Child]);
+        Index = Child;
+    }
+    QuicSendFairQueueSet(Send, Index, Stream);
+}
+
+//
+// Moves a stream that can't send out of the heap, into the blocked entries.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairQueueBlock(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    const uint32_t Index = Stream->SendFairQueueIndex;
+    CXPLAT_DBG_ASSERT(Index < Send->FairQueueCount);
+    CXPLAT_DBG_ASSERT(Send->FairQueue[Index] == Stream);
+
+    QUIC_STREAM* Last = Send->FairQueue[--Send->FairQueueCount];
+    if (Last != Stream) {
+        QuicSendFairQueueSet(Send, Index, Last);
+        QuicSendFairQueueSiftDown(Send, Index);
+        QuicSendFairQueueSiftUp(Send, Last->SendFairQueueIndex);
+    }
+    QuicSendFairQueueSet(Send, Send->FairQueueCount, Stream);
+    Send->FairQueueBlockedCount++;
+}
+
+//
+// Moves a blocked stream back into the heap. Like a newly queued stream, it
+// starts no earlier than the stream last picked.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairQueueUnblock(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    const uint32_t Index = Stream->SendFairQueueIndex;
+    CXPLAT_DBG_ASSERT(Index >= Send->FairQueueCount);
+    CXPLAT_DBG_ASSERT(Index < Send->FairQueueCount + Send->FairQueueBlockedCount);
+    CXPLAT_DBG_ASSERT(Send->FairQueue[Index] == Stream);
+
+    if (Index != Send->FairQueueCount) {
+        QuicSendFairQueueSet(Send, Index, Send->FairQueue[Send->FairQueueCount]);
+    }
+    Send->FairQueueBlockedCount--;
+    if (Stream->SendVirtualTime < Send->FairQueueVirtualTime) {
+        Stream->SendVirtualTime = Send->FairQueueVirtualTime;
+    }
+    QuicSendFairQueueSet(Send, Send->FairQueueCount++, Stream);
+    QuicSendFairQueueSiftUp(Send, Stream->SendFairQueueIndex);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerOnStreamQueued(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Send->FairQueueInvalid) {
+        return;
+    }
+
+    const uint32_t TotalCount = Send->FairQueueCount + Send->FairQueueBlockedCount;
+    if (TotalCount == Send->FairQueueAllocCount) {
+        const uint32_t NewAllocCount =
+            Send->FairQueueAllocCount == 0 ?
+                QUIC_SEND_FAIR_QUEUE_INITIAL_COUNT : Send->FairQueueAllocCount * 2;
+        QUIC_STREAM** NewQueue =
+            CXPLAT_ALLOC_NONPAGED(
+                sizeof(QUIC_STREAM*) * NewAllocCount,
+                QUIC_POOL_SEND_FAIR_QUEUE);
+        if (NewQueue == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "send fair queue",
+                sizeof(QUIC_STREAM*) * NewAllocCount);
+            //
+            // Fall back to the queue order until the queue empties.
+            //
+            Send->FairQueueInvalid = TRUE;
+            Send->FairQueueCount = 0;
+            Send->FairQueueBlockedCount = 0;
+            return;
+        }
+        if (Send->FairQueue != NULL) {
+            CxPlatCopyMemory(
+                NewQueue,
+                Send->FairQueue,
+                sizeof(QUIC_STREAM*) * TotalCount);
+            CXPLAT_FREE(Send->FairQueue, QUIC_POOL_SEND_FAIR_QUEUE);
+        }
+        Send->FairQueue = NewQueue;
+        Send->FairQueueAllocCount = NewAllocCount;
+    }
+
+    //
+    // Make room at the end of the heap by moving the first blocked stream to
+    // the end of the blocked entries.
+    //
+    if (Send->FairQueueBlockedCount != 0) {
+        QuicSendFairQueueSet(Send, TotalCount, Send->FairQueue[Send->FairQueueCount]);
+    }
+    if (Stream->SendVirtualTime < Send->FairQueueVirtualTime) {
+        Stream->SendVirtualTime = Send->FairQueueVirtualTime;
+    }
+    QuicSendFairQueueSet(Send, Send->FairQueueCount++, Stream);
+    QuicSendFairQueueSiftUp(Send, Stream->SendFairQueueIndex);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerOnStreamDequeued(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Send->FairQueueInvalid) {
+        if (CxPlatListIsEmpty(&Send->SendStreams)) {
+            Send->FairQueueInvalid = FALSE;
+        }
+        return;
+    }
+
+    const uint32_t Index = Stream->SendFairQueueIndex;
+    const uint32_t LastBlocked = Send->FairQueueCount + Send->FairQueueBlockedCount - 1;
+    CXPLAT_DBG_ASSERT(Index <= LastBlocked);
+    CXPLAT_DBG_ASSERT(Send->FairQueue[Index] == Stream);
+
+    if (Index >= Send->FairQueueCount) {
+        if (Index != LastBlocked) {
+            QuicSendFairQueueSet(Send, Index, Send->FairQueue[LastBlocked]);
+        }
+        Send->FairQueueBlockedCount--;
+        return;
+    }
+
+    QUIC_STREAM* Last = Send->FairQueue[--Send->FairQueueCount];
+    if (Last != Stream) {
+        QuicSendFairQueueSet(Send, Index, Last);
+        QuicSendFairQueueSiftDown(Send, Index);
+        QuicSendFairQueueSiftUp(Send, Last->SendFairQueueIndex);
+    }
+
+    //
+    // Fill the hole left at the end of the heap with the last blocked stream.
+    //
+    if (Send->FairQueueBlockedCount != 0) {
+        QuicSendFairQueueSet(Send, Send->FairQueueCount, Send->FairQueue[LastBlocked]);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerOnStreamUnblocked(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Send->FairQueueInvalid ||
+        Stream->SendFairQueueIndex < Send->FairQueueCount ||
+        !QuicSendCanSendStreamNow(Stream)) {
+        return;
+    }
+
+    QuicSendFairQueueUnblock(Send, Stream);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerOnStreamsUnblocked(
+    _In_ QUIC_SEND* Send
+    )
+{
+    if (Send->FairQueueInvalid) {
+        return;
+    }
+
+    //
+    // Walk the blocked entries back to front, as unblocking one moves the first
+    // blocked entry into its place.
+    //
+    for (uint32_t i = Send->FairQueueCount + Send->FairQueueBlockedCount;
+         i > Send->FairQueueCount;
+         --i) {
+        QUIC_STREAM* Stream = Send->FairQueue[i - 1];
+        if (QuicSendCanSendStreamNow(Stream)) {
+            QuicSendFairQueueUnblock(Send, Stream);
+            ++i;
+        }
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerInitialize(
+    _In_ QUIC_SEND* Send
+    )
+{
+    for (CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Flink;
+         Entry != &Send->SendStreams;
+         Entry = Entry->Flink) {
+        QuicSendFairSchedulerOnStreamQueued(
+            Send, CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink));
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerUninitialize(
+    _In_ QUIC_SEND* Send
+    )
+{
+    if (Send->FairQueue != NULL) {
+        CXPLAT_FREE(Send->FairQueue, QUIC_POOL_SEND_FAIR_QUEUE);
+        Send->FairQueue = NULL;
+    }
+    Send->FairQueueCount = 0;
+    Send->FairQueueBlockedCount = 0;
+    Send->FairQueueAllocCount = 0;
+    Send->FairQueueInvalid = FALSE;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STREAM*
+QuicSendFairSchedulerGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    )
+{
+    *PacketCount = 1;
+
+    if (Send->FairQueueInvalid) {
+        for (CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Flink;
+             Entry != &Send->SendStreams;
+             Entry = Entry->Flink) {
+            QUIC_STREAM* Stream = CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink);
+            if (QuicSendCanSendStreamNow(Stream)) {
+                return Stream;
+            }
+        }
+        return NULL;
+    }
+
+    //
+    // Streams found blocked at the root stay out of the heap until they are
+    // unblocked, so each is only looked at once.
+    //
+    while (Send->FairQueueCount != 0 &&
+           !QuicSendCanSendStreamNow(Send->FairQueue[0])) {
+        QuicSendFairQueueBlock(Send, Send->FairQueue[0]);
+    }
+
+    if (Send->FairQueueCount == 0) {
+        return NULL;
+    }
+
+    QUIC_STREAM* Stream = Send->FairQueue[0];
+    if (Send->FairQueueVirtualTime < Stream->SendVirtualTime) {
+        Send->FairQueueVirtualTime = Stream->SendVirtualTime;
+    }
+    return Stream;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendFairSchedulerOnStreamSent(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint32_t BytesSent
+    )
+{
+    if (Send->FairQueueInvalid) {
+        return;
+    }
+
+    CXPLAT_DBG_ASSERT(Stream->SendFairQueueIndex < Send->FairQueueCount);
+    if (BytesSent != 0) {
+        Stream->SendVirtualTime +=
+            ((uint64_t)BytesSent << 16) / ((uint64_t)Stream->SendPriority + 1);
+        QuicSendFairQueueSiftDown(Send, Stream->SendFairQueueIndex);
+    }
+
+    //
+    // Take the stream out of the heap as soon as it blocks.
+    //
+    if (Stream->SendFlags != 0 && !QuicSendCanSendStreamNow(Stream)) {
+        QuicSendFairQueueBlock(Send, Stream);
+    }
+}
+
+static const QUIC_STREAM_SCHEDULER QuicStreamSchedulers[QUIC_STREAM_SCHEDULING_SCHEME_COUNT] = {
+    {
+        QUIC_STREAM_SCHEDULING_SCHEME_FIFO,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendFifoGetNextStream,
+        QuicSendPrioritySchedulerOnStreamSent
+    },
+    {
+        QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerStreamUpdate,
+        QuicSendPrioritySchedulerUpdate,
+        QuicSendRoundRobinGetNextStream,
+        QuicSendPrioritySchedulerOnStreamSent
+    },
+    {
+        QUIC_STREAM_SCHEDULING_SCHEME_WEIGHTED_FAIR,
+        QuicSendFairSchedulerInitialize,
+        QuicSendFairSchedulerUninitialize,
+        QuicSendFairSchedulerOnStreamQueued,
+        QuicSendFairSchedulerOnStreamDequeued,
+        QuicSendFairSchedulerOnStreamUnblocked,
+        QuicSendFairSchedulerOnStreamsUnblocked,
+        QuicSendFairSchedulerGetNextStream,
+        QuicSendFairSchedulerOnStreamSent
+    },
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamSchedulingScheme(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM_SCHEDULING_SCHEME Scheme
+    )
+{
+    CXPLAT_DBG_ASSERT(Scheme < QUIC_STREAM_SCHEDULING_SCHEME_COUNT);
+    const QUIC_STREAM_SCHEDULER* Scheduler = &QuicStreamSchedulers[Scheme];
+    if (Send->Scheduler == Scheduler) {
+        return;
+    }
+    if (Send->Scheduler != NULL) {
+        Send->Scheduler->Uninitialize(Send);
+    }
+    Send->Scheduler = Scheduler;
+    Scheduler->Initialize(Send);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamUnblocked(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Stream->SendLink.Flink != NULL) {
+        Send->Scheduler->OnStreamUnblocked(Send, Stream);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamsUnblocked(
+    _In_ QUIC_SEND* Send
+    )
+{
+    Send->Scheduler->OnStreamsUnblocked(Send);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicSendQueueStreamAbort(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ QUIC_VAR_INT ErrorCode
+    )
+{
+    QUIC_CONNECTION* Connection = QuicSendGetConnection(Send);
+    QUIC_OPERATION* Oper = QuicConnAllocOperation(Connection, QUIC_OPER_TYPE_API_CALL);
+    if (Oper == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "STRM_SHUTDOWN operation",
+            0);
+        return FALSE;
+    }
+    Oper->API_CALL.Context->Type = QUIC_API_TYPE_STRM_SHUTDOWN;
+    Oper->API_CALL.Context->STRM_SHUTDOWN.Stream = Stream;
+    Oper->API_CALL.Context->STRM_SHUTDOWN.Flags = QUIC_STREAM_SHUTDOWN_FLAG_ABORT_SEND;
+    Oper->API_CALL.Context->STRM_SHUTDOWN.ErrorCode = ErrorCode;
+    QuicStreamAddRef(Stream, QUIC_STREAM_REF_OPERATION);
+    QuicConnQueueOper(Connection, Oper);
+    return TRUE;
+}
+
+_Success_(return != NULL)
+QUIC_STREAM*
+QuicSendGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    )
+{
+    CXPLAT_DBG_ASSERT(
+        !QuicConnIsClosed(QuicSendGetConnection(Send)) ||
+        CxPlatListIsEmpty(&Send->SendStreams));
+
+    QUIC_STREAM* Stream;
+    while ((Stream = Send->Scheduler->GetNextStream(Send, PacketCount)) != NULL &&
+        Stream->SendDeadline != 0 &&
+        !Stream->Flags.SendLate &&
+        CxPlatTimeAtOrBefore64(Stream->SendDeadline, CxPlatTimeUs64())) {
+        //
+        // The deadline is only checked when the stream comes up to send. A
+        // late stream goes behind all the others and the scheduler is asked
+        // again.
+        //
+        QuicTraceLogStreamInfo(
+            SendDeadlineMissed,
+            Stream,
+            "Send deadline missed");
+        QuicSendSetStreamLate(Send, Stream, TRUE);
+        if (Stream->Flags.SendDeadlineAbort) {
+            //
+            // If the abort can't be queued, the stream is still deprioritized.
+            //
+            (void)QuicSendQueueStreamAbort(Send, Stream, Stream->SendDeadlineErrorCode);
+        }
+    }
+
+    return Stream;
+}
+
 BOOLEAN
 CxPlatIsRouteReady(
     _In_ QUIC_CONNECTION *Connection,
@@ -1416,14 +2296,19 @@ QuicSendFlush(
             //
             // Write the stream frames.
             //
+            const uint16_t PrevDatagramLength = Builder.DatagramLength;
             WrotePacketFrames |= QuicStreamSendWrite(Stream, &Builder);
+            if (Stream->SendLink.Flink != NULL) {
+                Send->Scheduler->OnStreamSent(
+                    Send, Stream, (uint32_t)(Builder.DatagramLength - PrevDatagramLength));
+            }
 
             if (Stream->SendFlags == 0 && Stream->SendLink.Flink != NULL) {
                 //
                 // If the stream no longer has anything to send, remove it from the
                 // list and release Send's reference on it.
                 //
-                CxPlatListEntryRemove(&Stream->SendLink);
+                QuicSendStreamQueueRemove(Send, Stream, QuicSendStreamQueuePriority(Stream));
                 Stream->SendLink.Flink = NULL;
                 QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
                 Stream = NULL;
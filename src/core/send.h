@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 #define SEND_PACKET_SHORT_HEADER_TYPE 0xff
 
 QUIC_INLINE
@@ -234,6 +238,102 @@ QUIC_INLINE BOOLEAN HasStreamDataFrames(uint32_t Flags)
          QUIC_STREAM_SEND_FLAG_FIN);
 }
 
+//
+// The run of streams with the same send priority in the send queue. Levels are
+// kept sorted from highest to lowest priority, the same as the queue itself, so
+// a stream can be placed at the end of its priority without walking the queue.
+//
+typedef struct QUIC_SEND_PRIORITY_LEVEL {
+
+    //
+    // The last stream of this priority in the send queue.
+    //
+    CXPLAT_LIST_ENTRY* Tail;
+
+    //
+    // The number of queued streams with this priority.
+    //
+    uint32_t StreamCount;
+
+    //
+    // The stream send priority plus one, or zero for streams that missed their
+    // send deadline, which are queued behind all others.
+    //
+    uint32_t Priority;
+
+} QUIC_SEND_PRIORITY_LEVEL;
+
+//
+// A stream scheduler decides which queued stream frames the next packets. All
+// schedulers share the send queue itself, which stays ordered by priority, and
+// may keep their own state on the side, updated as streams are queued and
+// removed.
+//
+struct QUIC_SEND;
+
+typedef struct QUIC_STREAM_SCHEDULER {
+
+    QUIC_STREAM_SCHEDULING_SCHEME Scheme;
+
+    //
+    // Builds the scheduler's state for the streams already queued.
+    //
+    void (*Initialize)(
+        _In_ struct QUIC_SEND* Send
+        );
+
+    //
+    // Frees the scheduler's state. The queue itself is left alone.
+    //
+    void (*Uninitialize)(
+        _In_ struct QUIC_SEND* Send
+        );
+
+    void (*OnStreamQueued)(
+        _In_ struct QUIC_SEND* Send,
+        _In_ QUIC_STREAM* Stream
+        );
+
+    void (*OnStreamDequeued)(
+        _In_ struct QUIC_SEND* Send,
+        _In_ QUIC_STREAM* Stream
+        );
+
+    //
+    // Called when a queued stream that couldn't send may be able to now.
+    //
+    void (*OnStreamUnblocked)(
+        _In_ struct QUIC_SEND* Send,
+        _In_ QUIC_STREAM* Stream
+        );
+
+    //
+    // Called when every queued stream that couldn't send may be able to now.
+    //
+    void (*OnStreamsUnblocked)(
+        _In_ struct QUIC_SEND* Send
+        );
+
+    //
+    // Returns the stream to frame the next packet(s) with, and how many
+    // packets it may frame before the scheduler is asked again.
+    //
+    QUIC_STREAM* (*GetNextStream)(
+        _In_ struct QUIC_SEND* Send,
+        _Out_ uint32_t* PacketCount
+        );
+
+    //
+    // Called with the number of bytes the stream just wrote into a packet.
+    //
+    void (*OnStreamSent)(
+        _In_ struct QUIC_SEND* Send,
+        _In_ QUIC_STREAM* Stream,
+        _In_ uint32_t BytesSent
+        );
+
+} QUIC_STREAM_SCHEDULER;
+
 typedef struct QUIC_SEND {
 
     //
@@ -262,6 +362,19 @@ typedef struct QUIC_SEND {
     //
     BOOLEAN Uninitialized : 1;
 
+    //
+    // Indicates the priority levels couldn't be grown and no longer describe
+    // the send queue. Queue updates fall back to walking the queue until it
+    // empties.
+    //
+    BOOLEAN PriorityLevelsInvalid : 1;
+
+    //
+    // Indicates the fair queue couldn't be grown. The weighted fair scheduler
+    // falls back to the queue order until the queue empties.
+    //
+    BOOLEAN FairQueueInvalid : 1;
+
     //
     // The next packet number to use.
     //
@@ -318,6 +431,24 @@ typedef struct QUIC_SEND {
     //
     uint64_t OrderedStreamBytesDeliveredAccumulator;
 
+    //
+    // The current connection-wide flow control window. Starts at the configured
+    // ConnFlowControlWindow and is doubled while the app drains it faster than
+    // the window allows in an RTT.
+    //
+    uint64_t ConnFlowControlWindow;
+
+    //
+    // The growth of ConnFlowControlWindow reserved from the library's receive
+    // window memory limit.
+    //
+    uint64_t ConnFlowControlWindowReserved;
+
+    //
+    // The last time the accumulator was reset.
+    //
+    uint64_t ConnFlowControlWindowLastUpdate;
+
     //
     // Set of flags indicating what data is ready to be sent out.
     //
@@ -328,6 +459,31 @@ typedef struct QUIC_SEND {
     //
     CXPLAT_LIST_ENTRY SendStreams;
 
+    //
+    // Index of the priorities present in SendStreams.
+    //
+    QUIC_SEND_PRIORITY_LEVEL* PriorityLevels;
+    uint32_t PriorityLevelCount;
+    uint32_t PriorityLevelAllocCount;
+    QUIC_SEND_PRIORITY_LEVEL PriorityLevelsPrealloc[QUIC_SEND_PRIORITY_LEVEL_PREALLOC_COUNT];
+
+    //
+    // Picks the next stream to send from SendStreams.
+    //
+    const QUIC_STREAM_SCHEDULER* Scheduler;
+
+    //
+    // Weighted fair scheduler state: a min-heap of the queued streams keyed by
+    // the virtual time their next packet starts at, and the virtual time of
+    // the last stream picked. The queued streams that can't send right now are
+    // kept out of the heap, in the FairQueueBlockedCount entries after it.
+    //
+    QUIC_STREAM** FairQueue;
+    uint32_t FairQueueCount;
+    uint32_t FairQueueBlockedCount;
+    uint32_t FairQueueAllocCount;
+    uint64_t FairQueueVirtualTime;
+
     //
     // The current token to send with an Initial packet.
     //
@@ -422,16 +578,84 @@ QuicSendQueueFlushForStream(
     _In_ BOOLEAN DelaySend
     );
 
+//
+// Called each time the delivered bytes accumulator fills up. Grows the
+// connection-wide flow control window if it limited throughput.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendTuneConnFlowControlWindow(
+    _In_ QUIC_SEND* Send,
+    _In_ uint64_t TimeNow
+    );
+
 //
 // Updates the stream's order in response to a priority change.
 //
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicSendUpdateStreamPriority(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint16_t OldPriority
+    );
+
+//
+// Marks the stream as having missed (or no longer missing) its send deadline,
+// moving it behind (or back among) the streams still on time.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamLate(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ BOOLEAN Late
+    );
+
+//
+// Aborts the send direction of the stream. This is called while the send queue
+// is being walked, so the abort is queued as an operation rather than done
+// inline. Returns FALSE if the operation couldn't be allocated.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicSendQueueStreamAbort(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ QUIC_VAR_INT ErrorCode
+    );
+
+//
+// Switches to the scheduler for the given scheme, keeping the queued streams.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamSchedulingScheme(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM_SCHEDULING_SCHEME Scheme
+    );
+
+//
+// Tells the scheduler something that kept the stream from sending, such as
+// stream flow control, may have cleared.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamUnblocked(
     _In_ QUIC_SEND* Send,
     _In_ QUIC_STREAM* Stream
     );
 
+//
+// Tells the scheduler something that kept every stream from sending, such as
+// connection flow control or missing keys, may have cleared.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendStreamsUnblocked(
+    _In_ QUIC_SEND* Send
+    );
+
 //
 // Tries to drain all queued data that needs to be sent. Returns TRUE if all the
 // data was drained.
@@ -523,3 +747,7 @@ QuicSendClearStreamSendFlag(
     _In_ QUIC_STREAM* Stream,
     _In_ uint32_t SendFlag
     );
+
+#if defined(__cplusplus)
+}
+#endif
@@ -178,6 +178,14 @@ QuicSendBufferFill(
         // Buffer as many requests as we can before moving to the next stream.
         //
         while (Req != NULL && QuicSendBufferHasSpace(&Connection->SendBuffer)) {
+            if (Req->Flags & QUIC_SEND_FLAG_FILE) {
+                //
+                // File requests are read from the file as they're sent;
+                // copying them would defeat the purpose. Buffering must stay
+                // in order, so nothing after one is buffered either.
+                //
+                break;
+            }
             if (QUIC_FAILED(QuicStreamSendBufferRequest(Stream, Req))) {
                 return;
             }
@@ -218,6 +218,7 @@ QuicStreamFree(
 #endif
     QuicPerfCounterDecrement(Connection->Partition, QUIC_PERF_COUNTER_STRM_ACTIVE);
 
+    QuicStreamRecvDirectRelease(Stream);
     QuicRecvBufferUninitialize(&Stream->RecvBuffer);
     QuicRangeUninitialize(&Stream->SparseAckRanges);
     CxPlatDispatchLockUninitialize(&Stream->ApiSendRequestLock);
@@ -669,6 +670,7 @@ QuicStreamParamSet(
         }
 
         if (Stream->SendPriority != *(uint16_t*)Buffer) {
+            const uint16_t OldPriority = Stream->SendPriority;
             Stream->SendPriority = *(uint16_t*)Buffer;
 
             QuicTraceLogStreamInfo(
@@ -681,7 +683,7 @@ QuicStreamParamSet(
                 //
                 // Update the stream's place in the send queue if necessary.
                 //
-                QuicSendUpdateStreamPriority(&Stream->Connection->Send, Stream);
+                QuicSendUpdateStreamPriority(&Stream->Connection->Send, Stream, OldPriority);
             }
         }
 
@@ -741,6 +743,74 @@ QuicStreamParamSet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE:
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (Stream->Flags.ReceiveMultiple || Stream->Flags.UseAppOwnedRecvBuffers) {
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        Stream->Flags.ZeroCopyRecv = !!*(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_STREAM_INCREMENTAL:
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        Stream->Flags.SendIncremental = !!*(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_STREAM_SEND_DEADLINE: {
+
+        if (BufferLength != sizeof(QUIC_STREAM_SEND_DEADLINE) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        const QUIC_STREAM_SEND_DEADLINE* Deadline = (const QUIC_STREAM_SEND_DEADLINE*)Buffer;
+        if ((Deadline->Flags & ~QUIC_STREAM_SEND_DEADLINE_FLAG_ABORT) != 0 ||
+            Deadline->AbortErrorCode > QUIC_UINT62_MAX) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (Deadline->TimeoutUs == 0) {
+            Stream->SendDeadline = 0;
+        } else {
+            const uint64_t TimeNow = CxPlatTimeUs64();
+            Stream->SendDeadline =
+                Deadline->TimeoutUs > UINT64_MAX - TimeNow ?
+                    UINT64_MAX : TimeNow + Deadline->TimeoutUs;
+        }
+        Stream->Flags.SendDeadlineAbort =
+            !!(Deadline->Flags & QUIC_STREAM_SEND_DEADLINE_FLAG_ABORT);
+        Stream->SendDeadlineErrorCode = Deadline->AbortErrorCode;
+
+        QuicTraceLogStreamInfo(
+            UpdateSendDeadline,
+            Stream,
+            "New send deadline = %llu",
+            Stream->SendDeadline);
+
+        //
+        // A new deadline puts a stream that missed the last one back among the
+        // others.
+        //
+        QuicSendSetStreamLate(&Stream->Connection->Send, Stream, FALSE);
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
@@ -958,6 +1028,42 @@ QuicStreamParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE:
+
+        if (*BufferLength < sizeof(BOOLEAN)) {
+            *BufferLength = sizeof(BOOLEAN);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(BOOLEAN);
+        *(BOOLEAN*)Buffer = Stream->Flags.ZeroCopyRecv;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_STREAM_INCREMENTAL:
+
+        if (*BufferLength < sizeof(BOOLEAN)) {
+            *BufferLength = sizeof(BOOLEAN);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(BOOLEAN);
+        *(BOOLEAN*)Buffer = Stream->Flags.SendIncremental;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
@@ -45,10 +45,12 @@ typedef struct QUIC_CONNECTION QUIC_CONNECTION;
 // Internal send flags. The public ones are defined in msquic.h.
 //
 #define QUIC_SEND_FLAG_BUFFERED     ((QUIC_SEND_FLAGS)0x80000000)
+#define QUIC_SEND_FLAG_FILE         ((QUIC_SEND_FLAGS)0x40000000) // Data is read from File as it is sent.
 
 #define QUIC_SEND_FLAGS_INTERNAL \
 ( \
-    QUIC_SEND_FLAG_BUFFERED \
+    QUIC_SEND_FLAG_BUFFERED | \
+    QUIC_SEND_FLAG_FILE \
 )
 
 #define QUIC_STREAM_PRIORITY_DEFAULT 0x7FFF // Medium priority by default
@@ -99,6 +101,14 @@ typedef struct QUIC_SEND_REQUEST {
     //
     void* ClientContext;
 
+#ifndef _KERNEL_MODE
+    //
+    // The private file handle and offset for QUIC_SEND_FLAG_FILE requests.
+    //
+    QUIC_FILE File;
+    uint64_t FileOffset;
+#endif
+
 } QUIC_SEND_REQUEST;
 
 //
@@ -142,6 +152,7 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN ReceiveEnabled          : 1;    // Application is ready for receive callbacks.
         BOOLEAN ReceiveMultiple         : 1;    // The app supports multiple parallel receive indications.
         BOOLEAN UseAppOwnedRecvBuffers  : 1;    // The stream is using app provided receive buffers.
+        BOOLEAN ZeroCopyRecv            : 1;    // In-order data may be indicated straight from received packets.
         BOOLEAN ReceiveFlushQueued      : 1;    // The receive flush operation is queued.
         BOOLEAN ReceiveDataPending      : 1;    // Data (or FIN) is queued and ready for delivery.
         BOOLEAN SendDelayed             : 1;    // A delayed send is currently queued.
@@ -159,6 +170,11 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN InStreamTable           : 1;    // The stream is currently in the connection's table.
         BOOLEAN InWaitingList           : 1;    // The stream is currently in the waiting list for stream id FC.
         BOOLEAN DelayIdFcUpdate         : 1;    // Delay stream ID FC updates to StreamClose.
+
+        BOOLEAN SendIncremental         : 1;    // Round robin with the stream's priority even under FIFO.
+        BOOLEAN SendLate                : 1;    // The send deadline was missed.
+        BOOLEAN SendDeadlineAbort       : 1;    // Abort the send direction when the deadline is missed.
+        BOOLEAN SendFileFailed          : 1;    // Reading a file send failed; the send is being aborted.
     };
 } QUIC_STREAM_FLAGS;
 
@@ -388,6 +404,20 @@ typedef struct QUIC_STREAM {
     //
     uint16_t SendPriority;
 
+    //
+    // The weighted fair scheduler's virtual time for the stream's next packet,
+    // and the stream's index in the fair queue.
+    //
+    uint64_t SendVirtualTime;
+    uint32_t SendFairQueueIndex;
+
+    //
+    // The time (in us) by which the queued data should have been sent, or zero
+    // if there is no deadline, and the error code to abort with if missed.
+    //
+    uint64_t SendDeadline;
+    QUIC_VAR_INT SendDeadlineErrorCode;
+
     //
     // Recv State
     //
@@ -440,6 +470,18 @@ typedef struct QUIC_STREAM {
     //
     volatile uint64_t RecvCompletionLength;
 
+    //
+    // In-order data that was indicated to the app straight from the payload of
+    // a received packet, without being copied into RecvBuffer first (see
+    // QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE). Its space in RecvBuffer is reserved
+    // but left unwritten until the app completes the receive. The packet is
+    // only held if the receive is still pending after the callback returns.
+    //
+    QUIC_RX_PACKET* RecvDirectPacket;
+    const uint8_t* RecvDirectData;
+    uint64_t RecvDirectOffset;
+    uint16_t RecvDirectLength;
+
     //
     // The error code for why the receive path was shutdown.
     //
@@ -1027,6 +1069,15 @@ QuicStreamRecvFlush(
     _In_ QUIC_STREAM* Stream
     );
 
+//
+// Releases the received packet data was indicated from, if still held.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicStreamRecvDirectRelease(
+    _In_ QUIC_STREAM* Stream
+    );
+
 //
 // Enables or disables receive callbacks for the stream.
 //
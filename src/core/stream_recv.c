@@ -379,7 +379,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamProcessStreamFrame(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RX_PACKET* Packet,
     _In_ const QUIC_STREAM_EX* Frame
     )
 {
@@ -487,6 +487,25 @@ QuicStreamProcessStreamFrame(
         uint64_t QuotaConsumed = 0;
         uint64_t BufferSizeNeeded = 0;
 
+        //
+        // In-order data arriving while the app is waiting for it, with nothing
+        // else buffered, can be indicated straight from the packet. Its space
+        // in the receive buffer is only reserved, and whatever the app doesn't
+        // accept is copied in when it completes the receive. Short header
+        // packets are never deferred once decrypted, so the packet can safely
+        // be held past the current receive batch.
+        //
+        const BOOLEAN ZeroCopy =
+            Stream->Flags.ZeroCopyRecv &&
+            Packet->IsShortHeader &&
+            Stream->Flags.ReceiveEnabled &&
+            Stream->RecvDirectLength == 0 &&
+            Stream->RecvPendingLength == 0 &&
+            (Stream->RecvBuffer.RecvMode == QUIC_RECV_BUF_MODE_SINGLE ||
+             Stream->RecvBuffer.RecvMode == QUIC_RECV_BUF_MODE_CIRCULAR) &&
+            Frame->Offset == Stream->RecvBuffer.BaseOffset &&
+            QuicRecvBufferGetTotalLength(&Stream->RecvBuffer) == Stream->RecvBuffer.BaseOffset;
+
         //
         // Write any nonduplicate data to the receive buffer.
         // QuicRecvBufferWrite will indicate if there is data to deliver.
@@ -496,7 +515,7 @@ QuicStreamProcessStreamFrame(
                 &Stream->RecvBuffer,
                 Frame->Offset,
                 (uint16_t)Frame->Length,
-                Frame->Data,
+                ZeroCopy ? NULL : Frame->Data,
                 FlowControlQuota,
                 &QuotaConsumed,
                 &ReadyToDeliver,
@@ -538,6 +557,13 @@ QuicStreamProcessStreamFrame(
             goto Error;
         }
 
+        if (ZeroCopy) {
+            CXPLAT_DBG_ASSERT(ReadyToDeliver);
+            Stream->RecvDirectData = Frame->Data;
+            Stream->RecvDirectOffset = Frame->Offset;
+            Stream->RecvDirectLength = (uint16_t)Frame->Length;
+        }
+
         //
         // Keep track of the total ordered bytes received.
         //
@@ -552,7 +578,7 @@ QuicStreamProcessStreamFrame(
                 "Flow control window exhausted!");
         }
 
-        if (EncryptedWith0Rtt) {
+        if (Packet->EncryptedWith0Rtt) {
             //
             // Keep track of the maximum length of the 0-RTT payload so that we
             // can indicate that appropriately to the API client.
@@ -581,7 +607,24 @@ QuicStreamProcessStreamFrame(
         Stream->Flags.ReceiveDataPending = TRUE;
         QuicStreamRecvQueueFlush(
             Stream,
-            Stream->RecvBuffer.BaseOffset == Stream->RecvMaxLength);
+            Stream->RecvBuffer.BaseOffset == Stream->RecvMaxLength ||
+            Stream->RecvDirectLength != 0);
+    }
+
+    if (Stream->RecvDirectLength != 0 && Stream->RecvDirectPacket == NULL) {
+        if (Stream->RecvPendingLength != 0) {
+            //
+            // The app kept the data indicated from the packet pending. Hold
+            // the packet until it completes the receive.
+            //
+            QuicRxPacketHold(Packet);
+            Stream->RecvDirectPacket = Packet;
+        } else {
+            //
+            // The receive path was aborted from the callback.
+            //
+            QuicStreamRecvDirectRelease(Stream);
+        }
     }
 
     QuicTraceLogStreamVerbose(
@@ -696,6 +739,7 @@ QuicStreamRecv(
                 &Stream->Connection->Send,
                 Stream,
                 QUIC_STREAM_SEND_FLAG_DATA_BLOCKED);
+            QuicSendStreamUnblocked(&Stream->Connection->Send, Stream);
             QuicStreamSendDumpState(Stream);
 
             QuicSendQueueFlush(
@@ -750,7 +794,7 @@ QuicStreamRecv(
 
         Status =
             QuicStreamProcessStreamFrame(
-                Stream, Packet->EncryptedWith0Rtt, &Frame);
+                Stream, Packet, &Frame);
 
         break;
     }
@@ -790,8 +834,8 @@ QuicStreamOnBytesDelivered(
 
     Stream->Connection->Send.OrderedStreamBytesDeliveredAccumulator += BytesDelivered;
     if (Stream->Connection->Send.OrderedStreamBytesDeliveredAccumulator >=
-        Stream->Connection->Settings.ConnFlowControlWindow / QUIC_RECV_BUFFER_DRAIN_RATIO) {
-        Stream->Connection->Send.OrderedStreamBytesDeliveredAccumulator = 0;
+        Stream->Connection->Send.ConnFlowControlWindow / QUIC_RECV_BUFFER_DRAIN_RATIO) {
+        QuicSendTuneConnFlowControlWindow(&Stream->Connection->Send, CxPlatTimeUs64());
         QuicSendSetSendFlag(
             &Stream->Connection->Send,
             QUIC_CONN_SEND_FLAG_MAX_DATA);
@@ -802,12 +846,13 @@ QuicStreamOnBytesDelivered(
         uint64_t TimeNow = CxPlatTimeUs64();
 
         //
-        // Limit stream FC window growth by the connection FC window size.
+        // Limit stream FC window growth by the (tuned) connection FC window size.
         // When using app-owned buffers, skip this: the virtual buffer length is entirely based
         // on the amount of buffer space provided by the app.
         //
         if (Stream->RecvBuffer.VirtualBufferLength != 0 &&
-            Stream->RecvBuffer.VirtualBufferLength < Stream->Connection->Settings.ConnFlowControlWindow) {
+            Stream->RecvBuffer.VirtualBufferLength <= UINT32_MAX / 2 &&
+            Stream->RecvBuffer.VirtualBufferLength < Stream->Connection->Send.ConnFlowControlWindow) {
 
             uint64_t TimeThreshold =
                 ((Stream->RecvWindowBytesDelivered * Stream->Connection->Paths[0].SmoothedRtt) / RecvBufferDrainThreshold);
@@ -970,6 +1015,18 @@ QuicStreamRecvFlush(
             }
             CXPLAT_DBG_ASSERT(Event.RECEIVE.TotalBufferLength != 0);
 
+            if (Stream->RecvDirectLength != 0) {
+                //
+                // The data was never copied into the receive buffer. Indicate
+                // it from the received packet instead.
+                //
+                CXPLAT_DBG_ASSERT(Event.RECEIVE.AbsoluteOffset == Stream->RecvDirectOffset);
+                CXPLAT_DBG_ASSERT(Event.RECEIVE.TotalBufferLength == Stream->RecvDirectLength);
+                RecvBuffers[0].Buffer = (uint8_t*)Stream->RecvDirectData;
+                RecvBuffers[0].Length = Stream->RecvDirectLength;
+                Event.RECEIVE.BufferCount = 1;
+            }
+
             if (Event.RECEIVE.AbsoluteOffset < Stream->RecvMax0RttLength) {
                 //
                 // This data includes data encrypted with 0-RTT key.
@@ -1064,6 +1121,22 @@ QuicStreamRecvFlush(
     }
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicStreamRecvDirectRelease(
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    QUIC_RX_PACKET* Packet = Stream->RecvDirectPacket;
+    if (Packet != NULL && QuicRxPacketRelease(Packet)) {
+        Packet->Next = NULL;
+        CxPlatRecvDataReturn((CXPLAT_RECV_DATA*)Packet);
+    }
+    Stream->RecvDirectPacket = NULL;
+    Stream->RecvDirectData = NULL;
+    Stream->RecvDirectLength = 0;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicStreamReceiveCompletePending(
@@ -1113,6 +1186,22 @@ QuicStreamReceiveComplete(
         BufferLength <= Stream->RecvPendingLength,
         "App overflowed read buffer!");
 
+    if (Stream->RecvDirectLength != 0) {
+        //
+        // The app is done with the data indicated from the received packet.
+        // Copy what it didn't accept into the receive buffer, to be indicated
+        // again, before letting go of the packet.
+        //
+        if (BufferLength < Stream->RecvDirectLength) {
+            QuicRecvBufferCopyIntoChunks(
+                &Stream->RecvBuffer,
+                Stream->RecvDirectOffset + BufferLength,
+                (uint16_t)(Stream->RecvDirectLength - BufferLength),
+                Stream->RecvDirectData + BufferLength);
+        }
+        QuicStreamRecvDirectRelease(Stream);
+    }
+
     //
     // Reclaim any buffer space comsumed by the app.
     //
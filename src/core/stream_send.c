@@ -346,6 +346,13 @@ QuicStreamSendCanWriteDataFrames(
     CXPLAT_DBG_ASSERT(QuicStreamAllowedByPeer(Stream));
     CXPLAT_DBG_ASSERT(HasStreamDataFrames(Stream->SendFlags));
 
+    if (Stream->Flags.SendFileFailed) {
+        //
+        // Nothing more is sent until the queued abort runs.
+        //
+        return FALSE;
+    }
+
     if (Stream->SendFlags & QUIC_STREAM_SEND_FLAG_OPEN) {
         //
         // Flow control doesn't block opening a new stream.
@@ -454,6 +461,12 @@ QuicStreamCompleteSendRequest(
         }
 
         (void)QuicStreamIndicateEvent(Stream, &Event);
+
+#ifndef _KERNEL_MODE
+        if (SendRequest->Flags & QUIC_SEND_FLAG_FILE) {
+            CxPlatFileClose(SendRequest->File);
+        }
+#endif
     } else if (SendRequest->InternalBuffer.Length != 0) {
         QuicSendBufferFree(
             &Connection->SendBuffer,
@@ -681,7 +694,7 @@ QuicStreamSendFlush(
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
-void
+BOOLEAN
 QuicStreamCopyFromSendRequests(
     _In_ QUIC_STREAM* Stream,
     _In_ uint64_t Offset,
@@ -691,7 +704,8 @@ QuicStreamCopyFromSendRequests(
 {
     //
     // Copies up to Len stream bytes starting at Offset from the noncontiguous
-    // send request queue into a contiguous frame buffer.
+    // send request queue into a contiguous frame buffer. Returns FALSE if a
+    // file request's data couldn't be read.
     //
 
     CXPLAT_DBG_ASSERT(Len > 0);
@@ -743,7 +757,17 @@ QuicStreamCopyFromSendRequests(
         uint32_t BufferLeft = Req->Buffers[CurIndex].Length - (uint32_t)CurOffset;
         uint16_t CopyLength = Len < BufferLeft ? Len : (uint16_t)BufferLeft;
         CXPLAT_DBG_ASSERT(CopyLength > 0);
-        CxPlatCopyMemory(Buf, Req->Buffers[CurIndex].Buffer + CurOffset, CopyLength);
+#ifndef _KERNEL_MODE
+        if (Req->Flags & QUIC_SEND_FLAG_FILE) {
+            if (QUIC_FAILED(
+                    CxPlatFileRead(Req->File, Req->FileOffset + CurOffset, CopyLength, Buf))) {
+                return FALSE;
+            }
+        } else
+#endif
+        {
+            CxPlatCopyMemory(Buf, Req->Buffers[CurIndex].Buffer + CurOffset, CopyLength);
+        }
         Len -= CopyLength;
         Buf += CopyLength;
 
@@ -768,6 +792,7 @@ QuicStreamCopyFromSendRequests(
     // Save the bookmark for later.
     //
     Stream->SendBookmark = Req;
+    return TRUE;
 }
 
 //
@@ -819,8 +844,27 @@ QuicStreamWriteOneFrame(
             CXPLAT_DBG_ASSERT(Frame.Length > 0);
         }
         Frame.Data = Buffer + HeaderLength;
-        QuicStreamCopyFromSendRequests(
-            Stream, Offset, (uint8_t*)Frame.Data, (uint16_t)Frame.Length);
+        if (!QuicStreamCopyFromSendRequests(
+                Stream, Offset, (uint8_t*)Frame.Data, (uint16_t)Frame.Length)) {
+            //
+            // The file behind a file send was truncated or couldn't be read.
+            // Stop sending from the stream and abort its send direction; the
+            // abort cancels the outstanding send requests.
+            //
+            QuicTraceEvent(
+                StreamError,
+                "[strm][%p] ERROR, %s.",
+                Stream,
+                "Reading the file failed");
+            Stream->Flags.SendFileFailed = TRUE;
+            if (!QuicSendQueueStreamAbort(
+                    &Stream->Connection->Send, Stream, 0)) {
+                QuicConnTransportError(Stream->Connection, QUIC_ERROR_INTERNAL_ERROR);
+            }
+            *FramePayloadBytes = 0;
+            *FrameBytes = 0;
+            return;
+        }
         Stream->Connection->Stats.Send.TotalStreamBytes += Frame.Length;
     }
 
@@ -514,6 +514,7 @@ QuicStreamSetUpdateMaxStreams(
                 QuicStreamSetInsertStream(StreamSet, Stream),
                 "Steam table lazy intialization failed");
             QuicStreamIndicatePeerAccepted(Stream);
+            QuicSendStreamUnblocked(&Connection->Send, Stream);
             FlushSend = TRUE;
         }
 
@@ -21,11 +21,19 @@ Abstract:
         The timer wheel itself doesn't care about anything other than that value
         from the connection.
 
-        Slots - This is a very simple hash table of time slots. Each slot holds
-        all connections with a next expiration time modulo the total slot count.
+        Levels - The timer wheel is hierarchical. Each level has 64 slots, and
+        each slot of a level covers 64 times the time span of a slot in the level
+        below it. The lowest level's slots are a single microsecond wide.
 
-        Slot Entry - Each slot is made up of a sorted, doubly-linked list of
-        connections.
+        Base Time - Connections are placed relative to the base time: a
+        connection goes in the lowest level where its expiration time and the
+        base time only differ in that level's (and lower levels') slot bits.
+        This means every connection in a lower level expires before every
+        connection in a higher level, and within a level, connections in lower
+        slots expire first.
+
+        Slot Entry - Each slot is an unsorted, doubly-linked list of
+        connections. Per level bit masks track which slots are in use.
 
         Next Expiration - Along with all the connections in the timer wheel, the
         timer wheel also explicitly keeps track of the next expiration time and
@@ -35,13 +43,18 @@ Abstract:
     removal of any number of timers (and their associated connection).
 
     Insertion or update consists of getting the next expiration time from the
-    connection, calculating the correct slot and then doing an insert into the
-    slot's sorted list of connections. Additionally, the next expiration is
-    updated if the new timer is the soonest to expire.
+    connection, calculating the correct level and slot from it and adding the
+    connection to the slot's list. Additionally, the next expiration is updated
+    if the new timer is the soonest to expire.
 
     Removal consists of removing the connection from the doubly-linked list and
     updating the timer wheel's next expiration if this connection was currently
-    next to expire.
+    next to expire. Finding the new next expiration only requires scanning the
+    first slot in use, which is found from the bit masks.
+
+    Connections are lazily moved ('cascaded') to lower levels when the base
+    time advances, after expired timers are processed. Only the one slot that
+    the new base time falls in needs to be moved.
 
 --*/
 
@@ -50,21 +63,161 @@ Abstract:
 #include "timer_wheel.c.clog.h"
 #endif
 
+#define QUIC_TIMER_WHEEL_SLOT_COUNT \
+    (QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_LEVEL_SLOTS)
+
+CXPLAT_STATIC_ASSERT(
+    QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_LEVEL_BITS >= 64,
+    "The levels must cover all 64-bit times");
+
+//
+// Returns the index of the lowest set bit. Mask must not be zero.
+//
+QUIC_INLINE
+uint32_t
+QuicTimerWheelLowestBit(
+    _In_ uint64_t Mask
+    )
+{
+    CXPLAT_DBG_ASSERT(Mask != 0);
+#if defined(_WIN64)
+    unsigned long Index;
+    _BitScanForward64(&Index, Mask);
+    return (uint32_t)Index;
+#elif defined(_WIN32)
+    unsigned long Index;
+    if (_BitScanForward(&Index, (uint32_t)Mask)) {
+        return (uint32_t)Index;
+    }
+    _BitScanForward(&Index, (uint32_t)(Mask >> 32));
+    return 32 + (uint32_t)Index;
+#else
+    return (uint32_t)__builtin_ctzll(Mask);
+#endif
+}
+
+//
+// Returns the index of the highest set bit. Mask must not be zero.
+//
+QUIC_INLINE
+uint32_t
+QuicTimerWheelHighestBit(
+    _In_ uint64_t Mask
+    )
+{
+    CXPLAT_DBG_ASSERT(Mask != 0);
+#if defined(_WIN64)
+    unsigned long Index;
+    _BitScanReverse64(&Index, Mask);
+    return (uint32_t)Index;
+#elif defined(_WIN32)
+    unsigned long Index;
+    if (_BitScanReverse(&Index, (uint32_t)(Mask >> 32))) {
+        return 32 + (uint32_t)Index;
+    }
+    _BitScanReverse(&Index, (uint32_t)Mask);
+    return (uint32_t)Index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(Mask);
+#endif
+}
+
+//
+// Helper to get the level of the slot index.
+//
+#define SLOT_INDEX_TO_LEVEL(SlotIndex) ((SlotIndex) / QUIC_TIMER_WHEEL_LEVEL_SLOTS)
+
+//
+// Helper to get the slot index (over all levels) for a given time.
+//
+QUIC_INLINE
+uint32_t
+QuicTimerWheelTimeToSlotIndex(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint64_t TimeUs
+    )
+{
+    if (TimeUs < TimerWheel->BaseTime) {
+        TimeUs = TimerWheel->BaseTime; // Already expired.
+    }
+    const uint64_t Diff = TimeUs ^ TimerWheel->BaseTime;
+    const uint32_t Level =
+        Diff == 0 ? 0 : QuicTimerWheelHighestBit(Diff) / QUIC_TIMER_WHEEL_LEVEL_BITS;
+    const uint32_t Slot =
+        (uint32_t)(TimeUs >> (Level * QUIC_TIMER_WHEEL_LEVEL_BITS)) &
+        (QUIC_TIMER_WHEEL_LEVEL_SLOTS - 1);
+    return Level * QUIC_TIMER_WHEEL_LEVEL_SLOTS + Slot;
+}
+
 //
-// The initial count of slots in the timer wheel.
+// Returns the index of the first slot in use. Because of the way connections
+// are placed, it always holds the connection that expires next.
 //
-#define QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT     32
+QUIC_INLINE
+uint32_t
+QuicTimerWheelFirstSlotIndex(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    const uint32_t Level = QuicTimerWheelLowestBit(TimerWheel->LevelMask);
+    return
+        Level * QUIC_TIMER_WHEEL_LEVEL_SLOTS +
+        QuicTimerWheelLowestBit(TimerWheel->SlotMask[Level]);
+}
+
+QUIC_INLINE
+void
+QuicTimerWheelSlotEmptied(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint32_t SlotIndex
+    )
+{
+    const uint32_t Level = SLOT_INDEX_TO_LEVEL(SlotIndex);
+    CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&TimerWheel->Slots[SlotIndex]));
+    TimerWheel->SlotMask[Level] &=
+        ~(1ull << (SlotIndex % QUIC_TIMER_WHEEL_LEVEL_SLOTS));
+    if (TimerWheel->SlotMask[Level] == 0) {
+        TimerWheel->LevelMask &= ~(1u << Level);
+    }
+}
 
 //
-// On average, the max number of connections per slot.
+// Adds the connection to the slot for its expiration time.
 //
-#define QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR    32
+QUIC_INLINE
+void
+QuicTimerWheelLink(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection
+    )
+{
+    const uint32_t SlotIndex =
+        QuicTimerWheelTimeToSlotIndex(TimerWheel, Connection->EarliestExpirationTime);
+    const uint32_t Level = SLOT_INDEX_TO_LEVEL(SlotIndex);
+    CxPlatListInsertTail(&TimerWheel->Slots[SlotIndex], &Connection->TimerLink);
+    TimerWheel->SlotMask[Level] |= 1ull << (SlotIndex % QUIC_TIMER_WHEEL_LEVEL_SLOTS);
+    TimerWheel->LevelMask |= 1u << Level;
+}
 
 //
-// Helper to get the slot index for a given time.
+// Removes the connection from its slot.
 //
-#define TIME_TO_SLOT_INDEX(TimerWheel, TimeUs) \
-    ((US_TO_MS(TimeUs) / 1000) % (TimerWheel)->SlotCount)
+QUIC_INLINE
+void
+QuicTimerWheelUnlink(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection
+    )
+{
+    CXPLAT_LIST_ENTRY* Next = Connection->TimerLink.Flink;
+    if (CxPlatListEntryRemove(&Connection->TimerLink)) {
+        //
+        // The connection was the last one in the slot, so Next is the slot's
+        // list head.
+        //
+        QuicTimerWheelSlotEmptied(TimerWheel, (uint32_t)(Next - TimerWheel->Slots));
+    }
+}
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
@@ -75,18 +228,20 @@ QuicTimerWheelInitialize(
     TimerWheel->NextExpirationTime = UINT64_MAX;
     TimerWheel->ConnectionCount = 0;
     TimerWheel->NextConnection = NULL;
-    TimerWheel->SlotCount = QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT;
+    TimerWheel->BaseTime = CxPlatTimeUs64();
+    TimerWheel->LevelMask = 0;
+    CxPlatZeroMemory(TimerWheel->SlotMask, sizeof(TimerWheel->SlotMask));
     TimerWheel->Slots =
-        CXPLAT_ALLOC_NONPAGED(QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
+        CXPLAT_ALLOC_NONPAGED(QUIC_TIMER_WHEEL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
     if (TimerWheel->Slots == NULL) {
         QuicTraceEvent(
             AllocFailure,
             "Allocation of '%s' failed. (%llu bytes)", "timerwheel slots",
-            QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY));
+            QUIC_TIMER_WHEEL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY));
         return QUIC_STATUS_OUT_OF_MEMORY;
     }
 
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
+    for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
         CxPlatListInitializeHead(&TimerWheel->Slots[i]);
     }
 
@@ -100,7 +255,7 @@ QuicTimerWheelUninitialize(
     )
 {
     if (TimerWheel->Slots != NULL) {
-        for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
+        for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
             CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
             CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
             while (Entry != ListHead) {
@@ -118,93 +273,60 @@ QuicTimerWheelUninitialize(
         CXPLAT_TEL_ASSERT(TimerWheel->ConnectionCount == 0);
         CXPLAT_TEL_ASSERT(TimerWheel->NextConnection == NULL);
         CXPLAT_TEL_ASSERT(TimerWheel->NextExpirationTime == UINT64_MAX);
+        CXPLAT_TEL_ASSERT(TimerWheel->LevelMask == 0);
 
         CXPLAT_FREE(TimerWheel->Slots, QUIC_POOL_TIMERWHEEL);
     }
 }
 
+//
+// Moves the base time forward to TimeNow. All connections expiring at or
+// before TimeNow must have already been removed. The only connections that
+// need to move are those in the slot TimeNow falls in, at the highest level
+// where the old and new base times differ. All the lower levels and lower
+// slots on that level only had connections that have expired.
+//
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
-QuicTimerWheelResize(
-    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+QuicTimerWheelAdvance(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint64_t TimeNow
     )
 {
-    uint32_t NewSlotCount = TimerWheel->SlotCount * 2;
-    if (NewSlotCount <= TimerWheel->SlotCount) {
-        //
-        // Max size has been reached.
-        //
+    if (TimeNow <= TimerWheel->BaseTime) {
         return;
     }
 
-    CXPLAT_LIST_ENTRY* NewSlots =
-        CXPLAT_ALLOC_NONPAGED(NewSlotCount * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
-    if (NewSlots == NULL) {
-        QuicTraceEvent(
-            AllocFailure,
-            "Allocation of '%s' failed. (%llu bytes)", "timerwheel slots (realloc)",
-            NewSlotCount * sizeof(CXPLAT_LIST_ENTRY));
+    const uint32_t Level =
+        QuicTimerWheelHighestBit(TimeNow ^ TimerWheel->BaseTime) / QUIC_TIMER_WHEEL_LEVEL_BITS;
+    TimerWheel->BaseTime = TimeNow;
+    if (Level == 0) {
         return;
     }
+    CXPLAT_DBG_ASSERT((TimerWheel->LevelMask & ((1u << Level) - 1)) == 0);
 
-    QuicTraceLogVerbose(
-        TimerWheelResize,
-        "[time][%p] Resizing timer wheel (new slot count = %u).",
-        TimerWheel,
-        NewSlotCount);
-
-    for (uint32_t i = 0; i < NewSlotCount; ++i) {
-        CxPlatListInitializeHead(&NewSlots[i]);
+    const uint32_t SlotIndex =
+        Level * QUIC_TIMER_WHEEL_LEVEL_SLOTS +
+        ((uint32_t)(TimeNow >> (Level * QUIC_TIMER_WHEEL_LEVEL_BITS)) &
+            (QUIC_TIMER_WHEEL_LEVEL_SLOTS - 1));
+    if (CxPlatListIsEmpty(&TimerWheel->Slots[SlotIndex])) {
+        return;
     }
 
-    uint32_t OldSlotCount = TimerWheel->SlotCount;
-    CXPLAT_LIST_ENTRY* OldSlots = TimerWheel->Slots;
-
-    TimerWheel->SlotCount = NewSlotCount;
-    TimerWheel->Slots = NewSlots;
-
-    for (uint32_t i = 0; i < OldSlotCount; ++i) {
-        //
-        // Iterate through each old slot, remove all connections and add them
-        // to the new slots.
-        //
-        while (!CxPlatListIsEmpty(&OldSlots[i])) {
-            QUIC_CONNECTION* Connection =
-                CXPLAT_CONTAINING_RECORD(
-                    CxPlatListRemoveHead(&OldSlots[i]),
-                    QUIC_CONNECTION,
-                    TimerLink);
-            uint64_t ExpirationTime = Connection->EarliestExpirationTime;
-            CXPLAT_DBG_ASSERT(TimerWheel->SlotCount != 0);
-            uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
-
-            //
-            // Insert the connection into the slot, in the correct order. We search
-            // the slot's list in reverse order, with the assumption that most new
-            // timers will on average be later than existing ones.
-            //
-            CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-            CXPLAT_LIST_ENTRY* Entry = ListHead->Blink;
-
-            while (Entry != ListHead) {
-                QUIC_CONNECTION* ConnectionEntry =
-                    CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-                uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-
-                if (ExpirationTime > EntryExpirationTime) {
-                    break;
-                }
-
-                Entry = Entry->Blink;
-            }
-
-            //
-            // Insert after the current entry.
-            //
-            CxPlatListInsertHead(Entry, &Connection->TimerLink);
-        }
+    CXPLAT_LIST_ENTRY Cascade;
+    CxPlatListInitializeHead(&Cascade);
+    CxPlatListMoveItems(&TimerWheel->Slots[SlotIndex], &Cascade);
+    QuicTimerWheelSlotEmptied(TimerWheel, SlotIndex);
+
+    while (!CxPlatListIsEmpty(&Cascade)) {
+        QUIC_CONNECTION* Connection =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Cascade),
+                QUIC_CONNECTION,
+                TimerLink);
+        CXPLAT_DBG_ASSERT(Connection->EarliestExpirationTime > TimeNow);
+        QuicTimerWheelLink(TimerWheel, Connection);
     }
-    CXPLAT_FREE(OldSlots, QUIC_POOL_TIMERWHEEL);
 }
 
 //
@@ -220,17 +342,18 @@ QuicTimerWheelUpdate(
     TimerWheel->NextExpirationTime = UINT64_MAX;
     TimerWheel->NextConnection = NULL;
 
-    //
-    // Loop over the slots to find the connection with the earliest
-    // expiration time.
-    //
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        if (!CxPlatListIsEmpty(&TimerWheel->Slots[i])) {
+    if (TimerWheel->LevelMask != 0) {
+        //
+        // Loop over the first slot in use to find the connection with the
+        // earliest expiration time.
+        //
+        CXPLAT_LIST_ENTRY* ListHead =
+            &TimerWheel->Slots[QuicTimerWheelFirstSlotIndex(TimerWheel)];
+        for (CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
+             Entry != ListHead;
+             Entry = Entry->Flink) {
             QUIC_CONNECTION* ConnectionEntry =
-                CXPLAT_CONTAINING_RECORD(
-                    TimerWheel->Slots[i].Flink,
-                    QUIC_CONNECTION,
-                    TimerLink);
+                CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
             uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
             if (EntryExpirationTime < TimerWheel->NextExpirationTime) {
                 TimerWheel->NextExpirationTime = EntryExpirationTime;
@@ -271,7 +394,7 @@ QuicTimerWheelRemoveConnection(
             "[time][%p] Removing Connection %p.",
             TimerWheel,
             Connection);
-        CxPlatListEntryRemove(&Connection->TimerLink);
+        QuicTimerWheelUnlink(TimerWheel, Connection);
         Connection->TimerLink.Flink = NULL;
         TimerWheel->ConnectionCount--;
 
@@ -296,7 +419,7 @@ QuicTimerWheelUpdateConnection(
         //
         // Connection is already in the timer wheel, so remove it first.
         //
-        CxPlatListEntryRemove(&Connection->TimerLink);
+        QuicTimerWheelUnlink(TimerWheel, Connection);
 
         if (ExpirationTime == UINT64_MAX || Connection->State.ShutdownComplete) {
             //
@@ -335,33 +458,7 @@ QuicTimerWheelUpdateConnection(
 
     CXPLAT_DBG_ASSERT(ExpirationTime != UINT64_MAX);
     CXPLAT_DBG_ASSERT(!Connection->State.ShutdownComplete);
-    CXPLAT_DBG_ASSERT(TimerWheel->SlotCount != 0);
-    uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
-
-    //
-    // Insert the connection into the slot, in the correct order. We search
-    // the slot's list in reverse order, with the assumption that most new
-    // timers will on average be later than existing ones.
-    //
-    CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-    CXPLAT_LIST_ENTRY* Entry = ListHead->Blink;
-
-    while (Entry != ListHead) {
-        QUIC_CONNECTION* ConnectionEntry =
-            CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-        uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-
-        if (ExpirationTime > EntryExpirationTime) {
-            break;
-        }
-
-        Entry = Entry->Blink;
-    }
-
-    //
-    // Insert after the current entry.
-    //
-    CxPlatListInsertHead(Entry, &Connection->TimerLink);
+    QuicTimerWheelLink(TimerWheel, Connection);
 
     QuicTraceLogVerbose(
         TimerWheelUpdateConnection,
@@ -384,15 +481,6 @@ QuicTimerWheelUpdateConnection(
     } else if (Connection == TimerWheel->NextConnection) {
         QuicTimerWheelUpdate(TimerWheel);
     }
-
-    //
-    // Resize the timer wheel if we have too many connections for the
-    // current size.
-    //
-    if (TimerWheel->ConnectionCount >
-        TimerWheel->SlotCount * QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR) {
-        QuicTimerWheelResize(TimerWheel);
-    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -404,32 +492,32 @@ QuicTimerWheelGetExpired(
     )
 {
     //
-    // Iterate through every slot to find all the connections that now have
-    // expired timers.
+    // The first slot in use always holds the next connection to expire, so
+    // keep collecting the expired connections from it until the next
+    // expiration is in the future.
     //
-    BOOLEAN NeedsUpdate = FALSE;
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
+    while (TimerWheel->NextExpirationTime <= TimeNow) {
+        const uint32_t SlotIndex = QuicTimerWheelFirstSlotIndex(TimerWheel);
+        CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
         CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
         while (Entry != ListHead) {
             QUIC_CONNECTION* ConnectionEntry =
                 CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-            uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-            if (EntryExpirationTime > TimeNow) {
-                break;
-            }
             Entry = Entry->Flink;
+            if (ConnectionEntry->EarliestExpirationTime > TimeNow) {
+                continue;
+            }
             CxPlatListEntryRemove(&ConnectionEntry->TimerLink);
             CxPlatListInsertTail(OutputListHead, &ConnectionEntry->TimerLink);
-            if (ConnectionEntry == TimerWheel->NextConnection) {
-                NeedsUpdate = TRUE;
-            }
             QuicConnAddRef(ConnectionEntry, QUIC_CONN_REF_WORKER);
             QuicConnRelease(ConnectionEntry, QUIC_CONN_REF_TIMER_WHEEL);
             TimerWheel->ConnectionCount--;
         }
-    }
-    if (NeedsUpdate) {
+        if (CxPlatListIsEmpty(ListHead)) {
+            QuicTimerWheelSlotEmptied(TimerWheel, SlotIndex);
+        }
         QuicTimerWheelUpdate(TimerWheel);
     }
+
+    QuicTimerWheelAdvance(TimerWheel, TimeNow);
 }
@@ -5,8 +5,20 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_CONNECTION QUIC_CONNECTION;
 
+//
+// The timer wheel has multiple levels of 64 slots each. Each level is 64 times
+// coarser than the one below it, so together they cover all 64-bit times.
+//
+#define QUIC_TIMER_WHEEL_LEVEL_BITS     6
+#define QUIC_TIMER_WHEEL_LEVEL_SLOTS    (1 << QUIC_TIMER_WHEEL_LEVEL_BITS)
+#define QUIC_TIMER_WHEEL_LEVEL_COUNT    11
+
 typedef struct QUIC_TIMER_WHEEL {
 
     //
@@ -25,12 +37,25 @@ typedef struct QUIC_TIMER_WHEEL {
     QUIC_CONNECTION* NextConnection;
 
     //
-    // The number of slots in the Slots array.
+    // The time (in us) the slots are currently relative to. All connections
+    // in the wheel expire after it, except for those that were inserted with
+    // an already expired time.
     //
-    uint32_t SlotCount;
+    uint64_t BaseTime;
 
     //
-    // An array of slots in the timer wheel.
+    // Bit mask of the levels with at least one connection.
+    //
+    uint32_t LevelMask;
+
+    //
+    // Per level, bit mask of the slots with at least one connection.
+    //
+    uint64_t SlotMask[QUIC_TIMER_WHEEL_LEVEL_COUNT];
+
+    //
+    // An array of QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_LEVEL_SLOTS
+    // slots, one level after the other.
     //
     CXPLAT_LIST_ENTRY* Slots;
 
@@ -85,3 +110,7 @@ QuicTimerWheelGetExpired(
     _In_ uint64_t TimeNow,
     _Inout_ CXPLAT_LIST_ENTRY* ListHead
     );
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,232 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the open addressing local CID table used by the lookup.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "CidTableTest.cpp.clog.h"
+#endif
+
+#include <map>
+#include <vector>
+
+#define CID_TABLE_TEST_CID_LENGTH   8
+
+//
+// Owns a CID table and the entries inserted into it, and keeps a reference
+// model (an ordered map from CID bytes to entry) of what it should contain.
+//
+struct CidTableModel {
+    QUIC_CID_TABLE Table;
+    std::map<std::vector<uint8_t>, QUIC_CID_HASH_ENTRY*> Model;
+    uint64_t NextCid {0};
+
+    CidTableModel() {
+        CXPLAT_FRE_ASSERT(QuicCidTableInitialize(&Table, QUIC_CID_TABLE_MIN_GROUPS));
+    }
+    ~CidTableModel() {
+        for (auto& It : Model) {
+            QuicCidTableRemove(&Table, It.second, Hash(It.second));
+            CXPLAT_FREE(It.second, QUIC_POOL_CIDHASH);
+        }
+        QuicCidTableUninitialize(&Table);
+    }
+
+    static uint32_t Hash(const QUIC_CID_HASH_ENTRY* Entry) {
+        return CxPlatHashSimple(Entry->CID.Length, Entry->CID.Data);
+    }
+
+    //
+    // Returns a CID that isn't in the table yet, optionally one whose hash
+    // picks the given group of the current table.
+    //
+    std::vector<uint8_t> NewCid(int64_t Group = -1) {
+        std::vector<uint8_t> Cid(CID_TABLE_TEST_CID_LENGTH);
+        do {
+            ++NextCid;
+            CxPlatCopyMemory(Cid.data(), &NextCid, sizeof(NextCid));
+        } while (Group >= 0 &&
+            (CxPlatHashSimple((uint16_t)Cid.size(), Cid.data()) & Table.GroupMask) != (uint32_t)Group);
+        return Cid;
+    }
+
+    QUIC_CID_HASH_ENTRY* Insert(const std::vector<uint8_t>& Cid) {
+        QUIC_CID_HASH_ENTRY* Entry =
+            QuicCidNewSource(nullptr, (uint8_t)Cid.size(), Cid.data());
+        CXPLAT_FRE_ASSERT(Entry != nullptr);
+        if (!QuicCidTableInsert(&Table, Entry, Hash(Entry))) {
+            CXPLAT_FREE(Entry, QUIC_POOL_CIDHASH);
+            return nullptr;
+        }
+        Model[Cid] = Entry;
+        return Entry;
+    }
+
+    void Remove(const std::vector<uint8_t>& Cid) {
+        auto It = Model.find(Cid);
+        CXPLAT_FRE_ASSERT(It != Model.end());
+        QuicCidTableRemove(&Table, It->second, Hash(It->second));
+        CXPLAT_FREE(It->second, QUIC_POOL_CIDHASH);
+        Model.erase(It);
+    }
+
+    QUIC_CID_HASH_ENTRY* Lookup(const std::vector<uint8_t>& Cid) const {
+        return
+            QuicCidTableLookup(
+                &Table,
+                Cid.data(),
+                (uint8_t)Cid.size(),
+                CxPlatHashSimple((uint16_t)Cid.size(), Cid.data()));
+    }
+
+    //
+    // Checks every CID in the model is found, the slot tags agree with the
+    // entry and deleted counts, and the load limit holds.
+    //
+    void Validate() const {
+        ASSERT_EQ(Model.size(), (size_t)Table.EntryCount);
+        for (auto& It : Model) {
+            ASSERT_EQ(It.second, Lookup(It.first));
+        }
+
+        uint32_t Used = 0, Deleted = 0;
+        for (uint32_t i = 0; i <= Table.GroupMask; ++i) {
+            for (uint32_t j = 0; j < QUIC_CID_TABLE_GROUP_SLOTS; ++j) {
+                const uint8_t Tag = Table.Groups[i].Tags[j];
+                if (Tag == QUIC_CID_TABLE_TAG_DELETED) {
+                    ++Deleted;
+                } else if (Tag != QUIC_CID_TABLE_TAG_EMPTY) {
+                    ASSERT_EQ(0, Tag & QUIC_CID_TABLE_TAG_EMPTY);
+                    ++Used;
+                }
+            }
+        }
+        ASSERT_EQ(Table.EntryCount, Used);
+        ASSERT_EQ(Table.DeletedCount, Deleted);
+
+        const uint32_t Capacity = (Table.GroupMask + 1) * QUIC_CID_TABLE_GROUP_SLOTS;
+        ASSERT_LE(Table.EntryCount + Table.DeletedCount, Capacity - Capacity / 8);
+    }
+};
+
+TEST(CidTableTest, InsertLookupRemove)
+{
+    CidTableModel Table;
+    auto Cid1 = Table.NewCid();
+    auto Cid2 = Table.NewCid();
+
+    ASSERT_EQ(nullptr, Table.Lookup(Cid1));
+    QUIC_CID_HASH_ENTRY* Entry1 = Table.Insert(Cid1);
+    ASSERT_NE(nullptr, Entry1);
+    ASSERT_EQ(Entry1, Table.Lookup(Cid1));
+    ASSERT_EQ(nullptr, Table.Lookup(Cid2));
+
+    QUIC_CID_HASH_ENTRY* Entry2 = Table.Insert(Cid2);
+    ASSERT_NE(nullptr, Entry2);
+    ASSERT_EQ(Entry2, Table.Lookup(Cid2));
+
+    //
+    // A CID that is a prefix of another must not match it.
+    //
+    std::vector<uint8_t> Prefix(Cid1.begin(), Cid1.end() - 1);
+    ASSERT_EQ(nullptr, Table.Lookup(Prefix));
+
+    Table.Remove(Cid1);
+    ASSERT_EQ(nullptr, Table.Lookup(Cid1));
+    ASSERT_EQ(Entry2, Table.Lookup(Cid2));
+    Table.Validate();
+}
+
+//
+// Removing from a full group has to leave a tombstone, or a CID that probed
+// past the group would no longer be found. Reusing the slot clears it.
+//
+TEST(CidTableTest, Tombstones)
+{
+    CidTableModel Table;
+    ASSERT_EQ((uint32_t)QUIC_CID_TABLE_MIN_GROUPS - 1, Table.Table.GroupMask);
+
+    std::vector<std::vector<uint8_t>> Cids;
+    for (uint32_t i = 0; i < QUIC_CID_TABLE_GROUP_SLOTS + 1; ++i) {
+        Cids.push_back(Table.NewCid(0));
+        ASSERT_NE(nullptr, Table.Insert(Cids.back()));
+    }
+    ASSERT_EQ((uint32_t)QUIC_CID_TABLE_MIN_GROUPS - 1, Table.Table.GroupMask);
+    ASSERT_EQ(0u, Table.Table.DeletedCount);
+
+    Table.Remove(Cids[0]);
+    ASSERT_EQ(1u, Table.Table.DeletedCount);
+    ASSERT_NE(nullptr, Table.Lookup(Cids.back())); // Overflowed into group 1
+    Table.Validate();
+
+    ASSERT_NE(nullptr, Table.Insert(Table.NewCid(0)));
+    ASSERT_EQ(0u, Table.Table.DeletedCount);
+    Table.Validate();
+
+    //
+    // The overflowed CID's group still has empty slots, so removing it needs
+    // no tombstone.
+    //
+    Table.Remove(Cids.back());
+    ASSERT_EQ(0u, Table.Table.DeletedCount);
+    Table.Validate();
+}
+
+TEST(CidTableTest, GrowAndShrink)
+{
+    const uint32_t Count = 4096;
+    CidTableModel Table;
+    std::vector<std::vector<uint8_t>> Cids;
+    for (uint32_t i = 0; i < Count; ++i) {
+        Cids.push_back(Table.NewCid());
+        ASSERT_NE(nullptr, Table.Insert(Cids.back()));
+    }
+    Table.Validate();
+    const uint32_t GrownGroups = Table.Table.GroupMask + 1;
+    ASSERT_GE(GrownGroups * QUIC_CID_TABLE_GROUP_SLOTS, Count);
+
+    for (uint32_t i = 0; i < Count - 1; ++i) {
+        Table.Remove(Cids[i]);
+    }
+    Table.Validate();
+    ASSERT_EQ((uint32_t)QUIC_CID_TABLE_MIN_GROUPS, Table.Table.GroupMask + 1);
+    ASSERT_NE(nullptr, Table.Lookup(Cids.back()));
+}
+
+//
+// Random inserts and removes, with enough churn at a steady size to build up
+// tombstones and force same size rehashes, checked against the model.
+//
+TEST(CidTableTest, RandomAgainstModel)
+{
+    CidTableModel Table;
+    std::vector<std::vector<uint8_t>> Cids;
+    uint32_t Seed = 0x5eed;
+    for (uint32_t i = 0; i < 50000; ++i) {
+        Seed = Seed * 1664525 + 1013904223;
+        const uint32_t Target = i < 25000 ? 1000 : 50; // Fill, then drain
+        const bool Add = Cids.empty() || (Seed >> 8) % (2 * Target) >= Cids.size();
+        if (Add) {
+            Cids.push_back(Table.NewCid());
+            ASSERT_NE(nullptr, Table.Insert(Cids.back()));
+        } else {
+            const size_t Index = (Seed >> 12) % Cids.size();
+            std::vector<uint8_t> Removed = Cids[Index];
+            Table.Remove(Removed);
+            ASSERT_EQ(nullptr, Table.Lookup(Removed));
+            Cids[Index] = Cids.back();
+            Cids.pop_back();
+        }
+        if (i % 1000 == 0) {
+            Table.Validate();
+        }
+    }
+    Table.Validate();
+}
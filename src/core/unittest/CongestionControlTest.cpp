@@ -0,0 +1,750 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the congestion control algorithms. Drives each algorithm
+    through a canned, deterministic ACK/loss sequence and compares the
+    resulting congestion window and pacing trajectory against a stored golden
+    trace. A second, policed scenario checks that BbrResync actually resyncs
+    where plain BBR does not. The per-ACK cost is measured in the core bench.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "CongestionControlTest.cpp.clog.h"
+#endif
+
+#include <map>
+#include <vector>
+
+//
+// Network model used by the simulator. A single bottleneck link with a fixed
+// rate and a drop-tail queue, plus a small set of canned losses.
+//
+#define CC_SIM_MTU                  1280
+#define CC_SIM_RATE_MBPS            100             // Bits per microsecond
+#define CC_SIM_RTT                  MS_TO_US(50)
+#define CC_SIM_MAX_QUEUE_DELAY      MS_TO_US(50)
+#define CC_SIM_START_TIME           S_TO_US(1)
+#define CC_SIM_DURATION             S_TO_US(4)
+#define CC_SIM_SAMPLE_INTERVAL      MS_TO_US(100)
+
+//
+// The policed scenario instead has a deep enough queue that BBR doesn't
+// overflow it, and drops everything sent during a short window once every
+// period. That gives the periodic window collapse, every ten or so rounds,
+// that BbrResync is built to detect.
+//
+#define CC_SIM_POLICED_MAX_QUEUE_DELAY  MS_TO_US(200)
+#define CC_SIM_POLICER_PERIOD           S_TO_US(2)
+#define CC_SIM_POLICER_WINDOW           MS_TO_US(10)
+#define CC_SIM_POLICED_DURATION         S_TO_US(8)
+#define CC_SIM_POLICED_SAMPLE_INTERVAL  MS_TO_US(200)
+
+static const uint64_t CcSimCannedLosses[] = {
+    400, 401, 402, 4000, 9000, 9001, 15000
+};
+
+struct CcTracePoint {
+    uint32_t CongestionWindow;
+    uint32_t SendAllowance;
+    bool operator==(const CcTracePoint& Other) const {
+        return CongestionWindow == Other.CongestionWindow &&
+            SendAllowance == Other.SendAllowance;
+    }
+};
+
+std::ostream& operator << (std::ostream& o, const CcTracePoint& Point) {
+    return o << "{ " << Point.CongestionWindow << ", " << Point.SendAllowance << " }";
+}
+
+//
+// Minimal connection wrapper that satisfies everything the congestion control
+// algorithms reach through QuicCongestionControlGetConnection. Mirrors the
+// per-packet bookkeeping done by loss_detection.c so that rate sampling in
+// BBR sees the same inputs it would on a real connection.
+//
+struct CcSimulator {
+
+    enum EventType { EventAck, EventLoss, EventPacing };
+
+    struct Event {
+        EventType Type;
+        QUIC_SENT_PACKET_METADATA* Packet;
+    };
+
+    QUIC_CONNECTION* Connection;
+    QUIC_CONGESTION_CONTROL* Cc;
+    std::multimap<uint64_t, Event> Events;
+    bool Policed;
+
+    uint64_t TimeNow {CC_SIM_START_TIME};
+    uint64_t NextPacketNumber {0};
+    uint64_t LargestAck {0};
+    uint64_t BottleneckFreeTime {0};
+    uint64_t LastSendTime {0};
+    bool LastSendTimeValid {false};
+    bool PacingTimerArmed {false};
+    uint32_t LastSendAllowance {0};
+
+    uint64_t TotalBytesSent {0};
+    uint64_t TotalBytesAcked {0};
+    uint64_t TotalBytesSentAtLastAck {0};
+    uint64_t TimeOfLastPacketAcked {0};
+    uint64_t TimeOfLastAckedPacketSent {0};
+    uint64_t AdjustedLastAckedTime {0};
+
+    CcSimulator(QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm, bool Policed = false) : Policed(Policed) {
+        Connection =
+            (QUIC_CONNECTION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Connection != nullptr);
+        CxPlatZeroMemory(Connection, sizeof(QUIC_CONNECTION));
+
+        QuicSettingsSetDefault(&Connection->Settings);
+        Connection->Settings.CongestionControlAlgorithm = (uint16_t)Algorithm;
+        Connection->Settings.IsSet.CongestionControlAlgorithm = TRUE;
+
+        QUIC_PATH* Path = &Connection->Paths[0];
+        Path->IsActive = TRUE;
+        Path->Mtu = CC_SIM_MTU;
+        QuicAddrSetFamily(&Path->Route.RemoteAddress, QUIC_ADDRESS_FAMILY_INET);
+        Path->SmoothedRtt = CC_SIM_RTT;
+        Path->MinRtt = UINT64_MAX;
+        Path->RttVariance = CC_SIM_RTT / 2;
+        Connection->PathsCount = 1;
+
+        Cc = &Connection->CongestionControl;
+        QuicCongestionControlInitialize(Cc, &Connection->Settings);
+    }
+
+    ~CcSimulator() {
+        for (auto& It : Events) {
+            if (It.second.Packet != nullptr) {
+                CXPLAT_FREE(It.second.Packet, QUIC_POOL_TEST);
+            }
+        }
+        CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+    }
+
+    uint16_t PacketLength() const {
+        return QuicPathGetDatagramPayloadSize(&Connection->Paths[0]);
+    }
+
+    bool IsCannedLoss(uint64_t PacketNumber) const {
+        for (auto Lost : CcSimCannedLosses) {
+            if (Lost == PacketNumber) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsPoliced() const {
+        const uint64_t Elapsed = TimeNow - CC_SIM_START_TIME;
+        return
+            Policed &&
+            Elapsed >= CC_SIM_POLICER_PERIOD &&
+            Elapsed % CC_SIM_POLICER_PERIOD < CC_SIM_POLICER_WINDOW;
+    }
+
+    void SendPacket() {
+        QUIC_SENT_PACKET_METADATA* Packet =
+            (QUIC_SENT_PACKET_METADATA*)CXPLAT_ALLOC_NONPAGED(
+                SIZEOF_QUIC_SENT_PACKET_METADATA(0), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Packet != nullptr);
+        CxPlatZeroMemory(Packet, SIZEOF_QUIC_SENT_PACKET_METADATA(0));
+
+        Packet->PacketNumber = NextPacketNumber++;
+        Packet->PacketId = Packet->PacketNumber;
+        Packet->SentTime = TimeNow;
+        Packet->PacketLength = PacketLength();
+        Packet->Flags.KeyType = QUIC_PACKET_KEY_1_RTT;
+        Packet->Flags.IsAckEliciting = TRUE;
+        Packet->Flags.IsAppLimited = QuicCongestionControlIsAppLimited(Cc);
+
+        TotalBytesSent += Packet->PacketLength;
+        Packet->TotalBytesSent = TotalBytesSent;
+        if (TimeOfLastPacketAcked) {
+            Packet->Flags.HasLastAckedPacketInfo = TRUE;
+            Packet->LastAckedPacketInfo.SentTime = TimeOfLastAckedPacketSent;
+            Packet->LastAckedPacketInfo.AckTime = TimeOfLastPacketAcked;
+            Packet->LastAckedPacketInfo.AdjustedAckTime = AdjustedLastAckedTime;
+            Packet->LastAckedPacketInfo.TotalBytesSent = TotalBytesSentAtLastAck;
+            Packet->LastAckedPacketInfo.TotalBytesAcked = TotalBytesAcked;
+        }
+        Connection->LossDetection.LargestSentPacketNumber = Packet->PacketNumber;
+        Connection->Send.NextPacketNumber = NextPacketNumber;
+
+        QuicCongestionControlOnDataSent(Cc, Packet->PacketLength);
+
+        //
+        // Push the packet through the bottleneck.
+        //
+        const uint64_t OneWayDelay = CC_SIM_RTT / 2;
+        const uint64_t TransmitTime = (uint64_t)Packet->PacketLength * 8 / CC_SIM_RATE_MBPS;
+        const uint64_t ArrivalTime = TimeNow + OneWayDelay;
+        const uint64_t DepartTime = CXPLAT_MAX(ArrivalTime, BottleneckFreeTime) + TransmitTime;
+
+        const uint64_t MaxQueueDelay =
+            Policed ? CC_SIM_POLICED_MAX_QUEUE_DELAY : CC_SIM_MAX_QUEUE_DELAY;
+        if (IsCannedLoss(Packet->PacketNumber) ||
+            IsPoliced() ||
+            DepartTime - ArrivalTime - TransmitTime > MaxQueueDelay) {
+            //
+            // Declared lost roughly when a later packet's ACK would reveal
+            // the gap.
+            //
+            Events.insert({DepartTime + OneWayDelay + CC_SIM_RTT / 8, {EventLoss, Packet}});
+        } else {
+            BottleneckFreeTime = DepartTime;
+            Events.insert({DepartTime + OneWayDelay, {EventAck, Packet}});
+        }
+    }
+
+    void OnAck(QUIC_SENT_PACKET_METADATA* Packet) {
+        QUIC_PATH* Path = &Connection->Paths[0];
+        const uint64_t RttSample = TimeNow - Packet->SentTime;
+        if (!Path->GotFirstRttSample) {
+            Path->GotFirstRttSample = TRUE;
+            Path->SmoothedRtt = RttSample;
+            Path->RttVariance = RttSample / 2;
+        } else {
+            const uint64_t Delta =
+                Path->SmoothedRtt > RttSample ?
+                    Path->SmoothedRtt - RttSample : RttSample - Path->SmoothedRtt;
+            Path->RttVariance = (3 * Path->RttVariance + Delta) / 4;
+            Path->SmoothedRtt = (7 * Path->SmoothedRtt + RttSample) / 8;
+        }
+        if (RttSample < Path->MinRtt) {
+            Path->MinRtt = RttSample;
+        }
+        if (Packet->PacketNumber > LargestAck) {
+            LargestAck = Packet->PacketNumber;
+        }
+
+        TotalBytesAcked += Packet->PacketLength;
+        TotalBytesSentAtLastAck = Packet->TotalBytesSent;
+        TimeOfLastPacketAcked = TimeNow;
+        TimeOfLastAckedPacketSent = Packet->SentTime;
+        AdjustedLastAckedTime = TimeNow;
+
+        Packet->Next = nullptr;
+        QUIC_ACK_EVENT AckEvent;
+        CxPlatZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.IsImplicit = FALSE;
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestAck = LargestAck;
+        AckEvent.LargestSentPacketNumber = NextPacketNumber - 1;
+        AckEvent.NumRetransmittableBytes = Packet->PacketLength;
+        AckEvent.SmoothedRtt = Path->SmoothedRtt;
+        AckEvent.MinRtt = RttSample;
+        AckEvent.OneWayDelay = CC_SIM_RTT / 2;
+        AckEvent.HasLoss = FALSE;
+        AckEvent.AdjustedAckTime = TimeNow;
+        AckEvent.AckedPackets = Packet;
+        AckEvent.NumTotalAckedRetransmittableBytes = TotalBytesAcked;
+        AckEvent.IsLargestAckedPacketAppLimited = Packet->Flags.IsAppLimited;
+        AckEvent.MinRttValid = TRUE;
+
+        (void)QuicCongestionControlOnDataAcknowledged(Cc, &AckEvent);
+    }
+
+    void OnLoss(QUIC_SENT_PACKET_METADATA* Packet) {
+        QUIC_LOSS_EVENT LossEvent;
+        CxPlatZeroMemory(&LossEvent, sizeof(LossEvent));
+        LossEvent.LargestPacketNumberLost = Packet->PacketNumber;
+        LossEvent.LargestSentPacketNumber = NextPacketNumber - 1;
+        LossEvent.NumRetransmittableBytes = Packet->PacketLength;
+        LossEvent.PersistentCongestion = FALSE;
+        QuicCongestionControlOnDataLost(Cc, &LossEvent);
+    }
+
+    //
+    // Sends as much as the congestion controller allows right now, arming a
+    // pacing timer if we were held back by pacing rather than by the window.
+    //
+    void Flush() {
+        const uint16_t Length = PacketLength();
+        while (QuicCongestionControlCanSend(Cc)) {
+            LastSendAllowance =
+                QuicCongestionControlGetSendAllowance(
+                    Cc,
+                    LastSendTimeValid ? TimeNow - LastSendTime : 0,
+                    LastSendTimeValid);
+            if (LastSendAllowance < Length) {
+                if (!PacingTimerArmed) {
+                    PacingTimerArmed = true;
+                    Events.insert({TimeNow + QUIC_SEND_PACING_INTERVAL, {EventPacing, nullptr}});
+                }
+                break;
+            }
+            for (uint32_t i = 0; i < LastSendAllowance / Length && QuicCongestionControlCanSend(Cc); ++i) {
+                SendPacket();
+            }
+            LastSendTime = TimeNow;
+            LastSendTimeValid = true;
+        }
+    }
+
+    //
+    // Runs the simulation, invoking Sample at every sample interval.
+    //
+    template<typename SampleFn>
+    void Run(uint64_t Duration, uint64_t SampleInterval, SampleFn Sample) {
+        const uint64_t EndTime = TimeNow + Duration;
+        uint64_t NextSampleTime = TimeNow + SampleInterval;
+        Flush();
+        while (!Events.empty()) {
+            auto It = Events.begin();
+            const uint64_t EventTime = It->first;
+            const Event Current = It->second;
+            Events.erase(It);
+
+            while (NextSampleTime <= EventTime && NextSampleTime <= EndTime) {
+                Sample();
+                NextSampleTime += SampleInterval;
+            }
+            if (EventTime > EndTime) {
+                if (Current.Packet != nullptr) {
+                    CXPLAT_FREE(Current.Packet, QUIC_POOL_TEST);
+                }
+                break;
+            }
+
+            TimeNow = EventTime;
+            switch (Current.Type) {
+            case EventAck:
+                OnAck(Current.Packet);
+                CXPLAT_FREE(Current.Packet, QUIC_POOL_TEST);
+                break;
+            case EventLoss:
+                OnLoss(Current.Packet);
+                CXPLAT_FREE(Current.Packet, QUIC_POOL_TEST);
+                break;
+            case EventPacing:
+                PacingTimerArmed = false;
+                break;
+            }
+            Flush();
+        }
+    }
+};
+
+//
+// BBR picks its initial ProbeBW gain cycle index with CxPlatRandom, so its
+// pacing rate is only reproducible until it first leaves STARTUP/DRAIN. For
+// those algorithms the pacing column of the trace is only compared up to that
+// point; the congestion window itself is compared for the whole run.
+//
+#define CC_TEST_BBR_STATE_PROBE_BW  2 // BBR_STATE_PROBE_BW, private to bbr.c/bbrresync.c
+#define CC_TEST_BBR_STATE_PROBE_RTT 3 // BBR_STATE_PROBE_RTT
+
+static bool
+CcPacingIsDeterministic(
+    QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm,
+    const QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    switch (Algorithm) {
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_BBR:
+        return Cc->Bbr.BbrState < CC_TEST_BBR_STATE_PROBE_BW;
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC:
+        return Cc->BbrResync.BbrState < CC_TEST_BBR_STATE_PROBE_BW;
+    default:
+        return true;
+    }
+}
+
+static uint8_t
+CcBbrState(
+    QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm,
+    const QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    return
+        Algorithm == QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC ?
+            (uint8_t)Cc->BbrResync.BbrState : (uint8_t)Cc->Bbr.BbrState;
+}
+
+static std::vector<CcTracePoint>
+CcRunGoldenScenario(
+    QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm,
+    bool Policed = false,
+    std::vector<uint8_t>* BbrStates = nullptr
+    )
+{
+    std::vector<CcTracePoint> Trace;
+    bool PacingDeterministic = true;
+    testing::internal::CaptureStdout(); // The algorithms printf on cwnd changes.
+    {
+        CcSimulator Sim(Algorithm, Policed);
+        Sim.Run(
+            Policed ? CC_SIM_POLICED_DURATION : CC_SIM_DURATION,
+            Policed ? CC_SIM_POLICED_SAMPLE_INTERVAL : CC_SIM_SAMPLE_INTERVAL,
+            [&]() {
+            PacingDeterministic =
+                PacingDeterministic && CcPacingIsDeterministic(Algorithm, Sim.Cc);
+            Trace.push_back({
+                QuicCongestionControlGetCongestionWindow(Sim.Cc),
+                PacingDeterministic ? Sim.LastSendAllowance : 0});
+            if (BbrStates != nullptr) {
+                BbrStates->push_back(CcBbrState(Algorithm, Sim.Cc));
+            }
+        });
+    }
+    (void)testing::internal::GetCapturedStdout();
+    return Trace;
+}
+
+static void
+CcPrintTrace(
+    const char* Name,
+    const std::vector<CcTracePoint>& Trace
+    )
+{
+    std::cout << "static const CcTracePoint " << Name << "[] = {" << std::endl;
+    for (auto& Point : Trace) {
+        std::cout << "    " << Point << "," << std::endl;
+    }
+    std::cout << "};" << std::endl;
+}
+
+//
+// Golden traces. Regenerate by running the failing test and pasting the
+// printed array over the old one, after confirming the change in behavior is
+// intended.
+//
+static const CcTracePoint CubicGoldenTrace[] = {
+    { 25040, 1252 },
+    { 100160, 3756 },
+    { 400640, 10016 },
+    { 408986, 834 },
+    { 426677, 997 },
+    { 434784, 340 },
+    { 441372, 668 },
+    { 447606, 642 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 315441, 1189 },
+    { 317436, 316 },
+    { 320883, 371 },
+    { 225211, 220 },
+    { 225211, 1236 },
+    { 225211, 758 },
+    { 225211, 1024 },
+    { 225211, 70 },
+    { 225211, 715 },
+    { 225211, 629 },
+    { 226414, 100 },
+    { 229092, 539 },
+    { 231900, 851 },
+    { 234595, 959 },
+    { 237238, 1118 },
+    { 239693, 372 },
+    { 242050, 414 },
+    { 244334, 719 },
+    { 246442, 379 },
+    { 173205, 1188 },
+    { 173205, 178 },
+    { 173205, 814 },
+    { 173205, 253 },
+    { 173205, 988 },
+    { 173205, 44 },
+};
+
+static const CcTracePoint CubicProbeGoldenTrace[] = {
+    { 25040, 1252 },
+    { 100160, 3756 },
+    { 400640, 10016 },
+    { 417917, 1001 },
+    { 429185, 1001 },
+    { 435445, 1001 },
+    { 441705, 1001 },
+    { 447965, 1001 },
+    { 315328, 1076 },
+    { 327848, 1076 },
+    { 331604, 1076 },
+    { 334108, 1076 },
+    { 337864, 1076 },
+    { 340368, 1076 },
+    { 342872, 1076 },
+    { 346628, 1076 },
+    { 349132, 1076 },
+    { 245268, 545 },
+    { 254032, 1140 },
+    { 257788, 821 },
+    { 260292, 1247 },
+    { 262796, 57 },
+    { 265300, 1198 },
+    { 267804, 1102 },
+    { 269056, 1216 },
+    { 271560, 1230 },
+    { 274064, 1128 },
+    { 275316, 994 },
+    { 277820, 349 },
+    { 280324, 720 },
+    { 280324, 575 },
+    { 197103, 7 },
+    { 205867, 750 },
+    { 208371, 549 },
+    { 210875, 260 },
+    { 212127, 1068 },
+    { 214631, 677 },
+    { 217135, 604 },
+    { 218387, 919 },
+    { 219639, 996 },
+};
+
+static const CcTracePoint BbrResyncGoldenTrace[] = {
+    { 25040, 2504 },
+    { 100160, 2504 },
+    { 400640, 2504 },
+    { 1385964, 2504 },
+    { 1831676, 1252 },
+    { 1370940, 2504 },
+    { 2008208, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+};
+
+static const CcTracePoint BbrGoldenTrace[] = {
+    { 25040, 2504 },
+    { 100160, 2504 },
+    { 400640, 2504 },
+    { 1385964, 2504 },
+    { 1831676, 1252 },
+    { 1370940, 2504 },
+    { 2008208, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+};
+
+static const CcTracePoint BbrResyncPolicedGoldenTrace[] = {
+    { 100160, 2504 },
+    { 1385964, 2504 },
+    { 2008208, 1252 },
+    { 2006956, 1252 },
+    { 2008208, 1252 },
+    { 2021980, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2023232, 1252 },
+    { 2024496, 0 },
+    { 1899284, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 5008, 0 },
+    { 5008, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1342144, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+    { 1468300, 0 },
+};
+
+static const CcTracePoint BbrPolicedGoldenTrace[] = {
+    { 100160, 2504 },
+    { 1385964, 2504 },
+    { 2008208, 1252 },
+    { 2006956, 1252 },
+    { 2008208, 1252 },
+    { 2021980, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2023232, 1252 },
+    { 2024496, 0 },
+    { 1899284, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 1899284, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 1899284, 1252 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+    { 2024496, 0 },
+};
+
+struct CcGoldenTrace {
+    QUIC_CONGESTION_CONTROL_ALGORITHM Algorithm;
+    bool Policed;
+    const char* Name;
+    const CcTracePoint* Points;
+    size_t PointCount;
+};
+
+std::ostream& operator << (std::ostream& o, const CcGoldenTrace& Golden) {
+    return o << Golden.Name;
+}
+
+static const CcGoldenTrace CcGoldenTraces[] = {
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, false, "CubicGoldenTrace", CubicGoldenTrace, ARRAYSIZE(CubicGoldenTrace) },
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_CUBICPROBE, false, "CubicProbeGoldenTrace", CubicProbeGoldenTrace, ARRAYSIZE(CubicProbeGoldenTrace) },
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC, false, "BbrResyncGoldenTrace", BbrResyncGoldenTrace, ARRAYSIZE(BbrResyncGoldenTrace) },
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_BBR, false, "BbrGoldenTrace", BbrGoldenTrace, ARRAYSIZE(BbrGoldenTrace) },
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC, true, "BbrResyncPolicedGoldenTrace", BbrResyncPolicedGoldenTrace, ARRAYSIZE(BbrResyncPolicedGoldenTrace) },
+    { QUIC_CONGESTION_CONTROL_ALGORITHM_BBR, true, "BbrPolicedGoldenTrace", BbrPolicedGoldenTrace, ARRAYSIZE(BbrPolicedGoldenTrace) },
+};
+
+struct CongestionControlTest : public ::testing::TestWithParam<CcGoldenTrace> {
+};
+
+TEST_P(CongestionControlTest, GoldenTrace)
+{
+    const CcGoldenTrace& Golden = GetParam();
+    std::vector<CcTracePoint> Trace = CcRunGoldenScenario(Golden.Algorithm, Golden.Policed);
+    std::vector<CcTracePoint> Expected(Golden.Points, Golden.Points + Golden.PointCount);
+    if (Trace != Expected) {
+        CcPrintTrace(Golden.Name, Trace);
+    }
+    ASSERT_EQ(Expected.size(), Trace.size());
+    for (size_t i = 0; i < Trace.size(); ++i) {
+        ASSERT_EQ(Expected[i], Trace[i]) << "Sample " << i;
+    }
+}
+
+TEST_P(CongestionControlTest, Deterministic)
+{
+    const CcGoldenTrace& Golden = GetParam();
+    ASSERT_EQ(
+        CcRunGoldenScenario(Golden.Algorithm, Golden.Policed),
+        CcRunGoldenScenario(Golden.Algorithm, Golden.Policed));
+}
+
+INSTANTIATE_TEST_SUITE_P(CongestionControlTest, CongestionControlTest, ::testing::ValuesIn(CcGoldenTraces));
+
+//
+// The default scenario's losses are too few and too irregular for BbrResync
+// to do anything BBR wouldn't. Under the policer it must detect the periodic
+// window collapse and force a ProbeRtt, which plain BBR never enters.
+//
+TEST(CongestionControlTest, BbrResyncForcesProbeRtt)
+{
+    std::vector<uint8_t> BbrStates;
+    std::vector<CcTracePoint> BbrTrace =
+        CcRunGoldenScenario(QUIC_CONGESTION_CONTROL_ALGORITHM_BBR, true, &BbrStates);
+    for (auto State : BbrStates) {
+        ASSERT_NE(CC_TEST_BBR_STATE_PROBE_RTT, State);
+    }
+
+    BbrStates.clear();
+    std::vector<CcTracePoint> BbrResyncTrace =
+        CcRunGoldenScenario(QUIC_CONGESTION_CONTROL_ALGORITHM_BBRRESYNC, true, &BbrStates);
+    bool ProbedRtt = false;
+    for (auto State : BbrStates) {
+        ProbedRtt = ProbedRtt || State == CC_TEST_BBR_STATE_PROBE_RTT;
+    }
+    ASSERT_TRUE(ProbedRtt);
+    ASSERT_NE(BbrTrace, BbrResyncTrace);
+}
@@ -0,0 +1,205 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit tests for preparing the next 1-RTT keys ahead of a key update.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "CryptoTest.cpp.clog.h"
+#endif
+
+//
+// A connection with confirmed 1-RTT read and write keys and a 1-RTT packet
+// space, enough to prepare keys and change the key phase.
+//
+struct KeyUpdateTestConnection : public SendTestConnection {
+    QUIC_PACKET_SPACE PacketSpace;
+    const QUIC_VERSION_INFO* VersionInfo = &QuicSupportedVersionList[0];
+
+    KeyUpdateTestConnection() {
+        CxPlatZeroMemory(&PacketSpace, sizeof(PacketSpace));
+        Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT] = &PacketSpace;
+        Connection->State.HandshakeConfirmed = TRUE;
+        Connection->Stats.QuicVersion = VersionInfo->Number;
+        Connection->Settings.MaxBytesPerKey = 1000;
+
+        CXPLAT_SECRET Secret;
+        CxPlatZeroMemory(&Secret, sizeof(Secret));
+        Secret.Hash = CXPLAT_HASH_SHA256;
+        Secret.Aead = CXPLAT_AEAD_AES_128_GCM;
+        for (uint8_t i = 0; i < CxPlatHashLength(Secret.Hash); ++i) {
+            Secret.Secret[i] = i;
+        }
+        QUIC_STATUS Status =
+            QuicPacketKeyDerive(
+                QUIC_PACKET_KEY_1_RTT, &VersionInfo->HkdfLabels, &Secret, "read", TRUE,
+                &Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT]);
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(Status));
+        Secret.Secret[0] = 0xFF;
+        Status =
+            QuicPacketKeyDerive(
+                QUIC_PACKET_KEY_1_RTT, &VersionInfo->HkdfLabels, &Secret, "write", TRUE,
+                &Connection->Crypto.TlsState.WriteKeys[QUIC_PACKET_KEY_1_RTT]);
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(Status));
+    }
+
+    ~KeyUpdateTestConnection() {
+        for (uint32_t i = QUIC_PACKET_KEY_1_RTT; i <= QUIC_PACKET_KEY_1_RTT_NEW; ++i) {
+            QuicPacketKeyFree(Connection->Crypto.TlsState.ReadKeys[i]);
+            QuicPacketKeyFree(Connection->Crypto.TlsState.WriteKeys[i]);
+        }
+    }
+
+    QUIC_PACKET_KEY* Read(QUIC_PACKET_KEY_TYPE Type) const {
+        return Connection->Crypto.TlsState.ReadKeys[Type];
+    }
+
+    QUIC_PACKET_KEY* Write(QUIC_PACKET_KEY_TYPE Type) const {
+        return Connection->Crypto.TlsState.WriteKeys[Type];
+    }
+
+    //
+    // Derives the key a key update moves to from Current. Deriving the update
+    // wipes the old traffic secret, so this works from a copy of Current and
+    // must be called before the connection derives its own.
+    //
+    QUIC_PACKET_KEY* NextKey(QUIC_PACKET_KEY* Current) const {
+        CXPLAT_FRE_ASSERT(Current != NULL);
+        QUIC_PACKET_KEY* Copy = NULL;
+        QUIC_PACKET_KEY* Next = NULL;
+        QUIC_STATUS Status =
+            QuicPacketKeyDerive(
+                QUIC_PACKET_KEY_1_RTT, &VersionInfo->HkdfLabels, Current->TrafficSecret,
+                "copy", FALSE, &Copy);
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(Status));
+        Status = QuicPacketKeyUpdate(&VersionInfo->HkdfLabels, Copy, &Next);
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(Status));
+        QuicPacketKeyFree(Copy);
+        return Next;
+    }
+
+    //
+    // Checks Actual holds the same key material as Expected, then frees
+    // Expected.
+    //
+    static void ValidateKey(QUIC_PACKET_KEY* Expected, QUIC_PACKET_KEY* Actual) {
+        const bool Match =
+            Actual != NULL &&
+            memcmp(Expected->Iv, Actual->Iv, CXPLAT_IV_LENGTH) == 0 &&
+            memcmp(
+                Expected->TrafficSecret->Secret,
+                Actual->TrafficSecret->Secret,
+                CxPlatHashLength(Expected->TrafficSecret->Hash)) == 0;
+        QuicPacketKeyFree(Expected);
+        ASSERT_TRUE(Match);
+    }
+};
+
+TEST(CryptoTest, PrepareNextKeysOnlyWhenLikelyNeeded)
+{
+    KeyUpdateTestConnection Conn;
+
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    ASSERT_EQ(nullptr, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+    ASSERT_EQ(nullptr, Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW));
+
+    Conn.PacketSpace.CurrentKeyPhaseBytesSent = Conn.Connection->Settings.MaxBytesPerKey / 2;
+    Conn.Connection->State.HandshakeConfirmed = FALSE;
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    ASSERT_EQ(nullptr, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+
+    Conn.Connection->State.HandshakeConfirmed = TRUE;
+    QUIC_PACKET_KEY* ExpectedRead = Conn.NextKey(Conn.Read(QUIC_PACKET_KEY_1_RTT));
+    QUIC_PACKET_KEY* ExpectedWrite = Conn.NextKey(Conn.Write(QUIC_PACKET_KEY_1_RTT));
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    KeyUpdateTestConnection::ValidateKey(ExpectedRead, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+    KeyUpdateTestConnection::ValidateKey(ExpectedWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW));
+}
+
+//
+// Keys prepared while idle are kept until the key phase changes, and are the
+// ones the change moves into place.
+//
+TEST(CryptoTest, PreparedKeysUsedAtKeyPhaseChange)
+{
+    KeyUpdateTestConnection Conn;
+    Conn.PacketSpace.CurrentKeyPhaseBytesSent = Conn.Connection->Settings.MaxBytesPerKey / 2;
+
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    QUIC_PACKET_KEY* PreparedRead = Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW);
+    QUIC_PACKET_KEY* PreparedWrite = Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW);
+    ASSERT_NE(nullptr, PreparedRead);
+    ASSERT_NE(nullptr, PreparedWrite);
+
+    //
+    // Going idle again, or generating the keys on demand, keeps them.
+    //
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    TEST_QUIC_SUCCEEDED(QuicCryptoGenerateNewKeys(Conn.Connection));
+    ASSERT_EQ(PreparedRead, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+    ASSERT_EQ(PreparedWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW));
+
+    QUIC_PACKET_KEY* OldRead = Conn.Read(QUIC_PACKET_KEY_1_RTT);
+    QUIC_PACKET_KEY* OldWrite = Conn.Write(QUIC_PACKET_KEY_1_RTT);
+    const BOOLEAN OldKeyPhase = Conn.PacketSpace.CurrentKeyPhase;
+    QuicCryptoUpdateKeyPhase(Conn.Connection, TRUE);
+
+    ASSERT_NE(OldKeyPhase, Conn.PacketSpace.CurrentKeyPhase);
+    ASSERT_EQ(PreparedRead, Conn.Read(QUIC_PACKET_KEY_1_RTT));
+    ASSERT_EQ(PreparedWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT));
+    ASSERT_EQ(OldRead, Conn.Read(QUIC_PACKET_KEY_1_RTT_OLD));
+    ASSERT_EQ(OldWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT_OLD));
+    ASSERT_EQ(nullptr, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+    ASSERT_EQ(nullptr, Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW));
+}
+
+//
+// After the key phase changes, whether or not keys were prepared for it, the
+// next keys are rebuilt from the new current keys rather than reused.
+//
+TEST(CryptoTest, PreparedKeysRebuiltAfterKeyPhaseChange)
+{
+    KeyUpdateTestConnection Conn;
+
+    //
+    // The peer updates before any keys were prepared; they're generated on
+    // demand instead.
+    //
+    TEST_QUIC_SUCCEEDED(QuicCryptoGenerateNewKeys(Conn.Connection));
+    QuicCryptoUpdateKeyPhase(Conn.Connection, FALSE);
+    ASSERT_EQ(nullptr, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+
+    //
+    // Having seen an update, the connection prepares the keys for the next
+    // one once idle, from the keys now in use.
+    //
+    QUIC_PACKET_KEY* ExpectedRead = Conn.NextKey(Conn.Read(QUIC_PACKET_KEY_1_RTT));
+    QUIC_PACKET_KEY* ExpectedWrite = Conn.NextKey(Conn.Write(QUIC_PACKET_KEY_1_RTT));
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    QUIC_PACKET_KEY* PreparedRead = Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW);
+    QUIC_PACKET_KEY* PreparedWrite = Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW);
+    KeyUpdateTestConnection::ValidateKey(ExpectedRead, PreparedRead);
+    KeyUpdateTestConnection::ValidateKey(ExpectedWrite, PreparedWrite);
+
+    //
+    // The phase changes again, consuming them. The keys prepared next follow
+    // on from them, not from the keys they replaced.
+    //
+    QuicCryptoUpdateKeyPhase(Conn.Connection, TRUE);
+    ASSERT_EQ(PreparedRead, Conn.Read(QUIC_PACKET_KEY_1_RTT));
+    ASSERT_EQ(PreparedWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT));
+    ASSERT_EQ(nullptr, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+
+    ExpectedRead = Conn.NextKey(PreparedRead);
+    ExpectedWrite = Conn.NextKey(PreparedWrite);
+    QuicCryptoPrepareNextKeys(Conn.Connection);
+    KeyUpdateTestConnection::ValidateKey(ExpectedRead, Conn.Read(QUIC_PACKET_KEY_1_RTT_NEW));
+    KeyUpdateTestConnection::ValidateKey(ExpectedWrite, Conn.Write(QUIC_PACKET_KEY_1_RTT_NEW));
+    ASSERT_EQ(2u, Conn.Connection->Stats.Misc.KeyUpdateCount);
+}
@@ -0,0 +1,107 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the connection-wide receive flow control window tuning.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "FlowControlTest.cpp.clog.h"
+#endif
+
+//
+// Only the fields used by the window tuning are meaningful.
+//
+struct FlowControlTestConnection : SendTestConnection {
+    uint64_t OldMemoryLimit;
+    uint64_t OldMemoryUsage;
+    FlowControlTestConnection(uint32_t Window, uint64_t MemoryLimit, uint64_t SmoothedRtt) :
+        SendTestConnection(Window),
+        OldMemoryLimit(MsQuicLib.RecvWindowMemoryLimit),
+        OldMemoryUsage(MsQuicLib.CurrentRecvWindowMemoryUsage) {
+        MsQuicLib.RecvWindowMemoryLimit = MemoryLimit;
+        MsQuicLib.CurrentRecvWindowMemoryUsage = 0;
+        Connection->Paths[0].SmoothedRtt = SmoothedRtt;
+    }
+    ~FlowControlTestConnection() {
+        Uninitialize(); // Releases the reserved memory before the limits are restored
+        MsQuicLib.RecvWindowMemoryLimit = OldMemoryLimit;
+        MsQuicLib.CurrentRecvWindowMemoryUsage = OldMemoryUsage;
+    }
+    //
+    // Delivers a full accumulator's worth of data, Elapsed after the last one.
+    //
+    void Drain(uint64_t Elapsed) {
+        const uint64_t Delivered = Send->ConnFlowControlWindow / QUIC_RECV_BUFFER_DRAIN_RATIO;
+        Send->MaxData += Delivered;
+        Send->OrderedStreamBytesDeliveredAccumulator += Delivered;
+        QuicSendTuneConnFlowControlWindow(Send, Send->ConnFlowControlWindowLastUpdate + Elapsed);
+        ASSERT_EQ(0u, Send->OrderedStreamBytesDeliveredAccumulator);
+    }
+};
+
+TEST(FlowControlTest, ConnWindowGrowsWhenDrainedQuickly)
+{
+    const uint32_t Window = 0x100000;
+    FlowControlTestConnection Conn(Window, 3 * Window, MS_TO_US(100));
+    uint64_t Delivered = 0;
+
+    //
+    // The app drained a quarter of the window in half an RTT.
+    //
+    Conn.Drain(MS_TO_US(50));
+    Delivered += Window / QUIC_RECV_BUFFER_DRAIN_RATIO;
+    ASSERT_EQ(2ull * Window, Conn.Send->ConnFlowControlWindow);
+    ASSERT_EQ(Delivered + 2ull * Window, Conn.Send->MaxData);
+    ASSERT_EQ((uint64_t)Window, MsQuicLib.CurrentRecvWindowMemoryUsage);
+
+    //
+    // The app is the bottleneck.
+    //
+    Conn.Drain(S_TO_US(10));
+    Delivered += 2 * Window / QUIC_RECV_BUFFER_DRAIN_RATIO;
+    ASSERT_EQ(2ull * Window, Conn.Send->ConnFlowControlWindow);
+    ASSERT_EQ(Delivered + 2ull * Window, Conn.Send->MaxData);
+
+    Conn.Drain(MS_TO_US(1));
+    Delivered += 2 * Window / QUIC_RECV_BUFFER_DRAIN_RATIO;
+    ASSERT_EQ(4ull * Window, Conn.Send->ConnFlowControlWindow);
+    ASSERT_EQ(Delivered + 4ull * Window, Conn.Send->MaxData);
+    ASSERT_EQ(3ull * Window, MsQuicLib.CurrentRecvWindowMemoryUsage);
+
+    //
+    // The memory limit is reached.
+    //
+    Conn.Drain(MS_TO_US(1));
+    Delivered += 4 * Window / QUIC_RECV_BUFFER_DRAIN_RATIO;
+    ASSERT_EQ(4ull * Window, Conn.Send->ConnFlowControlWindow);
+    ASSERT_EQ(Delivered + 4ull * Window, Conn.Send->MaxData);
+    ASSERT_EQ(3ull * Window, MsQuicLib.CurrentRecvWindowMemoryUsage);
+
+    Conn.Uninitialize();
+    ASSERT_EQ(0u, MsQuicLib.CurrentRecvWindowMemoryUsage);
+}
+
+TEST(FlowControlTest, ConnWindowMemoryLimitShared)
+{
+    const uint32_t Window = 0x10000;
+    FlowControlTestConnection Conn1(Window, Window, MS_TO_US(100));
+    FlowControlTestConnection Conn2(Window, Window, MS_TO_US(100));
+    MsQuicLib.RecvWindowMemoryLimit = Window;
+    MsQuicLib.CurrentRecvWindowMemoryUsage = 0;
+
+    Conn1.Drain(MS_TO_US(10));
+    ASSERT_EQ(2ull * Window, Conn1.Send->ConnFlowControlWindow);
+    Conn2.Drain(MS_TO_US(10));
+    ASSERT_EQ((uint64_t)Window, Conn2.Send->ConnFlowControlWindow);
+
+    Conn1.Uninitialize();
+    Conn2.Drain(MS_TO_US(10));
+    ASSERT_EQ(2ull * Window, Conn2.Send->ConnFlowControlWindow);
+    ASSERT_EQ((uint64_t)Window, MsQuicLib.CurrentRecvWindowMemoryUsage);
+}
@@ -71,6 +71,54 @@ TEST_P(AckFrameTest, AckFrameEncodeDecode)
     QuicRangeUninitialize(&DecodedAckRange);
 }
 
+//
+// Decodes enough ACK blocks to grow the range, both into an empty range and
+// into one already holding values that overlap some of the blocks.
+//
+TEST_P(AckFrameTest, AckFrameDecodeManyBlocks)
+{
+    const uint32_t BlockCount = 200;
+    QUIC_ACK_ECN_EX Ecn = {4, 4, 4};
+    QUIC_ACK_ECN_EX DecodedEcn;
+    QUIC_RANGE AckRange;
+    QUIC_RANGE DecodedAckRange;
+    uint8_t Buffer[2048];
+    uint16_t BufferLength = 0;
+    uint64_t DecodedAckDelay;
+    BOOLEAN InvalidFrame;
+    BOOLEAN Unused;
+
+    QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &AckRange);
+    QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &DecodedAckRange);
+    for (uint32_t i = 0; i < BlockCount; ++i) {
+        ASSERT_TRUE(QuicRangeAddRange(&AckRange, 100 + i * 7, 1 + i % 5, &Unused) != nullptr);
+    }
+    ASSERT_TRUE(QuicAckFrameEncode(&AckRange, 0, (GetParam() == QUIC_FRAME_ACK ? nullptr : &Ecn), &BufferLength, sizeof(Buffer), Buffer));
+
+    uint16_t Offset = 1;
+    ASSERT_TRUE(QuicAckFrameDecode(GetParam(), BufferLength, Buffer, &Offset, &InvalidFrame, &DecodedAckRange, &DecodedEcn, &DecodedAckDelay));
+    ASSERT_EQ(BufferLength, Offset);
+    ASSERT_EQ(BlockCount, QuicRangeSize(&DecodedAckRange));
+    for (uint32_t i = 0; i < BlockCount; ++i) {
+        ASSERT_EQ(QuicRangeGet(&AckRange, i)->Low, QuicRangeGet(&DecodedAckRange, i)->Low);
+        ASSERT_EQ(QuicRangeGet(&AckRange, i)->Count, QuicRangeGet(&DecodedAckRange, i)->Count);
+    }
+
+    QuicRangeReset(&DecodedAckRange);
+    ASSERT_TRUE(QuicRangeAddRange(&DecodedAckRange, 100 + 10 * 7, 100 * 7, &Unused) != nullptr);
+    ASSERT_TRUE(QuicRangeAddRange(&AckRange, 100 + 10 * 7, 100 * 7, &Unused) != nullptr);
+    Offset = 1;
+    ASSERT_TRUE(QuicAckFrameDecode(GetParam(), BufferLength, Buffer, &Offset, &InvalidFrame, &DecodedAckRange, &DecodedEcn, &DecodedAckDelay));
+    ASSERT_EQ(QuicRangeSize(&AckRange), QuicRangeSize(&DecodedAckRange));
+    for (uint32_t i = 0; i < QuicRangeSize(&AckRange); ++i) {
+        ASSERT_EQ(QuicRangeGet(&AckRange, i)->Low, QuicRangeGet(&DecodedAckRange, i)->Low);
+        ASSERT_EQ(QuicRangeGet(&AckRange, i)->Count, QuicRangeGet(&DecodedAckRange, i)->Count);
+    }
+
+    QuicRangeUninitialize(&AckRange);
+    QuicRangeUninitialize(&DecodedAckRange);
+}
+
 TEST_P(AckFrameTest, DecodeAckFrameFail) {
     QUIC_ACK_ECN_EX DecodedEcn;
     uint8_t Buffer[18];
@@ -164,6 +212,92 @@ TEST_P(AckFrameTest, DecodeAckFrameFail) {
     ASSERT_FALSE(Result);
     QuicRangeReset(&DecodedAckBlocks);
 
+    //
+    // Test Case: Second ACK range goes below packet number zero, both when the
+    // range is put in front of the decoded ranges and when it is merged in.
+    //
+    for (auto Merge : {false, true}) {
+        Offset = 1;
+        InvalidFrame = FALSE;
+        BufferLength = 8;
+        Buffer[1] = 10; // Highest ACKed PN
+        Buffer[2] = 1; // ACK Delay
+        Buffer[3] = 1; // ACK range count
+        Buffer[4] = 0; // First ACK range
+        Buffer[5] = 0; // First ACK gap
+        Buffer[6] = 0x40; // Second ACK range (100, two byte encoding)
+        Buffer[7] = 100;
+
+        if (GetParam() == QUIC_FRAME_ACK_1) {
+            BufferLength += 3;
+            Buffer[8] = 1;
+            Buffer[9] = 2;
+            Buffer[10] = 3;
+        }
+
+        if (Merge) {
+            BOOLEAN Unused;
+            ASSERT_TRUE(QuicRangeAddRange(&DecodedAckBlocks, 0, 20, &Unused) != nullptr);
+        }
+
+        Result = QuicAckFrameDecode(GetParam(), BufferLength, Buffer, &Offset, &InvalidFrame, &DecodedAckBlocks, &DecodedEcn, &AckDelay);
+
+        ASSERT_TRUE(InvalidFrame);
+        ASSERT_FALSE(Result);
+        QuicRangeReset(&DecodedAckBlocks);
+    }
+
+    //
+    // Test Case: ACK ranges that end exactly at packet number zero are valid.
+    //
+    Offset = 1;
+    InvalidFrame = FALSE;
+    BufferLength = 7;
+    Buffer[1] = 10; // Highest ACKed PN
+    Buffer[2] = 1; // ACK Delay
+    Buffer[3] = 1; // ACK range count
+    Buffer[4] = 0; // First ACK range
+    Buffer[5] = 0; // First ACK gap
+    Buffer[6] = 8; // Second ACK range
+
+    if (GetParam() == QUIC_FRAME_ACK_1) {
+        BufferLength += 3;
+        Buffer[7] = 1;
+        Buffer[8] = 2;
+        Buffer[9] = 3;
+    }
+
+    Result = QuicAckFrameDecode(GetParam(), BufferLength, Buffer, &Offset, &InvalidFrame, &DecodedAckBlocks, &DecodedEcn, &AckDelay);
+
+    ASSERT_FALSE(InvalidFrame);
+    ASSERT_TRUE(Result);
+    ASSERT_EQ(2u, QuicRangeSize(&DecodedAckBlocks));
+    ASSERT_EQ(0ull, QuicRangeGetMin(&DecodedAckBlocks));
+    ASSERT_EQ(10ull, QuicRangeGetMax(&DecodedAckBlocks));
+    QuicRangeReset(&DecodedAckBlocks);
+
+    Offset = 1;
+    BufferLength = 5;
+    Buffer[1] = 5; // Highest ACKed PN
+    Buffer[2] = 1; // ACK Delay
+    Buffer[3] = 0; // ACK range count
+    Buffer[4] = 5; // First ACK range
+
+    if (GetParam() == QUIC_FRAME_ACK_1) {
+        BufferLength += 3;
+        Buffer[5] = 1;
+        Buffer[6] = 2;
+        Buffer[7] = 3;
+    }
+
+    Result = QuicAckFrameDecode(GetParam(), BufferLength, Buffer, &Offset, &InvalidFrame, &DecodedAckBlocks, &DecodedEcn, &AckDelay);
+
+    ASSERT_FALSE(InvalidFrame);
+    ASSERT_TRUE(Result);
+    ASSERT_EQ(1u, QuicRangeSize(&DecodedAckBlocks));
+    ASSERT_EQ(0ull, QuicRangeGetMin(&DecodedAckBlocks));
+    QuicRangeReset(&DecodedAckBlocks);
+
     //
     // Test Case: ECN fields contain improperly-formatted QUIC VAR INTs.
     //
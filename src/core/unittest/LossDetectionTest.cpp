@@ -0,0 +1,298 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the loss detection tracking of sent packets.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "LossDetectionTest.cpp.clog.h"
+#endif
+
+#include <random>
+#include <set>
+
+#define LOSS_TEST_PACKET_LENGTH 1200
+
+//
+// Adds the rest of the state loss detection reaches while sending and
+// processing 1-RTT ACK frames to a server connection. A send flush is always
+// marked as pending so nothing gets queued to the (fake) worker, and the peer's
+// max ACK delay is large enough that lost packets are never forgotten. The base
+// reference keeps the connection from being freed when its timer is removed
+// from the worker's timer wheel.
+//
+struct LossDetectionTestConnection : SendTestConnection {
+    QUIC_LOSS_DETECTION* LossDetection;
+    QUIC_WORKER* Worker;
+    QUIC_PARTITION* Partition;
+    QUIC_RANGE AckRanges;
+    uint64_t NextPacketNumber {0};
+    std::set<uint64_t> Tracked; // Outstanding or lost packets.
+
+    LossDetectionTestConnection() {
+        Worker = (QUIC_WORKER*)Alloc(sizeof(QUIC_WORKER));
+        Partition = (QUIC_PARTITION*)Alloc(sizeof(QUIC_PARTITION));
+        Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT] =
+            (QUIC_PACKET_SPACE*)Alloc(sizeof(QUIC_PACKET_SPACE));
+
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(QuicTimerWheelInitialize(&Worker->TimerWheel)));
+        QuicSentPacketPoolInitialize(&Partition->SentPacketPool);
+
+        Connection->_.Type = QUIC_HANDLE_TYPE_CONNECTION_SERVER;
+        Connection->RefCount = 1;
+        Connection->Worker = Worker;
+        Connection->Partition = Partition;
+        Connection->EarliestExpirationTime = UINT64_MAX;
+        for (auto& ExpirationTime : Connection->ExpirationTimes) {
+            ExpirationTime = UINT64_MAX;
+        }
+        QuicSettingsSetDefault(&Connection->Settings);
+        Connection->Settings.HandshakeIdleTimeoutMs = 0;
+        Connection->PeerTransportParams.MaxAckDelay = 60000;
+
+        QUIC_PATH* Path = &Connection->Paths[0];
+        Path->IsActive = TRUE;
+        Path->IsPeerValidated = TRUE;
+        Path->IsMinMtuValidated = TRUE;
+        Path->Mtu = 1280;
+        QuicAddrSetFamily(&Path->Route.RemoteAddress, QUIC_ADDRESS_FAMILY_INET);
+        Path->SmoothedRtt = MS_TO_US(Connection->Settings.InitialRttMs);
+        Path->RttVariance = Path->SmoothedRtt / 2;
+        Path->MinRtt = UINT64_MAX;
+        Path->EcnValidationState = ECN_VALIDATION_FAILED;
+        Connection->PathsCount = 1;
+
+        Send->FlushOperationPending = TRUE;
+        QuicCongestionControlInitialize(&Connection->CongestionControl, &Connection->Settings);
+        QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &Connection->DecodedAckRanges);
+        QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &AckRanges);
+
+        LossDetection = &Connection->LossDetection;
+        QuicLossDetectionInitialize(LossDetection);
+    }
+
+    ~LossDetectionTestConnection() {
+        QuicLossDetectionUninitialize(LossDetection);
+        QuicTimerWheelRemoveConnection(&Worker->TimerWheel, Connection);
+        QuicTimerWheelUninitialize(&Worker->TimerWheel);
+        QuicRangeUninitialize(&AckRanges);
+        QuicRangeUninitialize(&Connection->DecodedAckRanges);
+        QuicSentPacketPoolUninitialize(&Partition->SentPacketPool);
+        CXPLAT_FREE(Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT], QUIC_POOL_TEST);
+        CXPLAT_FREE(Partition, QUIC_POOL_TEST);
+        CXPLAT_FREE(Worker, QUIC_POOL_TEST);
+    }
+
+    static void* Alloc(size_t Size) {
+        void* Memory = CXPLAT_ALLOC_NONPAGED(Size, QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Memory != NULL);
+        CxPlatZeroMemory(Memory, Size);
+        return Memory;
+    }
+
+    void SendPacket(uint64_t Skip = 0) {
+        QUIC_MAX_SENT_PACKET_METADATA TempPacket;
+        CxPlatZeroMemory(&TempPacket, sizeof(TempPacket));
+        QUIC_SENT_PACKET_METADATA* Packet = &TempPacket.Metadata;
+        NextPacketNumber += Skip;
+        Packet->PacketNumber = NextPacketNumber++;
+        Packet->PacketLength = LOSS_TEST_PACKET_LENGTH;
+        Packet->SentTime = CxPlatTimeUs64();
+        Packet->Flags.KeyType = QUIC_PACKET_KEY_1_RTT;
+        Packet->Flags.IsAckEliciting = TRUE;
+        Packet->FrameCount = 1;
+        Packet->Frames[0].Type = QUIC_FRAME_PING;
+        QuicLossDetectionOnPacketSent(LossDetection, &Connection->Paths[0], Packet);
+        Tracked.insert(Packet->PacketNumber);
+    }
+
+    //
+    // Acknowledges everything in AckRanges with a single ACK frame.
+    //
+    void Ack() {
+        uint8_t Buffer[8192];
+        uint16_t Offset = 0;
+        ASSERT_TRUE(QuicAckFrameEncode(&AckRanges, 0, nullptr, &Offset, sizeof(Buffer), Buffer));
+        const uint16_t Length = Offset;
+        Offset = 1;
+        QUIC_RX_PACKET Packet;
+        CxPlatZeroMemory(&Packet, sizeof(Packet));
+        BOOLEAN InvalidFrame = FALSE;
+        ASSERT_TRUE(
+            QuicLossDetectionProcessAckFrame(
+                LossDetection, &Connection->Paths[0], &Packet, QUIC_ENCRYPT_LEVEL_1_RTT,
+                QUIC_FRAME_ACK, Length, Buffer, &Offset, &InvalidFrame));
+        ASSERT_FALSE(InvalidFrame);
+
+        for (uint32_t i = 0; i < QuicRangeSize(&AckRanges); ++i) {
+            const QUIC_SUBRANGE* Sub = QuicRangeGet(&AckRanges, i);
+            Tracked.erase(
+                Tracked.lower_bound(Sub->Low),
+                Tracked.upper_bound(QuicRangeGetHigh(Sub)));
+        }
+        Validate();
+    }
+
+    void Ack(uint64_t Low, uint64_t Count) {
+        BOOLEAN Unused;
+        ASSERT_NE(nullptr, QuicRangeAddRange(&AckRanges, Low, Count, &Unused));
+        Ack();
+    }
+
+    std::vector<uint64_t> LostPackets() const {
+        std::vector<uint64_t> PacketNumbers;
+        for (auto Packet = LossDetection->LostPackets; Packet != NULL; Packet = Packet->Next) {
+            PacketNumbers.push_back(Packet->PacketNumber);
+        }
+        return PacketNumbers;
+    }
+
+    void Validate() {
+        std::set<uint64_t> Found;
+        uint32_t PacketsInFlight = 0;
+        for (uint32_t i = 0; i < LossDetection->SentPacketsSpan; ++i) {
+            const QUIC_SENT_PACKET_METADATA* Packet =
+                LossDetection->SentPackets[
+                    (LossDetection->SentPacketsStart + i) & (LossDetection->SentPacketsSize - 1)];
+            if (i == 0 || i == LossDetection->SentPacketsSpan - 1) {
+                ASSERT_NE(nullptr, Packet);
+            }
+            if (Packet != NULL) {
+                ASSERT_EQ(LossDetection->SentPacketsBase + i, Packet->PacketNumber);
+                Found.insert(Packet->PacketNumber);
+                PacketsInFlight++;
+            }
+        }
+        ASSERT_EQ(PacketsInFlight, LossDetection->PacketsInFlight);
+        for (auto PacketNumber : LostPackets()) {
+            ASSERT_TRUE(Found.insert(PacketNumber).second);
+        }
+        ASSERT_EQ(Tracked, Found);
+    }
+};
+
+TEST(LossDetectionTest, InOrderAcks)
+{
+    LossDetectionTestConnection Conn;
+    for (uint32_t i = 0; i < 100; ++i) {
+        Conn.SendPacket();
+    }
+    Conn.Validate();
+    ASSERT_EQ(100u, Conn.LossDetection->PacketsInFlight);
+
+    Conn.Ack(0, 50);
+    ASSERT_EQ(50u, Conn.LossDetection->PacketsInFlight);
+    ASSERT_EQ(50u, Conn.LossDetection->SentPacketsBase);
+    ASSERT_EQ(50u, Conn.LossDetection->SentPacketsSpan);
+
+    Conn.Ack(50, 50);
+    ASSERT_EQ(0u, Conn.LossDetection->PacketsInFlight);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPacketsSpan);
+    ASSERT_TRUE(Conn.LostPackets().empty());
+}
+
+TEST(LossDetectionTest, SkippedPacketNumbers)
+{
+    LossDetectionTestConnection Conn;
+    Conn.SendPacket();
+    Conn.SendPacket(5);
+    Conn.SendPacket(1);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPacketsBase);
+    ASSERT_EQ(9u, Conn.LossDetection->SentPacketsSpan);
+
+    Conn.Ack(0, 1);
+    ASSERT_EQ(6u, Conn.LossDetection->SentPacketsBase);
+    ASSERT_EQ(3u, Conn.LossDetection->SentPacketsSpan);
+    Conn.Ack(6, 1);
+    ASSERT_EQ(8u, Conn.LossDetection->SentPacketsBase);
+    ASSERT_EQ(1u, Conn.LossDetection->SentPacketsSpan);
+    Conn.Ack(8, 1);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPacketsSpan);
+    ASSERT_TRUE(Conn.LostPackets().empty());
+}
+
+TEST(LossDetectionTest, LossAndSpuriousLoss)
+{
+    LossDetectionTestConnection Conn;
+    for (uint32_t i = 0; i < 20; ++i) {
+        Conn.SendPacket();
+    }
+
+    //
+    // Packets 5 to 7 are more than the reordering threshold behind the largest
+    // acknowledged one.
+    //
+    BOOLEAN Unused;
+    ASSERT_NE(nullptr, QuicRangeAddRange(&Conn.AckRanges, 0, 5, &Unused));
+    Conn.Ack(8, 12);
+    ASSERT_EQ(std::vector<uint64_t>({5, 6, 7}), Conn.LostPackets());
+    ASSERT_EQ(0u, Conn.LossDetection->PacketsInFlight);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPacketsSpan);
+    ASSERT_EQ(3u, Conn.Connection->Stats.Send.SuspectedLostPackets);
+
+    Conn.Ack(6, 1);
+    ASSERT_EQ(std::vector<uint64_t>({5, 7}), Conn.LostPackets());
+    ASSERT_EQ(1u, Conn.Connection->Stats.Send.SpuriousLostPackets);
+}
+
+TEST(LossDetectionTest, RingGrowth)
+{
+    LossDetectionTestConnection Conn;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        Conn.SendPacket();
+    }
+    ASSERT_GE(Conn.LossDetection->SentPacketsSize, 1000u);
+    Conn.Validate();
+
+    for (uint64_t i = 1; i < 1000; i += 2) {
+        Conn.Ack(i, 1);
+    }
+    Conn.Ack(0, 1000);
+    ASSERT_EQ(0u, Conn.LossDetection->PacketsInFlight);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPacketsSpan);
+}
+
+//
+// Sends packets, with the occasional skipped packet number, and acknowledges
+// random ranges below the largest sent, repeating older ranges as a receiver
+// does. Every packet must stay tracked, either as outstanding or as lost,
+// until a range covers it.
+//
+TEST(LossDetectionTest, RandomAcks)
+{
+    LossDetectionTestConnection Conn;
+    std::mt19937_64 Random(11);
+
+    for (uint32_t i = 0; i < 2000; ++i) {
+        const uint32_t SendCount = 1 + (uint32_t)(Random() % 16);
+        for (uint32_t j = 0; j < SendCount; ++j) {
+            Conn.SendPacket(Random() % 16 == 0 ? 1 : 0);
+        }
+
+        if (QuicRangeSize(&Conn.AckRanges) > 256) {
+            QuicRangeSetMin(&Conn.AckRanges, QuicRangeGetMax(&Conn.AckRanges) - 512);
+        }
+
+        uint64_t High = Conn.NextPacketNumber - 1;
+        const uint32_t BlockCount = 1 + (uint32_t)(Random() % 4);
+        for (uint32_t j = 0; j < BlockCount; ++j) {
+            const uint64_t Count = CXPLAT_MIN(High + 1, 1 + Random() % 24);
+            BOOLEAN Unused;
+            ASSERT_NE(
+                nullptr,
+                QuicRangeAddRange(&Conn.AckRanges, High + 1 - Count, Count, &Unused));
+            const uint64_t Gap = 1 + Random() % 32;
+            if (High + 1 < Count + Gap) {
+                break;
+            }
+            High -= Count + Gap;
+        }
+        Conn.Ack();
+    }
+}
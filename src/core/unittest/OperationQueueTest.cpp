@@ -0,0 +1,196 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the connection operation queue.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "OperationQueueTest.cpp.clog.h"
+#endif
+
+#include <atomic>
+#include <thread>
+
+//
+// Only the perf counters of the partition are used by the queue.
+//
+struct TestOperationQueue {
+    QUIC_OPERATION_QUEUE OperQ;
+    QUIC_PARTITION* Partition;
+    std::vector<QUIC_OPERATION> Opers;
+    TestOperationQueue(uint32_t OperCount) : Opers(OperCount) {
+        Partition = (QUIC_PARTITION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_PARTITION), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Partition != NULL);
+        CxPlatZeroMemory(Partition, sizeof(QUIC_PARTITION));
+        CxPlatZeroMemory(Opers.data(), sizeof(QUIC_OPERATION) * OperCount);
+        QuicOperationQueueInitialize(&OperQ);
+    }
+    ~TestOperationQueue() {
+        QuicOperationQueueUninitialize(&OperQ);
+        CXPLAT_FREE(Partition, QUIC_POOL_TEST);
+    }
+    BOOLEAN Enqueue(uint32_t Index, QUIC_OPERATION_LANE Lane) {
+        switch (Lane) {
+        case QUIC_OPERATION_LANE_FRONT:
+            return QuicOperationEnqueueFront(&OperQ, Partition, &Opers[Index]);
+        case QUIC_OPERATION_LANE_PRIORITY:
+            return QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[Index]);
+        default:
+            return QuicOperationEnqueue(&OperQ, Partition, &Opers[Index]);
+        }
+    }
+    uint32_t Dequeue() {
+        QUIC_OPERATION* Oper = QuicOperationDequeue(&OperQ, Partition);
+        return Oper == NULL ? UINT32_MAX : (uint32_t)(Oper - Opers.data());
+    }
+    int64_t QueueDepth() const {
+        return Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH];
+    }
+};
+
+TEST(OperationQueueTest, DrainOrder)
+{
+    TestOperationQueue Queue(6);
+    ASSERT_FALSE(QuicOperationHasPriority(&Queue.OperQ));
+    ASSERT_EQ(UINT32_MAX, Queue.Dequeue());
+
+    ASSERT_TRUE(Queue.Enqueue(0, QUIC_OPERATION_LANE_NORMAL));
+    ASSERT_FALSE(Queue.Enqueue(1, QUIC_OPERATION_LANE_NORMAL));
+    ASSERT_FALSE(QuicOperationHasPriority(&Queue.OperQ));
+    ASSERT_FALSE(Queue.Enqueue(2, QUIC_OPERATION_LANE_PRIORITY));
+    ASSERT_FALSE(Queue.Enqueue(3, QUIC_OPERATION_LANE_PRIORITY));
+    ASSERT_FALSE(Queue.Enqueue(4, QUIC_OPERATION_LANE_FRONT));
+    ASSERT_FALSE(Queue.Enqueue(5, QUIC_OPERATION_LANE_FRONT));
+    ASSERT_TRUE(QuicOperationHasPriority(&Queue.OperQ));
+    ASSERT_EQ(6, Queue.QueueDepth());
+
+    const uint32_t Expected[] = { 5, 4, 2, 3, 0, 1 };
+    for (uint32_t i = 0; i < ARRAYSIZE(Expected); ++i) {
+        ASSERT_EQ(Expected[i], Queue.Dequeue());
+        ASSERT_EQ(i < 3, (bool)QuicOperationHasPriority(&Queue.OperQ));
+    }
+    ASSERT_EQ(0, Queue.QueueDepth());
+
+    //
+    // Operations queued while draining don't need the connection scheduled
+    // again, but the first one after the queue was found empty does.
+    //
+    ASSERT_FALSE(Queue.Enqueue(0, QUIC_OPERATION_LANE_NORMAL));
+    ASSERT_EQ(0u, Queue.Dequeue());
+    ASSERT_EQ(UINT32_MAX, Queue.Dequeue());
+    ASSERT_TRUE(Queue.Enqueue(1, QUIC_OPERATION_LANE_PRIORITY));
+    ASSERT_EQ(1u, Queue.Dequeue());
+    ASSERT_EQ(UINT32_MAX, Queue.Dequeue());
+}
+
+TEST(OperationQueueTest, PriorityDuringDrain)
+{
+    TestOperationQueue Queue(4);
+    ASSERT_TRUE(Queue.Enqueue(0, QUIC_OPERATION_LANE_PRIORITY));
+    ASSERT_FALSE(Queue.Enqueue(1, QUIC_OPERATION_LANE_NORMAL));
+    ASSERT_EQ(0u, Queue.Dequeue());
+    ASSERT_FALSE(Queue.Enqueue(2, QUIC_OPERATION_LANE_PRIORITY));
+    ASSERT_FALSE(Queue.Enqueue(3, QUIC_OPERATION_LANE_FRONT));
+    ASSERT_EQ(3u, Queue.Dequeue());
+    ASSERT_EQ(2u, Queue.Dequeue());
+    ASSERT_EQ(1u, Queue.Dequeue());
+    ASSERT_EQ(UINT32_MAX, Queue.Dequeue());
+}
+
+//
+// Many producers queue into all lanes while a single consumer drains, only
+// ever starting a drain when a producer was told to schedule the connection.
+// Every operation must be dequeued exactly once, in queuing order per producer
+// and lane, and at most one schedule may be outstanding at any time.
+//
+TEST(OperationQueueTest, ConcurrentProducers)
+{
+    const uint32_t ProducerCount = 4;
+    const uint32_t OpersPerProducer = 50000;
+    TestOperationQueue Queue(ProducerCount * OpersPerProducer);
+
+    std::vector<uint8_t> Lanes(ProducerCount * OpersPerProducer);
+    std::atomic<uint32_t> PendingSchedules(0);
+    std::atomic<uint32_t> ProducersDone(0);
+    std::atomic<bool> TooManySchedules(false);
+
+    std::vector<std::thread> Producers;
+    for (uint32_t p = 0; p < ProducerCount; ++p) {
+        Producers.emplace_back([&, p]() {
+            uint32_t Seed = p + 1;
+            for (uint32_t i = 0; i < OpersPerProducer; ++i) {
+                const uint32_t Index = p * OpersPerProducer + i;
+                Seed = Seed * 1103515245 + 12345;
+                Lanes[Index] = (uint8_t)((Seed >> 16) % QUIC_OPERATION_LANE_COUNT);
+                if (Queue.Enqueue(Index, (QUIC_OPERATION_LANE)Lanes[Index])) {
+                    if (++PendingSchedules > 1) {
+                        TooManySchedules = true;
+                    }
+                }
+            }
+            ++ProducersDone;
+        });
+    }
+
+    //
+    // The consumer doesn't assert until the producers are joined.
+    //
+    std::vector<uint8_t> Dequeued(ProducerCount * OpersPerProducer, 0);
+    std::vector<uint32_t> LastSequence(ProducerCount * QUIC_OPERATION_LANE_COUNT, UINT32_MAX);
+    uint32_t DequeuedCount = 0;
+    bool LostSchedule = false;
+    bool DuplicateDequeue = false;
+    bool OutOfOrder = false;
+    while (DequeuedCount < ProducerCount * OpersPerProducer && !DuplicateDequeue) {
+        const bool AllQueued = ProducersDone == ProducerCount;
+        if (PendingSchedules == 0) {
+            if (AllQueued) {
+                LostSchedule = true;
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        --PendingSchedules;
+        uint32_t Index;
+        while ((Index = Queue.Dequeue()) != UINT32_MAX) {
+            if (Dequeued[Index]) {
+                DuplicateDequeue = true;
+                break;
+            }
+            Dequeued[Index] = 1;
+            ++DequeuedCount;
+
+            //
+            // The front lane is drained most recent first, the others in
+            // queuing order.
+            //
+            const uint32_t Producer = Index / OpersPerProducer;
+            const uint32_t Sequence = Index % OpersPerProducer;
+            if (Lanes[Index] != QUIC_OPERATION_LANE_FRONT) {
+                uint32_t& Last = LastSequence[Producer * QUIC_OPERATION_LANE_COUNT + Lanes[Index]];
+                if (Last != UINT32_MAX && Last > Sequence) {
+                    OutOfOrder = true;
+                }
+                Last = Sequence;
+            }
+        }
+    }
+
+    for (auto& Producer : Producers) {
+        Producer.join();
+    }
+    ASSERT_FALSE(DuplicateDequeue);
+    ASSERT_FALSE(OutOfOrder);
+    ASSERT_FALSE(LostSchedule);
+    ASSERT_FALSE(TooManySchedules);
+    ASSERT_EQ(ProducerCount * OpersPerProducer, DequeuedCount);
+    ASSERT_EQ(0u, PendingSchedules.load());
+    ASSERT_EQ(0, Queue.QueueDepth());
+}
@@ -478,6 +478,91 @@ TEST(RangeTest, HitMax)
     ASSERT_EQ(range.Max(), MaxCount*2);
 }
 
+TEST(RangeTest, AddBeforeMin)
+{
+    const uint32_t MaxCount = 16;
+    SmartRange range(MaxCount * sizeof(QUIC_SUBRANGE));
+    for (uint32_t i = 0; i < MaxCount; i++) {
+        ASSERT_NE(nullptr, QuicRangeAddRangeBeforeMin(&range.range, 1000 - i * 10, 5));
+    }
+    ASSERT_EQ(range.ValidCount(), MaxCount);
+    ASSERT_EQ(range.Min(), 1000 - (MaxCount - 1) * 10);
+    ASSERT_EQ(range.Max(), 1004ull);
+    for (uint32_t i = 0; i < MaxCount; i++) {
+        ASSERT_EQ(QuicRangeGet(&range.range, i)->Low, 1000 - (MaxCount - 1 - i) * 10);
+    }
+
+    //
+    // Values are never aged out to make room for smaller ones.
+    //
+    ASSERT_EQ(nullptr, QuicRangeAddRangeBeforeMin(&range.range, 10, 5));
+    ASSERT_EQ(range.ValidCount(), MaxCount);
+    range.Add(1010, 5);
+    ASSERT_EQ(range.ValidCount(), MaxCount);
+    ASSERT_EQ(range.Max(), 1014ull);
+}
+
+//
+// Random adds, removes and searches, checked against a bitmap of the values,
+// to cover the gap being moved around and the array growing and shrinking.
+//
+TEST(RangeTest, RandomOperations)
+{
+    const uint32_t MaxValue = 2048;
+    SmartRange range;
+    std::vector<bool> Values(MaxValue, false);
+    uint32_t Seed = 7;
+    auto Random = [&Seed](uint32_t Max) {
+        Seed = Seed * 1103515245 + 12345;
+        return (Seed >> 8) % Max;
+    };
+
+    for (uint32_t i = 0; i < 5000; ++i) {
+        const uint32_t Low = Random(MaxValue);
+        const uint32_t MaxCount = 1 + Random(32);
+        const uint32_t Count = 1 + Random(CXPLAT_MIN(MaxValue - Low, MaxCount));
+        switch (Random(4)) {
+        case 0:
+            range.Remove(Low, Count);
+            for (uint32_t j = Low; j < Low + Count; ++j) {
+                Values[j] = false;
+            }
+            break;
+        case 1: {
+            const int Index = range.FindRange(Low, Count);
+            bool Overlaps = false;
+            for (uint32_t j = Low; j < Low + Count; ++j) {
+                Overlaps |= Values[j];
+            }
+            ASSERT_EQ(Overlaps, IS_FIND_INDEX(Index));
+            break;
+        }
+        default:
+            range.Add(Low, Count);
+            for (uint32_t j = Low; j < Low + Count; ++j) {
+                Values[j] = true;
+            }
+            break;
+        }
+
+        uint32_t Index = 0;
+        for (uint32_t j = 0; j < MaxValue; ++j) {
+            if (!Values[j] || (j != 0 && Values[j - 1])) {
+                continue;
+            }
+            uint32_t k = j;
+            while (k < MaxValue && Values[k]) {
+                ++k;
+            }
+            const QUIC_SUBRANGE* Sub = QuicRangeGetSafe(&range.range, Index++);
+            ASSERT_NE(nullptr, Sub);
+            ASSERT_EQ(j, Sub->Low);
+            ASSERT_EQ(k - j, Sub->Count);
+        }
+        ASSERT_EQ(Index, range.ValidCount());
+    }
+}
+
 TEST(RangeTest, SearchZero)
 {
     SmartRange range;
@@ -752,10 +837,18 @@ TEST(RangeTest, SearchRangeThree)
 
     index = range.FindRange(24, 7);
     ASSERT_TRUE(IS_FIND_INDEX(index));
+#if QUIC_RANGE_USE_BINARY_SEARCH
+    ASSERT_EQ(index, 0);
+#else
     ASSERT_EQ(index, 1);
+#endif
     index = range.FindRange(25, 6);
     ASSERT_TRUE(IS_FIND_INDEX(index));
+#if QUIC_RANGE_USE_BINARY_SEARCH
+    ASSERT_EQ(index, 0);
+#else
     ASSERT_EQ(index, 1);
+#endif
 
     index = range.FindRange(29, 7);
     ASSERT_TRUE(IS_FIND_INDEX(index));
@@ -775,14 +868,14 @@ TEST(RangeTest, SearchRangeThree)
     index = range.FindRange(24, 12);
     ASSERT_TRUE(IS_FIND_INDEX(index));
 #if QUIC_RANGE_USE_BINARY_SEARCH
-    ASSERT_EQ(index, 1);
+    ASSERT_EQ(index, 0);
 #else
     ASSERT_EQ(index, 2);
 #endif
     index = range.FindRange(25, 11);
     ASSERT_TRUE(IS_FIND_INDEX(index));
 #if QUIC_RANGE_USE_BINARY_SEARCH
-    ASSERT_EQ(index, 1);
+    ASSERT_EQ(index, 0);
 #else
     ASSERT_EQ(index, 2);
 #endif
@@ -1180,6 +1180,69 @@ TEST_P(WithMode, IncreaseVirtualLength)
     }
 }
 
+TEST_P(WithMode, WriteReservedThenCopy)
+{
+    RecvBuffer RecvBuf;
+    auto Mode = GetParam();
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, RecvBuf.Initialize(Mode, false, DEF_TEST_BUFFER_LENGTH, LARGE_TEST_BUFFER_LENGTH));
+
+    //
+    // Reserve the space without copying anything, as done for data indicated
+    // straight from a received packet.
+    //
+    uint64_t QuotaConsumed = 0;
+    uint64_t BufferSizeNeeded = 0;
+    BOOLEAN NewDataReady = FALSE;
+    ASSERT_EQ(
+        QUIC_STATUS_SUCCESS,
+        QuicRecvBufferWrite(
+            &RecvBuf.RecvBuf, 0, 20, NULL, LARGE_TEST_BUFFER_LENGTH,
+            &QuotaConsumed, &NewDataReady, &BufferSizeNeeded));
+    ASSERT_TRUE(NewDataReady);
+    ASSERT_EQ(20ull, QuotaConsumed);
+    ASSERT_EQ(20ull, RecvBuf.GetTotalLength());
+
+    {
+        QUIC_BUFFER ReadBuffers[3]{};
+        uint32_t BufferCount = ARRAYSIZE(ReadBuffers);
+        uint64_t ReadOffset{};
+        QuicRecvBufferRead(&RecvBuf.RecvBuf, &ReadOffset, &BufferCount, ReadBuffers);
+        ASSERT_EQ(0ull, ReadOffset);
+        ASSERT_EQ(1u, BufferCount);
+        ASSERT_EQ(20u, ReadBuffers[0].Length);
+    }
+
+    //
+    // Grow the buffer while the read is pending.
+    //
+    uint64_t InOutWriteLength = LARGE_TEST_BUFFER_LENGTH;
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, RecvBuf.Write(20, 512, &InOutWriteLength, &NewDataReady));
+
+    //
+    // Only part of the reserved data is accepted, the rest is copied in first.
+    //
+    uint8_t Data[20];
+    for (uint8_t i = 0; i < sizeof(Data); ++i) {
+        Data[i] = i;
+    }
+    QuicRecvBufferCopyIntoChunks(&RecvBuf.RecvBuf, 8, 12, Data + 8);
+    RecvBuf.Drain(8);
+    ASSERT_TRUE(RecvBuf.HasUnreadData());
+
+    QUIC_BUFFER ReadBuffers[3]{};
+    uint32_t BufferCount = ARRAYSIZE(ReadBuffers);
+    uint64_t ReadOffset{};
+    RecvBuf.Read(&ReadOffset, &BufferCount, ReadBuffers);
+    if (Mode == QUIC_RECV_BUF_MODE_MULTIPLE) {
+        //
+        // The rest of the first read is still pending.
+        //
+        ASSERT_EQ(20ull, ReadOffset);
+    } else {
+        ASSERT_EQ(8ull, ReadOffset);
+    }
+}
+
 // Validate the gap can span the edge of a chunk
 // |0, 1, 2, 3, x, x, x, x| ReadStart:0, ReadLength:4, Ext:0
 // |R, R, R, R, x, x, x, x| ReadStart:0, ReadLength:4, Ext:1
@@ -0,0 +1,521 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the stream send queue ordering.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "SendQueueTest.cpp.clog.h"
+#endif
+
+#include <algorithm>
+#include <random>
+
+extern "C"
+QUIC_STREAM*
+QuicSendGetNextStream(
+    _In_ QUIC_SEND* Send,
+    _Out_ uint32_t* PacketCount
+    );
+
+extern "C"
+BOOLEAN
+QuicSendCanSendStreamNow(
+    _In_ QUIC_STREAM* Stream
+    );
+
+//
+// Only the fields used by the send queue and the stream scheduling checks are
+// meaningful. Server initiated streams are never allowed by the peer, so they
+// are skipped by the scheduler. The base reference keeps the streams from ever
+// being freed by a release.
+//
+struct SendQueueModel : SendTestConnection {
+    std::vector<QUIC_STREAM*> Streams;
+    std::vector<QUIC_STREAM*> Queue;
+    SendQueueModel(uint32_t StreamCount) : Streams(StreamCount) {
+        Connection->Crypto.TlsState.WriteKey = QUIC_PACKET_KEY_1_RTT;
+        Connection->Streams.Types[STREAM_ID_FLAG_IS_CLIENT | STREAM_ID_FLAG_IS_BI_DIR].MaxTotalStreamCount = UINT64_MAX;
+        for (uint32_t i = 0; i < StreamCount; ++i) {
+            QUIC_STREAM* Stream =
+                (QUIC_STREAM*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_STREAM), QUIC_POOL_TEST);
+            CXPLAT_FRE_ASSERT(Stream != NULL);
+            CxPlatZeroMemory(Stream, sizeof(QUIC_STREAM));
+            Stream->Connection = Connection;
+            Stream->RefCount = 1;
+            Stream->ID = ((uint64_t)i << 2) | (i % 5 == 4 ? STREAM_ID_FLAG_IS_SERVER : 0);
+            Stream->Flags.Started = TRUE;
+            Stream->SendPriority = QUIC_STREAM_PRIORITY_DEFAULT;
+            Streams[i] = Stream;
+        }
+    }
+    ~SendQueueModel() {
+        Uninitialize(); // Drops the queue's stream refs before the streams are freed
+        for (auto Stream : Streams) {
+            CXPLAT_FREE(Stream, QUIC_POOL_TEST);
+        }
+    }
+    //
+    // The queue is ordered by priority, with late streams last, then by queuing
+    // order.
+    //
+    static uint32_t QueuePriority(const QUIC_STREAM* Stream) {
+        return Stream->Flags.SendLate ? 0 : (uint32_t)Stream->SendPriority + 1;
+    }
+    void Insert(QUIC_STREAM* Stream) {
+        auto It = Queue.end();
+        while (It != Queue.begin() && QueuePriority(*(It - 1)) < QueuePriority(Stream)) {
+            --It;
+        }
+        Queue.insert(It, Stream);
+    }
+    void SetFlag(uint32_t Index) {
+        QUIC_STREAM* Stream = Streams[Index];
+        if (Stream->SendFlags == 0) {
+            Insert(Stream);
+        }
+        QuicSendSetStreamSendFlag(Send, Stream, QUIC_STREAM_SEND_FLAG_MAX_DATA, FALSE);
+    }
+    void ClearFlag(uint32_t Index) {
+        QUIC_STREAM* Stream = Streams[Index];
+        if (Stream->SendFlags != 0) {
+            Queue.erase(std::find(Queue.begin(), Queue.end(), Stream));
+        }
+        QuicSendClearStreamSendFlag(Send, Stream, QUIC_STREAM_SEND_FLAGS_ALL);
+    }
+    void SetPriority(uint32_t Index, uint16_t Priority) {
+        QUIC_STREAM* Stream = Streams[Index];
+        const uint16_t OldPriority = Stream->SendPriority;
+        if (OldPriority == Priority) {
+            return;
+        }
+        Stream->SendPriority = Priority;
+        if (Stream->SendFlags != 0) {
+            Queue.erase(std::find(Queue.begin(), Queue.end(), Stream));
+            Insert(Stream);
+            QuicSendUpdateStreamPriority(Send, Stream, OldPriority);
+        }
+    }
+    void SetLate(uint32_t Index, BOOLEAN Late) {
+        QUIC_STREAM* Stream = Streams[Index];
+        if (Stream->SendFlags != 0 && Stream->Flags.SendLate != Late) {
+            Queue.erase(std::find(Queue.begin(), Queue.end(), Stream));
+            Stream->Flags.SendLate = Late;
+            Insert(Stream);
+            Stream->Flags.SendLate = !Late;
+        }
+        QuicSendSetStreamLate(Send, Stream, Late);
+    }
+    QUIC_STREAM* GetNext(BOOLEAN RoundRobin) {
+        QuicSendSetStreamSchedulingScheme(
+            Send,
+            RoundRobin ?
+                QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN : QUIC_STREAM_SCHEDULING_SCHEME_FIFO);
+        auto It = std::find_if(Queue.begin(), Queue.end(), [](QUIC_STREAM* Stream) {
+            return !(Stream->ID & STREAM_ID_FLAG_IS_SERVER);
+        });
+        QUIC_STREAM* Expected = NULL;
+        const BOOLEAN Rotate = It != Queue.end() && (RoundRobin || (*It)->Flags.SendIncremental);
+        if (It != Queue.end()) {
+            Expected = *It;
+            if (Rotate) {
+                auto Last = It + 1;
+                while (Last != Queue.end() && QueuePriority(*Last) == QueuePriority(Expected)) {
+                    ++Last;
+                }
+                std::rotate(It, It + 1, Last);
+            }
+        }
+        uint32_t PacketCount;
+        QUIC_STREAM* Stream = QuicSendGetNextStream(Send, &PacketCount);
+        if (Stream != NULL) {
+            EXPECT_EQ(Rotate ? QUIC_STREAM_SEND_BATCH_COUNT : UINT32_MAX, PacketCount);
+        }
+        EXPECT_EQ(Expected, Stream);
+        return Stream;
+    }
+    //
+    // Picks the next stream with the weighted fair scheduler and charges it for
+    // sending Bytes.
+    //
+    static bool FairLess(const QUIC_STREAM* A, const QUIC_STREAM* B) {
+        if (A->Flags.SendLate != B->Flags.SendLate) {
+            return B->Flags.SendLate;
+        }
+        if (A->SendVirtualTime != B->SendVirtualTime) {
+            return A->SendVirtualTime < B->SendVirtualTime;
+        }
+        return A->ID < B->ID;
+    }
+    QUIC_STREAM* GetNextFair(uint32_t Bytes) {
+        QuicSendSetStreamSchedulingScheme(Send, QUIC_STREAM_SCHEDULING_SCHEME_WEIGHTED_FAIR);
+        QUIC_STREAM* Expected = NULL;
+        for (auto Stream : Queue) {
+            if (!(Stream->ID & STREAM_ID_FLAG_IS_SERVER) &&
+                (Expected == NULL || (!Send->FairQueueInvalid && FairLess(Stream, Expected)))) {
+                Expected = Stream;
+            }
+        }
+        uint32_t PacketCount;
+        QUIC_STREAM* Stream = QuicSendGetNextStream(Send, &PacketCount);
+        if (Stream != NULL) {
+            EXPECT_EQ(1u, PacketCount);
+            Send->Scheduler->OnStreamSent(Send, Stream, Bytes);
+        }
+        EXPECT_EQ(Expected, Stream);
+        return Stream;
+    }
+    //
+    // Checks the fair queue holds exactly the queued streams, as a valid heap
+    // followed by streams that can't send.
+    //
+    void ValidateFairQueue() {
+        if (Send->Scheduler->Scheme != QUIC_STREAM_SCHEDULING_SCHEME_WEIGHTED_FAIR ||
+            Send->FairQueueInvalid) {
+            return;
+        }
+        ASSERT_EQ((uint32_t)Queue.size(), Send->FairQueueCount + Send->FairQueueBlockedCount);
+        for (uint32_t i = 0; i < (uint32_t)Queue.size(); ++i) {
+            QUIC_STREAM* Stream = Send->FairQueue[i];
+            ASSERT_EQ(i, Stream->SendFairQueueIndex);
+            ASSERT_NE(Queue.end(), std::find(Queue.begin(), Queue.end(), Stream));
+            if (i >= Send->FairQueueCount) {
+                ASSERT_FALSE(QuicSendCanSendStreamNow(Stream));
+            } else if (i > 0) {
+                const QUIC_STREAM* Parent = Send->FairQueue[(i - 1) / 2];
+                ASSERT_TRUE(
+                    Parent->Flags.SendLate < Stream->Flags.SendLate ||
+                    (Parent->Flags.SendLate == Stream->Flags.SendLate &&
+                     Parent->SendVirtualTime <= Stream->SendVirtualTime));
+            }
+        }
+    }
+    void Validate() {
+        uint32_t Index = 0;
+        uint32_t LevelIndex = 0;
+        uint32_t LevelStreamCount = 0;
+        for (CXPLAT_LIST_ENTRY* Entry = Send->SendStreams.Flink;
+             Entry != &Send->SendStreams;
+             Entry = Entry->Flink, ++Index) {
+            QUIC_STREAM* Stream = CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink);
+            ASSERT_LT(Index, (uint32_t)Queue.size());
+            ASSERT_EQ(Queue[Index], Stream);
+            if (Send->PriorityLevelsInvalid) {
+                continue;
+            }
+            ASSERT_LT(LevelIndex, Send->PriorityLevelCount);
+            const QUIC_SEND_PRIORITY_LEVEL* Level = Send->PriorityLevels + LevelIndex;
+            ASSERT_EQ(Level->Priority, QueuePriority(Stream));
+            ++LevelStreamCount;
+            if (Level->Tail == Entry) {
+                ASSERT_EQ(Level->StreamCount, LevelStreamCount);
+                ++LevelIndex;
+                LevelStreamCount = 0;
+            }
+        }
+        ASSERT_EQ((uint32_t)Queue.size(), Index);
+        if (!Send->PriorityLevelsInvalid) {
+            ASSERT_EQ(LevelIndex, Send->PriorityLevelCount);
+        }
+    }
+};
+
+TEST(SendQueueTest, PriorityOrder)
+{
+    SendQueueModel Model(6);
+    const uint16_t Priorities[] = { 1, 5, 3, 5, 1, 0x7FFF };
+    for (uint32_t i = 0; i < ARRAYSIZE(Priorities); ++i) {
+        Model.SetPriority(i, Priorities[i]);
+    }
+    for (uint32_t i = 0; i < ARRAYSIZE(Priorities); ++i) {
+        Model.SetFlag(i);
+        Model.Validate();
+    }
+    ASSERT_EQ(4u, Model.Send->PriorityLevelCount);
+
+    ASSERT_EQ(Model.Streams[5], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[5], Model.GetNext(TRUE));
+    Model.ClearFlag(5);
+    Model.Validate();
+    ASSERT_EQ(Model.Streams[1], Model.GetNext(TRUE));
+    ASSERT_EQ(Model.Streams[3], Model.GetNext(TRUE));
+    ASSERT_EQ(Model.Streams[1], Model.GetNext(TRUE));
+    Model.Validate();
+
+    Model.SetPriority(0, 6);
+    Model.Validate();
+    ASSERT_EQ(Model.Streams[0], Model.GetNext(FALSE));
+    ASSERT_EQ(4u, Model.Send->PriorityLevelCount);
+}
+
+TEST(SendQueueTest, RandomOperations)
+{
+    const uint32_t StreamCount = 64;
+    const uint16_t Priorities[] = { 0, 1, 2, 100, 0x7FFF, 0x8000, 0xFFFE, 0xFFFF };
+
+    for (uint32_t Invalidate = 0; Invalidate < 2; ++Invalidate) {
+        SendQueueModel Model(StreamCount);
+        std::mt19937 Random(11 + Invalidate);
+
+        for (uint32_t i = 0; i < 20000; ++i) {
+            //
+            // Simulate failing to grow the priority levels.
+            //
+            if (Invalidate && i % 1000 == 500 && !Model.Send->PriorityLevelsInvalid) {
+                Model.Send->PriorityLevelsInvalid = TRUE;
+                Model.Send->PriorityLevelCount = 0;
+            }
+
+            //
+            // And failing to grow the fair queue.
+            //
+            if (Invalidate && i % 1000 == 700 && !Model.Send->FairQueueInvalid &&
+                Model.Send->Scheduler->Scheme == QUIC_STREAM_SCHEDULING_SCHEME_WEIGHTED_FAIR) {
+                Model.Send->FairQueueInvalid = TRUE;
+                Model.Send->FairQueueCount = 0;
+                Model.Send->FairQueueBlockedCount = 0;
+            }
+
+            const uint32_t Index = Random() % StreamCount;
+            switch (Random() % 9) {
+            case 0:
+                Model.ClearFlag(Index);
+                break;
+            case 1:
+                Model.SetPriority(Index, Priorities[Random() % ARRAYSIZE(Priorities)]);
+                break;
+            case 2:
+                Model.GetNext(Random() % 2 == 0);
+                break;
+            case 3:
+                Model.GetNextFair(1 + Random() % 1500);
+                break;
+            case 4:
+                Model.SetLate(Index, Random() % 4 == 0);
+                break;
+            case 5:
+                Model.Streams[Index]->Flags.SendIncremental = Random() % 2 == 0;
+                break;
+            default:
+                Model.SetFlag(Index);
+                break;
+            }
+            Model.Validate();
+            Model.ValidateFairQueue();
+        }
+
+        for (uint32_t i = 0; i < StreamCount; ++i) {
+            Model.ClearFlag(i);
+        }
+        Model.Validate();
+        ASSERT_FALSE(Model.Send->PriorityLevelsInvalid);
+        ASSERT_EQ(0u, Model.Send->PriorityLevelCount);
+        ASSERT_FALSE(Model.Send->FairQueueInvalid);
+        ASSERT_EQ(0u, Model.Send->FairQueueCount);
+        ASSERT_EQ(0u, Model.Send->FairQueueBlockedCount);
+    }
+}
+
+//
+// Under FIFO, incremental streams take turns within their priority while other
+// streams are still sent one after another.
+//
+TEST(SendQueueTest, Incremental)
+{
+    SendQueueModel Model(4);
+    Model.Streams[1]->Flags.SendIncremental = TRUE;
+    Model.Streams[2]->Flags.SendIncremental = TRUE;
+    for (uint32_t i = 0; i < 4; ++i) {
+        Model.SetFlag(i);
+    }
+
+    ASSERT_EQ(Model.Streams[0], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[0], Model.GetNext(FALSE));
+    Model.ClearFlag(0);
+    ASSERT_EQ(Model.Streams[1], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[2], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[3], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[3], Model.GetNext(FALSE));
+    Model.ClearFlag(3);
+    ASSERT_EQ(Model.Streams[1], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[2], Model.GetNext(FALSE));
+    ASSERT_EQ(Model.Streams[1], Model.GetNext(FALSE));
+    Model.Validate();
+}
+
+//
+// A stream found past its deadline when it comes up to send goes behind all
+// the streams still on time, whatever their priority, until a new deadline is
+// set.
+//
+TEST(SendQueueTest, DeadlineDemotion)
+{
+    SendQueueModel Model(4);
+    Model.SetPriority(3, 0);
+    for (uint32_t i = 0; i < 4; ++i) {
+        Model.SetFlag(i);
+    }
+    Model.Streams[0]->SendDeadline = 1;
+    Model.Streams[1]->SendDeadline = UINT64_MAX;
+
+    uint32_t PacketCount;
+    ASSERT_EQ(Model.Streams[1], QuicSendGetNextStream(Model.Send, &PacketCount));
+    ASSERT_TRUE(Model.Streams[0]->Flags.SendLate);
+    ASSERT_FALSE(Model.Streams[1]->Flags.SendLate);
+    Model.Queue.erase(Model.Queue.begin());
+    Model.Insert(Model.Streams[0]);
+    ASSERT_EQ(Model.Streams[0], Model.Queue.back());
+    Model.Validate();
+
+    Model.ClearFlag(1);
+    Model.ClearFlag(2);
+    ASSERT_EQ(Model.Streams[3], Model.GetNext(FALSE));
+    Model.ClearFlag(3);
+    ASSERT_EQ(Model.Streams[0], Model.GetNext(FALSE));
+
+    //
+    // Going idle doesn't reset it, but a new deadline does.
+    //
+    Model.ClearFlag(0);
+    Model.SetFlag(3);
+    Model.SetFlag(0);
+    ASSERT_EQ(Model.Streams[0], Model.Queue.back());
+    Model.Validate();
+    Model.Streams[0]->SendDeadline = 0;
+    Model.SetLate(0, FALSE);
+    Model.Validate();
+    ASSERT_EQ(Model.Streams[0], Model.GetNext(FALSE));
+
+    //
+    // The fair scheduler sends late streams last too.
+    //
+    Model.SetLate(0, TRUE);
+    Model.SetFlag(1);
+    ASSERT_EQ(Model.Streams[1], Model.GetNextFair(1000));
+    Model.ClearFlag(1);
+    ASSERT_EQ(Model.Streams[3], Model.GetNextFair(1000));
+    Model.ClearFlag(3);
+    ASSERT_EQ(Model.Streams[0], Model.GetNextFair(1000));
+    Model.ValidateFairQueue();
+}
+
+//
+// The weighted fair scheduler splits the packets in proportion to priority + 1,
+// and a stream that starts sending later gets its share from then on, not a
+// catch up burst.
+//
+TEST(SendQueueTest, WeightedFairShares)
+{
+    SendQueueModel Model(4);
+    const uint16_t Priorities[] = { 0, 1, 3, 3 };
+    for (uint32_t i = 0; i < ARRAYSIZE(Priorities); ++i) {
+        Model.SetPriority(i, Priorities[i]);
+    }
+    for (uint32_t i = 0; i < 3; ++i) {
+        Model.SetFlag(i);
+    }
+
+    uint32_t Counts[4] = { 0 };
+    for (uint32_t i = 0; i < 7000; ++i) {
+        QUIC_STREAM* Stream = Model.GetNextFair(1000);
+        ASSERT_NE(nullptr, Stream);
+        Counts[Stream->ID >> 2]++;
+        if (i % 100 == 0) {
+            Model.ValidateFairQueue();
+        }
+    }
+    ASSERT_NEAR(1000, Counts[0], 2);
+    ASSERT_NEAR(2000, Counts[1], 2);
+    ASSERT_NEAR(4000, Counts[2], 2);
+
+    Model.SetFlag(3);
+    Model.ValidateFairQueue();
+    CxPlatZeroMemory(Counts, sizeof(Counts));
+    for (uint32_t i = 0; i < 1100; ++i) {
+        QUIC_STREAM* Stream = Model.GetNextFair(1000);
+        ASSERT_NE(nullptr, Stream);
+        Counts[Stream->ID >> 2]++;
+        if (i < 8) {
+            ASSERT_LE(Counts[3], 4u);
+        }
+    }
+    ASSERT_NEAR(100, Counts[0], 2);
+    ASSERT_NEAR(200, Counts[1], 2);
+    ASSERT_NEAR(400, Counts[2], 2);
+    ASSERT_NEAR(400, Counts[3], 2);
+    Model.ValidateFairQueue();
+
+    //
+    // Switching back and forth keeps the queue.
+    //
+    QuicSendSetStreamSchedulingScheme(Model.Send, QUIC_STREAM_SCHEDULING_SCHEME_FIFO);
+    ASSERT_EQ(nullptr, Model.Send->FairQueue);
+    Model.Validate();
+    Model.GetNextFair(1000);
+    Model.ValidateFairQueue();
+}
+
+//
+// The fair scheduler keeps streams that can't send out of its heap until it
+// is told they may be unblocked, and they then start from the current virtual
+// time rather than with the credit they built up while blocked.
+//
+TEST(SendQueueTest, WeightedFairBlocked)
+{
+    SendQueueModel Model(5);
+    for (uint32_t i = 0; i < 5; ++i) {
+        Model.SetFlag(i);
+    }
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_NE(Model.Streams[4], Model.GetNextFair(1000));
+    }
+    ASSERT_EQ(4u, Model.Send->FairQueueCount);
+    ASSERT_EQ(1u, Model.Send->FairQueueBlockedCount);
+    ASSERT_EQ(Model.Streams[4], Model.Send->FairQueue[4]);
+    Model.ValidateFairQueue();
+
+    //
+    // Nothing changed, so telling the scheduler leaves the stream blocked.
+    //
+    QuicSendStreamUnblocked(Model.Send, Model.Streams[4]);
+    QuicSendStreamsUnblocked(Model.Send);
+    ASSERT_EQ(1u, Model.Send->FairQueueBlockedCount);
+
+    Model.Streams[4]->ID &= ~(uint64_t)STREAM_ID_FLAG_IS_SERVER;
+    QuicSendStreamUnblocked(Model.Send, Model.Streams[4]);
+    ASSERT_EQ(0u, Model.Send->FairQueueBlockedCount);
+    ASSERT_EQ(Model.Send->FairQueueVirtualTime, Model.Streams[4]->SendVirtualTime);
+    Model.ValidateFairQueue();
+
+    //
+    // A stream blocking while others are blocked, and being dequeued while
+    // blocked.
+    //
+    Model.Streams[4]->ID |= STREAM_ID_FLAG_IS_SERVER;
+    Model.Streams[2]->ID |= STREAM_ID_FLAG_IS_SERVER;
+    for (uint32_t i = 0; i < 3; ++i) {
+        Model.GetNextFair(1000);
+    }
+    ASSERT_EQ(2u, Model.Send->FairQueueBlockedCount);
+    Model.ValidateFairQueue();
+    Model.ClearFlag(4);
+    ASSERT_EQ(1u, Model.Send->FairQueueBlockedCount);
+    Model.ValidateFairQueue();
+    Model.SetFlag(4);
+    Model.ValidateFairQueue();
+
+    Model.Streams[2]->ID &= ~(uint64_t)STREAM_ID_FLAG_IS_SERVER;
+    Model.Streams[4]->ID &= ~(uint64_t)STREAM_ID_FLAG_IS_SERVER;
+    QuicSendStreamsUnblocked(Model.Send);
+    ASSERT_EQ(0u, Model.Send->FairQueueBlockedCount);
+    Model.ValidateFairQueue();
+    Model.ClearFlag(2);
+    Model.ClearFlag(4);
+}
@@ -0,0 +1,175 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the worker timer wheel.
+
+--*/
+
+#include "main.h"
+#ifdef QUIC_CLOG
+#include "TimerWheelTest.cpp.clog.h"
+#endif
+
+#include <map>
+#include <random>
+
+//
+// Only the fields used by the timer wheel are meaningful. The base reference
+// keeps the connection from ever being freed by a release.
+//
+struct TestConnection {
+    QUIC_CONNECTION* Connection;
+    TestConnection() {
+        Connection = (QUIC_CONNECTION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Connection != NULL);
+        CxPlatZeroMemory(Connection, sizeof(QUIC_CONNECTION));
+        Connection->RefCount = 1;
+        Connection->EarliestExpirationTime = UINT64_MAX;
+    }
+    ~TestConnection() {
+        CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+    }
+};
+
+struct TimerWheelModel {
+    QUIC_TIMER_WHEEL TimerWheel;
+    std::map<QUIC_CONNECTION*, uint64_t> Expirations;
+    TimerWheelModel() {
+        CXPLAT_FRE_ASSERT(QUIC_SUCCEEDED(QuicTimerWheelInitialize(&TimerWheel)));
+    }
+    ~TimerWheelModel() {
+        QuicTimerWheelUninitialize(&TimerWheel);
+    }
+    void Update(QUIC_CONNECTION* Connection, uint64_t ExpirationTime) {
+        Connection->EarliestExpirationTime = ExpirationTime;
+        QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+        if (ExpirationTime == UINT64_MAX) {
+            Expirations.erase(Connection);
+        } else {
+            Expirations[Connection] = ExpirationTime;
+        }
+    }
+    void Remove(QUIC_CONNECTION* Connection) {
+        QuicTimerWheelRemoveConnection(&TimerWheel, Connection);
+        Expirations.erase(Connection);
+    }
+    void GetExpired(uint64_t TimeNow) {
+        CXPLAT_LIST_ENTRY ExpiredTimers;
+        CxPlatListInitializeHead(&ExpiredTimers);
+        QuicTimerWheelGetExpired(&TimerWheel, TimeNow, &ExpiredTimers);
+        while (!CxPlatListIsEmpty(&ExpiredTimers)) {
+            CXPLAT_LIST_ENTRY* Entry = CxPlatListRemoveHead(&ExpiredTimers);
+            Entry->Flink = NULL;
+            QUIC_CONNECTION* Connection =
+                CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
+            auto It = Expirations.find(Connection);
+            ASSERT_NE(It, Expirations.end());
+            ASSERT_LE(It->second, TimeNow);
+            Expirations.erase(It);
+            QuicConnRelease(Connection, QUIC_CONN_REF_WORKER);
+        }
+        for (auto& It : Expirations) {
+            ASSERT_GT(It.second, TimeNow);
+        }
+    }
+    void Validate() {
+        uint64_t NextExpirationTime = UINT64_MAX;
+        for (auto& It : Expirations) {
+            NextExpirationTime = CXPLAT_MIN(NextExpirationTime, It.second);
+        }
+        ASSERT_EQ(NextExpirationTime, TimerWheel.NextExpirationTime);
+        ASSERT_EQ((uint64_t)Expirations.size(), TimerWheel.ConnectionCount);
+        if (NextExpirationTime != UINT64_MAX) {
+            ASSERT_EQ(NextExpirationTime, Expirations[TimerWheel.NextConnection]);
+        }
+    }
+};
+
+TEST(TimerWheelTest, Empty)
+{
+    TimerWheelModel Model;
+    Model.Validate();
+    Model.GetExpired(CxPlatTimeUs64());
+    Model.Validate();
+}
+
+TEST(TimerWheelTest, ExpiresInOrder)
+{
+    TimerWheelModel Model;
+    TestConnection Connections[4];
+    const uint64_t TimeNow = CxPlatTimeUs64();
+    const uint64_t Delays[4] = { S_TO_US(60), 1, MS_TO_US(25), 64 * 64 };
+    for (uint32_t i = 0; i < 4; ++i) {
+        Model.Update(Connections[i].Connection, TimeNow + Delays[i]);
+        Model.Validate();
+    }
+    ASSERT_EQ(Connections[1].Connection, Model.TimerWheel.NextConnection);
+
+    Model.GetExpired(TimeNow + 1);
+    Model.Validate();
+    Model.GetExpired(TimeNow + MS_TO_US(25) - 1);
+    Model.Validate();
+    ASSERT_EQ(Connections[2].Connection, Model.TimerWheel.NextConnection);
+    Model.GetExpired(TimeNow + S_TO_US(60));
+    Model.Validate();
+    ASSERT_EQ(UINT64_MAX, Model.TimerWheel.NextExpirationTime);
+}
+
+TEST(TimerWheelTest, AlreadyExpired)
+{
+    TimerWheelModel Model;
+    TestConnection Connections[2];
+    const uint64_t TimeNow = CxPlatTimeUs64() + S_TO_US(1);
+    Model.GetExpired(TimeNow);
+    Model.Update(Connections[0].Connection, TimeNow + 10);
+    Model.Update(Connections[1].Connection, TimeNow - MS_TO_US(100));
+    Model.Validate();
+    ASSERT_EQ(Connections[1].Connection, Model.TimerWheel.NextConnection);
+    Model.GetExpired(TimeNow);
+    Model.Validate();
+    Model.Remove(Connections[0].Connection);
+    Model.Validate();
+}
+
+TEST(TimerWheelTest, RandomOperations)
+{
+    const uint32_t ConnectionCount = 256;
+    const uint64_t Ranges[] = { 100, MS_TO_US(50), S_TO_US(2), S_TO_US(3600ull) };
+
+    TimerWheelModel Model;
+    std::vector<TestConnection> Connections(ConnectionCount);
+    std::mt19937_64 Random(7);
+    uint64_t TimeNow = CxPlatTimeUs64();
+
+    for (uint32_t i = 0; i < 20000; ++i) {
+        QUIC_CONNECTION* Connection = Connections[Random() % ConnectionCount].Connection;
+        switch (Random() % 8) {
+        case 0:
+            Model.Remove(Connection);
+            break;
+        case 1:
+            Model.Update(Connection, UINT64_MAX);
+            break;
+        case 2:
+            Model.GetExpired(TimeNow);
+            TimeNow += Random() % Ranges[Random() % ARRAYSIZE(Ranges)];
+            break;
+        case 3:
+            Model.Update(Connection, TimeNow - Random() % MS_TO_US(10));
+            break;
+        default:
+            Model.Update(Connection, TimeNow + Random() % Ranges[Random() % ARRAYSIZE(Ranges)]);
+            break;
+        }
+        Model.Validate();
+    }
+
+    for (auto& Connection : Connections) {
+        Model.Remove(Connection.Connection);
+    }
+    Model.Validate();
+}
@@ -19,6 +19,38 @@
 #define COMPARE_TP_FIELD(TpName, Field) \
     if (A->Flags & QUIC_TP_FLAG_##TpName) { ASSERT_EQ(A->Field, B->Field); }
 
+//
+// A zeroed connection with only its send state initialized, for unit tests of
+// the send path. Uninitialize may be called early to check what it releases;
+// it only runs once.
+//
+struct SendTestConnection {
+    QUIC_CONNECTION* Connection;
+    QUIC_SEND* Send;
+    bool SendInitialized;
+    SendTestConnection(uint32_t ConnFlowControlWindow = 0) {
+        Connection = (QUIC_CONNECTION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_CONNECTION), QUIC_POOL_TEST);
+        CXPLAT_FRE_ASSERT(Connection != NULL);
+        CxPlatZeroMemory(Connection, sizeof(QUIC_CONNECTION));
+        Send = &Connection->Send;
+        QUIC_SETTINGS_INTERNAL Settings;
+        CxPlatZeroMemory(&Settings, sizeof(Settings));
+        Settings.ConnFlowControlWindow = ConnFlowControlWindow;
+        QuicSendInitialize(Send, &Settings);
+        SendInitialized = true;
+    }
+    ~SendTestConnection() {
+        Uninitialize();
+        CXPLAT_FREE(Connection, QUIC_POOL_TEST);
+    }
+    void Uninitialize() {
+        if (SendInitialized) {
+            QuicSendUninitialize(Send);
+            SendInitialized = false;
+        }
+    }
+};
+
 QUIC_INLINE
 std::ostream& operator << (std::ostream& o, const QUIC_FRAME_TYPE& type) {
     switch (type) {
@@ -507,6 +507,77 @@ QuicWorkerProcessTimers(
     }
 }
 
+//
+// With rebalancing enabled, an overloaded worker moves the connection it just
+// drained to the least loaded worker on the same NUMA node, if that one is idle
+// or has at most half the queue delay. The move goes through the same path as
+// following an RSS change: the connection switches partition and gets new
+// source CIDs, and the timers move with it when it is next processed. Only
+// server connections are moved; a client's socket is bound to its partition.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerTryRebalanceConnection(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint64_t TimeNow
+    )
+{
+    if (!MsQuicLib.RebalanceConnections ||
+        Worker->AverageQueueDelay < QUIC_WORKER_REBALANCE_QUEUE_DELAY_US ||
+        CxPlatListIsEmptyNoFence(&Worker->Connections) ||
+        CxPlatTimeDiff64(Worker->LastRebalanceTime, TimeNow) < QUIC_WORKER_REBALANCE_INTERVAL_US) {
+        return;
+    }
+
+    if (!QuicConnIsServer(Connection) ||
+        Connection->Registration == NULL ||
+        Connection->Registration->NoPartitioning ||
+        !Connection->State.Connected ||
+        Connection->State.ShutdownComplete ||
+        Connection->State.UpdateWorker) {
+        return;
+    }
+
+    QUIC_WORKER_POOL* WorkerPool = Connection->Registration->WorkerPool;
+    if (Worker->Partition->Index >= WorkerPool->WorkerCount ||
+        &WorkerPool->Workers[Worker->Partition->Index] != Worker) {
+        return; // Not one of the registration's partitioned workers.
+    }
+
+    QUIC_WORKER* Target = NULL;
+    uint32_t TargetQueueDelay = Worker->AverageQueueDelay / 2;
+    for (uint16_t i = 0; i < WorkerPool->WorkerCount; ++i) {
+        QUIC_WORKER* Other = &WorkerPool->Workers[i];
+        if (Other == Worker || Other->Partition->NumaNode != Worker->Partition->NumaNode) {
+            continue;
+        }
+        const uint32_t QueueDelay = Other->IsActive ? Other->AverageQueueDelay : 0;
+        if (QueueDelay <= TargetQueueDelay) {
+            TargetQueueDelay = QueueDelay;
+            Target = Other;
+        }
+    }
+    if (Target == NULL) {
+        return;
+    }
+
+    QuicTraceLogConnInfo(
+        WorkerRebalance,
+        Connection,
+        "Moving to partition %hu to rebalance (QueueDelay=%u, Target=%u)",
+        Target->Partition->Index,
+        Worker->AverageQueueDelay,
+        TargetQueueDelay);
+    Worker->LastRebalanceTime = TimeNow;
+
+    //
+    // Keep the RSS based partition update from moving it straight back.
+    //
+    Connection->Paths[0].PartitionUpdated = TRUE;
+    QuicConnMoveToPartition(Connection, Target->Partition->Index);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicWorkerProcessConnection(
@@ -575,8 +646,9 @@ QuicWorkerProcessConnection(
     // Process some operations.
     //
     BOOLEAN StillHasPriorityWork = FALSE;
-    BOOLEAN StillHasWorkToDo =
-        QuicConnDrainOperations(Connection, &StillHasPriorityWork) | Connection->State.UpdateWorker;
+    BOOLEAN StillHasWorkToDo = QuicConnDrainOperations(Connection, &StillHasPriorityWork);
+    QuicWorkerTryRebalanceConnection(Worker, Connection, *TimeNow);
+    StillHasWorkToDo |= Connection->State.UpdateWorker;
     Connection->WorkerThreadID = 0;
 
     //
@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 //
 // A worker thread for draining queued operations on a connection.
 //
@@ -46,6 +50,11 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     uint32_t AverageQueueDelay;
 
+    //
+    // The last time a connection was moved off this worker to balance load.
+    //
+    uint64_t LastRebalanceTime;
+
     //
     // Timers for the worker's connections.
     //
@@ -198,3 +207,7 @@ QuicWorkerQueueOperation(
     _In_ QUIC_WORKER* Worker,
     _In_ QUIC_OPERATION* Operation
     );
+
+#if defined(__cplusplus)
+}
+#endif
@@ -219,6 +219,9 @@ namespace Microsoft.Quic
         NO_IDEAL_PROC = 0x0008,
         HIGH_PRIORITY = 0x0010,
         AFFINITIZE = 0x0020,
+        SQPOLL = 0x0040,
+        BUSY_POLL = 0x0080,
+        REBALANCE = 0x0100,
     }
 
     internal unsafe partial struct QUIC_GLOBAL_EXECUTION_CONFIG
@@ -190,6 +190,9 @@ DEFINE_ENUM_FLAG_OPERATORS(QUIC_SEND_RESUMPTION_FLAGS)
 typedef enum QUIC_STREAM_SCHEDULING_SCHEME {
     QUIC_STREAM_SCHEDULING_SCHEME_FIFO          = 0x0000,   // Sends stream data first come, first served. (Default)
     QUIC_STREAM_SCHEDULING_SCHEME_ROUND_ROBIN   = 0x0001,   // Sends stream data evenly multiplexed.
+#ifdef QUIC_API_ENABLE_PREVIEW_FEATURES
+    QUIC_STREAM_SCHEDULING_SCHEME_WEIGHTED_FAIR = 0x0002,   // Shares bandwidth between streams in proportion to priority + 1.
+#endif
     QUIC_STREAM_SCHEDULING_SCHEME_COUNT,                    // The number of stream scheduling schemes.
 } QUIC_STREAM_SCHEDULING_SCHEME;
 
@@ -277,6 +280,9 @@ typedef enum QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS {
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_NO_IDEAL_PROC    = 0x0008,
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_HIGH_PRIORITY    = 0x0010,
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_AFFINITIZE       = 0x0020,
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_SQPOLL           = 0x0040, // Linux io_uring only
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL        = 0x0080, // Linux epoll only
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE        = 0x0100, // Move connections off overloaded workers
 } QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS;
 
 DEFINE_ENUM_FLAG_OPERATORS(QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS)
@@ -1083,6 +1089,22 @@ typedef struct QUIC_SCHANNEL_CONTEXT_ATTRIBUTE_EX_W {
 #define QUIC_PARAM_STREAM_STATISTICS                    0X08000004  // QUIC_STREAM_STATISTICS
 #ifdef QUIC_API_ENABLE_PREVIEW_FEATURES
 #define QUIC_PARAM_STREAM_RELIABLE_OFFSET               0x08000005  // uint64_t
+#define QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE             0x08000006  // BOOLEAN
+#define QUIC_PARAM_STREAM_INCREMENTAL                   0x08000007  // BOOLEAN
+#define QUIC_PARAM_STREAM_SEND_DEADLINE                 0x08000008  // QUIC_STREAM_SEND_DEADLINE
+
+typedef enum QUIC_STREAM_SEND_DEADLINE_FLAGS {
+    QUIC_STREAM_SEND_DEADLINE_FLAG_NONE     = 0x0000,
+    QUIC_STREAM_SEND_DEADLINE_FLAG_ABORT    = 0x0001,   // Abort the send direction instead of deprioritizing the stream.
+} QUIC_STREAM_SEND_DEADLINE_FLAGS;
+
+DEFINE_ENUM_FLAG_OPERATORS(QUIC_STREAM_SEND_DEADLINE_FLAGS)
+
+typedef struct QUIC_STREAM_SEND_DEADLINE {
+    uint64_t TimeoutUs;                     // From now. Zero clears the deadline.
+    QUIC_STREAM_SEND_DEADLINE_FLAGS Flags;
+    QUIC_UINT62 AbortErrorCode;             // Used with QUIC_STREAM_SEND_DEADLINE_FLAG_ABORT.
+} QUIC_STREAM_SEND_DEADLINE;
 #endif
 
 typedef
@@ -1728,6 +1750,28 @@ QUIC_STATUS
     _In_reads_(BufferCount) const QUIC_BUFFER* Buffers
     );
 
+#ifndef _KERNEL_MODE
+//
+// Sends Length bytes of the file, starting at Offset, on an open stream. The
+// data is read from the file straight into each packet as it is sent, without
+// first being copied into app or send buffers. The file handle may be closed
+// once the call returns; the file contents must not change until
+// SEND_COMPLETE. If the file can no longer be read (e.g. it was truncated),
+// the send is canceled and the stream's send direction is aborted.
+//
+typedef
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+(QUIC_API * QUIC_STREAM_SEND_FILE_FN)(
+    _In_ _Pre_defensive_ HQUIC Stream,
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    );
+#endif // _KERNEL_MODE
+
 #endif
 
 //
@@ -1860,6 +1904,7 @@ typedef struct QUIC_API_TABLE {
     QUIC_EXECUTION_CREATE_FN            ExecutionCreate;    // Available from v2.5
     QUIC_EXECUTION_DELETE_FN            ExecutionDelete;    // Available from v2.5
     QUIC_EXECUTION_POLL_FN              ExecutionPoll;      // Available from v2.5
+    QUIC_STREAM_SEND_FILE_FN            StreamSendFile;     // Available from v2.6
 #endif // _KERNEL_MODE
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
 
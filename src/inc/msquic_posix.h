@@ -529,6 +529,12 @@ QuicAddrToString(
     return TRUE;
 }
 
+//
+// File Abstraction
+//
+
+typedef int QUIC_FILE;
+
 //
 // Event Queue Abstraction
 //
@@ -378,6 +378,12 @@ QuicAddrToString(
 
 #endif // WINAPI_FAMILY != WINAPI_FAMILY_GAMES
 
+//
+// File Abstraction
+//
+
+typedef HANDLE QUIC_FILE;
+
 //
 // Event Queue Abstraction
 //
@@ -329,6 +329,47 @@ CxPlatDecrypt(
         uint8_t* Buffer
     );
 
+//
+// A single packet in a batched encrypt (or decrypt) call. The fields have the
+// same meaning as the corresponding CxPlatEncrypt/CxPlatDecrypt parameters.
+//
+typedef struct CXPLAT_CRYPT_BATCH_ENTRY {
+    const uint8_t* Iv; // CXPLAT_IV_LENGTH bytes
+    const uint8_t* AuthData;
+    uint8_t* Buffer;
+    uint16_t AuthDataLength;
+    uint16_t BufferLength;
+} CXPLAT_CRYPT_BATCH_ENTRY;
+
+//
+// Encrypts a batch of buffers with the same key, as if CxPlatEncrypt were
+// called on each entry in order. Stops at the first failure.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _In_reads_(BatchSize)
+        const CXPLAT_CRYPT_BATCH_ENTRY* Entries
+    );
+
+//
+// Decrypts a batch of buffers with the same key, as if CxPlatDecrypt were
+// called on each entry. A failed entry doesn't stop the others; the status of
+// each entry is written to Results and the first failure is returned.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _In_reads_(BatchSize)
+        const CXPLAT_CRYPT_BATCH_ENTRY* Entries,
+    _Out_writes_(BatchSize)
+        QUIC_STATUS* Results
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 CxPlatHpKeyCreate(
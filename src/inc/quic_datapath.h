@@ -601,6 +601,11 @@ typedef struct CXPLAT_UDP_CONFIG {
     uint8_t CibirIdOffsetSrc;           // CIBIR ID offset in source CID
     uint8_t CibirIdOffsetDst;           // CIBIR ID offset in destination CID
     uint8_t CibirId[6];                 // CIBIR ID data
+
+    // used for CID based receive steering of server sockets (Linux)
+    uint8_t CidPartitionIdOffset;       // Partition ID offset in server issued CIDs
+    uint16_t CidPartitionMask;          // Mask applied to the partition ID
+    uint16_t CidPartitionCount;         // Value of 0 indicates CID steering isn't used
 } CXPLAT_UDP_CONFIG;
 
 //
@@ -698,6 +703,19 @@ CxPlatSocketGetRemoteAddress(
     _Out_ QUIC_ADDR* Address
     );
 
+#if defined(QUIC_TEST_APIS) && defined(CX_PLATFORM_LINUX) && \
+    !defined(CXPLAT_USE_IO_URING) && !defined(CXPLAT_USE_SHM_DATAPATH)
+//
+// Queries the largest number of messages any of the socket's contexts
+// currently posts per recvmmsg call. Zero if nothing has been received yet.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint16_t
+CxPlatSocketGetRecvBatchSize(
+    _In_ CXPLAT_SOCKET* Socket
+    );
+#endif
+
 //
 // Queries a raw socket availability.
 //
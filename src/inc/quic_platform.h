@@ -161,6 +161,9 @@ typedef struct CXPLAT_SLIST_ENTRY {
 #define QUIC_POOL_DATAPATH_RSS_CONFIG       'F4cQ' // Qc4F - QUIC Datapath RSS configuration
 #define QUIC_POOL_TLS_AUX_DATA              '05cQ' // Qc50 - QUIC TLS Backing Aux data
 #define QUIC_POOL_TLS_RECORD_ENTRY          '15cQ' // Qc51 - QUIC TLS Backing Record storage
+#define QUIC_POOL_SENT_PACKET_RING          '25cQ' // Qc52 - QUIC Sent Packet Ring
+#define QUIC_POOL_SEND_PRIORITY_LEVELS      '35cQ' // Qc53 - QUIC Send Priority Levels
+#define QUIC_POOL_SEND_FAIR_QUEUE           '45cQ' // Qc54 - QUIC Send Fair Queue
 
 typedef enum CXPLAT_THREAD_FLAGS {
     CXPLAT_THREAD_FLAG_NONE               = 0x0000,
@@ -510,6 +513,15 @@ CxPlatWorkerPoolRelease(
     _In_ CXPLAT_WORKER_POOL* WorkerPool
     );
 
+//
+// Returns the time, in microseconds, the workers keep polling after their last
+// work before sleeping; zero if the pool doesn't busy poll.
+//
+uint32_t
+CxPlatWorkerPoolGetBusyPollTimeout(
+    _In_ CXPLAT_WORKER_POOL* WorkerPool
+    );
+
 uint32_t
 CxPlatWorkerPoolGetIdealProcessor(
     _In_ CXPLAT_WORKER_POOL* WorkerPool,
@@ -556,6 +568,39 @@ CxPlatRemoveDynamicPoolAllocator(
     _Inout_ CXPLAT_POOL_EX* Pool
     );
 
+//
+// Opens a private handle for reading Length bytes of the file, starting at
+// Offset. The caller's handle may be closed once this returns; the region is
+// read with CxPlatFileRead until the private handle is closed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileOpenRegion(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_ QUIC_FILE* RegionFile
+    );
+
+//
+// Reads exactly Length bytes at Offset. Fails with QUIC_STATUS_INVALID_STATE
+// if the file no longer holds them (i.e. it was truncated).
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileRead(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_writes_bytes_(Length) uint8_t* Buffer
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatFileClose(
+    _In_ QUIC_FILE File
+    );
+
 #endif // !_KERNEL_MODE
 
 //
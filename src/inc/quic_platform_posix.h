@@ -245,6 +245,17 @@ InterlockedFetchAndClearPointer(
     return __sync_fetch_and_and(Target, 0);
 }
 
+QUIC_INLINE
+void*
+InterlockedCompareExchangePointer(
+    _Inout_ _Interlocked_operand_ void* volatile *Destination,
+    _In_opt_ void* ExChange,
+    _In_opt_ void* Comperand
+    )
+{
+    return __sync_val_compare_and_swap(Destination, Comperand, ExChange);
+}
+
 QUIC_INLINE
 short
 InterlockedIncrement16(
@@ -1002,6 +1013,7 @@ extern "C++" {
 #if defined(__cplusplus)
 } // extern "C++"
 #endif
+#include <sys/resource.h>
 
 typedef struct CXPLAT_EVENTQ {
     struct io_uring Ring;
@@ -1016,6 +1028,11 @@ typedef struct CXPLAT_EVENTQ {
     uint32_t ContentionCount;
 #endif
     BOOLEAN NeedsSubmit;
+    //
+    // Size of the ring's (sparse) registered file table. File descriptors
+    // below this are registered at the slot matching their value.
+    //
+    uint32_t FixedFileCount;
 } CXPLAT_EVENTQ;
 typedef struct io_uring_cqe* CXPLAT_CQE;
 typedef
@@ -1050,6 +1067,31 @@ typedef enum CXPLAT_IO_RING_BUF_GROUP {
     CxPlatIoRingBufGroupRecv,
 } CXPLAT_IO_RING_BUF_GROUP;
 
+#define CXPLAT_EVENTQ_MAX_FIXED_FILES 16384
+
+QUIC_INLINE
+void
+CxPlatEventQRegisterFileTable(
+    _Inout_ CXPLAT_EVENTQ* Queue
+    )
+{
+    //
+    // The kernel caps the table at the open file limit, which also bounds the
+    // descriptor values, so a table of that size can hold every socket.
+    // Failure is not fatal; sockets just aren't registered.
+    //
+    struct rlimit Limit;
+    if (getrlimit(RLIMIT_NOFILE, &Limit) != 0) {
+        return;
+    }
+    const uint32_t Count =
+        Limit.rlim_cur < CXPLAT_EVENTQ_MAX_FIXED_FILES ?
+            (uint32_t)Limit.rlim_cur : CXPLAT_EVENTQ_MAX_FIXED_FILES;
+    if (io_uring_register_files_sparse(&Queue->Ring, Count) == 0) {
+        Queue->FixedFileCount = Count;
+    }
+}
+
 QUIC_INLINE
 BOOLEAN
 CxPlatEventQInitialize(
@@ -1068,7 +1110,53 @@ CxPlatEventQInitialize(
         | IORING_SETUP_COOP_TASKRUN
 #endif
         ;
-    return 0 == io_uring_queue_init_params(4096, &Queue->Ring, &params); // TODO - make size configurable
+    if (0 != io_uring_queue_init_params(4096, &Queue->Ring, &params)) { // TODO - make size configurable
+        return FALSE;
+    }
+    CxPlatEventQRegisterFileTable(Queue);
+    return TRUE;
+}
+
+//
+// Initializes the queue with a kernel thread polling its submission queue, so
+// submitting IO no longer requires entering the kernel while the thread is
+// awake.
+//
+QUIC_INLINE
+BOOLEAN
+CxPlatEventQInitializeSqPoll(
+    _Out_ CXPLAT_EVENTQ* Queue,
+    _In_ uint32_t IdleTimeMs,       // Time the polling thread spins before sleeping.
+    _In_opt_ const CXPLAT_EVENTQ* SharedQueue // Reuses its polling thread instead.
+    )
+{
+    CxPlatZeroMemory(Queue, sizeof(*Queue));
+    CxPlatLockInitialize(&Queue->Lock);
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    //
+    // N.B. The task run flags are only valid without SQPOLL.
+    //
+    params.flags = IORING_SETUP_SQPOLL
+#ifdef IORING_SETUP_SUBMIT_ALL
+        | IORING_SETUP_SUBMIT_ALL
+#endif
+        ;
+    params.sq_thread_idle = IdleTimeMs;
+    //
+    // N.B. The polling thread is left unpinned (no IORING_SETUP_SQ_AFF) so it
+    // never competes with a worker thread for the worker's own processor.
+    //
+    if (SharedQueue != NULL) {
+        params.flags |= IORING_SETUP_ATTACH_WQ;
+        params.wq_fd = (uint32_t)SharedQueue->Ring.ring_fd;
+    }
+    if (0 != io_uring_queue_init_params(4096, &Queue->Ring, &params)) {
+        CxPlatLockUninitialize(&Queue->Lock);
+        return FALSE;
+    }
+    CxPlatEventQRegisterFileTable(Queue);
+    return TRUE;
 }
 
 QUIC_INLINE
@@ -1080,6 +1168,38 @@ CxPlatEventQCleanup(
     io_uring_queue_exit(&Queue->Ring);
 }
 
+//
+// Registers the file descriptor in the queue's registered file table, at the
+// slot matching its value. Returns FALSE if it could not be registered.
+//
+QUIC_INLINE
+BOOLEAN
+CxPlatEventQRegisterFile(
+    _In_ CXPLAT_EVENTQ* Queue,
+    _In_ int Fd
+    )
+{
+    if (Fd < 0 || (uint32_t)Fd >= Queue->FixedFileCount) {
+        return FALSE;
+    }
+    return io_uring_register_files_update(&Queue->Ring, (unsigned)Fd, &Fd, 1) == 1;
+}
+
+//
+// Must be called before closing a registered file descriptor, as the ring
+// holds a reference on the file while it is registered.
+//
+QUIC_INLINE
+void
+CxPlatEventQUnregisterFile(
+    _In_ CXPLAT_EVENTQ* Queue,
+    _In_ int Fd
+    )
+{
+    int Empty = -1;
+    (void)io_uring_register_files_update(&Queue->Ring, (unsigned)Fd, &Empty, 1);
+}
+
 QUIC_INLINE
 BOOLEAN
 CxPlatEventQEnqueue(
@@ -1579,6 +1699,14 @@ CxPlatProcCurrentNumber(
     void
     );
 
+//
+// Returns the NUMA node of the processor, or 0 if unknown.
+//
+uint32_t
+CxPlatProcNumaNode(
+    _In_ uint32_t Index
+    );
+
 //
 // Rundown Protection Interfaces.
 //
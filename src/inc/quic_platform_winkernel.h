@@ -925,6 +925,28 @@ extern uint32_t CxPlatProcessorCount;
 #define CxPlatProcCount() CxPlatProcessorCount
 #define CxPlatProcCurrentNumber() (KeGetCurrentProcessorIndex() % CxPlatProcessorCount)
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_INLINE
+uint32_t
+CxPlatProcNumaNode(
+    _In_ uint32_t Index
+    )
+{
+    PROCESSOR_NUMBER ProcNumber;
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX Info;
+    ULONG InfoLength = sizeof(Info);
+    if (!NT_SUCCESS(KeGetProcessorNumberFromIndex(Index, &ProcNumber)) ||
+        !NT_SUCCESS(
+            KeQueryLogicalProcessorRelationship(
+                &ProcNumber,
+                RelationNumaNode,
+                &Info,
+                &InfoLength))) {
+        return 0;
+    }
+    return Info.NumaNode.NodeNumber;
+}
+
 //
 // Rundown Protection Interfaces
 //
@@ -1087,6 +1087,23 @@ CxPlatProcCurrentNumber(
     return CxPlatProcNumberToIndex(&ProcNumber);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_INLINE
+uint32_t
+CxPlatProcNumaNode(
+    _In_ uint32_t Index
+    ) {
+    PROCESSOR_NUMBER ProcNumber;
+    ProcNumber.Group = CxPlatProcessorInfo[Index].Group;
+    ProcNumber.Number = CxPlatProcessorInfo[Index].Index;
+    ProcNumber.Reserved = 0;
+    USHORT NodeNumber;
+    if (!GetNumaProcessorNodeEx(&ProcNumber, &NodeNumber) || NodeNumber == MAXUSHORT) {
+        return 0;
+    }
+    return NodeNumber;
+}
+
 
 //
 // Create Thread Interfaces
@@ -68,6 +68,17 @@ typedef struct CXPLAT_TOEPLITZ_HASH {
     CXPLAT_TOEPLITZ_LOOKUP_TABLE LookupTableArray[CXPLAT_TOEPLITZ_LOOKUP_TABLE_COUNT_MAX];
     uint8_t HashKey[CXPLAT_TOEPLITZ_KEY_SIZE_MAX];
     CXPLAT_TOEPLITZ_INPUT_SIZE InputSize;
+    //
+    // Set by CxPlatToeplitzHashInitialize if the CPU has a carry-less multiply
+    // instruction (CLMUL on x64, PMULL on ARM64), in which case the hash is
+    // computed 4 input bytes at a time from KeyWindows instead of the lookup
+    // tables.
+    //
+    BOOLEAN UseClmul;
+    //
+    // The bit-reversed 64-bit window of the key starting at each input byte.
+    //
+    uint64_t KeyWindows[CXPLAT_TOEPLITZ_INPUT_SIZE_MAX];
 } CXPLAT_TOEPLITZ_HASH;
 
 //
@@ -92,6 +103,22 @@ CxPlatToeplitzHashCompute(
     _In_ uint32_t HashInputOffset
     );
 
+//
+// Computes the Toeplitz hash of each of HashInputCount inputs, all of the same
+// length and at the same offset.
+//
+void
+CxPlatToeplitzHashComputeBatch(
+    _In_ const CXPLAT_TOEPLITZ_HASH* Toeplitz,
+    _In_ uint32_t HashInputCount,
+    _In_reads_(HashInputCount)
+        const uint8_t* const* HashInputs,
+    _In_ uint32_t HashInputLength,
+    _In_ uint32_t HashInputOffset,
+    _Out_writes_(HashInputCount)
+        uint32_t* Hashes
+    );
+
 //
 // Computes the Toeplitz hash of a QUIC address.
 //
@@ -11,6 +11,10 @@ Abstract:
 
 #include "PerfClient.h"
 
+#ifndef _KERNEL_MODE
+#include "histogram/hdr_histogram.h"
+#endif
+
 #ifdef QUIC_CLOG
 #include "PerfClient.cpp.clog.h"
 #endif
@@ -156,6 +160,8 @@ PerfClient::Init(
     TryGetValue(argc, argv, "pstream", &PrintStreams);
     TryGetValue(argc, argv, "platency", &PrintLatency);
     TryGetValue(argc, argv, "plat", &PrintLatency);
+    const char* BucketVarNames[] = {"pbucket", "pbkt", nullptr};
+    TryGetVariableUnitValue(argc, argv, BucketVarNames, &BucketInterval);
 
     //
     // Scenario options
@@ -209,6 +215,27 @@ PerfClient::Init(
         StreamCount = 1; // Just up/down args imply they want a stream
     }
 
+    if (BucketInterval) {
+#ifdef _KERNEL_MODE
+        WriteOutput("'pbucket' is not supported in kernel mode!\n");
+        return QUIC_STATUS_NOT_SUPPORTED;
+#else
+        uint64_t BucketWindow = RunTime;
+        if (Timed) {
+            BucketWindow = CXPLAT_MAX(BucketWindow, CXPLAT_MAX(Upload, Download));
+        }
+        if (BucketWindow == 0) {
+            BucketWindow = PERF_DEFAULT_BUCKET_WINDOW;
+        }
+        uint64_t Count = BucketWindow / BucketInterval + 2; // Slack for handshake and shutdown
+        if (Count > PERF_MAX_TIME_BUCKETS) {
+            Count = PERF_MAX_TIME_BUCKETS;
+            WriteOutput("Warning! Limiting time buckets to %llu\n", (unsigned long long)Count);
+        }
+        BucketCount = (uint32_t)Count;
+#endif
+    }
+
     if (RepeatStreams && !StreamCount) {
         WriteOutput("Must specify a 'streams' if using 'rstream'!\n");
         return QUIC_STATUS_INVALID_PARAMETER;
@@ -312,6 +339,7 @@ PerfClient::Start(
         nullptr
     };
     const size_t TargetLen = strlen(Target.get());
+    BucketStartTime = CxPlatTimeUs64();
     for (uint32_t i = 0; i < WorkerCount; ++i) {
         auto Worker = &Workers[i];
         Worker->Processor = (uint16_t)i;
@@ -324,6 +352,14 @@ PerfClient::Start(
             Worker->ConnectionsQueued++;
         }
 
+        // Only workers with connections need time buckets.
+        if (BucketCount && Worker->ConnectionsQueued) {
+            Worker->TimeBuckets.reset(new(std::nothrow) PerfTimeBucket[BucketCount]);
+            if (!Worker->TimeBuckets) {
+                return QUIC_STATUS_OUT_OF_MEMORY;
+            }
+        }
+
         // Build up target hostname.
         Worker->Target.reset(new(std::nothrow) char[TargetLen + 10]);
         CxPlatCopyMemory(Worker->Target.get(), Target.get(), TargetLen);
@@ -409,6 +445,10 @@ PerfClient::Wait(
         }
     }
 
+    if (BucketCount) {
+        PrintTimeBuckets();
+    }
+
     return QUIC_STATUS_SUCCESS;
 }
 
@@ -442,6 +482,152 @@ PerfClient::GetExtraData(
     CxPlatCopyMemory(Data, LatencyValues.get(), (size_t)(Count * sizeof(uint32_t)));
 }
 
+void
+PerfClient::PrintTimeBuckets(
+    )
+{
+#ifndef _KERNEL_MODE
+    //
+    // The workers are all stopped at this point, so their buckets are merged
+    // without any synchronization. Trailing buckets without activity aren't
+    // printed.
+    //
+    uint32_t ActiveBucketCount = 0;
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        if (!Workers[i].TimeBuckets) {
+            continue;
+        }
+        for (uint32_t j = ActiveBucketCount; j < BucketCount; ++j) {
+            const auto& Bucket = Workers[i].TimeBuckets[j];
+            if (Bucket.BytesSent || Bucket.BytesReceived || Bucket.RequestsCompleted) {
+                ActiveBucketCount = j + 1;
+            }
+        }
+    }
+
+    struct hdr_histogram* Merged = nullptr;
+    if (hdr_init(1, PERF_BUCKET_MAX_LATENCY, PERF_BUCKET_LATENCY_PRECISION, &Merged)) {
+        WriteOutput("Failed to create histogram\n");
+        return;
+    }
+
+    WriteOutput("Bucket: t_ms,up_kbps,down_kbps,requests,p50_us,p99_us,p999_us\n");
+    for (uint32_t i = 0; i < ActiveBucketCount; ++i) {
+        uint64_t BytesSent = 0;
+        uint64_t BytesReceived = 0;
+        uint64_t RequestsCompleted = 0;
+        hdr_reset(Merged);
+        for (uint32_t j = 0; j < WorkerCount; ++j) {
+            if (!Workers[j].TimeBuckets) {
+                continue;
+            }
+            const auto& Bucket = Workers[j].TimeBuckets[i];
+            BytesSent += Bucket.BytesSent;
+            BytesReceived += Bucket.BytesReceived;
+            RequestsCompleted += Bucket.RequestsCompleted;
+            if (Bucket.Latency) {
+                hdr_add(Merged, Bucket.Latency);
+            }
+        }
+        const bool HasLatency = Merged->total_count != 0;
+        WriteOutput(
+            "Bucket: %llu,%llu,%llu,%llu,%lld,%lld,%lld\n",
+            (unsigned long long)US_TO_MS(i * BucketInterval),
+            (unsigned long long)(BytesSent * 8 * 1000 / BucketInterval),
+            (unsigned long long)(BytesReceived * 8 * 1000 / BucketInterval),
+            (unsigned long long)RequestsCompleted,
+            HasLatency ? (long long)hdr_value_at_percentile(Merged, 50.0) : 0ll,
+            HasLatency ? (long long)hdr_value_at_percentile(Merged, 99.0) : 0ll,
+            HasLatency ? (long long)hdr_value_at_percentile(Merged, 99.9) : 0ll);
+    }
+
+    hdr_close(Merged);
+#endif
+}
+
+PerfTimeBucket*
+PerfClientWorker::GetTimeBucket(
+    _In_ uint64_t Now
+    ) {
+    if (!TimeBuckets || !Client->Running) {
+        return nullptr;
+    }
+    const uint64_t Index = CxPlatTimeDiff64(Client->BucketStartTime, Now) / Client->BucketInterval;
+    if (Index >= Client->BucketCount) {
+        return nullptr;
+    }
+    return &TimeBuckets[(size_t)Index];
+}
+
+void
+PerfClientWorker::RecordBytes(
+    _In_ uint64_t Now,
+    _In_ uint64_t BytesSent,
+    _In_ uint64_t BytesReceived
+    ) {
+    auto Bucket = GetTimeBucket(Now);
+    if (Bucket) {
+        if (BytesSent) {
+            InterlockedExchangeAdd64((int64_t*)&Bucket->BytesSent, (int64_t)BytesSent);
+        }
+        if (BytesReceived) {
+            InterlockedExchangeAdd64((int64_t*)&Bucket->BytesReceived, (int64_t)BytesReceived);
+        }
+    }
+}
+
+void
+PerfClientWorker::RecordLatency(
+    _In_ uint64_t Now,
+    _In_ uint64_t Latency
+    ) {
+#ifndef _KERNEL_MODE
+    auto Bucket = GetTimeBucket(Now);
+    if (!Bucket) {
+        return;
+    }
+
+    struct hdr_histogram* Histogram = Bucket->Latency;
+    if (Histogram == nullptr) {
+        //
+        // Histograms are comparatively large, so they are only allocated for
+        // buckets that actually complete requests. The lock is only taken for
+        // the first request of each bucket.
+        //
+        Lock.Acquire();
+        Histogram = Bucket->Latency;
+        if (Histogram == nullptr &&
+            hdr_init(1, PERF_BUCKET_MAX_LATENCY, PERF_BUCKET_LATENCY_PRECISION, &Histogram) == 0) {
+            InterlockedExchangePointer((void**)&Bucket->Latency, Histogram);
+        }
+        Lock.Release();
+        if (Histogram == nullptr) {
+            return;
+        }
+    }
+
+    hdr_record_value_atomic(
+        Histogram,
+        (int64_t)CXPLAT_MIN(Latency, (uint64_t)PERF_BUCKET_MAX_LATENCY));
+    InterlockedIncrement64((int64_t*)&Bucket->RequestsCompleted);
+#else
+    UNREFERENCED_PARAMETER(Now);
+    UNREFERENCED_PARAMETER(Latency);
+#endif
+}
+
+void
+PerfClientWorker::FreeTimeBuckets() {
+#ifndef _KERNEL_MODE
+    if (TimeBuckets) {
+        for (uint32_t i = 0; i < Client->BucketCount; ++i) {
+            hdr_close(TimeBuckets[i].Latency);
+        }
+        TimeBuckets.reset(nullptr);
+    }
+#endif
+}
+
 void
 PerfClientWorker::WorkerThread() {
 #ifdef QUIC_COMPARTMENT_ID
@@ -907,6 +1093,9 @@ PerfClientStream::OnSendComplete(
     BytesOutstanding -= Length;
     if (!Canceled) {
         BytesAcked += Length;
+        if (Connection.Client.BucketCount) {
+            Connection.Worker.RecordBytes(CxPlatTimeUs64(), Length, 0);
+        }
         Send();
         if (SendComplete && BytesAcked == BytesSent) {
             OnSendShutdown();
@@ -952,10 +1141,19 @@ PerfClientStream::OnReceive(
         RecvStartTime = Now;
     }
 
+    if (Connection.Client.BucketCount) {
+        if (Now == 0) {
+            Now = CxPlatTimeUs64();
+        }
+        Connection.Worker.RecordBytes(Now, 0, Length);
+    }
+
     if (Finished) {
         OnReceiveShutdown(Now);
     } else if (Connection.Client.Timed) {
-        if (Now == 0) Now = CxPlatTimeUs64();
+        if (Now == 0) {
+            Now = CxPlatTimeUs64();
+        }
         if (CxPlatTimeDiff64(RecvStartTime, Now) >= Connection.Client.Download) {
             if (Connection.Client.UseTCP) {
                 auto SendData = Connection.Worker.TcpSendDataPool.Alloc();
@@ -1030,6 +1228,9 @@ PerfClientStream::OnShutdown() {
                 Client.LatencyValues[(size_t)Index] = Latency > UINT32_MAX ? UINT32_MAX : (uint32_t)Latency;
                 InterlockedIncrement64((int64_t*)&Connection.Client.LatencyCount);
             }
+            if (Client.BucketCount) {
+                Connection.Worker.RecordLatency(RecvEndTime, CxPlatTimeDiff64(StartTime, RecvEndTime));
+            }
         }
         InterlockedIncrement64((int64_t*)&Connection.Worker.StreamsCompleted);
     }
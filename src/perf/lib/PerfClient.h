@@ -14,6 +14,19 @@ Abstract:
 #include "SecNetPerf.h"
 #include "Tcp.h"
 
+struct hdr_histogram;
+
+//
+// Stats for a single time bucket of a single worker. Updated lock-free from
+// the MsQuic callback threads and merged across workers once the run is done.
+//
+struct PerfTimeBucket {
+    uint64_t BytesSent {0};
+    uint64_t BytesReceived {0};
+    uint64_t RequestsCompleted {0};
+    struct hdr_histogram* Latency {nullptr}; // Lazily allocated
+};
+
 struct PerfClientConnection {
     struct PerfClient& Client;
     struct PerfClientWorker& Worker;
@@ -104,9 +117,13 @@ struct QUIC_CACHEALIGN PerfClientWorker {
     CxPlatPoolT<PerfClientStream> StreamPool;
     CxPlatPoolT<TcpConnection> TcpConnectionPool;
     CxPlatPoolT<TcpSendData> TcpSendDataPool;
+    UniquePtr<PerfTimeBucket[]> TimeBuckets;
     PerfClientWorker() { }
-    ~PerfClientWorker() { WaitForThread(); }
+    ~PerfClientWorker() { WaitForThread(); FreeTimeBuckets(); }
     void Uninitialize() { WaitForThread(); }
+    PerfTimeBucket* GetTimeBucket(_In_ uint64_t Now);
+    void RecordBytes(_In_ uint64_t Now, _In_ uint64_t BytesSent, _In_ uint64_t BytesReceived);
+    void RecordLatency(_In_ uint64_t Now, _In_ uint64_t Latency);
     void QueueNewConnection() {
         InterlockedIncrement64((int64_t*)&ConnectionsQueued);
         WakeEvent.Set();
@@ -127,6 +144,7 @@ private:
     }
     void StartNewConnection();
     void WorkerThread();
+    void FreeTimeBuckets();
 };
 
 struct PerfClient {
@@ -144,6 +162,7 @@ struct PerfClient {
     QUIC_STATUS Wait(_In_ int Timeout);
     uint32_t GetExtraDataLength();
     void GetExtraData(_Out_writes_bytes_(Length) uint8_t* Data, _In_ uint32_t Length);
+    void PrintTimeBuckets();
 
     bool Running {true};
     CXPLAT_EVENT* CompletionEvent {nullptr};
@@ -151,6 +170,9 @@ struct PerfClient {
     uint64_t CurLatencyIndex {0};
     uint64_t LatencyCount {0};
     UniquePtr<uint32_t[]> LatencyValues {nullptr}; // TODO - Move to Worker
+    uint64_t BucketInterval {0}; // In microseconds; 0 disables time buckets
+    uint64_t BucketStartTime {0};
+    uint32_t BucketCount {0};
     PerfClientWorker Workers[PERF_MAX_THREAD_COUNT];
 
     UniquePtr<TcpEngine> Engine;
@@ -41,6 +41,10 @@ Abstract:
 
 #define PERF_MAX_THREAD_COUNT               128
 #define PERF_MAX_REQUESTS_PER_SECOND        2000000 // best guess - must increase if we can do better
+#define PERF_MAX_TIME_BUCKETS               36000   // e.g. one hour of 100ms buckets
+#define PERF_DEFAULT_BUCKET_WINDOW          S_TO_US(60) // Bucket window used if no runtime is set
+#define PERF_BUCKET_MAX_LATENCY             S_TO_US(60) // Highest latency tracked per bucket
+#define PERF_BUCKET_LATENCY_PRECISION       2       // Significant figures per bucket histogram
 
 typedef enum TCP_EXECUTION_PROFILE {
     TCP_EXECUTION_PROFILE_LOW_LATENCY,
@@ -111,6 +111,7 @@ PrintHelp(
         "  -pconn:<0/1>             Print connection statistics. (def:0)\n"
         "  -pstream:<0/1>           Print stream statistics. (def:0)\n"
         "  -platency<0/1>           Print latency statistics. (def:0)\n"
+        "  -pbucket:<####>[unit]    Print throughput and p50/p99/p99.9 latency per time bucket of this length (def unit is us). (def:0)\n"
         "\n"
         "  Scenario options:\n"
         "  -scenario:<profile>      Scenario profile to use.\n"
@@ -131,6 +132,9 @@ PrintHelp(
         "  -cc:<algo>               Congestion control algorithm to use.\n"
         "                            - {cubic, bbr}.\n"
         "  -pollidle:<time_us>      Amount of time to poll while idle before sleeping (default: 0).\n"
+        "  -sqpoll:<0/1>            Uses kernel submission polling threads with io_uring. (def:0)\n"
+        "  -busypoll:<0/1>          Busy polls sockets and spins workers for -pollidle with epoll. (def:0)\n"
+        "  -rebalance:<0/1>         Moves connections off overloaded workers. (def:0)\n"
         "  -ecn:<0/1>               Enables/disables sender-side ECN support. (def:0)\n"
         "  -qeo:<0/1>               Allows/disallowes QUIC encryption offload. (def:0)\n"
 #ifndef _KERNEL_MODE
@@ -228,6 +232,27 @@ QuicMainStart(
         SetConfig = true;
     }
 
+    uint8_t SqPoll = false;
+    TryGetValue(argc, argv, "sqpoll", &SqPoll);
+    if (SqPoll) {
+        Config->Flags |= QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_SQPOLL;
+        SetConfig = true;
+    }
+
+    uint8_t BusyPoll = false;
+    TryGetValue(argc, argv, "busypoll", &BusyPoll);
+    if (BusyPoll) {
+        Config->Flags |= QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL;
+        SetConfig = true;
+    }
+
+    uint8_t Rebalance = false;
+    TryGetValue(argc, argv, "rebalance", &Rebalance);
+    if (Rebalance) {
+        Config->Flags |= QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE;
+        SetConfig = true;
+    }
+
     if (SetConfig &&
         QUIC_FAILED(
         Status =
@@ -515,6 +515,62 @@ CxPlatDecrypt(
     return NtStatusToQuicStatus(Status);
 }
 
+//
+// BCrypt has no multi-buffer AEAD interface, so encrypt one entry at a time.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _In_reads_(BatchSize)
+        const CXPLAT_CRYPT_BATCH_ENTRY* Entries
+    )
+{
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        QUIC_STATUS Status =
+            CxPlatEncrypt(
+                Key,
+                Entries[i].Iv,
+                Entries[i].AuthDataLength,
+                Entries[i].AuthData,
+                Entries[i].BufferLength,
+                Entries[i].Buffer);
+        if (QUIC_FAILED(Status)) {
+            return Status;
+        }
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _In_reads_(BatchSize)
+        const CXPLAT_CRYPT_BATCH_ENTRY* Entries,
+    _Out_writes_(BatchSize)
+        QUIC_STATUS* Results
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        Results[i] =
+            CxPlatDecrypt(
+                Key,
+                Entries[i].Iv,
+                Entries[i].AuthDataLength,
+                Entries[i].AuthData,
+                Entries[i].BufferLength,
+                Entries[i].Buffer);
+        if (QUIC_FAILED(Results[i]) && QUIC_SUCCEEDED(Status)) {
+            Status = Results[i];
+        }
+    }
+    return Status;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 CxPlatHpKeyCreate(
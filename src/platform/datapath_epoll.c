@@ -241,6 +241,7 @@ DataPathInitialize(
         Datapath->TcpHandlers = *TcpCallbacks;
     }
     Datapath->WorkerPool = WorkerPool;
+    Datapath->BusyPollTimeoutUs = CxPlatWorkerPoolGetBusyPollTimeout(WorkerPool);
 
     Datapath->PartitionCount = (uint16_t)CxPlatWorkerPoolGetCount(WorkerPool);
     Datapath->Features |= CXPLAT_DATAPATH_FEATURE_TCP;
@@ -413,6 +414,54 @@ Exit:
     return Status;
 }
 
+//
+// Opts the socket into busy polling its receive queue. This is best effort:
+// raising SO_BUSY_POLL above the system default requires CAP_NET_ADMIN and
+// SO_PREFER_BUSY_POLL requires a 5.11+ kernel.
+//
+void
+CxPlatSocketContextSetBusyPoll(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    int Option = (int)SocketContext->Binding->Datapath->BusyPollTimeoutUs;
+    int Result =
+        setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_BUSY_POLL,
+            (const void*)&Option,
+            sizeof(Option));
+    if (Result == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_BUSY_POLL) failed");
+        return;
+    }
+
+#ifdef SO_PREFER_BUSY_POLL
+    Option = TRUE;
+    Result =
+        setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_PREFER_BUSY_POLL,
+            (const void*)&Option,
+            sizeof(Option));
+    if (Result == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_PREFER_BUSY_POLL) failed");
+    }
+#endif
+}
+
 //
 // Socket context interface. It abstracts a (generally per-processor) UDP socket
 // and the corresponding logic/functionality like send and receive processing.
@@ -707,6 +756,10 @@ CxPlatSocketContextInitialize(
             goto Exit;
         }
 
+        if (Datapath->BusyPollTimeoutUs != 0) {
+            CxPlatSocketContextSetBusyPoll(SocketContext);
+        }
+
         //
         // Only set SO_REUSEPORT on a server socket, otherwise the client could be
         // assigned a server port (unless it's forcing sharing).
@@ -1136,7 +1189,7 @@ SocketCreateUdp(
         // round robin, but each flow will be sent to the same socket, just not
         // based on RSS.
         //
-        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount, Config);
     }
 
     CxPlatConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
@@ -1432,7 +1485,7 @@ SocketCreateTcpListener(
     // than the default round-robin strategy, but it's good to keep TCP behavior
     // consistent with UDP.
     //
-    (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+    (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount, NULL);
 
     for (uint32_t i = 0; i < SocketCount; i++) {
         CxPlatSocketContextSetEvents(&Binding->SocketContexts[i], EPOLL_CTL_ADD, EPOLLIN);
@@ -1722,75 +1775,14 @@ CxPlatSocketContextRecvComplete(
     }
 }
 
-void
-CxPlatSocketReceiveCoalesced(
-    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
-    )
-{
-    CXPLAT_DATAPATH_PARTITION* DatapathPartition = SocketContext->DatapathPartition;
-    DATAPATH_RX_IO_BLOCK* IoBlock = NULL;
-    struct mmsghdr RecvMsgHdr;
-    CXPLAT_RECV_MSG_CONTROL_BUFFER RecvMsgControl;
-    struct iovec RecvIov;
-
-    do {
-        uint32_t RetryCount = 0;
-        do {
-            IoBlock = CxPlatPoolAlloc(&DatapathPartition->RecvBlockPool);
-        } while (IoBlock == NULL && ++RetryCount < 10);
-        if (IoBlock == NULL) {
-            QuicTraceEvent(
-                AllocFailure,
-                "Allocation of '%s' failed. (%llu bytes)",
-                "DATAPATH_RX_IO_BLOCK",
-                0);
-            goto Exit;
-        }
-
-        CxPlatZeroMemory(&IoBlock->Route, sizeof(CXPLAT_ROUTE));
-        IoBlock->Route.State = RouteResolved;
-
-        struct msghdr* MsgHdr = &RecvMsgHdr.msg_hdr;
-        MsgHdr->msg_name = &IoBlock->Route.RemoteAddress;
-        MsgHdr->msg_namelen = sizeof(IoBlock->Route.RemoteAddress);
-        MsgHdr->msg_iov = &RecvIov;
-        MsgHdr->msg_iovlen = 1;
-        MsgHdr->msg_control = &RecvMsgControl.Data;
-        MsgHdr->msg_controllen = sizeof(RecvMsgControl.Data);
-        MsgHdr->msg_flags = 0;
-        RecvIov.iov_base = (char*)IoBlock + DatapathPartition->Datapath->RecvBlockBufferOffset;
-        RecvIov.iov_len = CXPLAT_LARGE_IO_BUFFER_SIZE;
-
-        int Ret =
-            recvmmsg(
-                SocketContext->SocketFd,
-                &RecvMsgHdr,
-                1,
-                0,
-                NULL);
-        if (Ret < 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                QuicTraceEvent(
-                    DatapathErrorStatus,
-                    "[data][%p] ERROR, %u, %s.",
-                    SocketContext->Binding,
-                    errno,
-                    "recvmmsg failed");
-            }
-            break;
-        }
-
-        CXPLAT_DBG_ASSERT(Ret == 1);
-        CxPlatSocketContextRecvComplete(SocketContext, &IoBlock, &RecvMsgHdr, Ret);
-
-    } while (TRUE);
-
-Exit:
-
-    if (IoBlock) {
-        CxPlatPoolFree(IoBlock);
-    }
-}
+//
+// Receive batching adapts to the yield of recent recvmmsg calls: the batch
+// doubles whenever a call fills it and halves whenever a call comes back a
+// quarter full or less. GRO coalesced buffers are large, so fewer of them are
+// posted at once.
+//
+#define CXPLAT_RECV_BATCH_SIZE_INITIAL          8
+#define CXPLAT_MAX_COALESCED_RECV_BATCH_SIZE    4
 
 void
 CxPlatSocketReceiveMessages(
@@ -1798,21 +1790,37 @@ CxPlatSocketReceiveMessages(
     )
 {
     CXPLAT_DATAPATH_PARTITION* DatapathPartition = SocketContext->DatapathPartition;
+    const BOOLEAN Coalesced =
+        !!(DatapathPartition->Datapath->Features & CXPLAT_DATAPATH_FEATURE_RECV_COALESCING);
+    const uint16_t MaxBatchSize =
+        Coalesced ? CXPLAT_MAX_COALESCED_RECV_BATCH_SIZE : CXPLAT_MAX_IO_BATCH_SIZE;
     DATAPATH_RX_IO_BLOCK* IoBlocks[CXPLAT_MAX_IO_BATCH_SIZE];
     struct mmsghdr RecvMsgHdr[CXPLAT_MAX_IO_BATCH_SIZE];
     CXPLAT_RECV_MSG_CONTROL_BUFFER RecvMsgControl[CXPLAT_MAX_IO_BATCH_SIZE];
     struct iovec RecvIov[CXPLAT_MAX_IO_BATCH_SIZE];
     CxPlatZeroMemory(IoBlocks, sizeof(IoBlocks));
 
+    if (SocketContext->RecvBatchSize == 0) {
+        SocketContext->RecvBatchSize = CXPLAT_MIN(CXPLAT_RECV_BATCH_SIZE_INITIAL, MaxBatchSize);
+    }
+
     do {
+        //
+        // Post as much of the batch as the receive pool can currently supply.
+        // Only failing to get a single buffer aborts the receive.
+        //
+        uint32_t BatchSize = 0;
         uint32_t RetryCount = 0;
-        for (uint32_t i = 0; i < CXPLAT_MAX_IO_BATCH_SIZE && IoBlocks[i] == NULL; ++i) {
+        while (BatchSize < SocketContext->RecvBatchSize) {
 
-            DATAPATH_RX_IO_BLOCK* IoBlock;
-            do {
-                IoBlock = CxPlatPoolAlloc(&DatapathPartition->RecvBlockPool);
-            } while (IoBlock == NULL && ++RetryCount < 10);
+            DATAPATH_RX_IO_BLOCK* IoBlock = CxPlatPoolAlloc(&DatapathPartition->RecvBlockPool);
             if (IoBlock == NULL) {
+                if (BatchSize != 0) {
+                    break;
+                }
+                if (++RetryCount < 10) {
+                    continue;
+                }
                 QuicTraceEvent(
                     AllocFailure,
                     "Allocation of '%s' failed. (%llu bytes)",
@@ -1820,28 +1828,30 @@ CxPlatSocketReceiveMessages(
                     0);
                 goto Exit;
             }
+            IoBlocks[BatchSize] = IoBlock;
 
-            IoBlocks[i] = IoBlock;
             CxPlatZeroMemory(&IoBlock->Route, sizeof(CXPLAT_ROUTE));
             IoBlock->Route.State = RouteResolved;
 
-            struct msghdr* MsgHdr = &RecvMsgHdr[i].msg_hdr;
+            struct msghdr* MsgHdr = &RecvMsgHdr[BatchSize].msg_hdr;
             MsgHdr->msg_name = &IoBlock->Route.RemoteAddress;
             MsgHdr->msg_namelen = sizeof(IoBlock->Route.RemoteAddress);
-            MsgHdr->msg_iov = &RecvIov[i];
+            MsgHdr->msg_iov = &RecvIov[BatchSize];
             MsgHdr->msg_iovlen = 1;
-            MsgHdr->msg_control = &RecvMsgControl[i].Data;
-            MsgHdr->msg_controllen = sizeof(RecvMsgControl[i].Data);
+            MsgHdr->msg_control = &RecvMsgControl[BatchSize].Data;
+            MsgHdr->msg_controllen = sizeof(RecvMsgControl[BatchSize].Data);
             MsgHdr->msg_flags = 0;
-            RecvIov[i].iov_base = (char*)IoBlock + DatapathPartition->Datapath->RecvBlockBufferOffset;
-            RecvIov[i].iov_len = CXPLAT_SMALL_IO_BUFFER_SIZE;
+            RecvIov[BatchSize].iov_base = (char*)IoBlock + DatapathPartition->Datapath->RecvBlockBufferOffset;
+            RecvIov[BatchSize].iov_len =
+                Coalesced ? CXPLAT_LARGE_IO_BUFFER_SIZE : CXPLAT_SMALL_IO_BUFFER_SIZE;
+            ++BatchSize;
         }
 
         int Ret =
             recvmmsg(
                 SocketContext->SocketFd,
                 RecvMsgHdr,
-                (int)CXPLAT_MAX_IO_BATCH_SIZE,
+                (int)BatchSize,
                 0,
                 NULL);
         if (Ret < 0) {
@@ -1856,9 +1866,28 @@ CxPlatSocketReceiveMessages(
             break;
         }
 
-        CXPLAT_DBG_ASSERT(Ret <= CXPLAT_MAX_IO_BATCH_SIZE);
+        CXPLAT_DBG_ASSERT((uint32_t)Ret <= BatchSize);
         CxPlatSocketContextRecvComplete(SocketContext, IoBlocks, RecvMsgHdr, Ret);
 
+        if ((uint32_t)Ret == BatchSize) {
+            if (BatchSize == SocketContext->RecvBatchSize && BatchSize < MaxBatchSize) {
+                SocketContext->RecvBatchSize = (uint16_t)CXPLAT_MIN(BatchSize * 2, MaxBatchSize);
+            }
+
+        } else {
+            if ((uint32_t)Ret * 4 <= BatchSize) {
+                SocketContext->RecvBatchSize =
+                    (uint16_t)CXPLAT_MAX(SocketContext->RecvBatchSize / 2, 1);
+            }
+
+            //
+            // A short batch means the socket has been drained. The socket is
+            // registered level triggered, so rather than making another call
+            // just to get EAGAIN, wait for the next readiness event.
+            //
+            break;
+        }
+
     } while (TRUE);
 
 Exit:
@@ -1959,11 +1988,7 @@ CxPlatSocketReceive(
     )
 {
     if (SocketContext->Binding->Type == CXPLAT_SOCKET_UDP) {
-        if (SocketContext->DatapathPartition->Datapath->Features & CXPLAT_DATAPATH_FEATURE_RECV_COALESCING) {
-            CxPlatSocketReceiveCoalesced(SocketContext);
-        } else {
-            CxPlatSocketReceiveMessages(SocketContext);
-        }
+        CxPlatSocketReceiveMessages(SocketContext);
     } else {
         CxPlatSocketReceiveTcpData(SocketContext);
     }
@@ -2566,6 +2591,23 @@ CxPlatSocketGetTcpStatistics(
     return QUIC_STATUS_NOT_SUPPORTED;
 }
 
+#if defined(QUIC_TEST_APIS)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint16_t
+CxPlatSocketGetRecvBatchSize(
+    _In_ CXPLAT_SOCKET* Socket
+    )
+{
+    const uint16_t SocketCount =
+        Socket->NumPerProcessorSockets ? (uint16_t)CxPlatProcCount() : 1;
+    uint16_t RecvBatchSize = 0;
+    for (uint16_t i = 0; i < SocketCount; ++i) {
+        RecvBatchSize = CXPLAT_MAX(RecvBatchSize, Socket->SocketContexts[i].RecvBatchSize);
+    }
+    return RecvBatchSize;
+}
+#endif // QUIC_TEST_APIS
+
 void
 CxPlatSocketContextIoEventComplete(
     _In_ CXPLAT_CQE* Cqe
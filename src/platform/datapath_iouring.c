@@ -79,6 +79,29 @@ typedef struct __attribute__((aligned(CXPLAT_MEMORY_ALIGNMENT))) DATAPATH_RX_PAC
 
 } DATAPATH_RX_PACKET;
 
+//
+// Receive packets accumulated across consecutive multishot receive completions
+// on the same socket, so they can be indicated to the app as a single chain.
+//
+typedef struct DATAPATH_RX_BATCH {
+    //
+    // The socket context the packets were received on.
+    //
+    struct CXPLAT_SOCKET_CONTEXT* SocketContext;
+
+    //
+    // The chain of packets to indicate.
+    //
+    CXPLAT_RECV_DATA* Head;
+    CXPLAT_RECV_DATA** Tail;
+
+    //
+    // The number of IO blocks (ring buffers) held by the chain.
+    //
+    uint32_t IoBlockCount;
+
+} DATAPATH_RX_BATCH;
+
 //
 // Send context.
 //
@@ -126,6 +149,14 @@ typedef struct CXPLAT_SEND_DATA {
     //
     uint16_t AlreadySentCount;
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    //
+    // The io_uring registered buffer index of this send data, when it was
+    // allocated from the partition's SendRegisteredBufferPool.
+    //
+    uint16_t RegisteredBufferIndex;
+#endif
+
     //
     // Length of the calculated ControlBuffer. Value is zero until the data is
     // computed.
@@ -147,6 +178,19 @@ typedef struct CXPLAT_SEND_DATA {
     //
     uint8_t SegmentationSupported : 1;
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    //
+    // Indicates the send data lives in an io_uring registered buffer.
+    //
+    uint8_t Registered : 1;
+
+    //
+    // Indicates the send was submitted as a zero-copy send, and so the buffer
+    // is owned by the kernel until the notification completion.
+    //
+    uint8_t ZeroCopy : 1;
+#endif
+
     //
     // The message header for the send.
     //
@@ -201,6 +245,20 @@ const struct msghdr CxPlatRecvMsgHdr = {
 };
 const uint32_t RecvBufCount = 1024;
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+//
+// Registered send buffers per partition. Each is a full CXPLAT_SEND_DATA, so
+// this is kept small to stay within the locked memory limit.
+//
+const uint32_t SendZcBufCount = 64;
+
+//
+// Sends smaller than this are copied; below this size pinning the pages and
+// the extra notification completion cost more than the copy saves.
+//
+const uint32_t SendZcMinLength = 16 * 1024;
+#endif
+
 void
 CxPlatSocketIoStart(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
@@ -223,6 +281,23 @@ CxPlatSocketAllocSqe(
     return io_sqe;
 }
 
+//
+// Points the SQE at the registered file instead of the file descriptor when
+// possible. The fd value is also the registered file index, so the SQE's fd
+// field stays as prepared.
+//
+QUIC_INLINE
+void
+CxPlatSocketSqeSetFile(
+    _In_ const CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _Inout_ struct io_uring_sqe* Sqe
+    )
+{
+    if (SocketContext->FixedFile) {
+        Sqe->flags |= IOSQE_FIXED_FILE;
+    }
+}
+
 uint32_t
 CxPlatGetBufferPoolBufferSize(
     _In_ const CXPLAT_REGISTERED_BUFFER_POOL* Pool
@@ -240,6 +315,32 @@ CxPlatGetBufferPoolBuffer(
     return Pool->Buffers + (Index * Pool->BufferSize);
 }
 
+//
+// Hands a set of receive IO blocks back to the kernel's provided buffer ring,
+// publishing them with a single tail update.
+//
+void
+CxPlatRecvBufferRingReplenish(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition,
+    _In_reads_(IoBlockCount) DATAPATH_RX_IO_BLOCK** IoBlocks,
+    _In_ uint32_t IoBlockCount
+    )
+{
+    CXPLAT_REGISTERED_BUFFER_POOL* Pool = &DatapathPartition->RecvRegisteredBufferPool;
+    const uint32_t BufferOffset = DatapathPartition->Datapath->RecvBlockBufferOffset;
+
+    CxPlatLockAcquire(&Pool->Lock);
+    for (uint32_t i = 0; i < IoBlockCount; i++) {
+        io_uring_buf_ring_add(
+            Pool->Ring,
+            (uint8_t*)IoBlocks[i] + BufferOffset,
+            CxPlatGetBufferPoolBufferSize(Pool) - BufferOffset,
+            IoBlocks[i]->BufferIndex, io_uring_buf_ring_mask(RecvBufCount), (int)i);
+    }
+    io_uring_buf_ring_advance(Pool->Ring, (int)IoBlockCount);
+    CxPlatLockRelease(&Pool->Lock);
+}
+
 void
 CxPlatFreeBufferPool(
     _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition,
@@ -322,6 +423,109 @@ Exit:
     return Status;
 }
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+void
+CxPlatFreeSendBufferPool(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition,
+    _Inout_ CXPLAT_REGISTERED_BUFFER_POOL* Pool
+    )
+{
+    if (Pool->Buffers != NULL) {
+        io_uring_unregister_buffers(&DatapathPartition->EventQ->Ring);
+        free(Pool->Buffers);
+        Pool->Buffers = NULL;
+    }
+}
+
+//
+// Creates a pool of send data blocks backed by memory registered with the
+// partition's io_uring, so sends can be transmitted with zero-copy from them.
+//
+QUIC_STATUS
+CxPlatCreateSendBufferPool(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition,
+    _In_ uint32_t BufferSize,
+    _In_ uint32_t BufferCount,
+    _Out_ CXPLAT_REGISTERED_BUFFER_POOL* Pool
+    )
+{
+    int Result;
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    void* Buffers = NULL;
+    struct iovec* Iovs = NULL;
+
+    CXPLAT_DBG_ASSERT(BufferSize % CXPLAT_MEMORY_ALIGNMENT == 0);
+    CXPLAT_DBG_ASSERT(BufferCount <= UINT16_MAX);
+
+    CxPlatZeroMemory(Pool, sizeof(*Pool));
+    CxPlatLockInitialize(&Pool->Lock);
+    CxPlatListInitializeHead(&Pool->FreeList);
+
+    Pool->TotalSize = BufferCount * BufferSize;
+    if (posix_memalign(&Buffers, getpagesize(), Pool->TotalSize)) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_REGISTERED_BUFFER_POOL",
+            Pool->TotalSize);
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        goto Exit;
+    }
+    CxPlatZeroMemory(Buffers, Pool->TotalSize);
+
+    Iovs = CXPLAT_ALLOC_PAGED(BufferCount * sizeof(struct iovec), QUIC_POOL_TMP_ALLOC);
+    if (Iovs == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "Registered send buffer iovecs",
+            BufferCount * sizeof(struct iovec));
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        goto Exit;
+    }
+
+    for (uint32_t i = 0; i < BufferCount; i++) {
+        Iovs[i].iov_base = (uint8_t*)Buffers + i * BufferSize;
+        Iovs[i].iov_len = BufferSize;
+    }
+
+    Result = io_uring_register_buffers(&DatapathPartition->EventQ->Ring, Iovs, BufferCount);
+    if (Result < 0) {
+        Status = -Result;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            DatapathPartition,
+            Status,
+            "io_uring_register_buffers failed");
+        goto Exit;
+    }
+
+    Pool->Buffers = (uint8_t*)Buffers;
+    Pool->BufferSize = BufferSize;
+    Buffers = NULL;
+
+    for (uint32_t i = 0; i < BufferCount; i++) {
+        CXPLAT_SEND_DATA* SendData =
+            (CXPLAT_SEND_DATA*)CxPlatGetBufferPoolBuffer(Pool, i);
+        SendData->RegisteredBufferIndex = (uint16_t)i;
+        SendData->Registered = TRUE;
+        CxPlatListInsertTail(&Pool->FreeList, &SendData->TxEntry);
+    }
+
+Exit:
+
+    if (Iovs != NULL) {
+        CXPLAT_FREE(Iovs, QUIC_POOL_TMP_ALLOC);
+    }
+    if (Buffers != NULL) {
+        free(Buffers);
+    }
+
+    return Status;
+}
+#endif
+
 QUIC_STATUS
 CxPlatProcessorContextInitialize(
     _In_ CXPLAT_DATAPATH* Datapath,
@@ -363,6 +567,16 @@ CxPlatProcessorContextInitialize(
     }
     io_uring_buf_ring_advance(DatapathPartition->RecvRegisteredBufferPool.Ring, RecvBufCount);
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    //
+    // Not fatal: without registered buffers all sends are copied from the
+    // regular send pool.
+    //
+    (void)CxPlatCreateSendBufferPool(
+        DatapathPartition, ALIGN_UP_BY(Datapath->SendDataSize, CXPLAT_MEMORY_ALIGNMENT),
+        SendZcBufCount, &DatapathPartition->SendRegisteredBufferPool);
+#endif
+
 Exit:
 
     return Status;
@@ -505,6 +719,10 @@ CxPlatProcessorContextRelease(
         CxPlatFreeBufferPool(
             DatapathPartition, CxPlatIoRingBufGroupRecv,
             &DatapathPartition->RecvRegisteredBufferPool);
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+        CxPlatFreeSendBufferPool(
+            DatapathPartition, &DatapathPartition->SendRegisteredBufferPool);
+#endif
         CxPlatPoolUninitialize(&DatapathPartition->SendBlockPool);
         CxPlatDataPathRelease(DatapathPartition->Datapath);
     }
@@ -1081,6 +1299,10 @@ CxPlatSocketContextUninitializeComplete(
     CXPLAT_DBG_ASSERT(SocketContext->AcceptSocket == NULL);
 
     if (SocketContext->SocketFd != INVALID_SOCKET) {
+        if (SocketContext->FixedFile) {
+            CxPlatEventQUnregisterFile(
+                SocketContext->DatapathPartition->EventQ, SocketContext->SocketFd);
+        }
         close(SocketContext->SocketFd);
     }
 
@@ -1175,8 +1397,6 @@ CxPlatSocketContextStartMultiRecvUnderLock(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
     )
 {
-    CXPLAT_EVENTQ* EventQ = SocketContext->DatapathPartition->EventQ;
-
     CXPLAT_DBG_ASSERT(!SocketContext->MultiRecvStarted);
     CXPLAT_DBG_ASSERT(!SocketContext->Shutdown);
 
@@ -1197,12 +1417,19 @@ CxPlatSocketContextStartMultiRecvUnderLock(
         return;
     }
 
+    //
+    // A single multishot SQE keeps producing one CQE per datagram, each with a
+    // buffer picked by the kernel from the provided buffer ring, until it
+    // terminates (e.g. the ring ran dry) and has to be re-armed. The SQE is
+    // not submitted here; the caller submits, which lets re-arms from the
+    // completion path ride along with the completion batch's single submit.
+    //
     io_uring_prep_recvmsg_multishot(
         Sqe, SocketContext->SocketFd, (struct msghdr*)&CxPlatRecvMsgHdr, MSG_TRUNC);
+    CxPlatSocketSqeSetFile(SocketContext, Sqe);
     Sqe->flags |= IOSQE_BUFFER_SELECT;
     Sqe->buf_group = CxPlatIoRingBufGroupRecv;
     io_uring_sqe_set_data(Sqe, &SocketContext->IoSqe.Sqe);
-    io_uring_submit(&EventQ->Ring);
 
     CXPLAT_DBG_ONLY(SocketContext->MultiRecvStarted = TRUE);
     CxPlatSocketIoStart(SocketContext);
@@ -1216,6 +1443,7 @@ CxPlatSocketContextStartMultiRecv(
     CXPLAT_EVENTQ* EventQ = SocketContext->DatapathPartition->EventQ;
     CxPlatLockAcquire(&EventQ->Lock);
     CxPlatSocketContextStartMultiRecvUnderLock(SocketContext);
+    io_uring_submit(&EventQ->Ring);
     CxPlatLockRelease(&EventQ->Lock);
 }
 
@@ -1302,7 +1530,7 @@ SocketCreateUdp(
         // round robin, but each flow will be sent to the same socket, just not
         // based on RSS.
         //
-        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount, Config);
     }
 
     CxPlatConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
@@ -1322,8 +1550,13 @@ SocketCreateUdp(
 
     for (uint32_t i = 0; i < SocketCount; i++) {
         //
-        // Review: the sockets can be registered with io_uring for better perf.
+        // Register the sockets with io_uring so IO on them skips the per-op
+        // file lookup and reference.
         //
+        Binding->SocketContexts[i].FixedFile =
+            CxPlatEventQRegisterFile(
+                Binding->SocketContexts[i].DatapathPartition->EventQ,
+                Binding->SocketContexts[i].SocketFd);
         Binding->SocketContexts[i].IoStarted = TRUE;
         CxPlatSocketContextStartMultiRecv(&Binding->SocketContexts[i]);
     }
@@ -1463,14 +1696,55 @@ CxPlatSocketHandleErrors(
     }
 }
 
+void
+CxPlatSocketContextRecvFlush(
+    _Inout_ DATAPATH_RX_BATCH* RecvBatch
+    )
+{
+    CXPLAT_SOCKET_CONTEXT* SocketContext = RecvBatch->SocketContext;
+    CXPLAT_RECV_DATA* DatagramHead = RecvBatch->Head;
+
+    RecvBatch->Head = NULL;
+    RecvBatch->Tail = &RecvBatch->Head;
+    RecvBatch->IoBlockCount = 0;
+
+    if (DatagramHead == NULL) {
+        return;
+    }
+
+    if (CxPlatRundownAcquire(&SocketContext->UpcallRundown)) {
+        if (!SocketContext->Binding->PcpBinding) {
+            CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath->UdpHandlers.Receive);
+            SocketContext->Binding->Datapath->UdpHandlers.Receive(
+                SocketContext->Binding,
+                SocketContext->Binding->ClientContext,
+                DatagramHead);
+        } else{
+            CxPlatPcpRecvCallback(
+                SocketContext->Binding,
+                SocketContext->Binding->ClientContext,
+                DatagramHead);
+        }
+
+        CxPlatRundownRelease(&SocketContext->UpcallRundown);
+    } else {
+        //
+        // The socket is shutting down. Put the buffers back in the ring.
+        //
+        RecvDataReturn(DatagramHead);
+    }
+}
+
 void
 CxPlatSocketContextRecvComplete(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
     _Inout_ DATAPATH_RX_IO_BLOCK** IoBlocks,
-    _In_ struct msghdr* RecvMsgHdr
+    _In_ struct msghdr* RecvMsgHdr,
+    _Inout_ DATAPATH_RX_BATCH* RecvBatch
     )
 {
     CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath == SocketContext->DatapathPartition->Datapath);
+    CXPLAT_DBG_ASSERT(RecvBatch->SocketContext == SocketContext);
 
     uint32_t BytesTransferred = 0;
     CXPLAT_RECV_DATA* DatagramHead = NULL;
@@ -1481,6 +1755,14 @@ CxPlatSocketContextRecvComplete(
         uint32_t MsgLen = (uint32_t)RecvMsgHdr->msg_iov->iov_len;
         BytesTransferred += MsgLen;
 
+        if (MsgLen == 0) {
+            //
+            // Nothing will reference the block, so return it immediately.
+            //
+            CxPlatRecvBufferRingReplenish(SocketContext->DatapathPartition, &IoBlock, 1);
+            continue;
+        }
+
         uint8_t TOS = 0;
         int HopLimitTTL = 0;
         uint16_t SegmentLength = 0;
@@ -1606,28 +1888,21 @@ CxPlatSocketContextRecvComplete(
         return;
     }
 
-    if (CxPlatRundownAcquire(&SocketContext->UpcallRundown)) {
-        if (!SocketContext->Binding->PcpBinding) {
-            CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath->UdpHandlers.Receive);
-            SocketContext->Binding->Datapath->UdpHandlers.Receive(
-                SocketContext->Binding,
-                SocketContext->Binding->ClientContext,
-                DatagramHead);
-        } else{
-            CxPlatPcpRecvCallback(
-                SocketContext->Binding,
-                SocketContext->Binding->ClientContext,
-                DatagramHead);
-        }
-
-        CxPlatRundownRelease(&SocketContext->UpcallRundown);
+    *RecvBatch->Tail = DatagramHead;
+    RecvBatch->Tail = DatagramTail;
+    if (++RecvBatch->IoBlockCount >= CXPLAT_MAX_IO_BATCH_SIZE) {
+        //
+        // Bound how many ring buffers a single indication can hold.
+        //
+        CxPlatSocketContextRecvFlush(RecvBatch);
     }
 }
 
 void
 CxPlatSocketReceiveComplete(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
-    _In_ CXPLAT_CQE Cqe
+    _In_ CXPLAT_CQE Cqe,
+    _Inout_ DATAPATH_RX_BATCH* RecvBatch
     )
 {
     CXPLAT_DATAPATH_PARTITION* DatapathPartition = SocketContext->DatapathPartition;
@@ -1640,6 +1915,8 @@ CxPlatSocketReceiveComplete(
 
     if (Cqe->res == -ENOBUFS) {
         //
+        // The provided buffer ring ran dry (the app is holding all the
+        // buffers); the multishot receive terminates and is re-armed below.
         // Ignore packet loss indications for now.
         //
         goto Exit;
@@ -1667,9 +1944,6 @@ CxPlatSocketReceiveComplete(
 
     IoBlock->Route.State = RouteResolved;
 
-    //
-    // Review: these can be batched by propagating the CQE array here.
-    //
     struct msghdr* MsgHdr = &RecvMsgHdrs[0];
     MsgHdr->msg_name = io_uring_recvmsg_name(RecvMsgOut);
     MsgHdr->msg_namelen = RecvMsgOut->namelen;
@@ -1683,11 +1957,17 @@ CxPlatSocketReceiveComplete(
     RecvIov.iov_len =
         io_uring_recvmsg_payload_length(RecvMsgOut, Cqe->res, (struct msghdr*)&CxPlatRecvMsgHdr);
 
-    CxPlatSocketContextRecvComplete(SocketContext, &IoBlock, RecvMsgHdrs);
+    CxPlatSocketContextRecvComplete(SocketContext, &IoBlock, RecvMsgHdrs, RecvBatch);
 
 Exit:
 
     if (!(Cqe->flags & IORING_CQE_F_MORE)) {
+        //
+        // Indicate everything received so far before the socket's IO
+        // reference from this receive is released.
+        //
+        CxPlatSocketContextRecvFlush(RecvBatch);
+
         CXPLAT_DBG_ASSERT(SocketContext->MultiRecvStarted);
         CXPLAT_DBG_ONLY(SocketContext->MultiRecvStarted = FALSE);
 
@@ -1704,34 +1984,62 @@ RecvDataReturn(
     _In_ CXPLAT_RECV_DATA* RecvDataChain
     )
 {
+    //
+    // Freed blocks are recycled in place into their partition's buffer ring,
+    // one ring update (and lock acquisition) per run of blocks from the same
+    // partition rather than one per block.
+    //
+    DATAPATH_RX_IO_BLOCK* IoBlocks[CXPLAT_MAX_IO_BATCH_SIZE];
+    uint32_t IoBlockCount = 0;
+    CXPLAT_DATAPATH_PARTITION* DatapathPartition = NULL;
+
     CXPLAT_RECV_DATA* Datagram;
     while ((Datagram = RecvDataChain) != NULL) {
         RecvDataChain = RecvDataChain->Next;
         DATAPATH_RX_IO_BLOCK* IoBlock =
             CXPLAT_CONTAINING_RECORD(Datagram, DATAPATH_RX_PACKET, Data)->IoBlock;
         if (InterlockedDecrement(&IoBlock->RefCount) == 0) {
-            CXPLAT_DATAPATH_PARTITION* DatapathPartition = IoBlock->DatapathPartition;
-            //
-            // Review: this is amenable to batching, but the added complexity
-            // may not be worth it.
-            //
-            CxPlatLockAcquire(&DatapathPartition->RecvRegisteredBufferPool.Lock);
-            io_uring_buf_ring_add(
-                DatapathPartition->RecvRegisteredBufferPool.Ring,
-                (uint8_t*)IoBlock + DatapathPartition->Datapath->RecvBlockBufferOffset,
-                CxPlatGetBufferPoolBufferSize(&DatapathPartition->RecvRegisteredBufferPool) -
-                    DatapathPartition->Datapath->RecvBlockBufferOffset,
-                IoBlock->BufferIndex, io_uring_buf_ring_mask(RecvBufCount), 0);
-            io_uring_buf_ring_advance(DatapathPartition->RecvRegisteredBufferPool.Ring, 1);
-            CxPlatLockRelease(&DatapathPartition->RecvRegisteredBufferPool.Lock);
+            if (IoBlockCount == ARRAYSIZE(IoBlocks) ||
+                (IoBlockCount != 0 && IoBlock->DatapathPartition != DatapathPartition)) {
+                CxPlatRecvBufferRingReplenish(DatapathPartition, IoBlocks, IoBlockCount);
+                IoBlockCount = 0;
+            }
+            DatapathPartition = IoBlock->DatapathPartition;
+            IoBlocks[IoBlockCount++] = IoBlock;
         }
     }
+
+    if (IoBlockCount != 0) {
+        CxPlatRecvBufferRingReplenish(DatapathPartition, IoBlocks, IoBlockCount);
+    }
 }
 
 //
 // Send Path
 //
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+static
+CXPLAT_SEND_DATA*
+CxPlatSendDataAllocRegistered(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition
+    )
+{
+    CXPLAT_REGISTERED_BUFFER_POOL* Pool = &DatapathPartition->SendRegisteredBufferPool;
+    CXPLAT_SEND_DATA* SendData = NULL;
+
+    CxPlatLockAcquire(&Pool->Lock);
+    if (!CxPlatListIsEmpty(&Pool->FreeList)) {
+        SendData =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Pool->FreeList), CXPLAT_SEND_DATA, TxEntry);
+    }
+    CxPlatLockRelease(&Pool->Lock);
+
+    return SendData;
+}
+#endif
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Success_(return != NULL)
 CXPLAT_SEND_DATA*
@@ -1749,7 +2057,20 @@ SendDataAlloc(
     CXPLAT_SOCKET_CONTEXT* SocketContext = (CXPLAT_SOCKET_CONTEXT*)Config->Route->Queue;
     CXPLAT_DBG_ASSERT(SocketContext->Binding == Socket);
     CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath == SocketContext->DatapathPartition->Datapath);
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    CXPLAT_SEND_DATA* SendData = CxPlatSendDataAllocRegistered(SocketContext->DatapathPartition);
+    if (SendData == NULL) {
+        SendData = CxPlatPoolAlloc(&SocketContext->DatapathPartition->SendBlockPool);
+        if (SendData != NULL) {
+            SendData->Registered = FALSE;
+        }
+    }
+    if (SendData != NULL) {
+        SendData->ZeroCopy = FALSE;
+    }
+#else
     CXPLAT_SEND_DATA* SendData = CxPlatPoolAlloc(&SocketContext->DatapathPartition->SendBlockPool);
+#endif
     if (SendData != NULL) {
         SendData->SocketContext = SocketContext;
         SendData->ClientBuffer.Buffer = SendData->Buffer;
@@ -1783,6 +2104,16 @@ SendDataFree(
     _In_ CXPLAT_SEND_DATA* SendData
     )
 {
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    if (SendData->Registered) {
+        CXPLAT_REGISTERED_BUFFER_POOL* Pool =
+            &SendData->SocketContext->DatapathPartition->SendRegisteredBufferPool;
+        CxPlatLockAcquire(&Pool->Lock);
+        CxPlatListInsertHead(&Pool->FreeList, &SendData->TxEntry);
+        CxPlatLockRelease(&Pool->Lock);
+        return;
+    }
+#endif
     CxPlatPoolFree(SendData);
 }
 
@@ -2025,7 +2356,25 @@ CxPlatSendDataSendSegmented(
         SendData->MsgHdr.msg_controllen = SendData->ControlBufferLength;
     }
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    if (SendData->Registered &&
+        SendData->TotalSize >= SendZcMinLength &&
+        !SocketContext->Binding->Datapath->SendZeroCopyDisabled) {
+        //
+        // Transmit straight out of the registered buffer. The kernel owns the
+        // buffer until it posts the notification completion.
+        //
+        io_uring_prep_sendmsg_zc(Sqe, SendData->SocketContext->SocketFd, &SendData->MsgHdr, 0);
+        Sqe->ioprio |= IORING_RECVSEND_FIXED_BUF;
+        Sqe->buf_index = SendData->RegisteredBufferIndex;
+        SendData->ZeroCopy = TRUE;
+    } else {
+        io_uring_prep_sendmsg(Sqe, SendData->SocketContext->SocketFd, &SendData->MsgHdr, 0);
+    }
+#else
     io_uring_prep_sendmsg(Sqe, SendData->SocketContext->SocketFd, &SendData->MsgHdr, 0);
+#endif
+    CxPlatSocketSqeSetFile(SocketContext, Sqe);
     io_uring_sqe_set_data(Sqe, (void*)&SendData->Sqe);
     CxPlatBatchSqeInitialize(
         DatapathPartition->EventQ, CxPlatSocketContextIoEventComplete, &SendData->Sqe.Sqe);
@@ -2136,8 +2485,43 @@ CxPlatSocketContextSendComplete(
 {
     CXPLAT_SQE* Sqe = CxPlatCqeGetSqe(&Cqe);
     CXPLAT_SEND_DATA* SendData = CXPLAT_CONTAINING_RECORD(Sqe, CXPLAT_SEND_DATA, Sqe);
+    BOOLEAN BufferReleased = TRUE;
+
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    if (SendData->ZeroCopy) {
+        if (Cqe->flags & IORING_CQE_F_NOTIF) {
+            //
+            // The kernel is done with the buffer. The send itself was already
+            // completed (and the queue serviced) by the first completion.
+            //
+            CxPlatSendDataFree(SendData);
+            CxPlatSocketIoComplete(SocketContext);
+            return;
+        }
+
+        if (Cqe->res == -EINVAL || Cqe->res == -EOPNOTSUPP) {
+            //
+            // The kernel doesn't support zero-copy sends from registered
+            // buffers, so stop trying them on this datapath.
+            //
+            QuicTraceEvent(
+                LibraryError,
+                "[ lib] ERROR, %s.",
+                "Disabling zero-copy send support globally");
+            SocketContext->Binding->Datapath->SendZeroCopyDisabled = TRUE;
+        }
+
+        //
+        // When more is set, a notification completion follows once the kernel
+        // is done with the buffer; the IO stays outstanding until then.
+        //
+        BufferReleased = !(Cqe->flags & IORING_CQE_F_MORE);
+    }
+#endif
 
-    CxPlatSendDataFree(SendData);
+    if (BufferReleased) {
+        CxPlatSendDataFree(SendData);
+    }
     SendData = NULL;
 
     if (SocketContext->Shutdown) {
@@ -2176,7 +2560,9 @@ CxPlatSocketContextSendComplete(
 
 Exit:
 
-    CxPlatSocketIoComplete(SocketContext);
+    if (BufferReleased) {
+        CxPlatSocketIoComplete(SocketContext);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -2229,18 +2615,30 @@ CxPlatSocketContextIoEventComplete(
         DatapathPartition->OwningThreadID = CxPlatCurThreadID();
     }
 
+    DATAPATH_RX_BATCH RecvBatch;
+    RecvBatch.SocketContext = NULL;
+    RecvBatch.Head = NULL;
+    RecvBatch.Tail = &RecvBatch.Head;
+    RecvBatch.IoBlockCount = 0;
+
     CxPlatLockAcquire(&EventQ->Lock);
 
     while (TRUE) {
         CXPLAT_SOCKET_SQE* SocketSqe = CXPLAT_CONTAINING_RECORD(Sqe, CXPLAT_SOCKET_SQE, Sqe);
 
-        //
-        // Review: these functions could be unrolled to batch within an IO
-        // type on a socket.
-        //
         switch ((DATAPATH_CONTEXT_TYPE)(uintptr_t)SocketSqe->Context) {
         case DatapathContextRecv:
-            CxPlatSocketReceiveComplete(SocketContext, *Cqes[0]);
+            //
+            // Consecutive receive completions on a socket are indicated as one
+            // chain.
+            //
+            if (RecvBatch.SocketContext != SocketContext) {
+                if (RecvBatch.SocketContext != NULL) {
+                    CxPlatSocketContextRecvFlush(&RecvBatch);
+                }
+                RecvBatch.SocketContext = SocketContext;
+            }
+            CxPlatSocketReceiveComplete(SocketContext, *Cqes[0], &RecvBatch);
             break;
         case DatapathContextSend:
             CxPlatSocketContextSendComplete(SocketContext, *Cqes[0]);
@@ -2261,6 +2659,10 @@ CxPlatSocketContextIoEventComplete(
         SocketContext = GetSocketContextFromSqe(Sqe);
     }
 
+    if (RecvBatch.SocketContext != NULL) {
+        CxPlatSocketContextRecvFlush(&RecvBatch);
+    }
+
     io_uring_submit(&EventQ->Ring);
 
     CxPlatLockRelease(&EventQ->Lock);
@@ -194,7 +194,8 @@ Error:
 QUIC_STATUS
 CxPlatSocketConfigureRss(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
-    _In_ uint32_t SocketCount
+    _In_ uint32_t SocketCount,
+    _In_opt_ const CXPLAT_UDP_CONFIG* Config
     )
 {
 #ifdef SO_ATTACH_REUSEPORT_CBPF
@@ -211,6 +212,48 @@ CxPlatSocketConfigureRss(
 	BpfConfig.len = ARRAYSIZE(BpfCode);
     BpfConfig.filter = BpfCode;
 
+    //
+    // Server sockets may additionally steer short header packets by the
+    // partition ID the core encodes (in host byte order) right after the
+    // server ID of every CID it issues. Socket N is owned by partition N, so
+    // packets for migrated or NAT rebound connections still land on the
+    // partition that owns them. Long header packets (and anything too short
+    // to hold a CID) keep the CPU based steering above. The program sees the
+    // UDP payload, starting at the first byte of the QUIC header.
+    //
+    const uint32_t PartitionIdOffset =
+        Config != NULL ? 1 + (uint32_t)Config->CidPartitionIdOffset : 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const uint32_t PartitionIdHigh = PartitionIdOffset;
+    const uint32_t PartitionIdLow = PartitionIdOffset + 1;
+#else
+    const uint32_t PartitionIdHigh = PartitionIdOffset + 1;
+    const uint32_t PartitionIdLow = PartitionIdOffset;
+#endif
+    struct sock_filter CidBpfCode[] = {
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, 0}, // Load first byte
+        {BPF_JMP | BPF_JSET | BPF_K, 11, 0, 0x80}, // Long header -> CPU
+        {BPF_LD | BPF_W | BPF_LEN, 0, 0, 0}, // Load payload length
+        {BPF_JMP | BPF_JGE | BPF_K, 0, 9, PartitionIdOffset + 2}, // Too short -> CPU
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, PartitionIdHigh}, // Load partition ID high byte
+        {BPF_ALU | BPF_LSH | BPF_K, 0, 0, 8}, // Shift into place
+        {BPF_MISC | BPF_TAX, 0, 0, 0}, // Stash in X
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, PartitionIdLow}, // Load partition ID low byte
+        {BPF_ALU | BPF_OR | BPF_X, 0, 0, 0}, // Combine with high byte
+        {BPF_ALU | BPF_AND | BPF_K, 0, 0, Config != NULL ? Config->CidPartitionMask : 0}, // AND by PartitionMask
+        {BPF_ALU | BPF_MOD, 0, 0, Config != NULL ? Config->CidPartitionCount : 1}, // MOD by PartitionCount
+        {BPF_ALU | BPF_MOD, 0, 0, SocketCount}, // MOD by SocketCount
+        {BPF_RET | BPF_A, 0, 0, 0}, // Return
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, SKF_AD_OFF | SKF_AD_CPU}, // Load CPU number
+        {BPF_ALU | BPF_MOD, 0, 0, SocketCount}, // MOD by SocketCount
+        {BPF_RET | BPF_A, 0, 0, 0} // Return
+    };
+
+    if (Config != NULL && Config->CidPartitionCount != 0) {
+        BpfConfig.len = ARRAYSIZE(CidBpfCode);
+        BpfConfig.filter = CidBpfCode;
+    }
+
     Result =
         setsockopt(
             SocketContext->SocketFd,
@@ -232,6 +275,7 @@ CxPlatSocketConfigureRss(
 #else
     UNREFERENCED_PARAMETER(SocketContext);
     UNREFERENCED_PARAMETER(SocketCount);
+    UNREFERENCED_PARAMETER(Config);
     return QUIC_STATUS_NOT_SUPPORTED;
 #endif
 }
@@ -42,7 +42,8 @@ CxPlatDataPathCalculateFeatureSupport(
 QUIC_STATUS
 CxPlatSocketConfigureRss(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
-    _In_ uint32_t SocketCount
+    _In_ uint32_t SocketCount,
+    _In_opt_ const CXPLAT_UDP_CONFIG* Config
     );
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
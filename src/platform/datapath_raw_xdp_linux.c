@@ -32,6 +32,7 @@ Abstract:
 #define PROD_NUM_DESCS     NUM_FRAMES / 2
 #define FRAME_SIZE         XSK_UMEM__DEFAULT_FRAME_SIZE // TODO: 2K mode
 #define INVALID_UMEM_FRAME UINT64_MAX
+#define FQ_REFILL_BATCH    64 // Minimum free fill ring slots before refilling
 
 struct XskSocketInfo {
     struct xsk_ring_cons Rx;
@@ -67,6 +68,7 @@ typedef struct XDP_DATAPATH { // NOLINT(clang-analyzer-optin.performance.Padding
     uint32_t PollingIdleTimeoutUs;
     BOOLEAN TxAlwaysPoke;
     BOOLEAN SkipXsum;
+    BOOLEAN ZeroCopy;       // Try native mode and zero-copy UMEM first.
     BOOLEAN Running;        // Signal to stop workers.
 
     CXPLAT_RUNDOWN_REF Rundown;
@@ -205,6 +207,16 @@ CxPlatXdpReadConfig(
     // Default config.
     //
     Xdp->TxAlwaysPoke = FALSE;
+    Xdp->ZeroCopy = FALSE;
+
+    //
+    // Zero-copy needs the XDP program attached in native (driver) mode, which
+    // doesn't work on every NIC (e.g. eth0 on azure VMs), so it's opt-in.
+    //
+    const char* ZeroCopy = getenv("MSQUIC_XDP_ZEROCOPY");
+    if (ZeroCopy != NULL && strcmp(ZeroCopy, "1") == 0) {
+        Xdp->ZeroCopy = TRUE;
+    }
 }
 
 void UninitializeUmem(struct XskUmemInfo* UmemInfo)
@@ -363,10 +375,13 @@ AttachXdpProgram(struct xdp_program *Prog, XDP_INTERFACE *Interface, struct xsk_
         unsigned int xdp_flag;
     } AttachTypePairs[]  = {
         // { XDP_MODE_HW, XDP_FLAGS_HW_MODE },
-        // { XDP_MODE_NATIVE, XDP_FLAGS_DRV_MODE },
+        { XDP_MODE_NATIVE, XDP_FLAGS_DRV_MODE },
         { XDP_MODE_SKB, XDP_FLAGS_SKB_MODE },
     };
-    for (uint32_t i = 0; i < ARRAYSIZE(AttachTypePairs); i++) {
+    //
+    // Native mode is only attempted when zero-copy was requested.
+    //
+    for (uint32_t i = Interface->Xdp->ZeroCopy ? 0 : 1; i < ARRAYSIZE(AttachTypePairs); i++) {
         err = xdp_program__attach(Prog, Interface->IfIndex, AttachTypePairs[i].mode, 0);
         if (!err) {
             Interface->AttachMode = AttachTypePairs[i].mode;
@@ -476,10 +491,6 @@ CxPlatDpRawInterfaceInitialize(
     XskCfg->rx_size = CONS_NUM_DESCS;
     XskCfg->tx_size = PROD_NUM_DESCS;
     XskCfg->libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
-    // TODO: check ZEROCOPY feature, change Tx/Rx behavior based on feature
-    //       refer xdp-tools/xdp-loader/xdp-loader features <ifname>
-    XskCfg->bind_flags &= ~XDP_ZEROCOPY;
-    XskCfg->bind_flags |= XDP_COPY;
     XskCfg->bind_flags |= XDP_USE_NEED_WAKEUP;
     Interface->XskCfg = XskCfg;
 
@@ -495,6 +506,16 @@ CxPlatDpRawInterfaceInitialize(
         goto Error;
     }
 
+    //
+    // Zero-copy requires driver support in native mode. If the driver turns
+    // it down at bind time, the sockets fall back to copy mode below.
+    //
+    if (Xdp->ZeroCopy && Interface->AttachMode == XDP_MODE_NATIVE) {
+        XskCfg->bind_flags |= XDP_ZEROCOPY;
+    } else {
+        XskCfg->bind_flags |= XDP_COPY;
+    }
+
     int XskBypassMapFd = bpf_map__fd(bpf_object__find_map_by_name(xdp_program__bpf_obj(Interface->XdpProg), "xsks_map"));
     if (XskBypassMapFd < 0) {
         QuicTraceLogVerbose(
@@ -577,6 +598,14 @@ CxPlatDpRawInterfaceInitialize(
                         &XskInfo->Tx, XskCfg);
             if (Ret == -EBUSY) {
                 CxPlatSleep(100);
+            } else if (Ret == -EOPNOTSUPP && (XskCfg->bind_flags & XDP_ZEROCOPY)) {
+                QuicTraceLogVerbose(
+                    XdpZeroCopyNotSupported,
+                    "[ xdp] Zero-copy not supported on %s, falling back to copy mode",
+                    Interface->IfName);
+                XskCfg->bind_flags &= ~XDP_ZEROCOPY;
+                XskCfg->bind_flags |= XDP_COPY;
+                Ret = -EBUSY; // Retry immediately in copy mode.
             }
         } while (Ret == -EBUSY && RetryCount-- > 0);
         if (Ret < 0) {
@@ -681,14 +710,13 @@ CxPlatDpRawInitialize(
 
     CxPlatListInitializeHead(&Xdp->Interfaces);
     Xdp->PollingIdleTimeoutUs = 0;
+    CxPlatXdpReadConfig(Xdp);
     Xdp->PartitionCount = CxPlatWorkerPoolGetCount(WorkerPool);
     for (uint32_t i = 0; i < Xdp->PartitionCount; i++) {
         Xdp->Partitions[i].Processor = (uint16_t)
             CxPlatWorkerPoolGetIdealProcessor(WorkerPool, i);
     }
 
-    //CxPlatXdpReadConfig(Xdp); // TODO - Make this more secure
-
     QuicTraceLogVerbose(
         XdpInitialize,
         "[ xdp][%p] XDP initialized, %u procs",
@@ -1047,6 +1075,37 @@ CxPlatDpRawRxFree(
     }
 }
 
+//
+// Returns all completed TX frames to the UMEM in one batch.
+//
+static
+uint32_t
+XskReapCompletions(
+    _In_ CXPLAT_QUEUE* Queue
+    )
+{
+    struct XskSocketInfo* XskInfo = Queue->XskInfo;
+    uint32_t Completed;
+    uint32_t CqIdx;
+    CxPlatLockAcquire(&Queue->CqLock);
+    Completed = xsk_ring_cons__peek(&XskInfo->UmemInfo->Cq, CONS_NUM_DESCS, &CqIdx);
+    if (Completed > 0) {
+        CxPlatLockAcquire(&XskInfo->UmemLock);
+        for (uint32_t i = 0; i < Completed; i++) {
+            uint64_t addr = *xsk_ring_cons__comp_addr(&XskInfo->UmemInfo->Cq, CqIdx++) - XskInfo->UmemInfo->TxHeadRoom;
+            XskUmemFrameFree(XskInfo, addr);
+        }
+        CxPlatLockRelease(&XskInfo->UmemLock);
+
+        xsk_ring_cons__release(&XskInfo->UmemInfo->Cq, Completed);
+        QuicTraceLogVerbose(
+            ReleaseCons,
+            "[ xdp][cq  ] Release %d from completion queue", Completed);
+    }
+    CxPlatLockRelease(&Queue->CqLock);
+    return Completed;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 CXPLAT_SEND_DATA*
 CxPlatDpRawTxAlloc(
@@ -1060,6 +1119,15 @@ CxPlatDpRawTxAlloc(
     CxPlatLockAcquire(&XskInfo->UmemLock);
     uint64_t BaseAddr = XskUmemFrameAlloc(XskInfo);
     CxPlatLockRelease(&XskInfo->UmemLock);
+    if (BaseAddr == INVALID_UMEM_FRAME && XskReapCompletions(Queue) > 0) {
+        //
+        // Completions are normally reaped by the partition; when the UMEM runs
+        // dry, reclaim whatever the kernel is already done with.
+        //
+        CxPlatLockAcquire(&XskInfo->UmemLock);
+        BaseAddr = XskUmemFrameAlloc(XskInfo);
+        CxPlatLockRelease(&XskInfo->UmemLock);
+    }
     if (BaseAddr == INVALID_UMEM_FRAME) {
         QuicTraceLogVerbose(
             FailTxAlloc,
@@ -1100,40 +1168,31 @@ KickTx(
     )
 {
     struct XskSocketInfo* XskInfo = Queue->XskInfo;
-    if (sendto(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, 0) < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            if (!SendAlreadyPending) {
-                XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
+
+    //
+    // With need_wakeup, a driver that is already processing the TX ring
+    // (zero-copy) clears the flag and the syscall can be skipped. Copy mode
+    // always needs it, since the kernel only transmits from sendto.
+    //
+    if (xsk_ring_prod__needs_wakeup(&XskInfo->Tx)) {
+        if (sendto(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, 0) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!SendAlreadyPending) {
+                    XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
+                }
+                return;
             }
-            return;
         }
+        QuicTraceLogVerbose(
+            DoneSendTo,
+            "[ xdp][TX  ] Done sendto.");
     }
-    QuicTraceLogVerbose(
-        DoneSendTo,
-        "[ xdp][TX  ] Done sendto.");
 
     if (SendAlreadyPending) {
         XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN);
     }
 
-    uint32_t Completed;
-    uint32_t CqIdx;
-    CxPlatLockAcquire(&Queue->CqLock);
-    Completed = xsk_ring_cons__peek(&XskInfo->UmemInfo->Cq, CONS_NUM_DESCS, &CqIdx);
-    if (Completed > 0) {
-        CxPlatLockAcquire(&XskInfo->UmemLock);
-        for (uint32_t i = 0; i < Completed; i++) {
-            uint64_t addr = *xsk_ring_cons__comp_addr(&XskInfo->UmemInfo->Cq, CqIdx++) - XskInfo->UmemInfo->TxHeadRoom;
-            XskUmemFrameFree(XskInfo, addr);
-        }
-        CxPlatLockRelease(&XskInfo->UmemLock);
-
-        xsk_ring_cons__release(&XskInfo->UmemInfo->Cq, Completed);
-        QuicTraceLogVerbose(
-            ReleaseCons,
-            "[ xdp][cq  ] Release %d from completion queue", Completed);
-    }
-    CxPlatLockRelease(&Queue->CqLock);
+    XskReapCompletions(Queue);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -1150,6 +1209,7 @@ CxPlatDpRawTxEnqueue(
     uint32_t TxIdx = 0;
     CxPlatLockAcquire(&Queue->TxLock);
     if (xsk_ring_prod__reserve(&XskInfo->Tx, 1, &TxIdx) != 1) {
+        CxPlatLockRelease(&Queue->TxLock);
         CxPlatLockAcquire(&XskInfo->UmemLock);
         XskUmemFrameFree(XskInfo, Packet->UmemRelativeAddr);
         CxPlatLockRelease(&XskInfo->UmemLock);
@@ -1164,12 +1224,18 @@ CxPlatDpRawTxEnqueue(
     tx_desc->addr = Packet->UmemRelativeAddr + XskInfo->UmemInfo->TxHeadRoom;
     tx_desc->len = SendData->Buffer.Length;
     xsk_ring_prod__submit(&XskInfo->Tx, 1);
+    const BOOLEAN WasQueued = Queue->TxQueued;
+    Queue->TxQueued = TRUE;
     CxPlatLockRelease(&Queue->TxLock);
 
-    KickTx(Packet->Queue, FALSE);
-
-    Partition->Ec.Ready = TRUE;
-    CxPlatWakeExecutionContext(&Partition->Ec);
+    //
+    // The partition kicks the TX ring once for everything submitted since
+    // its last pass, instead of a syscall per packet.
+    //
+    if (!WasQueued) {
+        Partition->Ec.Ready = TRUE;
+        CxPlatWakeExecutionContext(&Partition->Ec);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -1204,8 +1270,21 @@ CxPlatXdpTx(
     )
 {
     UNREFERENCED_PARAMETER(Xdp);
-    UNREFERENCED_PARAMETER(Queue);
-    return FALSE;
+
+    CxPlatLockAcquire(&Queue->TxLock);
+    const BOOLEAN TxQueued = Queue->TxQueued;
+    Queue->TxQueued = FALSE;
+    CxPlatLockRelease(&Queue->TxLock);
+
+    if (TxQueued) {
+        KickTx(Queue, FALSE);
+        return TRUE;
+    }
+
+    //
+    // Zero-copy drivers complete sends asynchronously, so keep reaping.
+    //
+    return XskReapCompletions(Queue) > 0;
 }
 
 static
@@ -1273,7 +1352,6 @@ CxPlatXdpRx(
     uint32_t Rcvd, i;
     uint32_t Available;
     uint32_t RxIdx = 0, FqIdx = 0;
-    unsigned int ret;
 
     CxPlatLockAcquire(&Queue->RxLock);
     Rcvd = xsk_ring_cons__peek(&XskInfo->Rx, RX_BATCH_SIZE, &RxIdx);
@@ -1327,41 +1405,42 @@ CxPlatXdpRx(
     }
     CxPlatLockRelease(&Queue->RxLock);
 
+    //
+    // Refill the fill ring in batches, rather than a few frames per pass.
+    //
+    uint32_t Filled = 0;
     CxPlatLockAcquire(&XskInfo->UmemLock);
     CxPlatLockAcquire(&Queue->FqLock);
-    // Stuff the ring with as much frames as possible
-    Available = xsk_prod_nb_free(&XskInfo->UmemInfo->Fq, XskUmemFreeFrames(XskInfo));
-    if (Available > 0) {
-        ret = xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, Available, &FqIdx);
-
-        // This should not happen, but just in case
-        while (ret != Available) {
-            ret = xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, Rcvd, &FqIdx);
-        }
-        for (i = 0; i < Available; i++) {
-            uint64_t addr = XskUmemFrameAlloc(XskInfo);
-            if (addr == INVALID_UMEM_FRAME) {
-                QuicTraceLogVerbose(
-                    FailRxAlloc,
-                    "[ xdp][rx  ] OOM for Rx");
-                break;
+    Available = xsk_prod_nb_free(&XskInfo->UmemInfo->Fq, FQ_REFILL_BATCH);
+    if (Available >= FQ_REFILL_BATCH) {
+        Available = (uint32_t)CXPLAT_MIN(Available, XskUmemFreeFrames(XskInfo));
+        if (Available > 0 &&
+            xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, Available, &FqIdx) == Available) {
+            for (; Filled < Available; Filled++) {
+                *xsk_ring_prod__fill_addr(&XskInfo->UmemInfo->Fq, FqIdx++) =
+                    XskUmemFrameAlloc(XskInfo);
             }
-            *xsk_ring_prod__fill_addr(&XskInfo->UmemInfo->Fq, FqIdx++) = addr;
-        }
-        if (i > 0) {
-            xsk_ring_prod__submit(&XskInfo->UmemInfo->Fq, i);
+            xsk_ring_prod__submit(&XskInfo->UmemInfo->Fq, Filled);
         }
     }
     CxPlatLockRelease(&Queue->FqLock);
     CxPlatLockRelease(&XskInfo->UmemLock);
 
+    //
+    // In zero-copy mode, a driver that ran out of fill ring entries stops
+    // and sets need_wakeup until it's poked.
+    //
+    if (Rcvd == 0 && xsk_ring_prod__needs_wakeup(&XskInfo->UmemInfo->Fq)) {
+        recvfrom(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, NULL);
+    }
+
     if (PacketCount) {
         CxPlatDpRawRxEthernet(
             (CXPLAT_DATAPATH_RAW*)Queue->Partition->Xdp,
             Buffers,
             (uint16_t)PacketCount);
     }
-    return PacketCount > 0 || i > 0;
+    return PacketCount > 0 || Filled > 0;
 }
 
 void
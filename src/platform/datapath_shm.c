@@ -0,0 +1,1574 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    QUIC shared memory loopback datapath. Replaces the UDP socket datapath for
+    in-host benchmarking: datagrams are exchanged between processes (or
+    threads) through memfd-backed, single producer single consumer rings, so
+    the kernel network stack is kept off the data path entirely.
+
+    Every socket is identified by its UDP port, which names an abstract unix
+    datagram socket (the "doorbell"). The first send to a peer creates a ring
+    for that local/remote address pair and hands its file descriptor to the
+    peer over the doorbell. After that, the doorbell only carries single byte
+    wake ups, and only when the consuming socket has gone idle.
+
+    TCP is not supported.
+
+Environment:
+
+    Linux
+
+--*/
+
+#include "platform_internal.h"
+#include "datapath_linux.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#ifdef QUIC_CLOG
+#include "datapath_shm.c.clog.h"
+#endif
+
+#define CXPLAT_SHM_CACHE_LINE           64
+#define CXPLAT_SHM_RING_MAGIC           0x4D534851  // "QHSM"
+#define CXPLAT_SHM_RING_ENTRY_COUNT     1024        // Must be a power of 2
+#define CXPLAT_SHM_RECV_BATCH_SIZE      32          // Datagrams per receive indication
+#define CXPLAT_SHM_RECV_MAX_ROUNDS      16          // Batches per ring before yielding
+#define CXPLAT_SHM_PORT_RANGE_START     49152
+#define CXPLAT_SHM_BIND_ATTEMPTS        64
+#define CXPLAT_SHM_HOP_LIMIT            64          // What a looped back datagram carries
+
+#define CXPLAT_SHM_DOORBELL_WAKE        'W'
+#define CXPLAT_SHM_DOORBELL_RING        'R'         // Carries the ring fd (SCM_RIGHTS)
+
+//
+// A single datagram slot in a ring.
+//
+typedef struct CXPLAT_SHM_RING_ENTRY {
+    uint16_t Length;
+    uint8_t TOS;
+    uint8_t Reserved;
+    uint8_t Data[CXPLAT_SMALL_IO_BUFFER_SIZE];
+} CXPLAT_SHM_RING_ENTRY;
+
+//
+// The start of the shared memory ring. The producer and consumer indexes are
+// free running and kept on separate cache lines.
+//
+typedef struct CXPLAT_SHM_RING_HEADER {
+    uint32_t Magic;
+    uint32_t EntryCount;
+    uint32_t EntrySize;
+
+    //
+    // Set by the producer once it will no longer publish to the ring.
+    //
+    uint32_t Closed;
+
+    QUIC_ADDR Source;
+    QUIC_ADDR Destination;
+
+    //
+    // Written only by the producer.
+    //
+    alignas(CXPLAT_SHM_CACHE_LINE)
+    uint32_t Tail;
+
+    //
+    // Written only by the consumer.
+    //
+    alignas(CXPLAT_SHM_CACHE_LINE)
+    uint32_t Head;
+
+    //
+    // Set by the consumer before it goes idle; cleared by the first producer
+    // to publish afterwards, which then rings the doorbell.
+    //
+    alignas(CXPLAT_SHM_CACHE_LINE)
+    uint32_t NeedWakeup;
+
+} CXPLAT_SHM_RING_HEADER;
+
+#define CXPLAT_SHM_RING_ENTRIES_OFFSET \
+    ALIGN_UP_BY(sizeof(CXPLAT_SHM_RING_HEADER), CXPLAT_SHM_CACHE_LINE)
+#define CXPLAT_SHM_RING_ENTRY_SIZE \
+    ALIGN_UP_BY(sizeof(CXPLAT_SHM_RING_ENTRY), CXPLAT_SHM_CACHE_LINE)
+#define CXPLAT_SHM_RING_LENGTH \
+    (CXPLAT_SHM_RING_ENTRIES_OFFSET + CXPLAT_SHM_RING_ENTRY_COUNT * CXPLAT_SHM_RING_ENTRY_SIZE)
+
+//
+// A process local reference to a mapped ring. The geometry and addresses are
+// copied out of the shared header when the ring is mapped, so a misbehaving
+// peer can't change them afterwards.
+//
+typedef struct CXPLAT_SHM_RING {
+    CXPLAT_LIST_ENTRY Link;
+    CXPLAT_SHM_RING_HEADER* Header;
+    size_t Length;
+    int Fd; // Only valid until the ring is handed to the peer.
+    uint32_t EntryMask;
+    uint32_t EntrySize;
+    QUIC_ADDR Source;
+    QUIC_ADDR Destination;
+} CXPLAT_SHM_RING;
+
+//
+// Contains all the info for a single received datagram.
+//
+typedef struct __attribute__((aligned(16))) DATAPATH_RX_IO_BLOCK {
+    //
+    // Represents the network route.
+    //
+    CXPLAT_ROUTE Route;
+
+    //
+    // Ref count of receive data/packets that are using this block.
+    //
+    long RefCount;
+
+} DATAPATH_RX_IO_BLOCK;
+
+typedef struct __attribute__((aligned(16))) DATAPATH_RX_PACKET {
+    //
+    // The IO block that owns the packet.
+    //
+    DATAPATH_RX_IO_BLOCK* IoBlock;
+
+    //
+    // Publicly visible receive data.
+    //
+    CXPLAT_RECV_DATA Data;
+
+} DATAPATH_RX_PACKET;
+
+//
+// Send context.
+//
+
+typedef struct CXPLAT_SEND_DATA {
+    CXPLAT_SEND_DATA_COMMON;
+    //
+    // The socket context owning this send.
+    //
+    struct CXPLAT_SOCKET_CONTEXT* SocketContext;
+
+    //
+    // The current QUIC_BUFFER returned to the client for segmented sends.
+    //
+    QUIC_BUFFER ClientBuffer;
+
+    //
+    // Total number of packet buffers allocated.
+    //
+    uint16_t BufferCount;
+
+    //
+    // Set of flags set to configure the send behavior.
+    //
+    uint8_t Flags; // CXPLAT_SEND_FLAGS
+
+    //
+    // Space for all the packet buffers. Each SegmentSize bytes is copied into
+    // its own ring entry on send.
+    //
+    uint8_t Buffer[CXPLAT_LARGE_IO_BUFFER_SIZE];
+
+} CXPLAT_SEND_DATA;
+
+CXPLAT_EVENT_COMPLETION CxPlatSocketContextUninitializeEventComplete;
+CXPLAT_EVENT_COMPLETION CxPlatSocketContextIoEventComplete;
+
+void
+CxPlatProcessorContextInitialize(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_ uint16_t PartitionIndex,
+    _Out_ CXPLAT_DATAPATH_PARTITION* DatapathPartition
+    )
+{
+    CXPLAT_DBG_ASSERT(Datapath != NULL);
+    DatapathPartition->Datapath = Datapath;
+    DatapathPartition->PartitionIndex = PartitionIndex;
+    DatapathPartition->EventQ = CxPlatWorkerPoolGetEventQ(Datapath->WorkerPool, PartitionIndex);
+    CxPlatRefInitialize(&DatapathPartition->RefCount);
+    CxPlatPoolInitialize(TRUE, Datapath->RecvBlockSize, QUIC_POOL_DATA, &DatapathPartition->RecvBlockPool);
+    CxPlatPoolInitialize(TRUE, Datapath->SendDataSize, QUIC_POOL_DATA, &DatapathPartition->SendBlockPool);
+}
+
+QUIC_STATUS
+DataPathInitialize(
+    _In_ uint32_t ClientRecvDataLength,
+    _In_opt_ const CXPLAT_UDP_DATAPATH_CALLBACKS* UdpCallbacks,
+    _In_opt_ const CXPLAT_TCP_DATAPATH_CALLBACKS* TcpCallbacks,
+    _In_ CXPLAT_WORKER_POOL* WorkerPool,
+    _Out_ CXPLAT_DATAPATH** NewDatapath
+    )
+{
+    UNREFERENCED_PARAMETER(TcpCallbacks);
+
+    if (NewDatapath == NULL) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+    if (UdpCallbacks != NULL) {
+        if (UdpCallbacks->Receive == NULL || UdpCallbacks->Unreachable == NULL) {
+            return QUIC_STATUS_INVALID_PARAMETER;
+        }
+    }
+    if (WorkerPool == NULL) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+    const size_t DatapathLength =
+        sizeof(CXPLAT_DATAPATH) +
+        CxPlatWorkerPoolGetCount(WorkerPool) * sizeof(CXPLAT_DATAPATH_PARTITION);
+
+    CXPLAT_DATAPATH* Datapath =
+        (CXPLAT_DATAPATH*)CXPLAT_ALLOC_PAGED(DatapathLength, QUIC_POOL_DATAPATH);
+    if (Datapath == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_DATAPATH",
+            DatapathLength);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(Datapath, DatapathLength);
+    if (UdpCallbacks) {
+        Datapath->UdpHandlers = *UdpCallbacks;
+    }
+    Datapath->WorkerPool = WorkerPool;
+
+    Datapath->PartitionCount = (uint16_t)CxPlatWorkerPoolGetCount(WorkerPool);
+    CxPlatRefInitializeEx(&Datapath->RefCount, Datapath->PartitionCount);
+
+    //
+    // Segmentation is free here: every segment of a send is copied into its
+    // own ring entry and published together.
+    //
+    Datapath->Features =
+        CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION |
+        CXPLAT_DATAPATH_FEATURE_TTL |
+        CXPLAT_DATAPATH_FEATURE_SEND_DSCP |
+        CXPLAT_DATAPATH_FEATURE_RECV_DSCP;
+    Datapath->SendDataSize = sizeof(CXPLAT_SEND_DATA);
+    Datapath->SendIoVecCount = 1;
+
+    Datapath->RecvBlockStride =
+        ALIGN_UP_BY(sizeof(DATAPATH_RX_PACKET) + ClientRecvDataLength, CXPLAT_MEMORY_ALIGNMENT);
+    Datapath->RecvBlockBufferOffset =
+        ALIGN_UP_BY(
+            sizeof(DATAPATH_RX_IO_BLOCK) + Datapath->RecvBlockStride, CXPLAT_MEMORY_ALIGNMENT);
+    Datapath->RecvBlockSize =
+        ALIGN_UP_BY(
+            Datapath->RecvBlockBufferOffset + CXPLAT_SMALL_IO_BUFFER_SIZE,
+            CXPLAT_MEMORY_ALIGNMENT);
+
+    //
+    // Initialize the per processor contexts.
+    //
+    for (uint32_t i = 0; i < Datapath->PartitionCount; i++) {
+        CxPlatProcessorContextInitialize(
+            Datapath, i, &Datapath->Partitions[i]);
+    }
+
+    CXPLAT_FRE_ASSERT(CxPlatWorkerPoolAddRef(WorkerPool));
+    *NewDatapath = Datapath;
+
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatDataPathRelease(
+    _In_ CXPLAT_DATAPATH* Datapath
+    )
+{
+    if (CxPlatRefDecrement(&Datapath->RefCount)) {
+#if DEBUG
+        CXPLAT_DBG_ASSERT(!Datapath->Freed);
+        CXPLAT_DBG_ASSERT(Datapath->Uninitialized);
+        Datapath->Freed = TRUE;
+#endif
+        CxPlatWorkerPoolRelease(Datapath->WorkerPool);
+        CXPLAT_FREE(Datapath, QUIC_POOL_DATAPATH);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatProcessorContextRelease(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition
+    )
+{
+    if (CxPlatRefDecrement(&DatapathPartition->RefCount)) {
+#if DEBUG
+        CXPLAT_DBG_ASSERT(!DatapathPartition->Uninitialized);
+        DatapathPartition->Uninitialized = TRUE;
+#endif
+        CxPlatPoolUninitialize(&DatapathPartition->SendBlockPool);
+        CxPlatPoolUninitialize(&DatapathPartition->RecvBlockPool);
+        CxPlatDataPathRelease(DatapathPartition->Datapath);
+    }
+}
+
+void
+DataPathUninitialize(
+    _In_ CXPLAT_DATAPATH* Datapath
+    )
+{
+    if (Datapath != NULL) {
+#if DEBUG
+        CXPLAT_DBG_ASSERT(!Datapath->Uninitialized);
+        Datapath->Uninitialized = TRUE;
+#endif
+        const uint16_t PartitionCount = Datapath->PartitionCount;
+        for (uint32_t i = 0; i < PartitionCount; i++) {
+            CxPlatProcessorContextRelease(&Datapath->Partitions[i]);
+        }
+    }
+}
+
+//
+// Shared memory rings.
+//
+
+static
+void
+CxPlatShmRingFree(
+    _In_ CXPLAT_SHM_RING* Ring
+    )
+{
+    if (Ring->Header != NULL) {
+        munmap(Ring->Header, Ring->Length);
+    }
+    if (Ring->Fd != -1) {
+        close(Ring->Fd);
+    }
+    CXPLAT_FREE(Ring, QUIC_POOL_SOCKET);
+}
+
+QUIC_INLINE
+CXPLAT_SHM_RING_ENTRY*
+CxPlatShmRingGetEntry(
+    _In_ const CXPLAT_SHM_RING* Ring,
+    _In_ uint32_t Index
+    )
+{
+    return
+        (CXPLAT_SHM_RING_ENTRY*)
+            ((uint8_t*)Ring->Header + CXPLAT_SHM_RING_ENTRIES_OFFSET +
+             (size_t)(Index & Ring->EntryMask) * Ring->EntrySize);
+}
+
+//
+// Creates a new, not yet shared, ring for sending from Source to Destination.
+//
+QUIC_STATUS
+CxPlatShmRingCreate(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ const QUIC_ADDR* Source,
+    _In_ const QUIC_ADDR* Destination,
+    _Out_ CXPLAT_SHM_RING** NewRing
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    CXPLAT_SHM_RING* Ring =
+        (CXPLAT_SHM_RING*)CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_SHM_RING), QUIC_POOL_SOCKET);
+    if (Ring == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SHM_RING",
+            sizeof(CXPLAT_SHM_RING));
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(Ring, sizeof(*Ring));
+    Ring->Length = CXPLAT_SHM_RING_LENGTH;
+    Ring->EntryMask = CXPLAT_SHM_RING_ENTRY_COUNT - 1;
+    Ring->EntrySize = CXPLAT_SHM_RING_ENTRY_SIZE;
+    Ring->Source = *Source;
+    Ring->Destination = *Destination;
+
+    Ring->Fd = memfd_create("msquic-shm-ring", MFD_CLOEXEC);
+    if (Ring->Fd == -1) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            Status,
+            "memfd_create failed");
+        goto Exit;
+    }
+
+    if (ftruncate(Ring->Fd, (off_t)Ring->Length) != 0) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            Status,
+            "ftruncate failed");
+        goto Exit;
+    }
+
+    void* Mapping = mmap(NULL, Ring->Length, PROT_READ | PROT_WRITE, MAP_SHARED, Ring->Fd, 0);
+    if (Mapping == MAP_FAILED) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            Status,
+            "mmap failed");
+        goto Exit;
+    }
+
+    //
+    // The file starts out zeroed, so only the constant fields need writing.
+    //
+    Ring->Header = (CXPLAT_SHM_RING_HEADER*)Mapping;
+    Ring->Header->Magic = CXPLAT_SHM_RING_MAGIC;
+    Ring->Header->EntryCount = CXPLAT_SHM_RING_ENTRY_COUNT;
+    Ring->Header->EntrySize = CXPLAT_SHM_RING_ENTRY_SIZE;
+    Ring->Header->Source = *Source;
+    Ring->Header->Destination = *Destination;
+
+    *NewRing = Ring;
+    Ring = NULL;
+
+Exit:
+
+    if (Ring != NULL) {
+        CxPlatShmRingFree(Ring);
+    }
+
+    return Status;
+}
+
+//
+// Maps a ring handed over by a peer and adds it to the socket's receive set.
+// Always takes ownership of the file descriptor.
+//
+void
+CxPlatSocketContextMapRing(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ int Fd
+    )
+{
+    struct stat Stat;
+    CXPLAT_SHM_RING* Ring = NULL;
+
+    if (fstat(Fd, &Stat) != 0 ||
+        (size_t)Stat.st_size < CXPLAT_SHM_RING_ENTRIES_OFFSET) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            EINVAL,
+            "Invalid shared memory ring");
+        goto Exit;
+    }
+
+    Ring = (CXPLAT_SHM_RING*)CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_SHM_RING), QUIC_POOL_SOCKET);
+    if (Ring == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SHM_RING",
+            sizeof(CXPLAT_SHM_RING));
+        goto Exit;
+    }
+
+    CxPlatZeroMemory(Ring, sizeof(*Ring));
+    Ring->Fd = -1;
+    Ring->Length = (size_t)Stat.st_size;
+
+    void* Mapping = mmap(NULL, Ring->Length, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (Mapping == MAP_FAILED) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "mmap failed");
+        goto Exit;
+    }
+    Ring->Header = (CXPLAT_SHM_RING_HEADER*)Mapping;
+
+    const uint32_t EntryCount = Ring->Header->EntryCount;
+    const uint32_t EntrySize = Ring->Header->EntrySize;
+    if (Ring->Header->Magic != CXPLAT_SHM_RING_MAGIC ||
+        EntryCount == 0 || (EntryCount & (EntryCount - 1)) != 0 ||
+        EntrySize < sizeof(CXPLAT_SHM_RING_ENTRY) ||
+        CXPLAT_SHM_RING_ENTRIES_OFFSET + (size_t)EntryCount * EntrySize > Ring->Length) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            EINVAL,
+            "Invalid shared memory ring");
+        goto Exit;
+    }
+    Ring->EntryMask = EntryCount - 1;
+    Ring->EntrySize = EntrySize;
+    Ring->Source = Ring->Header->Source;
+    Ring->Destination = Ring->Header->Destination;
+
+    CxPlatListInsertTail(&SocketContext->RxRings, &Ring->Link);
+    Ring = NULL;
+
+Exit:
+
+    if (Ring != NULL) {
+        CxPlatShmRingFree(Ring);
+    }
+    close(Fd);
+}
+
+//
+// Copies each segment of the send into its own entry and publishes them all
+// with a single tail update. Segments that don't fit in the ring are dropped,
+// as a full socket buffer would. Returns TRUE if the consumer needs a wake up.
+//
+BOOLEAN
+CxPlatShmRingPublish(
+    _In_ CXPLAT_SHM_RING* Ring,
+    _In_ const CXPLAT_SEND_DATA* SendData
+    )
+{
+    CXPLAT_SHM_RING_HEADER* Header = Ring->Header;
+    const uint32_t Head = __atomic_load_n(&Header->Head, __ATOMIC_ACQUIRE);
+    const uint8_t TOS = (uint8_t)(SendData->ECN | (SendData->DSCP << 2));
+    uint32_t Tail = Header->Tail;
+    uint32_t Offset = 0;
+
+    while (Offset < SendData->TotalSize && Tail - Head <= Ring->EntryMask) {
+        uint32_t Length = SendData->TotalSize - Offset;
+        if (SendData->SegmentSize != 0 && Length > SendData->SegmentSize) {
+            Length = SendData->SegmentSize;
+        }
+        CXPLAT_SHM_RING_ENTRY* Entry = CxPlatShmRingGetEntry(Ring, Tail);
+        Entry->Length = (uint16_t)Length;
+        Entry->TOS = TOS;
+        CxPlatCopyMemory(Entry->Data, SendData->Buffer + Offset, Length);
+        Offset += Length;
+        Tail++;
+    }
+
+    if (Offset < SendData->TotalSize) {
+        QuicTraceLogWarning(
+            DatapathShmRingFull,
+            "[data][%p] Shared memory ring full, dropping %u bytes.",
+            SendData->SocketContext->Binding,
+            SendData->TotalSize - Offset);
+    }
+
+    //
+    // Pairs with the consumer arming NeedWakeup and then re-checking the tail:
+    // either it sees this tail or this sees its wake up request.
+    //
+    __atomic_store_n(&Header->Tail, Tail, __ATOMIC_SEQ_CST);
+    return __atomic_exchange_n(&Header->NeedWakeup, 0, __ATOMIC_SEQ_CST) != 0;
+}
+
+//
+// Doorbells.
+//
+
+static
+socklen_t
+CxPlatShmDoorbellAddress(
+    _In_ uint16_t Port,
+    _Out_ struct sockaddr_un* Address
+    )
+{
+    CxPlatZeroMemory(Address, sizeof(*Address));
+    Address->sun_family = AF_UNIX;
+    int Length =
+        snprintf(
+            Address->sun_path + 1, sizeof(Address->sun_path) - 1, "msquic-shm-%hu", Port);
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + Length);
+}
+
+//
+// Rings the doorbell of the socket bound to Port, optionally handing over a
+// ring file descriptor.
+//
+QUIC_STATUS
+CxPlatSocketContextRingDoorbell(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ uint16_t Port,
+    _In_ int RingFd
+    )
+{
+    struct sockaddr_un Address;
+    char Type = RingFd == -1 ? CXPLAT_SHM_DOORBELL_WAKE : CXPLAT_SHM_DOORBELL_RING;
+    struct iovec IoVec = { .iov_base = &Type, .iov_len = sizeof(Type) };
+    alignas(struct cmsghdr) char ControlBuffer[CMSG_SPACE(sizeof(int))];
+    struct msghdr Mhdr = {
+        .msg_name = &Address,
+        .msg_namelen = CxPlatShmDoorbellAddress(Port, &Address),
+        .msg_iov = &IoVec,
+        .msg_iovlen = 1,
+    };
+
+    if (RingFd != -1) {
+        Mhdr.msg_control = ControlBuffer;
+        Mhdr.msg_controllen = sizeof(ControlBuffer);
+        struct cmsghdr* CMsg = CMSG_FIRSTHDR(&Mhdr);
+        CMsg->cmsg_level = SOL_SOCKET;
+        CMsg->cmsg_type = SCM_RIGHTS;
+        CMsg->cmsg_len = CMSG_LEN(sizeof(int));
+        CxPlatCopyMemory(CMSG_DATA(CMsg), &RingFd, sizeof(int));
+    }
+
+    if (sendmsg(SocketContext->SocketFd, &Mhdr, MSG_NOSIGNAL) < 0) {
+        return errno;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+//
+// Reads all pending doorbell messages, mapping any newly shared rings. Wake
+// ups carry no information beyond the readiness they already caused.
+//
+void
+CxPlatSocketContextDrainDoorbell(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    for (;;) {
+        char Type;
+        struct iovec IoVec = { .iov_base = &Type, .iov_len = sizeof(Type) };
+        alignas(struct cmsghdr) char ControlBuffer[CMSG_SPACE(sizeof(int))];
+        struct msghdr Mhdr = {
+            .msg_iov = &IoVec,
+            .msg_iovlen = 1,
+            .msg_control = ControlBuffer,
+            .msg_controllen = sizeof(ControlBuffer),
+        };
+
+        if (recvmsg(SocketContext->SocketFd, &Mhdr, MSG_DONTWAIT | MSG_CMSG_CLOEXEC) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                QuicTraceEvent(
+                    DatapathErrorStatus,
+                    "[data][%p] ERROR, %u, %s.",
+                    SocketContext->Binding,
+                    errno,
+                    "recvmsg failed");
+            }
+            break;
+        }
+
+        for (struct cmsghdr *CMsg = CMSG_FIRSTHDR(&Mhdr); CMsg != NULL; CMsg = CMSG_NXTHDR(&Mhdr, CMsg)) {
+            if (CMsg->cmsg_level == SOL_SOCKET && CMsg->cmsg_type == SCM_RIGHTS) {
+                CXPLAT_DBG_ASSERT_CMSG(CMsg, int);
+                int Fd;
+                CxPlatCopyMemory(&Fd, CMSG_DATA(CMsg), sizeof(int));
+                CxPlatSocketContextMapRing(SocketContext, Fd);
+            }
+        }
+    }
+}
+
+//
+// Socket context lifetime.
+//
+
+QUIC_STATUS
+CxPlatSocketContextSqeInitialize(
+    _Inout_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    CXPLAT_SOCKET* Binding = SocketContext->Binding;
+    BOOLEAN ShutdownSqeInitialized = FALSE;
+
+    if (!CxPlatSqeInitialize(
+            SocketContext->DatapathPartition->EventQ,
+            CxPlatSocketContextUninitializeEventComplete,
+            &SocketContext->ShutdownSqe)) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Binding,
+            Status,
+            "CxPlatSqeInitialize failed");
+        goto Exit;
+    }
+    ShutdownSqeInitialized = TRUE;
+
+    if (!CxPlatSqeInitialize(
+            SocketContext->DatapathPartition->EventQ,
+            CxPlatSocketContextIoEventComplete,
+            &SocketContext->IoSqe.Sqe)) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Binding,
+            Status,
+            "CxPlatSqeInitialize failed");
+        goto Exit;
+    }
+
+    SocketContext->SqeInitialized = TRUE;
+    return QUIC_STATUS_SUCCESS;
+
+Exit:
+
+    if (ShutdownSqeInitialized) {
+        CxPlatSqeCleanup(SocketContext->DatapathPartition->EventQ, &SocketContext->ShutdownSqe);
+    }
+
+    return Status;
+}
+
+//
+// Creates the socket's doorbell, binding it to the name derived from the
+// local port. A zero port is replaced with a random one from the ephemeral
+// range that isn't in use yet.
+//
+QUIC_STATUS
+CxPlatSocketContextInitialize(
+    _Inout_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ const uint16_t PartitionIndex
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    CXPLAT_SOCKET* Binding = SocketContext->Binding;
+    CXPLAT_DATAPATH* Datapath = Binding->Datapath;
+
+    CXPLAT_DBG_ASSERT(PartitionIndex < Datapath->PartitionCount);
+    SocketContext->DatapathPartition = &Datapath->Partitions[PartitionIndex];
+    CxPlatRefIncrement(&SocketContext->DatapathPartition->RefCount);
+
+    Status = CxPlatSocketContextSqeInitialize(SocketContext);
+    if (QUIC_FAILED(Status)) {
+        goto Exit;
+    }
+
+    SocketContext->SocketFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (SocketContext->SocketFd == INVALID_SOCKET) {
+        Status = errno;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Binding,
+            Status,
+            "socket failed");
+        goto Exit;
+    }
+
+    const uint16_t RequestedPort = QuicAddrGetPort(&Binding->LocalAddress);
+    for (uint32_t Attempt = 0; Attempt < CXPLAT_SHM_BIND_ATTEMPTS; ++Attempt) {
+        uint16_t Port = RequestedPort;
+        if (Port == 0) {
+            CxPlatRandom(sizeof(Port), &Port);
+            Port = CXPLAT_SHM_PORT_RANGE_START + (Port % (UINT16_MAX - CXPLAT_SHM_PORT_RANGE_START + 1));
+        }
+
+        struct sockaddr_un Address;
+        socklen_t AddressLength = CxPlatShmDoorbellAddress(Port, &Address);
+        if (bind(SocketContext->SocketFd, (struct sockaddr*)&Address, AddressLength) == 0) {
+            QuicAddrSetPort(&Binding->LocalAddress, Port);
+            Status = QUIC_STATUS_SUCCESS;
+            break;
+        }
+
+        Status = errno;
+        if (Status != EADDRINUSE || RequestedPort != 0) {
+            break;
+        }
+    }
+
+    if (QUIC_FAILED(Status)) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Binding,
+            Status,
+            "bind failed");
+        goto Exit;
+    }
+
+Exit:
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatSocketRelease(
+    _In_ CXPLAT_SOCKET* Socket
+    )
+{
+    if (CxPlatRefDecrement(&Socket->RefCount)) {
+#if DEBUG
+        CXPLAT_DBG_ASSERT(!Socket->Freed);
+        CXPLAT_DBG_ASSERT(Socket->Uninitialized);
+        Socket->Freed = TRUE;
+#endif
+        CXPLAT_FREE(CxPlatSocketToRaw(Socket), QUIC_POOL_SOCKET);
+    }
+}
+
+void
+CxPlatSocketContextUninitializeComplete(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+#if DEBUG
+    CXPLAT_DBG_ASSERT(!SocketContext->Freed);
+    SocketContext->Freed = TRUE;
+#endif
+
+    //
+    // Let the consumers know they can unmap the rings once they're drained.
+    //
+    while (!CxPlatListIsEmpty(&SocketContext->TxRings)) {
+        CXPLAT_SHM_RING* Ring =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&SocketContext->TxRings),
+                CXPLAT_SHM_RING,
+                Link);
+        __atomic_store_n(&Ring->Header->Closed, 1, __ATOMIC_RELEASE);
+        (void)CxPlatSocketContextRingDoorbell(
+            SocketContext, QuicAddrGetPort(&Ring->Destination), -1);
+        CxPlatShmRingFree(Ring);
+    }
+
+    while (!CxPlatListIsEmpty(&SocketContext->RxRings)) {
+        CxPlatShmRingFree(
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&SocketContext->RxRings),
+                CXPLAT_SHM_RING,
+                Link));
+    }
+
+    if (SocketContext->SocketFd != INVALID_SOCKET) {
+        epoll_ctl(*SocketContext->DatapathPartition->EventQ, EPOLL_CTL_DEL, SocketContext->SocketFd, NULL);
+        close(SocketContext->SocketFd);
+    }
+
+    if (SocketContext->SqeInitialized) {
+        CxPlatSqeCleanup(SocketContext->DatapathPartition->EventQ, &SocketContext->ShutdownSqe);
+        CxPlatSqeCleanup(SocketContext->DatapathPartition->EventQ, &SocketContext->IoSqe.Sqe);
+    }
+
+    CxPlatLockUninitialize(&SocketContext->TxQueueLock);
+    CxPlatRundownUninitialize(&SocketContext->UpcallRundown);
+
+    if (SocketContext->DatapathPartition) {
+        CxPlatProcessorContextRelease(SocketContext->DatapathPartition);
+    }
+    CxPlatSocketRelease(SocketContext->Binding);
+}
+
+void
+CxPlatSocketContextUninitializeEventComplete(
+    _In_ CXPLAT_CQE* Cqe
+    )
+{
+    CXPLAT_SOCKET_CONTEXT* SocketContext =
+        CXPLAT_CONTAINING_RECORD(CxPlatCqeGetSqe(Cqe), CXPLAT_SOCKET_CONTEXT, ShutdownSqe);
+    CxPlatSocketContextUninitializeComplete(SocketContext);
+}
+
+void
+CxPlatSocketContextUninitialize(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+#if DEBUG
+    CXPLAT_DBG_ASSERT(!SocketContext->Uninitialized);
+    SocketContext->Uninitialized = TRUE;
+#endif
+
+    if (!SocketContext->IoStarted) {
+        CxPlatSocketContextUninitializeComplete(SocketContext);
+    } else {
+        CxPlatRundownReleaseAndWait(&SocketContext->UpcallRundown); // Block until all upcalls complete.
+
+        epoll_ctl(*SocketContext->DatapathPartition->EventQ, EPOLL_CTL_DEL, SocketContext->SocketFd, NULL);
+
+        CXPLAT_FRE_ASSERT(
+            CxPlatEventQEnqueue(
+                SocketContext->DatapathPartition->EventQ,
+                &SocketContext->ShutdownSqe));
+    }
+}
+
+//
+// Datapath binding interface.
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+SocketCreateUdp(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_ const CXPLAT_UDP_CONFIG* Config,
+    _Out_ CXPLAT_SOCKET** NewBinding
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+
+    CXPLAT_DBG_ASSERT(Datapath->UdpHandlers.Receive != NULL || Config->Flags & CXPLAT_SOCKET_FLAG_PCP);
+
+    //
+    // A port has a single doorbell, so server sockets aren't spread across
+    // the partitions; the one socket context receives for all of them.
+    //
+    const size_t RawBindingLength =
+        CxPlatGetRawSocketSize() + sizeof(CXPLAT_SOCKET_CONTEXT);
+    CXPLAT_SOCKET_RAW* RawBinding =
+        (CXPLAT_SOCKET_RAW*)CXPLAT_ALLOC_PAGED(RawBindingLength, QUIC_POOL_SOCKET);
+    if (RawBinding == NULL) {
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SOCKET",
+            RawBindingLength);
+        goto Exit;
+    }
+    CXPLAT_SOCKET* Binding = CxPlatRawToSocket(RawBinding);
+
+    QuicTraceEvent(
+        DatapathCreated,
+        "[data][%p] Created, local=%!ADDR!, remote=%!ADDR!",
+        Binding,
+        CASTED_CLOG_BYTEARRAY(Config->LocalAddress ? sizeof(*Config->LocalAddress) : 0, Config->LocalAddress),
+        CASTED_CLOG_BYTEARRAY(Config->RemoteAddress ? sizeof(*Config->RemoteAddress) : 0, Config->RemoteAddress));
+
+    CxPlatZeroMemory(RawBinding, RawBindingLength);
+    Binding->Datapath = Datapath;
+    Binding->ClientContext = Config->CallbackContext;
+    Binding->HasFixedRemoteAddress = (Config->RemoteAddress != NULL);
+    Binding->Mtu = CXPLAT_MAX_MTU;
+    Binding->Type = CXPLAT_SOCKET_UDP;
+    CxPlatRefInitialize(&Binding->RefCount);
+    if (Config->LocalAddress) {
+        Binding->LocalAddress = *Config->LocalAddress;
+    }
+    if (QuicAddrGetFamily(&Binding->LocalAddress) == QUIC_ADDRESS_FAMILY_UNSPEC) {
+        QuicAddrSetFamily(&Binding->LocalAddress, QUIC_ADDRESS_FAMILY_INET6);
+    } else if (QuicAddrGetFamily(&Binding->LocalAddress) == QUIC_ADDRESS_FAMILY_INET6) {
+        CxPlatConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
+    }
+    if (Config->RemoteAddress != NULL && QuicAddrIsWildCard(&Binding->LocalAddress)) {
+        //
+        // Everything is loopback; give the client a concrete address so the
+        // peer sees a consistent source.
+        //
+        const uint16_t Port = QuicAddrGetPort(&Binding->LocalAddress);
+        QuicAddrSetFamily(&Binding->LocalAddress, QuicAddrGetFamily(Config->RemoteAddress));
+        QuicAddrSetToLoopback(&Binding->LocalAddress);
+        QuicAddrSetPort(&Binding->LocalAddress, Port);
+    }
+    Binding->LocalAddress.Ipv6.sin6_scope_id = 0;
+    if (Config->Flags & CXPLAT_SOCKET_FLAG_PCP) {
+        Binding->PcpBinding = TRUE;
+    }
+
+    CXPLAT_SOCKET_CONTEXT* SocketContext = &Binding->SocketContexts[0];
+    SocketContext->Binding = Binding;
+    SocketContext->SocketFd = INVALID_SOCKET;
+    CxPlatListInitializeHead(&SocketContext->TxQueue);
+    CxPlatListInitializeHead(&SocketContext->TxRings);
+    CxPlatListInitializeHead(&SocketContext->RxRings);
+    CxPlatLockInitialize(&SocketContext->TxQueueLock);
+    CxPlatRundownInitialize(&SocketContext->UpcallRundown);
+
+    Status =
+        CxPlatSocketContextInitialize(
+            SocketContext,
+            Config->RemoteAddress ? Config->PartitionIndex : 0);
+    if (QUIC_FAILED(Status)) {
+        goto Exit;
+    }
+
+    if (Config->RemoteAddress != NULL) {
+        Binding->RemoteAddress = *Config->RemoteAddress;
+    } else {
+        Binding->RemoteAddress.Ipv4.sin_port = 0;
+    }
+
+    //
+    // Must set output pointer before starting receive path, as the receive path
+    // will try to use the output.
+    //
+    *NewBinding = Binding;
+
+    struct epoll_event SockFdEpEvt = {
+        .events = EPOLLIN, .data = { .ptr = &SocketContext->IoSqe.Sqe, } };
+    if (epoll_ctl(
+            *SocketContext->DatapathPartition->EventQ,
+            EPOLL_CTL_ADD,
+            SocketContext->SocketFd,
+            &SockFdEpEvt) != 0) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Binding,
+            errno,
+            "epoll_ctl failed");
+    }
+    SocketContext->IoStarted = TRUE;
+
+    Binding = NULL;
+    RawBinding = NULL;
+
+Exit:
+
+    if (RawBinding != NULL) {
+        SocketDelete(CxPlatRawToSocket(RawBinding));
+    }
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+SocketCreateTcp(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_opt_ const QUIC_ADDR* LocalAddress,
+    _In_ const QUIC_ADDR* RemoteAddress,
+    _In_opt_ void* CallbackContext,
+    _Out_ CXPLAT_SOCKET** Socket
+    )
+{
+    UNREFERENCED_PARAMETER(Datapath);
+    UNREFERENCED_PARAMETER(LocalAddress);
+    UNREFERENCED_PARAMETER(RemoteAddress);
+    UNREFERENCED_PARAMETER(CallbackContext);
+    UNREFERENCED_PARAMETER(Socket);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+SocketCreateTcpListener(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_opt_ const QUIC_ADDR* LocalAddress,
+    _In_opt_ void* RecvCallbackContext,
+    _Out_ CXPLAT_SOCKET** NewSocket
+    )
+{
+    UNREFERENCED_PARAMETER(Datapath);
+    UNREFERENCED_PARAMETER(LocalAddress);
+    UNREFERENCED_PARAMETER(RecvCallbackContext);
+    UNREFERENCED_PARAMETER(NewSocket);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+void
+SocketDelete(
+    _In_ CXPLAT_SOCKET* Socket
+    )
+{
+    CXPLAT_DBG_ASSERT(Socket != NULL);
+    QuicTraceEvent(
+        DatapathDestroyed,
+        "[data][%p] Destroyed",
+        Socket);
+
+#if DEBUG
+    CXPLAT_DBG_ASSERT(!Socket->Uninitialized);
+    Socket->Uninitialized = TRUE;
+#endif
+
+    CxPlatSocketContextUninitialize(&Socket->SocketContexts[0]);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetTcpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_TCP_STATISTICS* Statistics
+    )
+{
+    UNREFERENCED_PARAMETER(Socket);
+    UNREFERENCED_PARAMETER(Statistics);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+//
+// Receive Path
+//
+
+//
+// Indicates up to one batch of datagrams from the ring. Returns the number of
+// entries consumed.
+//
+uint32_t
+CxPlatSocketContextReceiveRing(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ CXPLAT_SHM_RING* Ring
+    )
+{
+    CXPLAT_DATAPATH_PARTITION* DatapathPartition = SocketContext->DatapathPartition;
+    CXPLAT_DATAPATH* Datapath = DatapathPartition->Datapath;
+    CXPLAT_SHM_RING_HEADER* Header = Ring->Header;
+
+    uint32_t Head = Header->Head;
+    uint32_t Count = __atomic_load_n(&Header->Tail, __ATOMIC_ACQUIRE) - Head;
+    if (Count > CXPLAT_SHM_RECV_BATCH_SIZE) {
+        Count = CXPLAT_SHM_RECV_BATCH_SIZE;
+    }
+
+    CXPLAT_RECV_DATA* DatagramHead = NULL;
+    CXPLAT_RECV_DATA** DatagramTail = &DatagramHead;
+    for (uint32_t i = 0; i < Count; ++i, ++Head) {
+        const CXPLAT_SHM_RING_ENTRY* Entry = CxPlatShmRingGetEntry(Ring, Head);
+        const uint16_t Length = Entry->Length;
+        if (Length == 0) {
+            QuicTraceLogWarning(
+                DatapathRecvEmpty,
+                "[data][%p] Dropping datagram with empty payload.",
+                SocketContext->Binding);
+            continue;
+        }
+        if (Length > CXPLAT_SMALL_IO_BUFFER_SIZE) {
+            //
+            // The peer process wrote an entry no send could have produced.
+            //
+            QuicTraceLogWarning(
+                DatapathShmRecvTooBig,
+                "[data][%p] Dropping shared memory ring entry with too many bytes (%hu).",
+                SocketContext->Binding,
+                Length);
+            continue;
+        }
+
+        DATAPATH_RX_IO_BLOCK* IoBlock = CxPlatPoolAlloc(&DatapathPartition->RecvBlockPool);
+        if (IoBlock == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "DATAPATH_RX_IO_BLOCK",
+                Datapath->RecvBlockSize);
+            continue;
+        }
+
+        IoBlock->Route.LocalAddress = Ring->Destination;
+        IoBlock->Route.RemoteAddress = Ring->Source;
+        IoBlock->Route.Queue = (CXPLAT_QUEUE*)SocketContext;
+        IoBlock->RefCount = 1;
+
+        QuicTraceEvent(
+            DatapathRecv,
+            "[data][%p] Recv %u bytes (segment=%hu) Src=%!ADDR! Dst=%!ADDR!",
+            SocketContext->Binding,
+            (uint32_t)Length,
+            Length,
+            CASTED_CLOG_BYTEARRAY(sizeof(IoBlock->Route.LocalAddress), &IoBlock->Route.LocalAddress),
+            CASTED_CLOG_BYTEARRAY(sizeof(IoBlock->Route.RemoteAddress), &IoBlock->Route.RemoteAddress));
+
+        DATAPATH_RX_PACKET* Datagram = (DATAPATH_RX_PACKET*)(IoBlock + 1);
+        uint8_t* RecvBuffer = (uint8_t*)IoBlock + Datapath->RecvBlockBufferOffset;
+        CxPlatCopyMemory(RecvBuffer, Entry->Data, Length);
+        Datagram->IoBlock = IoBlock;
+
+        CXPLAT_RECV_DATA* RecvData = &Datagram->Data;
+        RecvData->Next = NULL;
+        RecvData->Route = &IoBlock->Route;
+        RecvData->Buffer = RecvBuffer;
+        RecvData->BufferLength = Length;
+        RecvData->PartitionIndex = DatapathPartition->PartitionIndex;
+        RecvData->TypeOfService = Entry->TOS;
+        RecvData->HopLimitTTL = CXPLAT_SHM_HOP_LIMIT;
+        RecvData->Allocated = TRUE;
+        RecvData->Route->DatapathType = RecvData->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
+        RecvData->QueuedOnConnection = FALSE;
+        RecvData->Reserved = FALSE;
+
+        *DatagramTail = RecvData;
+        DatagramTail = &RecvData->Next;
+    }
+
+    //
+    // Everything has been copied out, so hand the entries back right away.
+    //
+    __atomic_store_n(&Header->Head, Head, __ATOMIC_RELEASE);
+
+    if (DatagramHead != NULL) {
+        if (!SocketContext->Binding->PcpBinding) {
+            CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath->UdpHandlers.Receive);
+            SocketContext->Binding->Datapath->UdpHandlers.Receive(
+                SocketContext->Binding,
+                SocketContext->Binding->ClientContext,
+                DatagramHead);
+        } else {
+            CxPlatPcpRecvCallback(
+                SocketContext->Binding,
+                SocketContext->Binding->ClientContext,
+                DatagramHead);
+        }
+    }
+
+    return Count;
+}
+
+static
+void
+CxPlatSocketContextSetNeedWakeup(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ BOOLEAN NeedWakeup
+    )
+{
+    for (CXPLAT_LIST_ENTRY* Entry = SocketContext->RxRings.Flink;
+         Entry != &SocketContext->RxRings;
+         Entry = Entry->Flink) {
+        CXPLAT_SHM_RING* Ring = CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SHM_RING, Link);
+        __atomic_store_n(&Ring->Header->NeedWakeup, (uint32_t)NeedWakeup, __ATOMIC_SEQ_CST);
+    }
+}
+
+static
+BOOLEAN
+CxPlatSocketContextHasPendingRecv(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    for (CXPLAT_LIST_ENTRY* Entry = SocketContext->RxRings.Flink;
+         Entry != &SocketContext->RxRings;
+         Entry = Entry->Flink) {
+        CXPLAT_SHM_RING* Ring = CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SHM_RING, Link);
+        if (__atomic_load_n(&Ring->Header->Tail, __ATOMIC_SEQ_CST) != Ring->Header->Head) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+//
+// Drains the doorbell and then round robins batches across the inbound rings
+// until they're all empty. Producers are told not to ring the doorbell while
+// this runs; it's re-armed before going idle. To keep one busy peer from
+// monopolizing the event queue, the socket rings its own doorbell and yields
+// after a fixed number of rounds.
+//
+void
+CxPlatSocketContextReceive(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    CxPlatSocketContextDrainDoorbell(SocketContext);
+    CxPlatSocketContextSetNeedWakeup(SocketContext, FALSE);
+
+    for (uint32_t Round = 0; ; ++Round) {
+        if (Round == CXPLAT_SHM_RECV_MAX_ROUNDS) {
+            (void)CxPlatSocketContextRingDoorbell(
+                SocketContext, QuicAddrGetPort(&SocketContext->Binding->LocalAddress), -1);
+            break;
+        }
+
+        BOOLEAN Received = FALSE;
+        CXPLAT_LIST_ENTRY* Entry = SocketContext->RxRings.Flink;
+        while (Entry != &SocketContext->RxRings) {
+            CXPLAT_SHM_RING* Ring = CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SHM_RING, Link);
+            Entry = Entry->Flink;
+            if (CxPlatSocketContextReceiveRing(SocketContext, Ring) != 0) {
+                Received = TRUE;
+            } else if (
+                __atomic_load_n(&Ring->Header->Closed, __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&Ring->Header->Tail, __ATOMIC_ACQUIRE) == Ring->Header->Head) {
+                CxPlatListEntryRemove(&Ring->Link);
+                CxPlatShmRingFree(Ring);
+            }
+        }
+
+        if (!Received) {
+            //
+            // Arm the wake ups, then check once more for anything published
+            // before the producers could have seen them.
+            //
+            CxPlatSocketContextSetNeedWakeup(SocketContext, TRUE);
+            if (!CxPlatSocketContextHasPendingRecv(SocketContext)) {
+                break;
+            }
+            CxPlatSocketContextSetNeedWakeup(SocketContext, FALSE);
+        }
+    }
+}
+
+void
+RecvDataReturn(
+    _In_ CXPLAT_RECV_DATA* RecvDataChain
+    )
+{
+    CXPLAT_RECV_DATA* Datagram;
+    while ((Datagram = RecvDataChain) != NULL) {
+        RecvDataChain = RecvDataChain->Next;
+        DATAPATH_RX_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(Datagram, DATAPATH_RX_PACKET, Data);
+        if (InterlockedDecrement(&Packet->IoBlock->RefCount) == 0) {
+            CxPlatPoolFree(Packet->IoBlock);
+        }
+    }
+}
+
+void
+CxPlatSocketContextIoEventComplete(
+    _In_ CXPLAT_CQE* Cqe
+    )
+{
+    CXPLAT_SOCKET_CONTEXT* SocketContext =
+        CXPLAT_CONTAINING_RECORD(CxPlatCqeGetSqe(Cqe), CXPLAT_SOCKET_CONTEXT, IoSqe.Sqe);
+
+    if (CxPlatRundownAcquire(&SocketContext->UpcallRundown)) {
+        if (EPOLLIN & Cqe->events) {
+            CxPlatSocketContextReceive(SocketContext);
+        }
+        CxPlatRundownRelease(&SocketContext->UpcallRundown);
+    }
+}
+
+//
+// Send Path
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+CXPLAT_SEND_DATA*
+SendDataAlloc(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Inout_ CXPLAT_SEND_CONFIG* Config
+    )
+{
+    CXPLAT_DBG_ASSERT(Socket != NULL);
+    CXPLAT_DBG_ASSERT(Config->MaxPacketSize <= CXPLAT_SMALL_IO_BUFFER_SIZE);
+    if (Config->Route->Queue == NULL) {
+        Config->Route->Queue = (CXPLAT_QUEUE*)&Socket->SocketContexts[0];
+    }
+
+    CXPLAT_SOCKET_CONTEXT* SocketContext = (CXPLAT_SOCKET_CONTEXT*)Config->Route->Queue;
+    CXPLAT_DBG_ASSERT(SocketContext->Binding == Socket);
+    CXPLAT_SEND_DATA* SendData = CxPlatPoolAlloc(&SocketContext->DatapathPartition->SendBlockPool);
+    if (SendData != NULL) {
+        SendData->SocketContext = SocketContext;
+        SendData->ClientBuffer.Buffer = SendData->Buffer;
+        SendData->ClientBuffer.Length = 0;
+        SendData->TotalSize = 0;
+        SendData->SegmentSize = Config->MaxPacketSize;
+        SendData->BufferCount = 0;
+        SendData->ECN = Config->ECN;
+        SendData->DSCP = Config->DSCP;
+        SendData->Flags = Config->Flags;
+        SendData->DatapathType = Config->Route->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
+    }
+
+    return SendData;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+SendDataFree(
+    _In_ CXPLAT_SEND_DATA* SendData
+    )
+{
+    CxPlatPoolFree(SendData);
+}
+
+static
+void
+CxPlatSendDataFinalizeSendBuffer(
+    _In_ CXPLAT_SEND_DATA* SendData
+    )
+{
+    if (SendData->ClientBuffer.Length == 0) { // No buffer to finalize.
+        return;
+    }
+
+    CXPLAT_DBG_ASSERT(SendData->SegmentSize == 0 || SendData->ClientBuffer.Length <= SendData->SegmentSize);
+    CXPLAT_DBG_ASSERT(SendData->TotalSize + SendData->ClientBuffer.Length <= sizeof(SendData->Buffer));
+
+    SendData->BufferCount++;
+    SendData->TotalSize += SendData->ClientBuffer.Length;
+    if (SendData->SegmentSize == 0 ||
+        SendData->ClientBuffer.Length < SendData->SegmentSize ||
+        SendData->TotalSize + SendData->SegmentSize > sizeof(SendData->Buffer)) {
+        SendData->ClientBuffer.Buffer = NULL;
+    } else {
+        SendData->ClientBuffer.Buffer += SendData->SegmentSize;
+    }
+    SendData->ClientBuffer.Length = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+QUIC_BUFFER*
+SendDataAllocBuffer(
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    CXPLAT_DBG_ASSERT(SendData != NULL);
+    CXPLAT_DBG_ASSERT(MaxBufferLength > 0);
+    CxPlatSendDataFinalizeSendBuffer(SendData);
+    CXPLAT_DBG_ASSERT(SendData->SegmentSize == 0 || SendData->SegmentSize >= MaxBufferLength);
+    CXPLAT_DBG_ASSERT(SendData->TotalSize + MaxBufferLength <= sizeof(SendData->Buffer));
+    if (SendData->ClientBuffer.Buffer == NULL) {
+        return NULL;
+    }
+    SendData->ClientBuffer.Length = MaxBufferLength;
+    return &SendData->ClientBuffer;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+SendDataFreeBuffer(
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _In_ QUIC_BUFFER* Buffer
+    )
+{
+    //
+    // This must be the final send buffer; intermediate buffers cannot be freed.
+    //
+    CXPLAT_DBG_ASSERT(Buffer == &SendData->ClientBuffer);
+    Buffer->Length = 0;
+    UNREFERENCED_PARAMETER(SendData);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+SendDataIsFull(
+    _In_ CXPLAT_SEND_DATA* SendData
+    )
+{
+    CxPlatSendDataFinalizeSendBuffer(SendData);
+    return SendData->ClientBuffer.Buffer == NULL;
+}
+
+//
+// Finds the ring for the address pair, keeping the most recently used ring at
+// the front of the list. Must be called with the TxQueueLock held.
+//
+CXPLAT_SHM_RING*
+CxPlatSocketContextFindTxRing(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ const QUIC_ADDR* Source,
+    _In_ const QUIC_ADDR* Destination
+    )
+{
+    for (CXPLAT_LIST_ENTRY* Entry = SocketContext->TxRings.Flink;
+         Entry != &SocketContext->TxRings;
+         Entry = Entry->Flink) {
+        CXPLAT_SHM_RING* Ring = CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SHM_RING, Link);
+        if (QuicAddrCompare(&Ring->Destination, Destination) &&
+            QuicAddrCompare(&Ring->Source, Source)) {
+            if (Entry != SocketContext->TxRings.Flink) {
+                CxPlatListEntryRemove(Entry);
+                CxPlatListInsertHead(&SocketContext->TxRings, Entry);
+            }
+            return Ring;
+        }
+    }
+    return NULL;
+}
+
+//
+// Publishes the send to the peer's ring, creating and handing over the ring
+// on the first send to the peer. Concurrent senders on the socket are
+// serialized on the TxQueueLock, which keeps each ring single producer.
+//
+QUIC_STATUS
+CxPlatSendDataSend(
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _In_ const CXPLAT_ROUTE* Route
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    CXPLAT_SOCKET_CONTEXT* SocketContext = SendData->SocketContext;
+    const uint16_t Port = QuicAddrGetPort(&Route->RemoteAddress);
+    BOOLEAN WakeConsumer = FALSE;
+
+    CxPlatLockAcquire(&SocketContext->TxQueueLock);
+    CXPLAT_SHM_RING* Ring =
+        CxPlatSocketContextFindTxRing(SocketContext, &Route->LocalAddress, &Route->RemoteAddress);
+    if (Ring != NULL) {
+        WakeConsumer = CxPlatShmRingPublish(Ring, SendData);
+    } else {
+        Status =
+            CxPlatShmRingCreate(
+                SocketContext, &Route->LocalAddress, &Route->RemoteAddress, &Ring);
+        if (QUIC_SUCCEEDED(Status)) {
+            //
+            // Publish before handing over the ring; the hand over itself is the
+            // consumer's first wake up.
+            //
+            (void)CxPlatShmRingPublish(Ring, SendData);
+            Status = CxPlatSocketContextRingDoorbell(SocketContext, Port, Ring->Fd);
+            if (QUIC_SUCCEEDED(Status)) {
+                close(Ring->Fd);
+                Ring->Fd = -1;
+                CxPlatListInsertHead(&SocketContext->TxRings, &Ring->Link);
+            } else {
+                CxPlatShmRingFree(Ring);
+            }
+        }
+    }
+    CxPlatLockRelease(&SocketContext->TxQueueLock);
+
+    if (WakeConsumer) {
+        Status = CxPlatSocketContextRingDoorbell(SocketContext, Port, -1);
+        if (Status == EAGAIN || Status == EWOULDBLOCK) {
+            Status = QUIC_STATUS_SUCCESS; // Earlier wake ups are still queued.
+        }
+    }
+
+    return Status;
+}
+
+void
+SocketSend(
+    _In_ CXPLAT_SOCKET* Socket,
+    _In_ const CXPLAT_ROUTE* Route,
+    _In_ CXPLAT_SEND_DATA* SendData
+    )
+{
+    //
+    // Finalize the state of the send data and log the send.
+    //
+    CxPlatSendDataFinalizeSendBuffer(SendData);
+    QuicTraceEvent(
+        DatapathSend,
+        "[data][%p] Send %u bytes in %hhu buffers (segment=%hu) Dst=%!ADDR!, Src=%!ADDR!",
+        Socket,
+        SendData->TotalSize,
+        SendData->BufferCount,
+        SendData->SegmentSize,
+        CASTED_CLOG_BYTEARRAY(sizeof(Route->RemoteAddress), &Route->RemoteAddress),
+        CASTED_CLOG_BYTEARRAY(sizeof(Route->LocalAddress), &Route->LocalAddress));
+
+    QUIC_STATUS Status = CxPlatSendDataSend(SendData, Route);
+    if (QUIC_FAILED(Status)) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            Socket,
+            Status,
+            "shared memory send failed");
+
+        //
+        // Nothing is bound to the remote port.
+        //
+        if (Status == ECONNREFUSED && !Socket->PcpBinding) {
+            Socket->Datapath->UdpHandlers.Unreachable(
+                Socket,
+                Socket->ClientContext,
+                &Route->RemoteAddress);
+        }
+    }
+
+    CxPlatSendDataFree(SendData);
+}
@@ -810,12 +810,36 @@ typedef struct QUIC_CACHEALIGN CXPLAT_SOCKET_CONTEXT {
     //
     BOOLEAN Shutdown : 1;
 
+    //
+    // Indicates the socket is in the io_uring's registered file table (at
+    // the index equal to SocketFd).
+    //
+    BOOLEAN FixedFile : 1;
+
 #if DEBUG
     //
     // Indicates if the socket socket has a multi recv outstanding.
     //
     BOOLEAN MultiRecvStarted : 1;
 #endif
+#elif defined(CXPLAT_USE_SHM_DATAPATH)
+    //
+    // Shared memory rings this socket produces into, one per local/remote
+    // address pair. Protected by the TxQueueLock.
+    //
+    CXPLAT_LIST_ENTRY TxRings;
+
+    //
+    // Shared memory rings peers produce into for this socket. Only accessed
+    // from the partition's event queue.
+    //
+    CXPLAT_LIST_ENTRY RxRings;
+#else
+    //
+    // The number of messages currently posted per recvmmsg call. Adapted to
+    // the yield of recent calls.
+    //
+    uint16_t RecvBatchSize;
 #endif
 
 #if DEBUG
@@ -896,6 +920,7 @@ typedef struct CXPLAT_REGISTERED_BUFFER_POOL {
     uint32_t BufferSize;
     uint32_t TotalSize;
     CXPLAT_LOCK Lock;
+    CXPLAT_LIST_ENTRY FreeList; // Only used by pools without a buffer ring.
 } CXPLAT_REGISTERED_BUFFER_POOL;
 
 //
@@ -1015,6 +1040,22 @@ typedef struct CXPLAT_DATAPATH {
 
     uint8_t ReserveAuxTcpSock : 1;
 
+#ifdef CXPLAT_USE_IO_URING_SEND_ZC
+    //
+    // Set when the kernel rejected a zero-copy send, so large sends go back
+    // to being copied.
+    //
+    BOOLEAN SendZeroCopyDisabled;
+#endif
+
+#ifndef CXPLAT_USE_IO_URING
+    //
+    // The SO_BUSY_POLL time, in microseconds, for UDP sockets. Zero when the
+    // worker pool doesn't busy poll.
+    //
+    uint32_t BusyPollTimeoutUs;
+#endif
+
     //
     // The per proc datapath contexts.
     //
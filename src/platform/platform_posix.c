@@ -25,6 +25,7 @@ Environment:
 #include <fcntl.h>
 #include <limits.h>
 #include <sched.h>
+#include <sys/stat.h>
 #include <syslog.h>
 #define QUIC_VERSION_ONLY 1
 #include "msquic.ver"
@@ -534,6 +535,24 @@ CxPlatProcCurrentNumber(
 #endif // CX_PLATFORM_DARWIN
 }
 
+uint32_t
+CxPlatProcNumaNode(
+    _In_ uint32_t Index
+    )
+{
+#ifdef CXPLAT_NUMA_AWARE
+    if (CxPlatNumaNodeCount != 0) {
+        const int NumaNode = numa_node_of_cpu((int)Index);
+        if (NumaNode >= 0) {
+            return (uint32_t)NumaNode;
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(Index);
+#endif // CXPLAT_NUMA_AWARE
+    return 0;
+}
+
 QUIC_STATUS
 CxPlatRandom(
     _In_ uint32_t BufferLen,
@@ -546,6 +565,97 @@ CxPlatRandom(
     return QUIC_STATUS_SUCCESS;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileOpenRegion(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_ QUIC_FILE* RegionFile
+    )
+{
+    struct stat FileStat;
+    if (fstat(File, &FileStat) == -1) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "fstat failed");
+        return (QUIC_STATUS)errno;
+    }
+
+    if (Length == 0 ||
+        Offset > (uint64_t)FileStat.st_size ||
+        (uint64_t)FileStat.st_size - Offset < Length) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+    int Fd = fcntl(File, F_DUPFD_CLOEXEC, 0);
+    if (Fd == -1) {
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            errno,
+            "fcntl(F_DUPFD_CLOEXEC) failed");
+        return (QUIC_STATUS)errno;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    //
+    // The region is read front to back as the stream is sent.
+    //
+    (void)posix_fadvise(Fd, (off_t)Offset, (off_t)Length, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    *RegionFile = Fd;
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileRead(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_writes_bytes_(Length) uint8_t* Buffer
+    )
+{
+    while (Length != 0) {
+        ssize_t Result = pread(File, Buffer, Length, (off_t)Offset);
+        if (Result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            QuicTraceEvent(
+                LibraryErrorStatus,
+                "[ lib] ERROR, %u, %s.",
+                errno,
+                "pread failed");
+            return (QUIC_STATUS)errno;
+        }
+        if (Result == 0) {
+            QuicTraceEvent(
+                LibraryError,
+                "[ lib] ERROR, %s.",
+                "File truncated");
+            return QUIC_STATUS_INVALID_STATE;
+        }
+        Buffer += Result;
+        Offset += (uint64_t)Result;
+        Length -= (uint32_t)Result;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatFileClose(
+    _In_ QUIC_FILE File
+    )
+{
+    (void)close(File);
+}
+
 void
 CxPlatConvertToMappedV6(
     _In_ const QUIC_ADDR* InAddr,
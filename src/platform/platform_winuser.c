@@ -437,6 +437,126 @@ CxPlatRandom(
 
 #endif
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileOpenRegion(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_ QUIC_FILE* RegionFile
+    )
+{
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize)) {
+        DWORD Error = GetLastError();
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            Error,
+            "GetFileSizeEx failed");
+        return HRESULT_FROM_WIN32(Error);
+    }
+
+    if (Length == 0 ||
+        Offset > (uint64_t)FileSize.QuadPart ||
+        (uint64_t)FileSize.QuadPart - Offset < Length) {
+        return QUIC_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!DuplicateHandle(
+            GetCurrentProcess(),
+            File,
+            GetCurrentProcess(),
+            RegionFile,
+            0,
+            FALSE,
+            DUPLICATE_SAME_ACCESS)) {
+        DWORD Error = GetLastError();
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            Error,
+            "DuplicateHandle failed");
+        return HRESULT_FROM_WIN32(Error);
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+CxPlatFileRead(
+    _In_ QUIC_FILE File,
+    _In_ uint64_t Offset,
+    _In_ uint32_t Length,
+    _Out_writes_bytes_(Length) uint8_t* Buffer
+    )
+{
+    //
+    // The handle may have been opened for overlapped I/O, so each read carries
+    // its own offset and event and waits for its completion.
+    //
+    HANDLE Event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (Event == NULL) {
+        DWORD Error = GetLastError();
+        QuicTraceEvent(
+            LibraryErrorStatus,
+            "[ lib] ERROR, %u, %s.",
+            Error,
+            "CreateEventW failed");
+        return HRESULT_FROM_WIN32(Error);
+    }
+
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    while (Length != 0) {
+        OVERLAPPED Overlapped = {0};
+        Overlapped.Offset = (DWORD)Offset;
+        Overlapped.OffsetHigh = (DWORD)(Offset >> 32);
+        Overlapped.hEvent = Event;
+
+        DWORD BytesRead = 0;
+        if (!ReadFile(File, Buffer, Length, &BytesRead, &Overlapped) &&
+            (GetLastError() != ERROR_IO_PENDING ||
+             !GetOverlappedResult(File, &Overlapped, &BytesRead, TRUE))) {
+            DWORD Error = GetLastError();
+            if (Error == ERROR_HANDLE_EOF) {
+                BytesRead = 0;
+            } else {
+                QuicTraceEvent(
+                    LibraryErrorStatus,
+                    "[ lib] ERROR, %u, %s.",
+                    Error,
+                    "ReadFile failed");
+                Status = HRESULT_FROM_WIN32(Error);
+                break;
+            }
+        }
+        if (BytesRead == 0) {
+            QuicTraceEvent(
+                LibraryError,
+                "[ lib] ERROR, %s.",
+                "File truncated");
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+        Buffer += BytesRead;
+        Offset += BytesRead;
+        Length -= BytesRead;
+    }
+
+    CloseHandle(Event);
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatFileClose(
+    _In_ QUIC_FILE File
+    )
+{
+    CloseHandle(File);
+}
+
 #ifdef DEBUG
 #define AllocOffset (sizeof(void*) * 2)
 #endif
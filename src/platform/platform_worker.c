@@ -15,6 +15,31 @@ Abstract:
 #include "platform_worker.c.clog.h"
 #endif
 
+#ifdef CXPLAT_USE_IO_URING
+//
+// Above this many processors, each worker gets its own SQPOLL thread.
+//
+#define CXPLAT_WORKER_SQPOLL_SHARED_MAX_PROCS   4
+
+//
+// Default time an SQPOLL thread spins without work before sleeping.
+//
+#define CXPLAT_WORKER_SQPOLL_DEFAULT_IDLE_MS    10
+#endif
+
+#if defined(CX_PLATFORM_LINUX) && !defined(CXPLAT_USE_IO_URING) && !defined(CXPLAT_USE_SHM_DATAPATH)
+//
+// Busy polling is only implemented for the epoll event queue; elsewhere the
+// flag is ignored rather than spinning the workers for nothing.
+//
+#define CXPLAT_WORKER_BUSY_POLL 1
+#endif
+
+//
+// Default time a busy polling worker spins without work before sleeping.
+//
+#define CXPLAT_WORKER_BUSY_POLL_DEFAULT_IDLE_US 1000
+
 typedef struct QUIC_CACHEALIGN CXPLAT_WORKER {
 
     //
@@ -75,6 +100,12 @@ typedef struct QUIC_CACHEALIGN CXPLAT_WORKER {
     uint64_t CqeCount;
 #endif
 
+    //
+    // Time, in microseconds, to keep polling the event queue without blocking
+    // after the last work was done. Zero disables busy polling.
+    //
+    uint32_t BusyPollIdleTimeoutUs;
+
     //
     // The ideal processor for the worker thread.
     //
@@ -108,6 +139,7 @@ typedef struct CXPLAT_WORKER_POOL {
 
     CXPLAT_RUNDOWN_REF Rundown;
     uint32_t WorkerCount;
+    uint32_t BusyPollIdleTimeoutUs;
     CXPLAT_WORKER Workers[0];
 
 } CXPLAT_WORKER_POOL;
@@ -167,7 +199,7 @@ CxPlatWorkerPoolInitWorker(
 
     if (EventQ != NULL) {
         Worker->EventQ = *EventQ;
-    } else {
+    } else if (!Worker->InitializedEventQ) { // Not already set up with SQPOLL
         if (!CxPlatEventQInitialize(&Worker->EventQ)) {
             QuicTraceEvent(
                 LibraryError,
@@ -306,6 +338,13 @@ CxPlatWorkerPoolCreate(
         if (Config->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_AFFINITIZE) {
             ThreadFlags |= CXPLAT_THREAD_FLAG_SET_AFFINITIZE;
         }
+#ifdef CXPLAT_WORKER_BUSY_POLL
+        if (Config->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL) {
+            WorkerPool->BusyPollIdleTimeoutUs =
+                Config->PollingIdleTimeoutUs != 0 ?
+                    Config->PollingIdleTimeoutUs : CXPLAT_WORKER_BUSY_POLL_DEFAULT_IDLE_US;
+        }
+#endif
     }
 
     CXPLAT_THREAD_CONFIG ThreadConfig = {
@@ -316,6 +355,26 @@ CxPlatWorkerPoolCreate(
         NULL
     };
 
+#ifdef CXPLAT_USE_IO_URING
+    //
+    // With SQPOLL, each worker's ring gets a kernel thread that polls its
+    // submission queue. The polling threads aren't pinned, so the scheduler
+    // keeps them off the processors the busy workers are running on. When
+    // there are few processors to spare, the workers instead share the first
+    // worker's polling thread. The polling thread spins for the polling idle
+    // timeout before going to sleep.
+    //
+    const BOOLEAN SqPoll =
+        Config && (Config->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_SQPOLL);
+    const BOOLEAN SqPollShared =
+        SqPoll && CxPlatProcCount() <= CXPLAT_WORKER_SQPOLL_SHARED_MAX_PROCS;
+    uint32_t SqPollIdleTimeMs = CXPLAT_WORKER_SQPOLL_DEFAULT_IDLE_MS;
+    if (SqPoll && Config->PollingIdleTimeoutUs != 0) {
+        SqPollIdleTimeMs = (Config->PollingIdleTimeoutUs + 999) / 1000;
+    }
+    const CXPLAT_EVENTQ* SqPollSharedQueue = NULL;
+#endif
+
     //
     // Set up each worker thread with the configuration initialized above. Also
     // creates the event queue and all the SQEs used to shutdown, wake and poll
@@ -326,6 +385,27 @@ CxPlatWorkerPoolCreate(
         CXPLAT_DBG_ASSERT(IdealProcessor < CxPlatProcCount());
 
         CXPLAT_WORKER* Worker = &WorkerPool->Workers[i];
+        Worker->BusyPollIdleTimeoutUs = WorkerPool->BusyPollIdleTimeoutUs;
+#ifdef CXPLAT_USE_IO_URING
+        if (SqPoll) {
+            if (CxPlatEventQInitializeSqPoll(
+                    &Worker->EventQ, SqPollIdleTimeMs, SqPollSharedQueue)) {
+                Worker->InitializedEventQ = TRUE;
+                if (SqPollShared && SqPollSharedQueue == NULL) {
+                    SqPollSharedQueue = &Worker->EventQ;
+                }
+            } else {
+                //
+                // Not fatal (e.g. an older kernel or missing privileges); the
+                // worker falls back to a regular ring below.
+                //
+                QuicTraceEvent(
+                    LibraryError,
+                    "[ lib] ERROR, %s.",
+                    "CxPlatEventQInitializeSqPoll");
+            }
+        }
+#endif
         if (!CxPlatWorkerPoolInitWorker(
                 Worker, IdealProcessor, NULL, &ThreadConfig)) {
             goto Error;
@@ -441,6 +521,14 @@ CxPlatWorkerPoolGetCount(
     return WorkerPool->WorkerCount;
 }
 
+uint32_t
+CxPlatWorkerPoolGetBusyPollTimeout(
+    _In_ CXPLAT_WORKER_POOL* WorkerPool
+    )
+{
+    return WorkerPool->BusyPollIdleTimeoutUs;
+}
+
 BOOLEAN
 CxPlatWorkerPoolAddRef(
     _In_ CXPLAT_WORKER_POOL* WorkerPool
@@ -755,6 +843,18 @@ CXPLAT_THREAD_CALLBACK(CxPlatWorkerThread, Context)
             CxPlatRunExecutionContexts(Worker); // Run once more to handle race conditions
         }
 
+#ifdef CXPLAT_WORKER_BUSY_POLL
+        if (Worker->State.WaitTime != 0 &&
+            Worker->BusyPollIdleTimeoutUs != 0 &&
+            Worker->State.TimeNow - Worker->State.LastWorkTime < Worker->BusyPollIdleTimeoutUs) {
+            //
+            // Shortly after doing work, keep polling the event queue instead
+            // of sleeping in it, trading CPU for wake up latency.
+            //
+            Worker->State.WaitTime = 0;
+        }
+#endif
+
         CxPlatProcessEvents(Worker);
 
         if (Worker->State.NoWorkCount == 0) {
@@ -38,6 +38,14 @@ Notes:
     at a time. This requires us to maintain a lookup table of 16 32-bit entries
     for each nibble of the hash input.
 
+    When the CPU has a carry-less multiply instruction, four bytes of input
+    are processed at once instead: carry-less multiplying a 32-bit input word
+    by a 64-bit window of the key XORs together the key, shifted by the
+    position of each set bit of the input. With the key window bit-reversed,
+    the hash output ends up (bit-reversed) in bits 31 to 62 of the product.
+    The products for each word of the input are XORed together and the
+    output is reversed once at the end.
+
     This implementation assumes that the output of the hash is always 32-bit.
     It also assumes that the caller will pass in a array of bytes to hash, and
     the number of bits in the hash input will always be a multiple of 8 -- that
@@ -51,6 +59,117 @@ Notes:
 #include "toeplitz.c.clog.h"
 #endif
 
+#if defined(_KERNEL_MODE)
+//
+// Vector registers aren't available in kernel mode without saving the
+// floating point state, so only the lookup tables are used.
+//
+#elif defined(_M_X64) || defined(__x86_64__)
+#define CXPLAT_TOEPLITZ_CLMUL 1
+#ifdef _WIN32
+#include <intrin.h>
+#define CXPLAT_TOEPLITZ_CLMUL_TARGET
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define CXPLAT_TOEPLITZ_CLMUL_TARGET __attribute__((target("pclmul")))
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define CXPLAT_TOEPLITZ_CLMUL 1
+#include <arm_neon.h>
+#define CXPLAT_TOEPLITZ_CLMUL_TARGET
+#endif
+
+#ifdef CXPLAT_TOEPLITZ_CLMUL
+
+static
+uint32_t
+CxPlatToeplitzReverseBits(
+    _In_ uint32_t Value
+    )
+{
+    Value = ((Value >> 1) & 0x55555555) | ((Value & 0x55555555) << 1);
+    Value = ((Value >> 2) & 0x33333333) | ((Value & 0x33333333) << 2);
+    Value = ((Value >> 4) & 0x0F0F0F0F) | ((Value & 0x0F0F0F0F) << 4);
+    return CxPlatByteSwapUint32(Value);
+}
+
+static
+BOOLEAN
+CxPlatToeplitzClmulSupported(
+    void
+    )
+{
+#if defined(_M_X64) && defined(_WIN32)
+    int CpuInfo[4];
+    __cpuid(CpuInfo, 1);
+    return (CpuInfo[2] & (1 << 1)) != 0; // PCLMULQDQ
+#elif defined(__x86_64__)
+    unsigned int Eax, Ebx, Ecx, Edx;
+    return __get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) && (Ecx & bit_PCLMUL) != 0;
+#else
+    return TRUE; // Required by the compile target.
+#endif
+}
+
+//
+// Returns the low 64 bits of the carry-less product.
+//
+CXPLAT_TOEPLITZ_CLMUL_TARGET
+static
+inline
+uint64_t
+CxPlatToeplitzClmul(
+    _In_ uint64_t KeyWindow,
+    _In_ uint32_t Input
+    )
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    return
+        (uint64_t)_mm_cvtsi128_si64(
+            _mm_clmulepi64_si128(
+                _mm_cvtsi64_si128((int64_t)KeyWindow),
+                _mm_cvtsi32_si128((int)Input),
+                0x00));
+#else
+    return vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64(KeyWindow, Input)), 0);
+#endif
+}
+
+CXPLAT_TOEPLITZ_CLMUL_TARGET
+static
+uint32_t
+CxPlatToeplitzHashComputeClmul(
+    _In_ const CXPLAT_TOEPLITZ_HASH* Toeplitz,
+    _In_reads_(HashInputLength)
+        const uint8_t* HashInput,
+    _In_ uint32_t HashInputLength,
+    _In_ uint32_t HashInputOffset
+    )
+{
+    const uint64_t* KeyWindows = Toeplitz->KeyWindows + HashInputOffset;
+    uint64_t Product = 0;
+    uint32_t Word;
+    uint32_t i = 0;
+
+    for (; i + sizeof(Word) <= HashInputLength; i += sizeof(Word)) {
+        CxPlatCopyMemory(&Word, HashInput + i, sizeof(Word));
+        Product ^= CxPlatToeplitzClmul(KeyWindows[i], CxPlatByteSwapUint32(Word));
+    }
+
+    if (i < HashInputLength) {
+        Word = 0;
+        for (uint32_t j = 0; i + j < HashInputLength; ++j) {
+            Word |= (uint32_t)HashInput[i + j] << (24 - 8 * j);
+        }
+        Product ^= CxPlatToeplitzClmul(KeyWindows[i], Word);
+    }
+
+    return CxPlatToeplitzReverseBits((uint32_t)(Product >> 31));
+}
+
+#endif // CXPLAT_TOEPLITZ_CLMUL
+
 //
 // Initializes the state required for a Toeplitz hash computation. We
 // maintain per-nibble lookup tables, and we initialize them here.
@@ -129,6 +248,30 @@ CxPlatToeplitzHashInitialize(
             }
         }
     }
+
+    Toeplitz->UseClmul = FALSE;
+#ifdef CXPLAT_TOEPLITZ_CLMUL
+    //
+    // Initialize the Toeplitz->KeyWindows, reading zeros past the end of the
+    // key. Those bits only ever get multiplied by padding in the input.
+    //
+    for (uint32_t i = 0; i < (uint32_t)Toeplitz->InputSize; i++) {
+        uint32_t High = 0, Low = 0;
+        for (uint32_t j = 0; j < sizeof(uint32_t); j++) {
+            High <<= 8;
+            Low <<= 8;
+            if (i + j < CXPLAT_TOEPLITZ_KEY_SIZE_MAX) {
+                High |= Toeplitz->HashKey[i + j];
+            }
+            if (i + j + 4 < CXPLAT_TOEPLITZ_KEY_SIZE_MAX) {
+                Low |= Toeplitz->HashKey[i + j + 4];
+            }
+        }
+        Toeplitz->KeyWindows[i] =
+            ((uint64_t)CxPlatToeplitzReverseBits(Low) << 32) | CxPlatToeplitzReverseBits(High);
+    }
+    Toeplitz->UseClmul = CxPlatToeplitzClmulSupported();
+#endif
 }
 
 //
@@ -156,6 +299,12 @@ CxPlatToeplitzHashCompute(
     CXPLAT_DBG_ASSERT(
         (BaseOffset + HashInputLength * NIBBLES_PER_BYTE) <= (uint32_t)(Toeplitz->InputSize * NIBBLES_PER_BYTE));
 
+#ifdef CXPLAT_TOEPLITZ_CLMUL
+    if (Toeplitz->UseClmul) {
+        return CxPlatToeplitzHashComputeClmul(Toeplitz, HashInput, HashInputLength, HashInputOffset);
+    }
+#endif
+
     for (uint32_t i = 0; i < HashInputLength; i++) {
         Result ^= Toeplitz->LookupTableArray[BaseOffset].Table[(HashInput[i] >> 4) & 0xf];
         BaseOffset++;
@@ -165,3 +314,39 @@ CxPlatToeplitzHashCompute(
 
     return Result;
 }
+
+void
+CxPlatToeplitzHashComputeBatch(
+    _In_ const CXPLAT_TOEPLITZ_HASH* Toeplitz,
+    _In_ uint32_t HashInputCount,
+    _In_reads_(HashInputCount)
+        const uint8_t* const* HashInputs,
+    _In_ uint32_t HashInputLength,
+    _In_ uint32_t HashInputOffset,
+    _Out_writes_(HashInputCount)
+        uint32_t* Hashes
+    )
+{
+    CXPLAT_DBG_ASSERT(HashInputLength + HashInputOffset <= (uint32_t)Toeplitz->InputSize);
+
+#ifdef CXPLAT_TOEPLITZ_CLMUL
+    if (Toeplitz->UseClmul) {
+        //
+        // Each input's products are independent of the others, so the
+        // multiplies of consecutive inputs overlap in the pipeline.
+        //
+        for (uint32_t i = 0; i < HashInputCount; i++) {
+            Hashes[i] =
+                CxPlatToeplitzHashComputeClmul(
+                    Toeplitz, HashInputs[i], HashInputLength, HashInputOffset);
+        }
+        return;
+    }
+#endif
+
+    for (uint32_t i = 0; i < HashInputCount; i++) {
+        Hashes[i] =
+            CxPlatToeplitzHashCompute(
+                Toeplitz, HashInputs[i], HashInputLength, HashInputOffset);
+    }
+}
@@ -619,6 +619,93 @@ TEST_P(CryptTest, Encryption)
     ASSERT_FALSE(Key.Decrypt(Iv, sizeof(AuthData), AuthData, sizeof(Buffer), Buffer));
 }
 
+TEST_P(CryptTest, EncryptionBatch)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 4;
+    uint8_t RawKey[32] = {0};
+    uint8_t Iv[BatchSize][CXPLAT_IV_LENGTH];
+    uint8_t AuthData[BatchSize][12];
+    uint8_t Buffer[BatchSize][128];
+    uint8_t Expected[BatchSize][128];
+    CXPLAT_CRYPT_BATCH_ENTRY Entries[BatchSize];
+
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CxPlatZeroMemory(Iv[i], sizeof(Iv[i]));
+        Iv[i][CXPLAT_IV_LENGTH - 1] = i;
+        memset(AuthData[i], 0xA0 + i, sizeof(AuthData[i]));
+        memset(Buffer[i], i, sizeof(Buffer[i]));
+        CxPlatCopyMemory(Expected[i], Buffer[i], sizeof(Buffer[i]));
+        ASSERT_TRUE(Key.Encrypt(Iv[i], sizeof(AuthData[i]), AuthData[i], sizeof(Expected[i]), Expected[i]));
+
+        Entries[i].Iv = Iv[i];
+        Entries[i].AuthData = AuthData[i];
+        Entries[i].AuthDataLength = sizeof(AuthData[i]);
+        Entries[i].Buffer = Buffer[i];
+        Entries[i].BufferLength = sizeof(Buffer[i]);
+    }
+
+    //
+    // The batch must produce exactly what individual encryption does.
+    //
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatEncryptBatch(Key.Ptr, BatchSize, Entries));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        ASSERT_EQ(0, memcmp(Expected[i], Buffer[i], sizeof(Buffer[i])));
+        ASSERT_TRUE(Key.Decrypt(Iv[i], sizeof(AuthData[i]), AuthData[i], sizeof(Buffer[i]), Buffer[i]));
+    }
+}
+
+TEST_P(CryptTest, DecryptionBatch)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 4;
+    const uint8_t TamperedIndex = 2;
+    uint8_t RawKey[32] = {0};
+    uint8_t Iv[BatchSize][CXPLAT_IV_LENGTH];
+    uint8_t AuthData[BatchSize][12];
+    uint8_t Buffer[BatchSize][128];
+    uint8_t Expected[BatchSize][128 - CXPLAT_ENCRYPTION_OVERHEAD];
+    CXPLAT_CRYPT_BATCH_ENTRY Entries[BatchSize];
+    QUIC_STATUS Results[BatchSize];
+
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CxPlatZeroMemory(Iv[i], sizeof(Iv[i]));
+        Iv[i][CXPLAT_IV_LENGTH - 1] = i;
+        memset(AuthData[i], 0xA0 + i, sizeof(AuthData[i]));
+        memset(Buffer[i], i, sizeof(Buffer[i]));
+        CxPlatCopyMemory(Expected[i], Buffer[i], sizeof(Expected[i]));
+        ASSERT_TRUE(Key.Encrypt(Iv[i], sizeof(AuthData[i]), AuthData[i], sizeof(Buffer[i]), Buffer[i]));
+
+        Entries[i].Iv = Iv[i];
+        Entries[i].AuthData = AuthData[i];
+        Entries[i].AuthDataLength = sizeof(AuthData[i]);
+        Entries[i].Buffer = Buffer[i];
+        Entries[i].BufferLength = sizeof(Buffer[i]);
+    }
+
+    //
+    // A failed entry must not affect the rest of the batch.
+    //
+    Buffer[TamperedIndex][0] ^= 1;
+    ASSERT_TRUE(QUIC_FAILED(CxPlatDecryptBatch(Key.Ptr, BatchSize, Entries, Results)));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        if (i == TamperedIndex) {
+            ASSERT_TRUE(QUIC_FAILED(Results[i]));
+        } else {
+            ASSERT_EQ(QUIC_STATUS_SUCCESS, Results[i]);
+            ASSERT_EQ(0, memcmp(Expected[i], Buffer[i], sizeof(Expected[i])));
+        }
+    }
+}
+
 TEST_P(CryptTest, HashWellKnown)
 {
     int HASH = GetParam();
@@ -883,6 +883,127 @@ TEST_P(DataPathTest, UdpDataPolling)
     ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.ClientCompletion, 2000));
 }
 
+#if defined(CX_PLATFORM_LINUX) && !defined(CXPLAT_USE_IO_URING) && !defined(CXPLAT_USE_SHM_DATAPATH)
+
+#define RECV_BATCH_BURST_COUNT  96
+#define RECV_BATCH_DATA_SIZE    64
+
+//
+// Blocks the worker in the first receive indication, so that a burst queued
+// meanwhile is waiting in the socket when it resumes, and samples the recvmmsg
+// batch size each indication was received with.
+//
+struct RecvBatchContext {
+    CXPLAT_EVENT Blocked;
+    CXPLAT_EVENT Unblock;
+    CXPLAT_EVENT Completion;
+    uint32_t ReceivedCount {0};
+    std::vector<uint16_t> BatchSizes;
+    RecvBatchContext() {
+        CxPlatEventInitialize(&Blocked, FALSE, FALSE);
+        CxPlatEventInitialize(&Unblock, FALSE, FALSE);
+        CxPlatEventInitialize(&Completion, FALSE, FALSE);
+    }
+    ~RecvBatchContext() {
+        CxPlatEventUninitialize(Blocked);
+        CxPlatEventUninitialize(Unblock);
+        CxPlatEventUninitialize(Completion);
+    }
+};
+
+static void
+RecvBatchRecvCallback(
+    _In_ CXPLAT_SOCKET* Socket,
+    _In_ void* Context,
+    _In_ CXPLAT_RECV_DATA* RecvDataChain
+    )
+{
+    RecvBatchContext* RecvContext = (RecvBatchContext*)Context;
+    RecvContext->BatchSizes.push_back(CxPlatSocketGetRecvBatchSize(Socket));
+    for (CXPLAT_RECV_DATA* RecvData = RecvDataChain; RecvData != NULL; RecvData = RecvData->Next) {
+        RecvContext->ReceivedCount++;
+    }
+    CxPlatRecvDataReturn(RecvDataChain);
+
+    if (RecvContext->BatchSizes.size() == 1) {
+        CxPlatEventSet(RecvContext->Blocked);
+        CxPlatEventWaitWithTimeout(RecvContext->Unblock, 2000);
+    }
+    if (RecvContext->ReceivedCount == 1 + RECV_BATCH_BURST_COUNT) {
+        CxPlatEventSet(RecvContext->Completion);
+    }
+}
+
+//
+// The recvmmsg batch halves after a call comes back nearly empty and doubles
+// while calls keep filling it. Runs with busy polling so that mode's receive
+// path is covered too.
+//
+TEST_P(DataPathTest, UdpRecvBatchAdapts)
+{
+    const CXPLAT_UDP_DATAPATH_CALLBACKS RecvBatchCallbacks = {
+        RecvBatchRecvCallback,
+        EmptyUnreachableCallback,
+    };
+    QUIC_GLOBAL_EXECUTION_CONFIG Config = { QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL, 1000, 0 };
+    RecvBatchContext RecvContext;
+    CxPlatDataPath Datapath(&RecvBatchCallbacks, nullptr, 0, &Config);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+
+    auto unspecAddress = GetNewUnspecAddr();
+    CxPlatSocket Server(Datapath, &unspecAddress.SockAddr, nullptr, &RecvContext);
+    while (Server.GetInitStatus() == QUIC_STATUS_ADDRESS_IN_USE) {
+        unspecAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Server.CreateUdp(Datapath, &unspecAddress.SockAddr, nullptr, &RecvContext);
+    }
+    VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+    ASSERT_NE(nullptr, Server.Socket);
+
+    auto serverAddress = GetNewLocalAddr();
+    serverAddress.SetPort(Server.GetLocalAddress().Ipv4.sin_port);
+    const socklen_t AddressLength =
+        QuicAddrGetFamily(&serverAddress.SockAddr) == QUIC_ADDRESS_FAMILY_INET ?
+            sizeof(serverAddress.SockAddr.Ipv4) : sizeof(serverAddress.SockAddr.Ipv6);
+
+    //
+    // Send from a plain socket, so the sends can't end up queued behind the
+    // blocked worker.
+    //
+    int Sender = socket(QuicAddrGetFamily(&serverAddress.SockAddr), SOCK_DGRAM, 0);
+    ASSERT_NE(-1, Sender);
+    uint8_t Data[RECV_BATCH_DATA_SIZE] = {0};
+
+    ASSERT_EQ(
+        (ssize_t)sizeof(Data),
+        sendto(Sender, Data, sizeof(Data), 0, &serverAddress.SockAddr.Ip, AddressLength));
+    ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.Blocked, 2000));
+    for (uint32_t i = 0; i < RECV_BATCH_BURST_COUNT; ++i) {
+        ASSERT_EQ(
+            (ssize_t)sizeof(Data),
+            sendto(Sender, Data, sizeof(Data), 0, &serverAddress.SockAddr.Ip, AddressLength));
+    }
+    CxPlatEventSet(RecvContext.Unblock);
+    ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.Completion, 2000));
+    close(Sender);
+
+    //
+    // The first sample is the batch the lone datagram was received with; the
+    // second is the shrunken batch the burst started out with.
+    //
+    ASSERT_GE(RecvContext.BatchSizes.size(), (size_t)3);
+    const uint16_t Initial = RecvContext.BatchSizes[0];
+    const uint16_t Shrunk = RecvContext.BatchSizes[1];
+    uint16_t Grown = Shrunk;
+    for (auto BatchSize : RecvContext.BatchSizes) {
+        Grown = CXPLAT_MAX(Grown, BatchSize);
+    }
+    ASSERT_LT(Shrunk, Initial);
+    ASSERT_GT(Grown, Shrunk);
+}
+
+#endif
+
 TEST_P(DataPathTest, UdpDataRebind)
 {
     UdpRecvContext RecvContext;
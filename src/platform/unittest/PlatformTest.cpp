@@ -64,6 +64,17 @@ TEST(PlatformTest, QuicAddrParsing)
     }
 }
 
+TEST(PlatformTest, ProcNumaNode)
+{
+    //
+    // Every node has at least one processor, so there can't be more nodes
+    // than processors.
+    //
+    for (uint32_t i = 0; i < CxPlatProcCount(); ++i) {
+        ASSERT_LT(CxPlatProcNumaNode(i), CxPlatProcCount());
+    }
+}
+
 TEST(PlatformTest, EventQueue)
 {
     struct my_sqe : public CXPLAT_SQE {
@@ -231,3 +242,127 @@ TEST(PlatformTest, EventQueueWorker)
 
     CxPlatEventQCleanup(&queue);
 }
+
+//
+// An unnamed temporary file holding the given contents.
+//
+struct TempFile {
+    QUIC_FILE File;
+    TempFile(const uint8_t* Data, uint32_t Length) {
+#ifdef _WIN32
+        char Dir[MAX_PATH], Path[MAX_PATH];
+        CXPLAT_FRE_ASSERT(GetTempPathA(sizeof(Dir), Dir) != 0);
+        CXPLAT_FRE_ASSERT(GetTempFileNameA(Dir, "qfm", 0, Path) != 0);
+        File =
+            CreateFileA(
+                Path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        CXPLAT_FRE_ASSERT(File != INVALID_HANDLE_VALUE);
+        DWORD Written;
+        CXPLAT_FRE_ASSERT(WriteFile(File, Data, Length, &Written, NULL));
+#else
+        char Path[] = "/tmp/msquic_file_XXXXXX";
+        File = mkstemp(Path);
+        CXPLAT_FRE_ASSERT(File != -1);
+        unlink(Path);
+        CXPLAT_FRE_ASSERT(write(File, Data, Length) == (ssize_t)Length);
+#endif
+    }
+    ~TempFile() { Close(); }
+    void Truncate(uint64_t Length) {
+#ifdef _WIN32
+        LARGE_INTEGER Position;
+        Position.QuadPart = (LONGLONG)Length;
+        CXPLAT_FRE_ASSERT(SetFilePointerEx(File, Position, NULL, FILE_BEGIN));
+        CXPLAT_FRE_ASSERT(SetEndOfFile(File));
+#else
+        CXPLAT_FRE_ASSERT(ftruncate(File, (off_t)Length) == 0);
+#endif
+    }
+    void Close() {
+#ifdef _WIN32
+        if (File != INVALID_HANDLE_VALUE) {
+            CloseHandle(File);
+            File = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (File != -1) {
+            close(File);
+            File = -1;
+        }
+#endif
+    }
+};
+
+TEST(PlatformTest, FileRead)
+{
+    uint8_t Data[3 * 4096 + 123];
+    for (uint32_t i = 0; i < sizeof(Data); ++i) {
+        Data[i] = (uint8_t)(i * 7);
+    }
+    TempFile Temp(Data, sizeof(Data));
+
+    //
+    // The region's handle outlives the original one.
+    //
+    const uint64_t Offset = 4096 + 17;
+    const uint32_t Length = 2 * 4096;
+    QUIC_FILE Region;
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileOpenRegion(Temp.File, Offset, Length, &Region));
+    Temp.Close();
+
+    uint8_t Buffer[2 * 4096];
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileRead(Region, Offset, Length, Buffer));
+    ASSERT_EQ(0, memcmp(Data + Offset, Buffer, Length));
+
+    //
+    // Reads don't depend on each other's position.
+    //
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileRead(Region, 5, 100, Buffer));
+    ASSERT_EQ(0, memcmp(Data + 5, Buffer, 100));
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileRead(Region, 3 * 4096, 123, Buffer));
+    ASSERT_EQ(0, memcmp(Data + 3 * 4096, Buffer, 123));
+    CxPlatFileClose(Region);
+}
+
+TEST(PlatformTest, FileOpenRegionOutOfRange)
+{
+    uint8_t Data[100] = { 0 };
+    TempFile Temp(Data, sizeof(Data));
+
+    QUIC_FILE Region;
+    ASSERT_EQ(QUIC_STATUS_INVALID_PARAMETER, CxPlatFileOpenRegion(Temp.File, 0, 0, &Region));
+    ASSERT_EQ(QUIC_STATUS_INVALID_PARAMETER, CxPlatFileOpenRegion(Temp.File, 1, sizeof(Data), &Region));
+    ASSERT_EQ(QUIC_STATUS_INVALID_PARAMETER, CxPlatFileOpenRegion(Temp.File, sizeof(Data) + 1, 1, &Region));
+    ASSERT_EQ(QUIC_STATUS_INVALID_PARAMETER, CxPlatFileOpenRegion(Temp.File, UINT64_MAX, 1, &Region));
+
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileOpenRegion(Temp.File, 1, sizeof(Data) - 1, &Region));
+    CxPlatFileClose(Region);
+}
+
+TEST(PlatformTest, FileReadTruncated)
+{
+    uint8_t Data[3 * 4096];
+    for (uint32_t i = 0; i < sizeof(Data); ++i) {
+        Data[i] = (uint8_t)(i * 7);
+    }
+    TempFile Temp(Data, sizeof(Data));
+
+    QUIC_FILE Region;
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileOpenRegion(Temp.File, 0, sizeof(Data), &Region));
+
+    //
+    // Reading past the new end of the file fails instead of faulting, whether
+    // the read starts before it or after it.
+    //
+    Temp.Truncate(4096 + 10);
+    uint8_t Buffer[3 * 4096];
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, CxPlatFileRead(Region, 0, 4096 + 10, Buffer));
+    ASSERT_EQ(0, memcmp(Data, Buffer, 4096 + 10));
+    ASSERT_EQ(QUIC_STATUS_INVALID_STATE, CxPlatFileRead(Region, 4096, 4096, Buffer));
+    ASSERT_EQ(QUIC_STATUS_INVALID_STATE, CxPlatFileRead(Region, 2 * 4096, 4096, Buffer));
+
+    Temp.Truncate(0);
+    ASSERT_EQ(QUIC_STATUS_INVALID_STATE, CxPlatFileRead(Region, 0, 1, Buffer));
+    CxPlatFileClose(Region);
+}
@@ -169,3 +169,37 @@ TEST_F(ToeplitzTest, IPv6WithTcp)
             QUIC_ADDRESS_FAMILY_INET6);
     }
 }
+
+TEST_F(ToeplitzTest, LookupTablesMatchClmulAndBatch)
+{
+    const uint32_t BatchSize = 8;
+    CXPLAT_TOEPLITZ_HASH ToeplitzHash{};
+    CxPlatRandom(sizeof(ToeplitzHash.HashKey), ToeplitzHash.HashKey);
+    ToeplitzHash.InputSize = CXPLAT_TOEPLITZ_INPUT_SIZE_QUIC;
+    CxPlatToeplitzHashInitialize(&ToeplitzHash);
+    CXPLAT_TOEPLITZ_HASH TableHash = ToeplitzHash;
+    TableHash.UseClmul = FALSE;
+
+    uint8_t Inputs[BatchSize][CXPLAT_TOEPLITZ_INPUT_SIZE_QUIC];
+    const uint8_t* InputPtrs[BatchSize];
+    CxPlatRandom(sizeof(Inputs), Inputs);
+    for (uint32_t i = 0; i < BatchSize; i++) {
+        InputPtrs[i] = Inputs[i];
+    }
+
+    for (uint32_t Offset = 0; Offset < CXPLAT_TOEPLITZ_INPUT_SIZE_QUIC; Offset++) {
+        for (uint32_t Length = 1; Offset + Length <= CXPLAT_TOEPLITZ_INPUT_SIZE_QUIC; Length++) {
+            uint32_t Hashes[BatchSize];
+            CxPlatToeplitzHashComputeBatch(
+                &ToeplitzHash, BatchSize, InputPtrs, Length, Offset, Hashes);
+            for (uint32_t i = 0; i < BatchSize; i++) {
+                const uint32_t Expected =
+                    CxPlatToeplitzHashCompute(&TableHash, Inputs[i], Length, Offset);
+                ASSERT_EQ(Expected, Hashes[i]);
+                ASSERT_EQ(
+                    Expected,
+                    CxPlatToeplitzHashCompute(&ToeplitzHash, Inputs[i], Length, Offset));
+            }
+        }
+    }
+}
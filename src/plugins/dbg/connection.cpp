@@ -118,30 +118,27 @@ EXT_COMMAND(
         Conn.HasQueuedWork() ? "TRUE" : "FALSE",
         Conn.HasPriorityWork() ? "TRUE" : "FALSE");
 
-    auto Operations = Conn.GetOperQueue().GetOperations();
+    auto Operations = OperQueueIterator(Conn.GetOperQueue());
     if (Operations.IsEmpty()) {
         Dml("\t\tNo Operations Queued\n");
     } else {
-        bool IsHighPriority = true;
+        bool IsHighPriority = false;
         bool IsFirstOperation = true;
-        UINT64 PriorityTail;
-        ReadPointerAtAddr(Conn.GetOperQueue().GetPriorityTail(), &PriorityTail);
         while (!CheckControlC()) {
+            bool NextIsHighPriority =
+                Operations.NextLane() != QUIC_OPERATION_LANE_NORMAL;
             auto OperLinkAddr = Operations.Next();
             if (OperLinkAddr == 0) {
                 break;
             }
 
-            if (PriorityTail == OperLinkAddr) {
-                IsHighPriority = false;
-                Dml("\n\tNORMAL PRIORITY:\n\n");
+            if (IsFirstOperation || IsHighPriority != NextIsHighPriority) {
+                Dml(NextIsHighPriority ?
+                    "\n\tHIGH PRIORITY:\n\n" : "\n\tNORMAL PRIORITY:\n\n");
             }
+            IsHighPriority = NextIsHighPriority;
 
-            if (IsFirstOperation && IsHighPriority) {
-                Dml("\n\tHIGH PRIORITY:\n\n");
-            }
-
-            auto Operation = Operation::FromLink(OperLinkAddr);
+            auto Operation = Operation::FromQueueLink(OperLinkAddr);
             Dml("\t\t%s\n", Operation.TypeStr());
             IsFirstOperation = false;
         }
@@ -105,14 +105,14 @@ EXT_COMMAND(
                         Conn.Addr,
                         Conn.TypeStr());
 
-                    auto Operations = Conn.GetOperQueue().GetOperations();
+                    auto Operations = OperQueueIterator(Conn.GetOperQueue());
                     while (!CheckControlC()) {
                         auto OperLinkAddr = Operations.Next();
                         if (OperLinkAddr == 0) {
                             break;
                         }
 
-                        auto Operation = Operation::FromLink(OperLinkAddr);
+                        auto Operation = Operation::FromQueueLink(OperLinkAddr);
                         Dml("      %s\n", Operation.TypeStr());
                     }
                 }
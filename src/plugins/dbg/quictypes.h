@@ -63,6 +63,7 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN ReceiveEnabled          : 1;    // Application is ready for receive callbacks.
         BOOLEAN ReceiveMultiple         : 1;    // The app supports multiple parallel receive indications.
         BOOLEAN UseAppOwnedRecvBuffers  : 1;    // The stream is using app provided receive buffers.
+        BOOLEAN ZeroCopyRecv            : 1;    // In-order data may be indicated straight from received packets.
         BOOLEAN ReceiveFlushQueued      : 1;    // The receive flush operation is queued.
         BOOLEAN ReceiveDataPending      : 1;    // Data (or FIN) is queued and ready for delivery.
         BOOLEAN SendDelayed             : 1;    // A delayed send is currently queued.
@@ -80,6 +81,11 @@ typedef union QUIC_STREAM_FLAGS {
         BOOLEAN InStreamTable           : 1;    // The stream is currently in the connection's table.
         BOOLEAN InWaitingList           : 1;    // The stream is currently in the waiting list for stream id FC.
         BOOLEAN DelayIdFcUpdate         : 1;    // Delay stream ID FC updates to StreamClose.
+
+        BOOLEAN SendIncremental         : 1;    // Round robin with the stream's priority even under FIFO.
+        BOOLEAN SendLate                : 1;    // The send deadline was missed.
+        BOOLEAN SendDeadlineAbort       : 1;    // Abort the send direction when the deadline is missed.
+        BOOLEAN SendFileFailed          : 1;    // Reading a file send failed; the send is being aborted.
     };
 } QUIC_STREAM_FLAGS;
 
@@ -190,12 +196,6 @@ typedef union QUIC_CONNECTION_STATE {
         //
         BOOLEAN TestTransportParameterSet : 1;
 
-        //
-        // Indicates the connection is using the round robin stream scheduling
-        // scheme.
-        //
-        BOOLEAN UseRoundRobinStreamScheduling : 1;
-
         //
         // Indicates that this connection has resumption enabled and needs to
         // keep the TLS state and transport parameters until it is done sending
@@ -461,10 +461,6 @@ struct CidHashEntry : Struct {
 
     CidHashEntry(ULONG64 Addr) : Struct("msquic!QUIC_CID_HASH_ENTRY", Addr) { }
 
-    static CidHashEntry FromEntry(ULONG64 EntryAddr) {
-        return CidHashEntry(LinkEntryToType(EntryAddr, "msquic!QUIC_CID_HASH_ENTRY", "Entry"));
-    }
-
     static CidHashEntry FromLink(ULONG64 LinkAddr) {
         return CidHashEntry(LinkEntryToType(LinkAddr, "msquic!QUIC_CID_HASH_ENTRY", "Link"));
     }
@@ -1111,6 +1107,10 @@ struct Operation : Struct {
         return Operation(LinkEntryToType(LinkAddr, "msquic!QUIC_OPERATION", "Link"));
     }
 
+    static Operation FromQueueLink(ULONG64 LinkAddr) {
+        return Operation(LinkEntryToType(LinkAddr, "msquic!QUIC_OPERATION", "QueueLink"));
+    }
+
     QUIC_OPERATION_TYPE Type() {
         return ReadType<QUIC_OPERATION_TYPE>("Type");
     }
@@ -1149,16 +1149,79 @@ struct Operation : Struct {
     }
 };
 
+typedef enum QUIC_OPERATION_LANE {
+
+    QUIC_OPERATION_LANE_FRONT,
+    QUIC_OPERATION_LANE_PRIORITY,
+    QUIC_OPERATION_LANE_NORMAL,
+    QUIC_OPERATION_LANE_COUNT
+
+} QUIC_OPERATION_LANE;
+
 struct OperQueue : Struct {
 
     OperQueue(ULONG64 Addr) : Struct("msquic!QUIC_OPERATION_QUEUE", Addr) { }
 
-    LinkedList GetOperations() {
-        return LinkedList(AddrOf("List"));
+    ULONG64 GetPushed(ULONG Lane) {
+        ULONG64 Head = 0;
+        ReadPointerAtAddr(AddrOf("Pushed") + Lane * g_ExtInstance.m_PtrSize, &Head);
+        return Head;
+    }
+
+    ULONG64 GetTaken(ULONG Lane) {
+        ULONG64 Head = 0;
+        ReadPointerAtAddr(AddrOf("Taken") + Lane * g_ExtInstance.m_PtrSize, &Head);
+        return Head;
+    }
+};
+
+//
+// Walks the operations of a queue lane by lane, in drain order, except that
+// operations not yet taken by the worker are listed most recent first.
+//
+struct OperQueueIterator {
+
+    OperQueue Queue;
+    ULONG Lane;
+    bool InTaken;
+    ULONG64 NextAddr;
+
+    OperQueueIterator(OperQueue Queue) : Queue(Queue) {
+        Lane = QUIC_OPERATION_LANE_FRONT;
+        InTaken = false;
+        NextAddr = Queue.GetPushed(Lane);
+        Skip();
+    }
+
+    bool IsEmpty() { return NextAddr == 0; }
+
+    //
+    // The lane of the operation returned next.
+    //
+    ULONG NextLane() { return Lane; }
+
+    ULONG64 Next() {
+        if (NextAddr == 0) {
+            return 0;
+        }
+        ULONG64 next = NextAddr;
+        NextAddr = SingleListEntry(NextAddr).Next();
+        Skip();
+        return next;
     }
 
-    ULONG64 GetPriorityTail() {
-        return ReadPointer("PriorityTail");
+private:
+
+    void Skip() {
+        while (NextAddr == 0 && Lane < QUIC_OPERATION_LANE_COUNT) {
+            if (Lane != QUIC_OPERATION_LANE_FRONT && InTaken) {
+                InTaken = false;
+                NextAddr = Queue.GetPushed(Lane);
+            } else if (++Lane < QUIC_OPERATION_LANE_COUNT) {
+                InTaken = true;
+                NextAddr = Queue.GetTaken(Lane);
+            }
+        }
     }
 };
 
@@ -1524,12 +1587,68 @@ struct Registration : Struct {
     }
 };
 
+//
+// Enumerates the in-use slots of the open addressing local CID table. A slot is
+// in use when the high bit of its tag is clear.
+//
+struct CidTable : Struct {
+
+    ULONG64 Groups;
+    ULONG GroupCount;
+    ULONG GroupSize;
+    ULONG TagsOffset;
+    ULONG EntriesOffset;
+    ULONG SlotCount;
+
+    ULONG Group;
+    ULONG Slot;
+
+    CidTable(ULONG64 Addr) : Struct("msquic!QUIC_CID_TABLE", Addr) {
+        Groups = ReadPointer("Groups");
+        GroupCount = ReadType<ULONG>("GroupMask") + 1;
+        GroupSize = GetTypeSize("msquic!QUIC_CID_TABLE_GROUP");
+        GetFieldOffset("msquic!QUIC_CID_TABLE_GROUP", "Tags", &TagsOffset);
+        GetFieldOffset("msquic!QUIC_CID_TABLE_GROUP", "Entries", &EntriesOffset);
+        SlotCount = (GroupSize - EntriesOffset) / g_ExtInstance.m_PtrSize;
+
+        Group = 0;
+        Slot = 0;
+    }
+
+    ULONG NumEntries() {
+        return ReadType<ULONG>("EntryCount");
+    }
+
+    bool GetNextEntry(ULONG64* EntryAddress) {
+        for (; Groups != 0 && Group < GroupCount; Group++, Slot = 0) {
+            ULONG64 GroupAddr = Groups + Group * GroupSize;
+            for (; Slot < SlotCount; Slot++) {
+                UCHAR Tag;
+                if (!ReadTypeAtAddr(GroupAddr + TagsOffset + Slot, &Tag)) {
+                    return false;
+                }
+                if (Tag & 0x80) {
+                    continue; // Empty or deleted.
+                }
+                if (!ReadPointerAtAddr(
+                        GroupAddr + EntriesOffset + Slot * g_ExtInstance.m_PtrSize,
+                        EntryAddress)) {
+                    return false;
+                }
+                Slot++;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
 struct LookupHashTable : Struct {
 
     LookupHashTable(ULONG64 Addr) : Struct("msquic!QUIC_PARTITIONED_HASHTABLE", Addr) { }
 
     ULONG64 GetTablePtr() {
-        return AddrOf("Table"); // TODO - Need Hash Table Enumeration.
+        return AddrOf("Table");
     }
 };
 
@@ -614,6 +614,16 @@ void
 QuicTestConnectionPriority(
     );
 
+#if defined(QUIC_API_ENABLE_PREVIEW_FEATURES) && !defined(_KERNEL_MODE)
+void
+QuicTestConnectionRebalance(
+    );
+
+void
+QuicTestStreamSendFile(
+    );
+#endif
+
 void
 QuicTestConnectionStreamStartSendPriority(
     );
@@ -629,6 +639,10 @@ void QuicTestStreamAppProvidedBuffers(
 void QuicTestStreamAppProvidedBuffersOutOfSpace(
     );
 
+void
+QuicTestStreamZeroCopyReceive(
+    );
+
 //
 // QuicDrill tests
 //
@@ -1407,4 +1421,7 @@ struct QUIC_RUN_CONNECTION_POOL_CREATE_PARAMS {
 #define IOCTL_QUIC_RUN_RETRY_CONFIG_SETTING \
     QUIC_CTL_CODE(134, METHOD_BUFFERED, FILE_WRITE_DATA)
 
-#define QUIC_MAX_IOCTL_FUNC_CODE 134
+#define IOCTL_QUIC_RUN_STREAM_ZERO_COPY_RECEIVE \
+    QUIC_CTL_CODE(135, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define QUIC_MAX_IOCTL_FUNC_CODE 135
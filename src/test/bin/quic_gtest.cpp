@@ -2345,6 +2345,15 @@ TEST(Misc, StreamAppProvidedBuffersOutOfSpace) {
         QuicTestStreamAppProvidedBuffersOutOfSpace();
     }
 }
+
+TEST(Misc, StreamZeroCopyReceive) {
+    TestLogger Logger("QuicTestStreamZeroCopyReceive");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_STREAM_ZERO_COPY_RECEIVE));
+    } else {
+        QuicTestStreamZeroCopyReceive();
+    }
+}
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
 
 TEST(Misc, StreamBlockUnblockUnidiConnFlowControl) {
@@ -2383,6 +2392,22 @@ TEST(Basic, ConnectionPriority) {
     }
 }
 
+#if defined(QUIC_API_ENABLE_PREVIEW_FEATURES)
+TEST(Basic, ConnectionRebalance) {
+    TestLogger Logger("QuicTestConnectionRebalance");
+    if (!TestingKernelMode) {
+        QuicTestConnectionRebalance();
+    }
+}
+
+TEST(Misc, StreamSendFile) {
+    TestLogger Logger("QuicTestStreamSendFile");
+    if (!TestingKernelMode) {
+        QuicTestStreamSendFile();
+    }
+}
+#endif // QUIC_API_ENABLE_PREVIEW_FEATURES
+
 TEST(Drill, VarIntEncoder) {
     TestLogger Logger("QuicDrillTestVarIntEncoder");
     if (TestingKernelMode) {
@@ -533,6 +533,7 @@ size_t QUIC_IOCTL_BUFFER_SIZES[] =
     sizeof(QUIC_RUN_CONNECTION_POOL_CREATE_PARAMS),
     0,
     0,
+    0,
 };
 
 CXPLAT_STATIC_ASSERT(
@@ -1548,6 +1549,12 @@ QuicTestCtlEvtIoDeviceControl(
         QuicTestCtlRun(QuicTestRetryConfigSetting());
         break;
 
+#ifdef QUIC_API_ENABLE_PREVIEW_FEATURES
+    case IOCTL_QUIC_RUN_STREAM_ZERO_COPY_RECEIVE:
+        QuicTestCtlRun(QuicTestStreamZeroCopyReceive());
+        break;
+#endif
+
     default:
         Status = STATUS_NOT_IMPLEMENTED;
         break;
@@ -5715,6 +5715,92 @@ void QuicTestStreamParam()
         }
     }
 #endif // QUIC_PARAM_STREAM_RELIABLE_OFFSET
+
+#ifdef QUIC_PARAM_STREAM_INCREMENTAL
+    //
+    // QUIC_PARAM_STREAM_INCREMENTAL
+    //
+    {
+        TestScopeLogger LogScope0("QUIC_PARAM_STREAM_INCREMENTAL");
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_NONE);
+        BOOLEAN Incremental = TRUE;
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_PARAMETER,
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_INCREMENTAL,
+                sizeof(Incremental) + 1,
+                &Incremental));
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_INCREMENTAL,
+                sizeof(Incremental),
+                &Incremental));
+        Incremental = FALSE;
+        uint32_t Length = sizeof(Incremental);
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->GetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_INCREMENTAL,
+                &Length,
+                &Incremental));
+        TEST_EQUAL(Length, sizeof(Incremental));
+        TEST_TRUE(Incremental);
+    }
+
+    //
+    // QUIC_PARAM_STREAM_SEND_DEADLINE
+    //
+    {
+        TestScopeLogger LogScope0("QUIC_PARAM_STREAM_SEND_DEADLINE");
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_NONE);
+        QUIC_STREAM_SEND_DEADLINE Deadline = { 1000, QUIC_STREAM_SEND_DEADLINE_FLAG_ABORT, 42 };
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_SEND_DEADLINE,
+                sizeof(Deadline),
+                &Deadline));
+
+        Deadline.AbortErrorCode = QUIC_UINT62_MAX + 1;
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_PARAMETER,
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_SEND_DEADLINE,
+                sizeof(Deadline),
+                &Deadline));
+
+        Deadline.AbortErrorCode = 0;
+        Deadline.Flags = (QUIC_STREAM_SEND_DEADLINE_FLAGS)0x2;
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_PARAMETER,
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_SEND_DEADLINE,
+                sizeof(Deadline),
+                &Deadline));
+
+        Deadline.TimeoutUs = 0;
+        Deadline.Flags = QUIC_STREAM_SEND_DEADLINE_FLAG_NONE;
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_SEND_DEADLINE,
+                sizeof(Deadline),
+                &Deadline));
+
+        uint32_t Length = sizeof(Deadline);
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_PARAMETER,
+            MsQuic->GetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_SEND_DEADLINE,
+                &Length,
+                &Deadline));
+    }
+#endif // QUIC_PARAM_STREAM_INCREMENTAL
 }
 
 void
@@ -13,6 +13,9 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "DataTest.cpp.clog.h"
 #endif
+#ifdef __linux__
+#include <dirent.h>
+#endif
 #if defined(_KERNEL_MODE)
 static bool UseQTIP = false;
 #elif defined(QUIC_API_ENABLE_PREVIEW_FEATURES)
@@ -4968,4 +4971,871 @@ QuicTestStreamAppProvidedBuffersOutOfSpace(
     }
 }
 
+//
+// Zero-copy receive tests.
+//
+
+#define ZeroCopyRecvChunkSize   1000 // Fits in a single packet
+#define ZeroCopyRecvChunkCount  16
+
+enum ZeroCopyRecvMode {
+    ZeroCopyRecvAcceptAll,
+    ZeroCopyRecvAcceptHalf,
+    ZeroCopyRecvPending
+};
+
+struct ZeroCopyRecvTestContext {
+    ZeroCopyRecvMode Mode;
+    MsQuicCleanUpMode ServerCleanUpMode {CleanUpAutoDelete};
+    MsQuicStream* ServerStream {nullptr};
+    QUIC_STATUS SetParamStatus {QUIC_STATUS_NOT_SUPPORTED};
+    BOOLEAN ZeroCopyEnabled {FALSE};
+    CxPlatEvent Received;
+    CxPlatEvent ReceiveDone;
+    CxPlatEvent ServerStreamShutdown;
+    CXPLAT_LOCK Lock;
+    uint64_t PendingLength {0};
+    uint64_t ReceivedLength {0};
+    uint32_t PartialAccepts {0};
+    bool Overflow {false};
+    uint8_t RecvBuffer[ZeroCopyRecvChunkSize * ZeroCopyRecvChunkCount] {0};
+
+    ZeroCopyRecvTestContext(ZeroCopyRecvMode RecvMode) : Mode(RecvMode) {
+        CxPlatLockInitialize(&Lock);
+    }
+    ~ZeroCopyRecvTestContext() {
+        CxPlatLockUninitialize(&Lock);
+    }
+
+    //
+    // Completes whatever the server kept pending, from the calling thread.
+    //
+    void CompletePending() {
+        CxPlatLockAcquire(&Lock);
+        uint64_t Length = PendingLength;
+        PendingLength = 0;
+        CxPlatLockRelease(&Lock);
+        if (Length != 0) {
+            ServerStream->ReceiveComplete(Length);
+        }
+    }
+
+    static QUIC_STATUS ServerStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (ZeroCopyRecvTestContext*)Context;
+        QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+        if (Event->Type == QUIC_STREAM_EVENT_RECEIVE) {
+            //
+            // Only record the bytes accepted, so anything not accepted has to
+            // be indicated again for the data to match.
+            //
+            uint64_t Accepted = Event->RECEIVE.TotalBufferLength;
+            if (TestContext->Mode == ZeroCopyRecvAcceptHalf && Accepted > 1) {
+                Accepted /= 2;
+                Event->RECEIVE.TotalBufferLength = Accepted;
+                TestContext->PartialAccepts++;
+                Status = QUIC_STATUS_CONTINUE;
+            }
+            uint64_t Offset = Event->RECEIVE.AbsoluteOffset;
+            uint64_t Remaining = Accepted;
+            for (uint32_t i = 0; i < Event->RECEIVE.BufferCount && Remaining != 0; ++i) {
+                uint32_t Length = (uint32_t)CXPLAT_MIN(Remaining, Event->RECEIVE.Buffers[i].Length);
+                if (Offset + Length > sizeof(TestContext->RecvBuffer)) {
+                    TestContext->Overflow = true;
+                    break;
+                }
+                memcpy(TestContext->RecvBuffer + Offset, Event->RECEIVE.Buffers[i].Buffer, Length);
+                Offset += Length;
+                Remaining -= Length;
+            }
+            CxPlatLockAcquire(&TestContext->Lock);
+            TestContext->ReceivedLength += Accepted;
+            if (TestContext->Mode == ZeroCopyRecvPending) {
+                TestContext->PendingLength += Accepted;
+                Status = QUIC_STATUS_PENDING;
+            }
+            CxPlatLockRelease(&TestContext->Lock);
+            TestContext->Received.Set();
+        } else if (Event->Type == QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN) {
+            TestContext->ReceiveDone.Set();
+        } else if (Event->Type == QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE) {
+            TestContext->ServerStreamShutdown.Set();
+        }
+        return Status;
+    }
+
+    static QUIC_STATUS ClientStreamCallback(_In_ MsQuicStream*, _In_opt_ void*, _Inout_ QUIC_STREAM_EVENT* Event) {
+        if (Event->Type == QUIC_STREAM_EVENT_SEND_COMPLETE && Event->SEND_COMPLETE.ClientContext != nullptr) {
+            ((CxPlatEvent*)Event->SEND_COMPLETE.ClientContext)->Set();
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ConnCallback(_In_ MsQuicConnection*, _In_opt_ void* Context, _Inout_ QUIC_CONNECTION_EVENT* Event) {
+        auto TestContext = (ZeroCopyRecvTestContext*)Context;
+        if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+            BOOLEAN Enabled = TRUE;
+            TestContext->SetParamStatus =
+                MsQuic->SetParam(
+                    Event->PEER_STREAM_STARTED.Stream,
+                    QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE,
+                    sizeof(Enabled),
+                    &Enabled);
+            uint32_t Size = sizeof(TestContext->ZeroCopyEnabled);
+            if (QUIC_FAILED(
+                MsQuic->GetParam(
+                    Event->PEER_STREAM_STARTED.Stream,
+                    QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE,
+                    &Size,
+                    &TestContext->ZeroCopyEnabled))) {
+                TestContext->ZeroCopyEnabled = FALSE;
+            }
+            TestContext->ServerStream =
+                new(std::nothrow) MsQuicStream(
+                    Event->PEER_STREAM_STARTED.Stream,
+                    TestContext->ServerCleanUpMode,
+                    ServerStreamCallback,
+                    Context);
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+};
+
+void
+QuicTestStreamZeroCopyReceive(
+    )
+{
+    MsQuicRegistration Registration(true);
+    TEST_QUIC_SUCCEEDED(Registration.GetInitStatus());
+
+    MsQuicConfiguration ServerConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetPeerUnidiStreamCount(1), ServerSelfSignedCredConfig);
+    TEST_QUIC_SUCCEEDED(ServerConfiguration.GetInitStatus());
+
+    //
+    // Without send buffering, SEND_COMPLETE means the data was acknowledged,
+    // and so processed by the server.
+    //
+    MsQuicConfiguration ClientConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetSendBufferingEnabled(false), MsQuicCredentialConfig());
+    TEST_QUIC_SUCCEEDED(ClientConfiguration.GetInitStatus());
+
+    const uint32_t BufferSize = ZeroCopyRecvChunkSize * ZeroCopyRecvChunkCount;
+    UniquePtr<uint8_t[]> SendDataBuffer{new(std::nothrow) uint8_t[BufferSize]};
+    TEST_TRUE(SendDataBuffer);
+    for (uint32_t i = 0; i < BufferSize; ++i) {
+        SendDataBuffer[i] = (uint8_t)(i ^ (i >> 8)); // Doesn't repeat every 256 bytes
+    }
+
+    //
+    // Send one packet sized chunk at a time, each arriving in order while the
+    // server is ready for it, and accept everything inline, then only half of
+    // every indication, then keep every receive pending and complete it from
+    // this thread only after later chunks were received and copied behind it.
+    //
+    const ZeroCopyRecvMode Modes[] = { ZeroCopyRecvAcceptAll, ZeroCopyRecvAcceptHalf, ZeroCopyRecvPending };
+    for (auto Mode : Modes) {
+        ZeroCopyRecvTestContext Context(Mode);
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, ZeroCopyRecvTestContext::ConnCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, ZeroCopyRecvTestContext::ClientStreamCallback);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Stream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+
+        for (uint32_t i = 0; i < ZeroCopyRecvChunkCount; ++i) {
+            CxPlatEvent SendComplete;
+            QUIC_BUFFER Buffer { ZeroCopyRecvChunkSize, SendDataBuffer.get() + i * ZeroCopyRecvChunkSize };
+            TEST_QUIC_SUCCEEDED(Stream.Send(&Buffer, 1, i == ZeroCopyRecvChunkCount - 1 ? QUIC_SEND_FLAG_FIN : QUIC_SEND_FLAG_NONE, &SendComplete));
+            TEST_TRUE(SendComplete.WaitTimeout(TestWaitTimeout));
+            if (Mode == ZeroCopyRecvPending && i % 2 == 1) {
+                Context.CompletePending();
+            }
+        }
+
+        if (Mode == ZeroCopyRecvPending) {
+            for (uint32_t Waited = 0; !Context.ReceiveDone.WaitTimeout(10); Waited += 10) {
+                TEST_TRUE(Waited < TestWaitTimeout);
+                Context.CompletePending();
+            }
+        } else {
+            TEST_TRUE(Context.ReceiveDone.WaitTimeout(TestWaitTimeout));
+        }
+        TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+
+        TEST_QUIC_SUCCEEDED(Context.SetParamStatus);
+        TEST_TRUE(Context.ZeroCopyEnabled);
+        TEST_FALSE(Context.Overflow);
+        TEST_EQUAL(Context.ReceivedLength, BufferSize);
+        TEST_EQUAL(0, memcmp(SendDataBuffer.get(), Context.RecvBuffer, BufferSize));
+        if (Mode == ZeroCopyRecvAcceptHalf) {
+            TEST_TRUE(Context.PartialAccepts != 0);
+        }
+    }
+
+    //
+    // Shut down the server stream's receive path, abort the client stream,
+    // or close the server stream while the server still holds a packet it
+    // indicated from, with a later chunk copied behind it. The held packet
+    // must be given back to the datapath when the stream is freed.
+    //
+    for (uint32_t Case = 0; Case < 3; ++Case) {
+        ZeroCopyRecvTestContext Context(ZeroCopyRecvPending);
+        if (Case == 2) {
+            Context.ServerCleanUpMode = CleanUpManual;
+        }
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, ZeroCopyRecvTestContext::ConnCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, ZeroCopyRecvTestContext::ClientStreamCallback);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Stream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+
+        for (uint32_t i = 0; i < 2; ++i) {
+            CxPlatEvent SendComplete;
+            QUIC_BUFFER Buffer { ZeroCopyRecvChunkSize, SendDataBuffer.get() + i * ZeroCopyRecvChunkSize };
+            TEST_QUIC_SUCCEEDED(Stream.Send(&Buffer, 1, QUIC_SEND_FLAG_NONE, &SendComplete));
+            TEST_TRUE(SendComplete.WaitTimeout(TestWaitTimeout));
+        }
+        TEST_TRUE(Context.Received.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Context.ZeroCopyEnabled);
+        TEST_TRUE(Context.ReceivedLength != 0 && Context.ReceivedLength <= ZeroCopyRecvChunkSize);
+        TEST_EQUAL(0, memcmp(SendDataBuffer.get(), Context.RecvBuffer, (size_t)Context.ReceivedLength));
+
+        if (Case == 0) {
+            TEST_QUIC_SUCCEEDED(Context.ServerStream->Shutdown(1, QUIC_STREAM_SHUTDOWN_FLAG_ABORT_RECEIVE));
+            TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+        } else if (Case == 1) {
+            TEST_QUIC_SUCCEEDED(Stream.Shutdown(1, QUIC_STREAM_SHUTDOWN_FLAG_ABORT_SEND));
+            TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+        } else {
+            delete Context.ServerStream;
+            Context.ServerStream = nullptr;
+        }
+    }
+
+    //
+    // The option is only accepted on streams that use the regular receive
+    // buffer, and not in multi-receive or app-owned buffer mode.
+    //
+    {
+        MsQuicConfiguration MultiRecvClientConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetStreamMultiReceiveEnabled(true), MsQuicCredentialConfig());
+        TEST_QUIC_SUCCEEDED(MultiRecvClientConfiguration.GetInitStatus());
+
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, MsQuicConnection::NoOpCallback);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicConnection MultiRecvConnection(Registration);
+        TEST_QUIC_SUCCEEDED(MultiRecvConnection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(MultiRecvConnection.Start(MultiRecvClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(MultiRecvConnection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(MultiRecvConnection.HandshakeComplete);
+
+        BOOLEAN Enabled = TRUE;
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_NONE);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->SetParam(
+                Stream.Handle,
+                QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE,
+                sizeof(Enabled),
+                &Enabled));
+
+        MsQuicStream AppOwnedStream(Connection, QUIC_STREAM_OPEN_FLAG_APP_OWNED_BUFFERS);
+        TEST_QUIC_SUCCEEDED(AppOwnedStream.GetInitStatus());
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_STATE,
+            MsQuic->SetParam(
+                AppOwnedStream.Handle,
+                QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE,
+                sizeof(Enabled),
+                &Enabled));
+
+        MsQuicStream MultiRecvStream(MultiRecvConnection, QUIC_STREAM_OPEN_FLAG_NONE);
+        TEST_QUIC_SUCCEEDED(MultiRecvStream.GetInitStatus());
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_INVALID_STATE,
+            MsQuic->SetParam(
+                MultiRecvStream.Handle,
+                QUIC_PARAM_STREAM_ZERO_COPY_RECEIVE,
+                sizeof(Enabled),
+                &Enabled));
+    }
+}
+
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
+
+#if defined(QUIC_API_ENABLE_PREVIEW_FEATURES) && !defined(_KERNEL_MODE)
+
+struct ConnectionRebalanceContext {
+    MsQuicConnection* Server {nullptr};
+    MsQuicStream* ServerStream {nullptr};
+    CxPlatEvent ServerStreamReceived;
+    CxPlatEvent ServerMoved;
+    uint32_t ServerMoveCount {0};
+    uint16_t ServerPartitionIndex {UINT16_MAX};
+    uint64_t ServerBytesReceived {0};
+    CxPlatEvent Blocked;
+    CxPlatEvent Unblock;
+    uint8_t SendBuffer[100] {};
+    QUIC_BUFFER Buffer { sizeof(SendBuffer), SendBuffer };
+
+    static QUIC_STATUS ServerStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (ConnectionRebalanceContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_RECEIVE) {
+            TestContext->ServerBytesReceived += Event->RECEIVE.TotalBufferLength;
+            TestContext->ServerStreamReceived.Set();
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ServerConnCallback(_In_ MsQuicConnection* Connection, _In_opt_ void* Context, _Inout_ QUIC_CONNECTION_EVENT* Event) {
+        auto TestContext = (ConnectionRebalanceContext*)Context;
+        if (TestContext->Server == nullptr) {
+            TestContext->Server = Connection; // The first one accepted is the one under test.
+        }
+        if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+            if (Connection == TestContext->Server) {
+                TestContext->ServerStream =
+                    new(std::nothrow) MsQuicStream(Event->PEER_STREAM_STARTED.Stream, CleanUpAutoDelete, ServerStreamCallback, Context);
+            } else {
+                new(std::nothrow) MsQuicStream(Event->PEER_STREAM_STARTED.Stream, CleanUpAutoDelete, MsQuicStream::NoOpCallback);
+            }
+        } else if (Event->Type == QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED &&
+            Connection == TestContext->Server) {
+            TestContext->ServerPartitionIndex = Event->IDEAL_PROCESSOR_CHANGED.PartitionIndex;
+            TestContext->ServerMoveCount++;
+            TestContext->ServerMoved.Set();
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    //
+    // Holds up the worker thread the stream's connection is on.
+    //
+    static QUIC_STATUS BlockingStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (ConnectionRebalanceContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_START_COMPLETE) {
+            TestContext->Blocked.Set();
+            TestContext->Unblock.WaitTimeout(TestWaitTimeout);
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+};
+
+//
+// Returns UINT16_MAX on failure.
+//
+static uint16_t
+ConnectionRebalanceGetIdealProcessor(
+    _In_ MsQuicConnection& Connection
+    )
+{
+    uint16_t IdealProcessor = UINT16_MAX;
+    uint32_t Length = sizeof(IdealProcessor);
+    if (QUIC_FAILED(Connection.GetParam(QUIC_PARAM_CONN_IDEAL_PROCESSOR, &Length, &IdealProcessor))) {
+        return UINT16_MAX;
+    }
+    return IdealProcessor;
+}
+
+void
+QuicTestConnectionRebalance(
+    )
+{
+    MsQuicRegistration Registration(true);
+    TEST_QUIC_SUCCEEDED(Registration.GetInitStatus());
+
+    //
+    // The client is kept in its own registration (and so on its own workers),
+    // so only the server side connections load the server's workers.
+    //
+    MsQuicRegistration ClientRegistration(true);
+    TEST_QUIC_SUCCEEDED(ClientRegistration.GetInitStatus());
+
+    GlobalSettingScope ParamScope(QUIC_PARAM_GLOBAL_EXECUTION_CONFIG);
+    QUIC_GLOBAL_EXECUTION_CONFIG Config {};
+    Config.Flags = QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_REBALANCE;
+    TEST_QUIC_SUCCEEDED(
+        MsQuic->SetParam(
+            nullptr,
+            QUIC_PARAM_GLOBAL_EXECUTION_CONFIG,
+            QUIC_GLOBAL_EXECUTION_CONFIG_MIN_SIZE,
+            &Config));
+
+    MsQuicConfiguration ServerConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetPeerBidiStreamCount(1).SetPeerUnidiStreamCount(1), ServerSelfSignedCredConfig);
+    TEST_QUIC_SUCCEEDED(ServerConfiguration.GetInitStatus());
+
+    MsQuicConfiguration ClientConfiguration(Registration, "MsQuicTest", MsQuicCredentialConfig());
+    TEST_QUIC_SUCCEEDED(ClientConfiguration.GetInitStatus());
+
+    MsQuicConfiguration DriverConfiguration(ClientRegistration, "MsQuicTest", MsQuicCredentialConfig());
+    TEST_QUIC_SUCCEEDED(DriverConfiguration.GetInitStatus());
+
+    ConnectionRebalanceContext Context;
+    MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, ConnectionRebalanceContext::ServerConnCallback, &Context);
+    TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+    TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+    QuicAddr ServerLocalAddr;
+    TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+    //
+    // Bring up the server connection under test, and let any RSS driven
+    // partition change from the handshake settle with a round trip of data.
+    //
+    MsQuicConnection Client(ClientRegistration);
+    TEST_QUIC_SUCCEEDED(Client.GetInitStatus());
+    MsQuicStream ClientStream(Client, QUIC_STREAM_OPEN_FLAG_NONE);
+    TEST_QUIC_SUCCEEDED(ClientStream.GetInitStatus());
+    TEST_QUIC_SUCCEEDED(ClientStream.Send(&Context.Buffer, 1, QUIC_SEND_FLAG_START));
+    TEST_QUIC_SUCCEEDED(Client.Start(DriverConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+    TEST_TRUE(Client.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+    TEST_TRUE(Client.HandshakeComplete);
+    TEST_TRUE(Context.ServerStreamReceived.WaitTimeout(TestWaitTimeout));
+    TEST_NOT_EQUAL(nullptr, Context.Server);
+    TEST_NOT_EQUAL(nullptr, Context.ServerStream);
+    const uint32_t InitialMoveCount = Context.ServerMoveCount;
+
+    //
+    // Find the server connection's partition by opening connections in each
+    // partition until one lands on the same processor. They share a worker.
+    //
+    const uint16_t ServerProcessor = ConnectionRebalanceGetIdealProcessor(*Context.Server);
+    TEST_NOT_EQUAL(UINT16_MAX, ServerProcessor);
+    uint16_t PartitionCount = 0;
+    uint16_t ServerPartition = UINT16_MAX;
+    UniquePtr<MsQuicConnection> Blocker;
+    for (uint16_t i = 0; i < UINT16_MAX; ++i) {
+        UniquePtr<MsQuicConnection> Connection(new(std::nothrow) MsQuicConnection(Registration, i));
+        TEST_NOT_EQUAL(nullptr, Connection);
+        if (QUIC_FAILED(Connection->GetInitStatus())) {
+            break; // Past the last partition.
+        }
+        ++PartitionCount;
+        if (ServerPartition == UINT16_MAX &&
+            ConnectionRebalanceGetIdealProcessor(*Connection) == ServerProcessor) {
+            ServerPartition = i;
+            Blocker = std::move(Connection);
+        }
+    }
+    if (PartitionCount < 2) {
+        return; // Nowhere to move to.
+    }
+    TEST_NOT_EQUAL(UINT16_MAX, ServerPartition);
+
+    MsQuicConnection Queued(Registration, ServerPartition);
+    TEST_QUIC_SUCCEEDED(Queued.GetInitStatus());
+
+    TEST_QUIC_SUCCEEDED(Blocker->Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+    TEST_TRUE(Blocker->HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+    TEST_TRUE(Blocker->HandshakeComplete);
+    TEST_EQUAL(InitialMoveCount, Context.ServerMoveCount);
+
+    //
+    // Hold up the shared worker, and while it is held queue the server
+    // connection and then another connection behind it. Once released, the
+    // server connection's time in the queue takes the worker's average queue
+    // delay over the rebalance threshold, with a connection still waiting, so
+    // the server connection is moved to an idle worker.
+    //
+    MsQuicStream BlockingStream(*Blocker, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, ConnectionRebalanceContext::BlockingStreamCallback, &Context);
+    TEST_QUIC_SUCCEEDED(BlockingStream.GetInitStatus());
+    TEST_QUIC_SUCCEEDED(BlockingStream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+    TEST_TRUE(Context.Blocked.WaitTimeout(TestWaitTimeout));
+    TEST_QUIC_SUCCEEDED(Context.ServerStream->Send(&Context.Buffer, 1));
+    CxPlatSleep(20);
+    TEST_QUIC_SUCCEEDED(Queued.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+    CxPlatSleep(20);
+    Context.Unblock.Set();
+
+    TEST_TRUE(Context.ServerMoved.WaitTimeout(TestWaitTimeout));
+    TEST_EQUAL(InitialMoveCount + 1, Context.ServerMoveCount);
+    const uint16_t NewPartition = Context.ServerPartitionIndex;
+    TEST_NOT_EQUAL(ServerPartition, NewPartition);
+    TEST_TRUE(NewPartition < PartitionCount);
+
+    //
+    // The client's packets still arrive on the old partition, but the RSS
+    // based partition update must not move the connection straight back.
+    //
+    for (uint32_t i = 0; i < 10; ++i) {
+        const uint64_t BytesReceived = Context.ServerBytesReceived;
+        TEST_QUIC_SUCCEEDED(ClientStream.Send(&Context.Buffer, 1));
+        do {
+            TEST_TRUE(Context.ServerStreamReceived.WaitTimeout(TestWaitTimeout));
+        } while (Context.ServerBytesReceived < BytesReceived + sizeof(Context.SendBuffer));
+    }
+    TEST_FALSE(Context.ServerMoved.WaitTimeout(100));
+    TEST_EQUAL(InitialMoveCount + 1, Context.ServerMoveCount);
+    const uint16_t NewProcessor = ConnectionRebalanceGetIdealProcessor(*Context.Server);
+    TEST_NOT_EQUAL(UINT16_MAX, NewProcessor);
+    TEST_NOT_EQUAL(ServerProcessor, NewProcessor);
+}
+
+//
+// StreamSendFile tests.
+//
+
+//
+// A temporary file holding the given contents, deleted once closed.
+//
+struct SendFileTempFile {
+    QUIC_FILE File;
+#ifdef _WIN32
+    char Path[MAX_PATH] {0};
+#else
+    char Path[32] = "/tmp/msquic_send_file_XXXXXX";
+#endif
+    bool Written {false};
+
+    SendFileTempFile(const uint8_t* Data, uint32_t Length) {
+#ifdef _WIN32
+        char Dir[MAX_PATH];
+        File = INVALID_HANDLE_VALUE;
+        if (GetTempPathA(sizeof(Dir), Dir) == 0 ||
+            GetTempFileNameA(Dir, "qsf", 0, Path) == 0) {
+            return;
+        }
+        File =
+            CreateFileA(
+                Path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        DWORD BytesWritten;
+        Written =
+            File != INVALID_HANDLE_VALUE &&
+            WriteFile(File, Data, Length, &BytesWritten, NULL) &&
+            BytesWritten == Length;
+#else
+        File = mkstemp(Path);
+        if (File == -1) {
+            return;
+        }
+        unlink(Path);
+        while (Length != 0) {
+            ssize_t BytesWritten = write(File, Data, Length);
+            if (BytesWritten <= 0) {
+                return;
+            }
+            Data += BytesWritten;
+            Length -= (uint32_t)BytesWritten;
+        }
+        Written = true;
+#endif
+    }
+
+    ~SendFileTempFile() {
+#ifdef _WIN32
+        if (File != INVALID_HANDLE_VALUE) {
+            CloseHandle(File);
+        }
+#else
+        if (File != -1) {
+            close(File);
+        }
+#endif
+    }
+
+    void Truncate(uint64_t Length) {
+#ifdef _WIN32
+        LARGE_INTEGER Position;
+        Position.QuadPart = (LONGLONG)Length;
+        CXPLAT_FRE_ASSERT(SetFilePointerEx(File, Position, NULL, FILE_BEGIN));
+        CXPLAT_FRE_ASSERT(SetEndOfFile(File));
+#else
+        CXPLAT_FRE_ASSERT(ftruncate(File, (off_t)Length) == 0);
+#endif
+    }
+
+    //
+    // Whether a handle to the file other than File is open in the process.
+    //
+    bool IsOpenElsewhere() const {
+#ifdef __linux__
+        uint32_t Count = 0;
+        DIR* Fds = opendir("/proc/self/fd");
+        if (Fds != nullptr) {
+            struct dirent* Entry;
+            while ((Entry = readdir(Fds)) != nullptr) {
+                char Target[512];
+                ssize_t Length = readlinkat(dirfd(Fds), Entry->d_name, Target, sizeof(Target) - 1);
+                if (Length > 0) {
+                    Target[Length] = '\0';
+                    if (strstr(Target, Path) != nullptr) {
+                        Count++;
+                    }
+                }
+            }
+            closedir(Fds);
+        }
+        return Count > 1;
+#else
+        return false; // No way to tell.
+#endif
+    }
+};
+
+#define SendFileContextFile     ((void*)(uintptr_t)1)
+#define SendFileContextBuffer   ((void*)(uintptr_t)2)
+
+struct SendFileTestContext {
+    const uint8_t* Expected;
+    uint64_t ExpectedLength;
+    bool StallReceive {false}; // Keeps the first receive pending forever.
+    uint64_t ReceivedLength {0};
+    bool Mismatch {false};
+    bool PeerSendAborted {false};
+    QUIC_UINT62 PeerSendAbortErrorCode {0};
+    MsQuicStream* ServerStream {nullptr};
+    CxPlatEvent Stalled;
+    CxPlatEvent ReceiveDone;
+    CxPlatEvent ServerStreamShutdown;
+    CxPlatEvent ClientStreamShutdown;
+    uint32_t SendCompleteCount {0};
+    void* SendCompleteContexts[2] {};
+    BOOLEAN SendCompleteCanceled[2] {};
+
+    SendFileTestContext(const uint8_t* Data, uint64_t Length) : Expected(Data), ExpectedLength(Length) { }
+
+    static QUIC_STATUS ServerStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (SendFileTestContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_RECEIVE) {
+            uint64_t Offset = Event->RECEIVE.AbsoluteOffset;
+            for (uint32_t i = 0; i < Event->RECEIVE.BufferCount; ++i) {
+                const QUIC_BUFFER* Buffer = &Event->RECEIVE.Buffers[i];
+                if (Offset + Buffer->Length > TestContext->ExpectedLength ||
+                    memcmp(TestContext->Expected + Offset, Buffer->Buffer, Buffer->Length) != 0) {
+                    TestContext->Mismatch = true;
+                }
+                Offset += Buffer->Length;
+            }
+            TestContext->ReceivedLength += Event->RECEIVE.TotalBufferLength;
+            if (TestContext->StallReceive) {
+                TestContext->Stalled.Set();
+                return QUIC_STATUS_PENDING;
+            }
+        } else if (Event->Type == QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN) {
+            TestContext->ReceiveDone.Set();
+        } else if (Event->Type == QUIC_STREAM_EVENT_PEER_SEND_ABORTED) {
+            TestContext->PeerSendAborted = true;
+            TestContext->PeerSendAbortErrorCode = Event->PEER_SEND_ABORTED.ErrorCode;
+        } else if (Event->Type == QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE) {
+            TestContext->ServerStreamShutdown.Set();
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ClientStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (SendFileTestContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_SEND_COMPLETE) {
+            if (TestContext->SendCompleteCount < ARRAYSIZE(TestContext->SendCompleteContexts)) {
+                TestContext->SendCompleteContexts[TestContext->SendCompleteCount] = Event->SEND_COMPLETE.ClientContext;
+                TestContext->SendCompleteCanceled[TestContext->SendCompleteCount] = Event->SEND_COMPLETE.Canceled;
+            }
+            TestContext->SendCompleteCount++;
+        } else if (Event->Type == QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE) {
+            TestContext->ClientStreamShutdown.Set();
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ConnCallback(_In_ MsQuicConnection*, _In_opt_ void* Context, _Inout_ QUIC_CONNECTION_EVENT* Event) {
+        if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+            ((SendFileTestContext*)Context)->ServerStream =
+                new(std::nothrow) MsQuicStream(Event->PEER_STREAM_STARTED.Stream, CleanUpAutoDelete, ServerStreamCallback, Context);
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+};
+
+void
+QuicTestStreamSendFile(
+    )
+{
+    MsQuicRegistration Registration(true);
+    TEST_QUIC_SUCCEEDED(Registration.GetInitStatus());
+
+    MsQuicConfiguration ServerConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetPeerUnidiStreamCount(1), ServerSelfSignedCredConfig);
+    TEST_QUIC_SUCCEEDED(ServerConfiguration.GetInitStatus());
+
+    MsQuicConfiguration ClientConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetSendBufferingEnabled(true), MsQuicCredentialConfig());
+    TEST_QUIC_SUCCEEDED(ClientConfiguration.GetInitStatus());
+
+    const uint32_t FileLength = 16 * 1024 * 1024;
+    const uint32_t BufferLength = 1000;
+    UniquePtr<uint8_t[]> Data{new(std::nothrow) uint8_t[FileLength + BufferLength]};
+    TEST_TRUE(Data);
+    for (uint32_t i = 0; i < FileLength + BufferLength; ++i) {
+        Data[i] = (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+    }
+
+    //
+    // Send 1MB of the file, then a small buffer with the FIN. Send buffering
+    // would normally complete the buffer send right away, but nothing queued
+    // behind a file send is buffered, so it must only complete after the
+    // file send, once that is acknowledged.
+    //
+    {
+        const uint32_t SentFileLength = 1024 * 1024;
+        SendFileTempFile Temp(Data.get(), SentFileLength);
+        TEST_TRUE(Temp.Written);
+
+        UniquePtr<uint8_t[]> Expected{new(std::nothrow) uint8_t[SentFileLength + BufferLength]};
+        TEST_TRUE(Expected);
+        memcpy(Expected.get(), Data.get(), SentFileLength);
+        memcpy(Expected.get() + SentFileLength, Data.get() + FileLength, BufferLength);
+
+        SendFileTestContext Context(Expected.get(), SentFileLength + BufferLength);
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, SendFileTestContext::ConnCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, SendFileTestContext::ClientStreamCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Stream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+
+        QUIC_BUFFER Buffer { BufferLength, Data.get() + FileLength };
+        TEST_QUIC_SUCCEEDED(MsQuic->StreamSendFile(Stream.Handle, Temp.File, 0, SentFileLength, QUIC_SEND_FLAG_NONE, SendFileContextFile));
+        TEST_QUIC_SUCCEEDED(Stream.Send(&Buffer, 1, QUIC_SEND_FLAG_FIN, SendFileContextBuffer));
+
+        TEST_TRUE(Context.ReceiveDone.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Context.ClientStreamShutdown.WaitTimeout(TestWaitTimeout));
+
+        TEST_FALSE(Context.Mismatch);
+        TEST_EQUAL(Context.ReceivedLength, SentFileLength + BufferLength);
+        TEST_EQUAL(Context.SendCompleteCount, 2u);
+        TEST_EQUAL(Context.SendCompleteContexts[0], SendFileContextFile);
+        TEST_EQUAL(Context.SendCompleteContexts[1], SendFileContextBuffer);
+        TEST_FALSE(Context.SendCompleteCanceled[0]);
+        TEST_FALSE(Context.SendCompleteCanceled[1]);
+        TEST_FALSE(Temp.IsOpenElsewhere());
+    }
+
+    //
+    // Abort the stream partway through a large file send, held up by the
+    // receiver never completing its first receive. The send completes as
+    // canceled and the stream's handle to the file must be closed.
+    //
+    {
+        SendFileTempFile Temp(Data.get(), FileLength);
+        TEST_TRUE(Temp.Written);
+
+        SendFileTestContext Context(Data.get(), FileLength);
+        Context.StallReceive = true;
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, SendFileTestContext::ConnCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, SendFileTestContext::ClientStreamCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Stream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+
+        TEST_QUIC_SUCCEEDED(MsQuic->StreamSendFile(Stream.Handle, Temp.File, 0, FileLength, QUIC_SEND_FLAG_FIN, SendFileContextFile));
+        TEST_TRUE(Context.Stalled.WaitTimeout(TestWaitTimeout));
+#ifdef __linux__
+        TEST_TRUE(Temp.IsOpenElsewhere()); // The send is still in flight.
+#endif
+        TEST_QUIC_SUCCEEDED(Stream.Shutdown(1, QUIC_STREAM_SHUTDOWN_FLAG_ABORT_SEND));
+
+        TEST_TRUE(Context.ClientStreamShutdown.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+
+        TEST_FALSE(Context.Mismatch);
+        TEST_TRUE(Context.ReceivedLength != 0 && Context.ReceivedLength < FileLength);
+        TEST_EQUAL(Context.SendCompleteCount, 1u);
+        TEST_EQUAL(Context.SendCompleteContexts[0], SendFileContextFile);
+        TEST_TRUE(Context.SendCompleteCanceled[0]);
+        TEST_FALSE(Temp.IsOpenElsewhere());
+    }
+
+    //
+    // Truncate the file while the receiver holds up the send, then let the
+    // send continue. The next read comes up short, so the send completes as
+    // canceled and the peer sees the send direction aborted.
+    //
+    {
+        SendFileTempFile Temp(Data.get(), FileLength);
+        TEST_TRUE(Temp.Written);
+
+        SendFileTestContext Context(Data.get(), FileLength);
+        Context.StallReceive = true;
+        MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, SendFileTestContext::ConnCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+        QuicAddr ServerLocalAddr;
+        TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+        MsQuicConnection Connection(Registration);
+        TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+        TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Connection.HandshakeComplete);
+
+        MsQuicStream Stream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, SendFileTestContext::ClientStreamCallback, &Context);
+        TEST_QUIC_SUCCEEDED(Stream.GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Stream.Start(QUIC_STREAM_START_FLAG_IMMEDIATE));
+
+        TEST_QUIC_SUCCEEDED(MsQuic->StreamSendFile(Stream.Handle, Temp.File, 0, FileLength, QUIC_SEND_FLAG_FIN, SendFileContextFile));
+        TEST_TRUE(Context.Stalled.WaitTimeout(TestWaitTimeout));
+        TEST_NOT_EQUAL(nullptr, Context.ServerStream);
+
+        Temp.Truncate(0);
+        Context.StallReceive = false;
+        Context.ServerStream->ReceiveComplete(Context.ReceivedLength);
+
+        TEST_TRUE(Context.ClientStreamShutdown.WaitTimeout(TestWaitTimeout));
+        TEST_TRUE(Context.ServerStreamShutdown.WaitTimeout(TestWaitTimeout));
+
+        TEST_FALSE(Context.Mismatch);
+        TEST_TRUE(Context.ReceivedLength < FileLength);
+        TEST_TRUE(Context.PeerSendAborted);
+        TEST_EQUAL(Context.PeerSendAbortErrorCode, 0u);
+        TEST_EQUAL(Context.SendCompleteCount, 1u);
+        TEST_EQUAL(Context.SendCompleteContexts[0], SendFileContextFile);
+        TEST_TRUE(Context.SendCompleteCanceled[0]);
+        TEST_FALSE(Temp.IsOpenElsewhere());
+    }
+}
+
+#endif // QUIC_API_ENABLE_PREVIEW_FEATURES && !_KERNEL_MODE